@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit dispatch microbenchmarks.
+
+#include <nullvm/core/exit_dispatcher.hpp>
+#include <nullvm/core/devices/bus.hpp>
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+#include <memory>
+#include <array>
+#include <bit>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Device doing no emulation work.
+    class NullDevice final : public devices::Device {
+    public:
+        auto read(u64, std::span<u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            benchmark::DoNotOptimize(data.data());
+            return None {};
+        }
+
+        auto write(u64, std::span<const u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            benchmark::DoNotOptimize(data.data());
+            return None {};
+        }
+    };
+
+    /// Size of fake virtual CPU state mapping.
+    constexpr usize STATE_SIZE {0x3000};
+
+    /// Offset of I/O data inside fake virtual CPU state mapping.
+    constexpr usize IO_DATA_OFFSET {0x1000};
+
+    /// @brief Fill bus with devices spaced 16 addresses apart.
+    ///
+    /// @param [in] bus given bus to fill.
+    /// @param [in] count given number of devices.
+    auto fill_bus(devices::Bus& bus, i64 count) -> void {
+        for (i64 i = 0; i < count; ++i) {
+            const auto base = static_cast<u64>(i) * 0x10;
+            auto result = bus.insert(base, 0x8, std::make_shared<NullDevice>());
+
+            if (!result)
+                throw std::runtime_error(result.error());
+        }
+    }
+
+    /// @brief Create dispatcher routing I/O and MMIO exits to buses.
+    ///
+    /// @param [in] pio given I/O port bus.
+    /// @param [in] mmio given MMIO bus.
+    ///
+    /// @return Exit dispatcher.
+    auto make_dispatcher(const devices::Bus& pio, const devices::Bus& mmio)
+    -> ExitDispatcher {
+        ExitDispatcher dispatcher;
+
+        auto result = dispatcher.set_handler(
+            KVM_EXIT_IO,
+            [&pio](kvm_run& state) -> VmmResult<ExitAction> {
+                const auto& io = state.io;
+                const auto data = std::span(
+                    std::bit_cast<u8*>(&state) + io.data_offset,
+                    static_cast<usize>(io.size) * io.count
+                );
+
+                if (auto result = pio.write(io.port, data, io.size); !result)
+                    return std::unexpected(result.error());
+
+                return ExitAction::Continue;
+            }
+        );
+
+        if (!result)
+            throw std::runtime_error(result.error());
+
+        result = dispatcher.set_handler(
+            KVM_EXIT_MMIO,
+            [&mmio](kvm_run& state) -> VmmResult<ExitAction> {
+                auto& access = state.mmio;
+                const auto data = std::span(access.data, access.len);
+
+                if (auto result = mmio.read(access.phys_addr, data, access.len);
+                    !result)
+                    return std::unexpected(result.error());
+
+                return ExitAction::Continue;
+            }
+        );
+
+        if (!result)
+            throw std::runtime_error(result.error());
+
+        return dispatcher;
+    }
+}
+
+/// Device lookup on bus with growing number of devices.
+static auto BM_bus_lookup(benchmark::State& state) -> void {
+    devices::Bus bus;
+    fill_bus(bus, state.range(0));
+
+    const auto last = static_cast<u64>(state.range(0) - 1) * 0x10;
+    std::array<u8, 1> data {};
+
+    for (auto _ : state) {
+        auto result = bus.read(last + 3, data, 1);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_bus_lookup)->RangeMultiplier(4)->Range(1, 1024);
+
+/// Dispatch of port I/O exit through dispatch table and bus.
+static auto BM_exit_dispatch_pio(benchmark::State& state) -> void {
+    devices::Bus pio, mmio;
+    fill_bus(pio, state.range(0));
+
+    const auto dispatcher = make_dispatcher(pio, mmio);
+
+    auto buffer = std::make_unique<u8[]>(STATE_SIZE);
+    auto run = std::bit_cast<kvm_run*>(buffer.get());
+
+    run->exit_reason    = KVM_EXIT_IO;
+    run->io.direction   = KVM_EXIT_IO_OUT;
+    run->io.size        = 1;
+    run->io.count       = 1;
+    run->io.port        = static_cast<__u16>((state.range(0) - 1) * 0x10);
+    run->io.data_offset = IO_DATA_OFFSET;
+
+    for (auto _ : state) {
+        auto result = dispatcher.dispatch(*run);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_exit_dispatch_pio)->RangeMultiplier(4)->Range(1, 1024);
+
+/// Dispatch of MMIO read exit through dispatch table and bus.
+static auto BM_exit_dispatch_mmio(benchmark::State& state) -> void {
+    devices::Bus pio, mmio;
+    fill_bus(mmio, state.range(0));
+
+    const auto dispatcher = make_dispatcher(pio, mmio);
+
+    auto buffer = std::make_unique<u8[]>(STATE_SIZE);
+    auto run = std::bit_cast<kvm_run*>(buffer.get());
+
+    run->exit_reason    = KVM_EXIT_MMIO;
+    run->mmio.phys_addr = static_cast<u64>(state.range(0) - 1) * 0x10;
+    run->mmio.len       = 4;
+    run->mmio.is_write  = 0;
+
+    for (auto _ : state) {
+        auto result = dispatcher.dispatch(*run);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_exit_dispatch_mmio)->RangeMultiplier(4)->Range(1, 1024);
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Logger microbenchmarks.
+
+#include <nullvm/log.hpp>
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+#include <fcntl.h>
+
+using namespace nullvm;
+
+namespace {
+    /// @brief Redirect log output to null device.
+    ///
+    /// @return Null device file descriptor.
+    auto open_null_output() -> i32 {
+        const auto fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+        if (fd == -1)
+            throw std::runtime_error("Error to open /dev/null");
+
+        log::set_output(fd);
+        return fd;
+    }
+}
+
+/// Cost of logging call on producer thread.
+static auto BM_log_custom(benchmark::State& state) -> void {
+    const auto fd = open_null_output();
+
+    for (auto _ : state)
+        log::custom("INFO", "vCPU {} exit reason: {}", 3, 0x1fu);
+
+    log::flush();
+    log::set_output(STDOUT_FILENO);
+    close(fd);
+}
+BENCHMARK(BM_log_custom);
+
+/// Cost of logging call with string argument on producer thread.
+static auto BM_log_custom_string(benchmark::State& state) -> void {
+    const auto fd = open_null_output();
+
+    for (auto _ : state)
+        log::custom("INFO", "Received: '{}'", "message from client");
+
+    log::flush();
+    log::set_output(STDOUT_FILENO);
+    close(fd);
+}
+BENCHMARK(BM_log_custom_string);
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Stream unix domain socket (UDS) server throughput benchmarks.
+
+#include <nullvm/service/stream_uds.hpp>
+#include <nullvm/log.hpp>
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <cstring>
+#include <thread>
+#include <bit>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// Server socket path used in benchmarks.
+    constexpr auto BENCH_SERVER_PATH {"/tmp/nullvm_stream_server_bench"};
+
+    /// Request payload size in bytes.
+    constexpr usize PAYLOAD_SIZE {64};
+
+    /// @brief Connect to benchmark server.
+    ///
+    /// @return Connected socket file descriptor.
+    auto connect_client() -> i32 {
+        const auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (fd == -1)
+            throw std::runtime_error("Error to create client socket");
+
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(
+            addr.sun_path, BENCH_SERVER_PATH, sizeof(addr.sun_path) - 1
+        );
+
+        const auto ret = connect(
+            fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)
+        );
+
+        if (ret == -1)
+            throw std::runtime_error("Error to connect to server");
+
+        return fd;
+    }
+
+    /// @brief Write whole buffer to socket.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] data given bytes to write.
+    ///
+    /// @return true - in case of success.
+    /// @return false - otherwise.
+    auto write_all(i32 fd, std::span<const std::byte> data) -> bool {
+        while (!data.empty()) {
+            const auto ret = write(fd, data.data(), data.size());
+
+            if (ret <= 0)
+                return false;
+
+            data = data.subspan(static_cast<usize>(ret));
+        }
+
+        return true;
+    }
+
+    /// @brief Read given number of replies.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] parser given connection parser.
+    /// @param [in] count given number of replies.
+    ///
+    /// @return true - in case of success.
+    /// @return false - otherwise.
+    auto read_replies(i32 fd, protocol::Parser& parser, usize count)
+    -> bool {
+        while (count != 0) {
+            auto reply = parser.next();
+
+            if (!reply)
+                return false;
+
+            if (reply.value()) {
+                --count;
+                continue;
+            }
+
+            const auto buffer = parser.buffer();
+            const auto ret = read(fd, buffer.data(), buffer.size());
+
+            if (ret <= 0)
+                return false;
+
+            parser.commit(static_cast<usize>(ret));
+        }
+
+        return true;
+    }
+}
+
+/// Request round-trips with growing number of pipelined requests.
+static auto BM_stream_uds_requests(
+    benchmark::State& state, IOBackend backend
+) -> void {
+    const auto depth = static_cast<usize>(state.range(0));
+
+    auto server = StreamUDS({
+        .path = BENCH_SERVER_PATH, .workers = 1, .backend = backend
+    });
+
+    if (auto result = server.init(); !result) {
+        state.SkipWithError(result.error().c_str());
+        return;
+    }
+
+    server.set_handler(
+        [](i32, const protocol::Message& message, Reply& output) {
+            protocol::encode(
+                output.data, protocol::MessageType::Ok, message.header.id,
+                message.payload
+            );
+        }
+    );
+
+    // Server logs every connection, keep it out of measurements.
+    const auto null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    log::set_output(null_fd);
+
+    std::jthread thread([&server] { static_cast<void>(server.run()); });
+
+    const auto fd = connect_client();
+    const Bytes payload(PAYLOAD_SIZE);
+
+    Bytes requests;
+
+    for (usize i = 0; i < depth; ++i) {
+        protocol::encode(
+            requests, protocol::MessageType::VmStats,
+            static_cast<u32>(i), payload
+        );
+    }
+
+    protocol::Parser parser;
+
+    for (auto _ : state) {
+        if (!write_all(fd, requests) || !read_replies(fd, parser, depth)) {
+            state.SkipWithError("Error to exchange requests");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(
+        state.iterations() * static_cast<i64>(depth)
+    );
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<i64>(requests.size())
+    );
+
+    close(fd);
+    server.stop();
+    thread.join();
+
+    log::flush();
+    log::set_output(STDOUT_FILENO);
+    close(null_fd);
+}
+BENCHMARK_CAPTURE(BM_stream_uds_requests, epoll, IOBackend::Epoll)
+    ->RangeMultiplier(8)->Range(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(BM_stream_uds_requests, io_uring, IOBackend::IoUring)
+    ->RangeMultiplier(8)->Range(1, 64)->UseRealTime();
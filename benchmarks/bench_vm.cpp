@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine lifecycle and exit round-trip benchmarks.
+
+#include <nullvm/core/vm.hpp>
+#include <nullvm/log.hpp>
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Guest physical address of benchmark code.
+    constexpr u64 CODE_ADDR {0x1000};
+
+    /// Number of exits done by guest per run.
+    constexpr u64 EXITS_PER_RUN {1000};
+
+    /// Real mode guest doing EXITS_PER_RUN port writes.
+    const std::vector<u8> PIO_CODE = {
+        0xb9, 0xe8, 0x03,   // mov $1000, %cx
+        0xe6, 0xf8,         // 1: out %al, $0xf8
+        0xe2, 0xfc,         // loop 1b
+        0xf4,               // hlt
+    };
+
+    /// Real mode guest doing EXITS_PER_RUN writes to unbacked memory.
+    const std::vector<u8> MMIO_CODE = {
+        0xb9, 0xe8, 0x03,   // mov $1000, %cx
+        0xa2, 0x00, 0x30,   // 1: mov %al, (0x3000)
+        0xe2, 0xfb,         // loop 1b
+        0xf4,               // hlt
+    };
+
+    /// Real mode guest halting forever.
+    const std::vector<u8> HLT_CODE = {
+        0xf4,               // 1: hlt
+        0xeb, 0xfd,         // jmp 1b
+    };
+
+    /// Log output redirected to null device while object is alive.
+    ///
+    /// Virtual machine logs its setup and, in debug builds, every exit.
+    class NullLogOutput final {
+        /// Null device file descriptor.
+        i32 m_fd;
+
+    public:
+        /// @brief Construct new NullLogOutput object.
+        NullLogOutput() : m_fd(open("/dev/null", O_WRONLY | O_CLOEXEC)) {
+            if (m_fd == -1)
+                throw std::runtime_error("Error to open /dev/null");
+
+            log::set_output(m_fd);
+        }
+
+        /// @brief Destroy NullLogOutput object.
+        ~NullLogOutput() {
+            log::flush();
+            log::set_output(STDOUT_FILENO);
+            close(m_fd);
+        }
+    };
+
+    /// @brief Create virtual machine with single page of loaded code.
+    ///
+    /// @param [in] code given guest code.
+    ///
+    /// @return Initialized virtual machine.
+    auto make_vm(const std::vector<u8>& code)
+    -> std::unique_ptr<VirtualMachine> {
+        auto vm = std::make_unique<VirtualMachine>();
+
+        auto result = vm->init();
+
+        if (result)
+            result = vm->set_mem_region(CODE_ADDR, 0x1000);
+
+        if (result)
+            result = vm->load_raw(code);
+
+        if (!result)
+            throw std::runtime_error(result.error());
+
+        return vm;
+    }
+
+    /// @brief Report exit rate and single exit round-trip time.
+    ///
+    /// @param [in] state given benchmark state.
+    /// @param [in] exits given number of exits per iteration.
+    auto report_exits(benchmark::State& state, u64 exits) -> void {
+        const auto total = static_cast<f64>(state.iterations() * exits);
+
+        state.SetItemsProcessed(static_cast<i64>(total));
+        state.counters["exit_time"] = benchmark::Counter(
+            total, benchmark::Counter::kIsRate | benchmark::Counter::kInvert
+        );
+    }
+
+    /// @brief Run guest looping over exits from its first instruction.
+    ///
+    /// @param [in] state given benchmark state.
+    /// @param [in] code given guest code.
+    auto run_exit_loop(benchmark::State& state, const std::vector<u8>& code)
+    -> void {
+        const NullLogOutput output;
+        auto vm = make_vm(code);
+        auto& vcpu = vm->vcpu();
+
+        auto regs = vcpu.regs();
+
+        if (!regs)
+            throw std::runtime_error(regs.error());
+
+        for (auto _ : state) {
+            auto result = vcpu.set_regs(regs.value());
+
+            if (result)
+                result = vm->run();
+
+            if (!result) {
+                state.SkipWithError(result.error().c_str());
+                break;
+            }
+        }
+
+        report_exits(state, EXITS_PER_RUN);
+    }
+}
+
+/// Virtual machine creation with growing number of virtual CPUs.
+static auto BM_vm_init(benchmark::State& state) -> void {
+    const VmConfig config {.vcpus = static_cast<usize>(state.range(0))};
+    const NullLogOutput output;
+
+    for (auto _ : state) {
+        auto vm = std::make_unique<VirtualMachine>();
+
+        if (auto result = vm->init(config); !result) {
+            state.SkipWithError(result.error().c_str());
+            break;
+        }
+
+        // Teardown is not part of creation latency.
+        state.PauseTiming();
+        vm.reset();
+        state.ResumeTiming();
+    }
+}
+// Virtual CPUs and serial device start host threads, so wall time is
+// measured.
+BENCHMARK(BM_vm_init)
+    ->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// Virtual machine creation from shared KVM handle.
+static auto BM_vm_init_shared_kvm(benchmark::State& state) -> void {
+    const NullLogOutput output;
+    auto kvm = std::make_shared<Kvm>();
+
+    if (auto result = kvm->init(); !result)
+        throw std::runtime_error(result.error());
+
+    for (auto _ : state) {
+        auto vm = std::make_unique<VirtualMachine>();
+
+        if (auto result = vm->init({}, kvm); !result) {
+            state.SkipWithError(result.error().c_str());
+            break;
+        }
+
+        state.PauseTiming();
+        vm.reset();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_vm_init_shared_kvm)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// Guest memory region setup with growing region size.
+static auto BM_vm_set_mem_region(benchmark::State& state) -> void {
+    const auto size = static_cast<usize>(state.range(0));
+    const NullLogOutput output;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto vm = std::make_unique<VirtualMachine>();
+
+        if (auto result = vm->init(); !result) {
+            state.SkipWithError(result.error().c_str());
+            break;
+        }
+
+        state.ResumeTiming();
+
+        if (auto result = vm->set_mem_region(0, size); !result) {
+            state.SkipWithError(result.error().c_str());
+            break;
+        }
+
+        state.PauseTiming();
+        vm.reset();
+        state.ResumeTiming();
+    }
+
+    // Bytes rate gives cost per GB of guest memory.
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_vm_set_mem_region)
+    ->RangeMultiplier(4)->Range(16 << 20, 1 << 30)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// Raw binary loading into guest memory.
+static auto BM_vm_load_raw(benchmark::State& state) -> void {
+    const auto size = static_cast<usize>(state.range(0));
+    const std::vector<u8> raw(size, 0xf4);
+    const NullLogOutput output;
+
+    VirtualMachine vm;
+    auto result = vm.init();
+
+    if (result)
+        result = vm.set_mem_region(0, size);
+
+    if (!result)
+        throw std::runtime_error(result.error());
+
+    for (auto _ : state) {
+        result = vm.load_raw(raw);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_vm_load_raw)->RangeMultiplier(16)->Range(4 << 10, 16 << 20);
+
+/// Port I/O exit round-trip: guest write, bus dispatch and re-entry.
+static auto BM_vm_exit_pio(benchmark::State& state) -> void {
+    run_exit_loop(state, PIO_CODE);
+}
+BENCHMARK(BM_vm_exit_pio)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// MMIO exit round-trip: instruction decode in kernel, bus dispatch and
+/// re-entry.
+static auto BM_vm_exit_mmio(benchmark::State& state) -> void {
+    run_exit_loop(state, MMIO_CODE);
+}
+BENCHMARK(BM_vm_exit_mmio)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// HLT exit round-trip with userspace halt handling.
+static auto BM_vm_exit_hlt(benchmark::State& state) -> void {
+    const NullLogOutput output;
+    auto vm = make_vm(HLT_CODE);
+
+    // Each halt is resumed, run returns after batch of halts.
+    u64 halts {0};
+    auto result = vm->set_exit_handler(
+        KVM_EXIT_HLT,
+        [&halts](kvm_run&) -> VmmResult<ExitAction> {
+            if (++halts % EXITS_PER_RUN == 0)
+                return ExitAction::Halt;
+
+            return ExitAction::Continue;
+        }
+    );
+
+    if (!result)
+        throw std::runtime_error(result.error());
+
+    for (auto _ : state) {
+        if (result = vm->run(); !result) {
+            state.SkipWithError(result.error().c_str());
+            break;
+        }
+    }
+
+    report_exits(state, EXITS_PER_RUN);
+}
+BENCHMARK(BM_vm_exit_hlt)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Device bus mapping address ranges to devices related declarations.
+
+#include <nullvm/core/devices/bus.hpp>
+#include <algorithm>
+#include <format>
+#include <mutex>
+
+namespace nullvm::core::devices {
+
+    auto Bus::insert(u64 base, u64 size, std::shared_ptr<Device> device)
+    noexcept -> VmmResult<None> {
+        if (size == 0)
+            return std::unexpected("Device range size cannot be 0");
+
+        if (!device)
+            return std::unexpected("Device cannot be null");
+
+        if (base + size < base)
+            return std::unexpected("Device range overflows address space");
+
+        std::unique_lock lock(m_lock);
+
+        auto next = std::upper_bound(
+            m_ranges.begin(), m_ranges.end(), base,
+            [](u64 value, const BusRange& range) { return value < range.base; }
+        );
+
+        const auto overlaps_next = next != m_ranges.end() &&
+            base + size > next->base;
+
+        const auto overlaps_prev = next != m_ranges.begin() &&
+            std::prev(next)->base + std::prev(next)->size > base;
+
+        if (overlaps_next || overlaps_prev) {
+            const auto err = std::format(
+                "Device range {:#x}-{:#x} overlaps existing device",
+                base, base + size - 1
+            );
+            return std::unexpected(err);
+        }
+
+        m_ranges.insert(next, BusRange {base, size, std::move(device)});
+        return None {};
+    }
+
+    auto Bus::remove(u64 base) noexcept -> VmmResult<None> {
+        std::unique_lock lock(m_lock);
+
+        auto range = std::find_if(
+            m_ranges.begin(), m_ranges.end(),
+            [base](const BusRange& entry) { return entry.base == base; }
+        );
+
+        if (range == m_ranges.end()) {
+            const auto err = std::format("No device at {:#x}", base);
+            return std::unexpected(err);
+        }
+
+        m_ranges.erase(range);
+        return None {};
+    }
+
+    auto Bus::size() const noexcept -> usize {
+        std::shared_lock lock(m_lock);
+        return m_ranges.size();
+    }
+
+    auto Bus::read(u64 addr, std::span<u8> data, u32 size) const noexcept
+    -> VmmResult<None> {
+        std::shared_lock lock(m_lock);
+
+        if (const auto range = lookup(addr); range)
+            return range->device->read(addr - range->base, data, size);
+
+        std::ranges::fill(data, 0xff);
+        return None {};
+    }
+
+    auto Bus::write(u64 addr, std::span<const u8> data, u32 size)
+    const noexcept -> VmmResult<None> {
+        std::shared_lock lock(m_lock);
+
+        if (const auto range = lookup(addr); range)
+            return range->device->write(addr - range->base, data, size);
+
+        return None {};
+    }
+
+    auto Bus::lookup(u64 addr) const noexcept -> const BusRange* {
+        auto next = std::upper_bound(
+            m_ranges.begin(), m_ranges.end(), addr,
+            [](u64 value, const BusRange& range) { return value < range.base; }
+        );
+
+        if (next == m_ranges.begin())
+            return nullptr;
+
+        const auto& range = *std::prev(next);
+
+        if (addr - range.base >= range.size)
+            return nullptr;
+
+        return &range;
+    }
+
+}
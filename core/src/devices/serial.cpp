@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// 16550 UART serial console device related declarations.
+
+#include <nullvm/core/devices/serial.hpp>
+#include <unistd.h>
+#include <cerrno>
+#include <vector>
+
+namespace nullvm::core::devices {
+
+    namespace {
+        /// Transmit ring capacity in bytes.
+        constexpr usize RING_SIZE {64 * 1024};
+
+        /// Maximum number of bytes written to host at once.
+        constexpr usize DRAIN_BATCH_SIZE {16 * 1024};
+
+        /// Transmitter holding / receiver buffer / divisor latch low.
+        constexpr u64 REG_DATA {0};
+        /// Interrupt enable / divisor latch high.
+        constexpr u64 REG_IER {1};
+        /// Interrupt identification / FIFO control.
+        constexpr u64 REG_IIR {2};
+        /// Line control.
+        constexpr u64 REG_LCR {3};
+        /// Modem control.
+        constexpr u64 REG_MCR {4};
+        /// Line status.
+        constexpr u64 REG_LSR {5};
+        /// Modem status.
+        constexpr u64 REG_MSR {6};
+        /// Scratch.
+        constexpr u64 REG_SCR {7};
+
+        /// Divisor latch access bit.
+        constexpr u8 LCR_DLAB {0x80};
+        /// Transmitter holding register empty.
+        constexpr u8 LSR_THRE {0x20};
+        /// Transmitter empty.
+        constexpr u8 LSR_TEMT {0x40};
+        /// No interrupt pending.
+        constexpr u8 IIR_NO_INTERRUPT {0x01};
+        /// FIFOs enabled.
+        constexpr u8 IIR_FIFO_ENABLED {0xc0};
+        /// FIFO enable.
+        constexpr u8 FCR_FIFO_ENABLE {0x01};
+        /// Data carrier detect, data set ready and clear to send.
+        constexpr u8 MSR_DEFAULT {0xb0};
+
+        /// @brief Write whole buffer to file descriptor.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [in] data given bytes to write.
+        auto write_all(i32 fd, std::span<const u8> data) noexcept -> void {
+            while (!data.empty()) {
+                const auto ret = write(fd, data.data(), data.size());
+
+                if (ret == -1) {
+                    if (errno == EINTR)
+                        continue;
+
+                    // Host console is gone, output is dropped.
+                    return;
+                }
+
+                data = data.subspan(static_cast<usize>(ret));
+            }
+        }
+    }
+
+    Serial::Serial() noexcept : m_ring(RING_SIZE) {}
+
+    Serial::~Serial() noexcept {
+        if (!m_thread.joinable())
+            return;
+
+        m_stop.store(true);
+        m_events.fetch_add(1, std::memory_order_release);
+        m_events.notify_one();
+        m_thread.join();
+    }
+
+    auto Serial::init(i32 output_fd) noexcept -> VmmResult<None> {
+        if (output_fd < 0)
+            return std::unexpected("Invalid serial output file descriptor");
+
+        if (m_thread.joinable())
+            return std::unexpected("Serial device is already initialized");
+
+        m_output_fd = output_fd;
+        m_thread = std::jthread([this] { drain(); });
+
+        return None {};
+    }
+
+    auto Serial::read(u64 offset, std::span<u8> data, u32 size) noexcept
+    -> VmmResult<None> {
+        if (size == 0 || data.size() % size != 0)
+            return std::unexpected("Invalid serial access size");
+
+        std::lock_guard lock(m_lock);
+
+        for (usize i = 0; i < data.size(); i += size) {
+            for (u32 byte = 0; byte < size; ++byte)
+                data[i + byte] = read_register(offset + byte);
+        }
+
+        return None {};
+    }
+
+    auto Serial::write(u64 offset, std::span<const u8> data, u32 size) noexcept
+    -> VmmResult<None> {
+        if (size == 0 || data.size() % size != 0)
+            return std::unexpected("Invalid serial access size");
+
+        std::lock_guard lock(m_lock);
+
+        // String output to transmitter holding register is queued at once.
+        if (offset == REG_DATA && size == 1 && !(m_lcr & LCR_DLAB)) {
+            transmit(data);
+            return None {};
+        }
+
+        for (usize i = 0; i < data.size(); i += size) {
+            for (u32 byte = 0; byte < size; ++byte)
+                write_register(offset + byte, data[i + byte]);
+        }
+
+        return None {};
+    }
+
+    auto Serial::flush() noexcept -> void {
+        if (!m_thread.joinable())
+            return;
+
+        const auto target = m_queued.load(std::memory_order_acquire);
+        auto written = m_written.load(std::memory_order_acquire);
+
+        while (written != target) {
+            m_written.wait(written, std::memory_order_acquire);
+            written = m_written.load(std::memory_order_acquire);
+        }
+    }
+
+    auto Serial::transmit(std::span<const u8> data) noexcept -> void {
+        while (true) {
+            const auto count = m_ring.push(data);
+            data = data.subspan(count);
+
+            m_queued.fetch_add(
+                static_cast<u32>(count), std::memory_order_release
+            );
+            m_events.fetch_add(1, std::memory_order_release);
+            m_events.notify_one();
+
+            if (data.empty())
+                break;
+
+            // Ring is full, let drain thread catch up.
+            std::this_thread::yield();
+        }
+    }
+
+    auto Serial::read_register(u64 offset) noexcept -> u8 {
+        const bool dlab = m_lcr & LCR_DLAB;
+
+        switch (offset) {
+            case REG_DATA:
+                // Host input is not supported, receiver buffer is empty.
+                return dlab ? m_dll : 0;
+
+            case REG_IER:
+                return dlab ? m_dlm : m_ier;
+
+            case REG_IIR:
+                if (m_fcr & FCR_FIFO_ENABLE)
+                    return IIR_NO_INTERRUPT | IIR_FIFO_ENABLED;
+
+                return IIR_NO_INTERRUPT;
+
+            case REG_LCR:
+                return m_lcr;
+
+            case REG_MCR:
+                return m_mcr;
+
+            case REG_LSR:
+                if (m_ring.size() < m_ring.capacity())
+                    return LSR_THRE | LSR_TEMT;
+
+                return 0;
+
+            case REG_MSR:
+                return MSR_DEFAULT;
+
+            case REG_SCR:
+                return m_scr;
+
+            default:
+                return 0;
+        }
+    }
+
+    auto Serial::write_register(u64 offset, u8 value) noexcept -> void {
+        const bool dlab = m_lcr & LCR_DLAB;
+
+        switch (offset) {
+            case REG_DATA:
+                if (dlab)
+                    m_dll = value;
+                else
+                    transmit({&value, 1});
+
+                break;
+
+            case REG_IER:
+                if (dlab)
+                    m_dlm = value;
+                else
+                    m_ier = value & 0x0f;
+
+                break;
+
+            case REG_IIR:
+                m_fcr = value;
+                break;
+
+            case REG_LCR:
+                m_lcr = value;
+                break;
+
+            case REG_MCR:
+                m_mcr = value & 0x1f;
+                break;
+
+            case REG_SCR:
+                m_scr = value;
+                break;
+
+            default:
+                // Line and modem status registers are read-only.
+                break;
+        }
+    }
+
+    auto Serial::drain() noexcept -> void {
+        std::vector<u8> buffer(DRAIN_BATCH_SIZE);
+
+        while (true) {
+            const auto events = m_events.load(std::memory_order_acquire);
+            const auto count = m_ring.pop(buffer);
+
+            if (count > 0) {
+                write_all(m_output_fd, std::span(buffer).first(count));
+
+                m_written.fetch_add(
+                    static_cast<u32>(count), std::memory_order_release
+                );
+                m_written.notify_all();
+                continue;
+            }
+
+            if (m_stop.load())
+                break;
+
+            m_events.wait(events, std::memory_order_acquire);
+        }
+    }
+
+}
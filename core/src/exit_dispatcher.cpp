@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit dispatch table related declarations.
+
+#include <nullvm/core/exit_dispatcher.hpp>
+#include <format>
+
+namespace nullvm::core {
+
+    auto ExitDispatcher::set_handler(u32 reason, ExitHandler handler) noexcept
+    -> VmmResult<None> {
+        if (reason >= EXIT_REASONS_COUNT) {
+            const auto err = std::format("Invalid exit reason: {}", reason);
+            return std::unexpected(err);
+        }
+
+        m_handlers[reason] = std::move(handler);
+        return None {};
+    }
+
+    auto ExitDispatcher::dispatch(kvm_run& state) const noexcept
+    -> VmmResult<ExitAction> {
+        const auto reason = state.exit_reason;
+
+        if (reason >= EXIT_REASONS_COUNT || !m_handlers[reason]) {
+            const auto err = std::format("Unhandled exit reason: {}", reason);
+            return std::unexpected(err);
+        }
+
+        return m_handlers[reason](state);
+    }
+
+}
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit statistics related declarations.
+
+#include <nullvm/core/exit_stats.hpp>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <bit>
+
+namespace nullvm::core {
+
+    namespace {
+        /// Number of buckets per power of two range.
+        constexpr u64 SUB_BUCKETS {1u << HISTOGRAM_SUB_BITS};
+
+        /// @brief Add to counter owned by current thread.
+        ///
+        /// Counter has single writer, so plain store is enough and no
+        /// locked instruction is issued.
+        ///
+        /// @param [in] counter given counter.
+        /// @param [in] value given value to add.
+        auto add(std::atomic<u64>& counter, u64 value) noexcept -> void {
+            const auto current = counter.load(std::memory_order_relaxed);
+            counter.store(current + value, std::memory_order_relaxed);
+        }
+
+        /// @brief Convert duration to nanoseconds count.
+        ///
+        /// @param [in] duration given duration.
+        ///
+        /// @return Non-negative number of nanoseconds.
+        auto to_ns(std::chrono::nanoseconds duration) noexcept -> u64 {
+            return static_cast<u64>(std::max<i64>(duration.count(), 0));
+        }
+    }
+
+    auto HistogramSnapshot::percentile(f64 percentile) const noexcept
+    -> u64 {
+        if (count == 0)
+            return 0;
+
+        const auto ratio = std::clamp(percentile, 0.0, 100.0) / 100.0;
+        const auto rank = std::max<u64>(
+            static_cast<u64>(std::ceil(ratio * static_cast<f64>(count))), 1
+        );
+
+        u64 seen {0};
+
+        for (usize i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            seen += counts[i];
+
+            if (seen >= rank)
+                return std::min(Histogram::bucket_limit(i), max);
+        }
+
+        return max;
+    }
+
+    auto HistogramSnapshot::merge(const HistogramSnapshot& other) noexcept
+    -> void {
+        for (usize i = 0; i < HISTOGRAM_BUCKETS; ++i)
+            counts[i] += other.counts[i];
+
+        count += other.count;
+        max = std::max(max, other.max);
+    }
+
+    auto Histogram::record(u64 value) noexcept -> void {
+        add(m_counts[bucket(value)], 1);
+
+        if (value > m_max.load(std::memory_order_relaxed))
+            m_max.store(value, std::memory_order_relaxed);
+    }
+
+    auto Histogram::snapshot() const noexcept -> HistogramSnapshot {
+        HistogramSnapshot snapshot;
+
+        // Total is summed from buckets, so percentiles stay consistent
+        // with counts even if writer is running.
+        for (usize i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+            snapshot.count += snapshot.counts[i];
+        }
+
+        snapshot.max = m_max.load(std::memory_order_relaxed);
+
+        return snapshot;
+    }
+
+    auto Histogram::bucket(u64 value) noexcept -> usize {
+        // Small values are counted exactly.
+        if (value < SUB_BUCKETS)
+            return static_cast<usize>(value);
+
+        const auto exponent = static_cast<u32>(std::bit_width(value)) - 1;
+
+        if (exponent >= HISTOGRAM_MAX_BITS)
+            return HISTOGRAM_BUCKETS - 1;
+
+        const auto shift = exponent - HISTOGRAM_SUB_BITS;
+        const auto sub = (value >> shift) & (SUB_BUCKETS - 1);
+
+        return static_cast<usize>(((shift + 1) << HISTOGRAM_SUB_BITS) + sub);
+    }
+
+    auto Histogram::bucket_limit(usize index) noexcept -> u64 {
+        if (index < SUB_BUCKETS)
+            return static_cast<u64>(index);
+
+        if (index >= HISTOGRAM_BUCKETS - 1)
+            return std::numeric_limits<u64>::max();
+
+        const auto shift = (index >> HISTOGRAM_SUB_BITS) - 1;
+        const auto sub = index & (SUB_BUCKETS - 1);
+
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+    auto ExitStatsSnapshot::exits() const noexcept -> u64 {
+        u64 total {0};
+
+        for (const auto& reason : reasons)
+            total += reason.count;
+
+        return total;
+    }
+
+    auto ExitStatsSnapshot::guest_time() const noexcept
+    -> std::chrono::nanoseconds {
+        std::chrono::nanoseconds total {0};
+
+        for (const auto& reason : reasons)
+            total += reason.guest;
+
+        return total;
+    }
+
+    auto ExitStatsSnapshot::handle_time() const noexcept
+    -> std::chrono::nanoseconds {
+        std::chrono::nanoseconds total {0};
+
+        for (const auto& reason : reasons)
+            total += reason.handle;
+
+        return total;
+    }
+
+    auto ExitStatsSnapshot::merge(const ExitStatsSnapshot& other) noexcept
+    -> void {
+        for (usize i = 0; i < EXIT_REASONS_COUNT; ++i) {
+            reasons[i].count  += other.reasons[i].count;
+            reasons[i].guest  += other.reasons[i].guest;
+            reasons[i].handle += other.reasons[i].handle;
+        }
+
+        guest.merge(other.guest);
+        handle.merge(other.handle);
+    }
+
+    auto ExitStats::record(
+        u32 reason, std::chrono::nanoseconds guest,
+        std::chrono::nanoseconds handle
+    ) noexcept -> void {
+        const auto guest_ns = to_ns(guest);
+        const auto handle_ns = to_ns(handle);
+
+        m_guest_latency.record(guest_ns);
+        m_handle_latency.record(handle_ns);
+
+        if (reason >= EXIT_REASONS_COUNT)
+            return;
+
+        add(m_count[reason], 1);
+        add(m_guest[reason], guest_ns);
+        add(m_handle[reason], handle_ns);
+    }
+
+    auto ExitStats::snapshot() const noexcept -> ExitStatsSnapshot {
+        ExitStatsSnapshot snapshot;
+
+        for (usize i = 0; i < EXIT_REASONS_COUNT; ++i) {
+            auto& reason = snapshot.reasons[i];
+
+            reason.count = m_count[i].load(std::memory_order_relaxed);
+            reason.guest = std::chrono::nanoseconds(
+                static_cast<i64>(m_guest[i].load(std::memory_order_relaxed))
+            );
+            reason.handle = std::chrono::nanoseconds(
+                static_cast<i64>(m_handle[i].load(std::memory_order_relaxed))
+            );
+        }
+
+        snapshot.guest = m_guest_latency.snapshot();
+        snapshot.handle = m_handle_latency.snapshot();
+
+        return snapshot;
+    }
+
+}
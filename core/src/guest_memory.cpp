@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest physical memory map related declarations.
+
+#include <nullvm/core/guest_memory.hpp>
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <bit>
+
+namespace nullvm::core {
+
+    namespace {
+        /// @brief Get number of 64-bit words in dirty bitmap.
+        ///
+        /// @param [in] size given range size in bytes.
+        ///
+        /// @return Number of bitmap words.
+        auto bitmap_words(u64 size) noexcept -> usize {
+            const auto pages = (size + GUEST_PAGE_SIZE - 1) / GUEST_PAGE_SIZE;
+            return static_cast<usize>((pages + 63) / 64);
+        }
+
+        /// @brief Allocate zeroed host dirty bitmap.
+        ///
+        /// @param [in] size given range size in bytes.
+        ///
+        /// @return Dirty bitmap.
+        auto make_bitmap(u64 size) -> std::unique_ptr<std::atomic<u64>[]> {
+            return std::make_unique<std::atomic<u64>[]>(bitmap_words(size));
+        }
+    }
+
+    auto GuestMemory::init(const VmFd& vmfd, u32 slots) noexcept
+    -> VmmResult<None> {
+        if (slots == 0)
+            return std::unexpected("Number of memory slots cannot be 0");
+
+        std::unique_lock lock(m_lock);
+
+        m_vmfd = &vmfd;
+        m_regions.clear();
+        m_slots.assign(slots, false);
+
+        return None {};
+    }
+
+    auto GuestMemory::add_region(
+        u64 guest_addr, u64 size, utils::MMapWrapper memory, u32 flags,
+        utils::FDWrapper fd
+    ) noexcept -> VmmResult<u32> {
+        if (!m_vmfd)
+            return std::unexpected("Guest memory is not initialized");
+
+        if (size == 0)
+            return std::unexpected("Memory region size cannot be 0");
+
+        if (size > memory.size())
+            return std::unexpected("Memory region exceeds host memory size");
+
+        if (guest_addr + size < guest_addr)
+            return std::unexpected("Memory region overflows address space");
+
+        std::unique_lock lock(m_lock);
+
+        auto next = std::upper_bound(
+            m_regions.begin(), m_regions.end(), guest_addr,
+            [](u64 value, const GuestRegion& region) {
+                return value < region.guest_addr;
+            }
+        );
+
+        const auto overlaps_next = next != m_regions.end() &&
+            guest_addr + size > next->guest_addr;
+
+        const auto overlaps_prev = next != m_regions.begin() &&
+            std::prev(next)->guest_addr + std::prev(next)->size > guest_addr;
+
+        if (overlaps_next || overlaps_prev) {
+            const auto err = std::format(
+                "Memory region {:#x}-{:#x} overlaps existing region",
+                guest_addr, guest_addr + size - 1
+            );
+            return std::unexpected(err);
+        }
+
+        const auto free_slot = std::ranges::find(m_slots, false);
+
+        if (free_slot == m_slots.end())
+            return std::unexpected("No free memory slots left");
+
+        const auto slot = static_cast<u32>(free_slot - m_slots.begin());
+
+        GuestRegion region {
+            slot, flags, guest_addr, size, std::move(memory), std::move(fd)
+        };
+
+        if (m_dirty_logging)
+            region.dirty = make_bitmap(size);
+
+        if (auto result = register_region(region); !result)
+            return std::unexpected(result.error());
+
+        *free_slot = true;
+        m_regions.insert(next, std::move(region));
+
+        return slot;
+    }
+
+    auto GuestMemory::remove_region(u64 guest_addr) noexcept
+    -> VmmResult<None> {
+        std::unique_lock lock(m_lock);
+
+        auto region = std::ranges::find(
+            m_regions, guest_addr, &GuestRegion::guest_addr
+        );
+
+        if (region == m_regions.end()) {
+            const auto err = std::format(
+                "No memory region at {:#x}", guest_addr
+            );
+            return std::unexpected(err);
+        }
+
+        // Zero-sized region deletes the slot.
+        const MemoryRegion mem_region = {
+            .slot            = region->slot,
+            .flags           = 0,
+            .guest_phys_addr = guest_addr,
+            .memory_size     = 0,
+            .userspace_addr  = 0,
+        };
+
+        if (auto result = m_vmfd->set_user_mem_region(mem_region); !result)
+            return std::unexpected(result.error());
+
+        m_slots[region->slot] = false;
+        m_regions.erase(region);
+
+        return None {};
+    }
+
+    auto GuestMemory::regions_count() const noexcept -> usize {
+        std::shared_lock lock(m_lock);
+        return m_regions.size();
+    }
+
+    auto GuestMemory::ranges() const -> std::vector<GuestRange> {
+        std::shared_lock lock(m_lock);
+
+        std::vector<GuestRange> ranges;
+        ranges.reserve(m_regions.size());
+
+        for (const auto& region : m_regions)
+            ranges.push_back({
+                region.guest_addr, region.size, region.flags, region.fd.fd()
+            });
+
+        return ranges;
+    }
+
+    auto GuestMemory::set_dirty_logging(bool enable) noexcept
+    -> VmmResult<None> {
+        std::unique_lock lock(m_lock);
+
+        if (m_dirty_logging == enable)
+            return None {};
+
+        m_dirty_logging = enable;
+
+        for (auto& region : m_regions) {
+            region.dirty = enable ? make_bitmap(region.size) : nullptr;
+
+            if (auto result = register_region(region); !result)
+                return result;
+        }
+
+        return None {};
+    }
+
+    auto GuestMemory::dirty_logging() const noexcept -> bool {
+        std::shared_lock lock(m_lock);
+        return m_dirty_logging;
+    }
+
+    auto GuestMemory::dirty_log() const
+    -> VmmResult<std::vector<DirtyBitmap>> {
+        std::shared_lock lock(m_lock);
+
+        if (!m_dirty_logging)
+            return std::unexpected("Dirty pages tracking is not enabled");
+
+        std::vector<DirtyBitmap> bitmaps;
+        bitmaps.reserve(m_regions.size());
+
+        for (const auto& region : m_regions) {
+            DirtyBitmap bitmap {
+                .guest_addr = region.guest_addr,
+                .size       = region.size,
+                .bits       = std::vector<u64>(bitmap_words(region.size)),
+            };
+
+            // Guest cannot write read-only regions, they are not logged.
+            if (!(region.flags & KVM_MEM_READONLY)) {
+                auto result = m_vmfd->get_dirty_log(region.slot, bitmap.bits);
+
+                // Already cleared pages of previous regions are kept.
+                if (!result) {
+                    merge_dirty_log(bitmaps);
+                    return std::unexpected(result.error());
+                }
+            }
+
+            for (usize i = 0; i < bitmap.bits.size(); ++i)
+                bitmap.bits[i] |= region.dirty[i].exchange(0);
+
+            bitmaps.push_back(std::move(bitmap));
+        }
+
+        return bitmaps;
+    }
+
+    auto GuestMemory::restore_dirty_log(std::span<const DirtyBitmap> dirty)
+    const noexcept -> void {
+        std::shared_lock lock(m_lock);
+        merge_dirty_log(dirty);
+    }
+
+    auto GuestMemory::translate(u64 guest_addr, u64 size) const noexcept
+    -> VmmResult<u8*> {
+        std::shared_lock lock(m_lock);
+
+        const auto region = lookup(guest_addr);
+        const auto offset = guest_addr - (region ? region->guest_addr : 0);
+
+        if (!region || size > region->size - offset) {
+            const auto err = std::format(
+                "Guest memory {:#x} (size {:#x}) is not mapped",
+                guest_addr, size
+            );
+            return std::unexpected(err);
+        }
+
+        return static_cast<u8*>(region->memory.addr()) + offset;
+    }
+
+    auto GuestMemory::read(u64 guest_addr, std::span<u8> data) const noexcept
+    -> VmmResult<None> {
+        // Lock is held during copy, so that region cannot be unmapped.
+        std::shared_lock lock(m_lock);
+
+        const auto region = lookup(guest_addr);
+        const auto offset = guest_addr - (region ? region->guest_addr : 0);
+
+        if (!region || data.size() > region->size - offset) {
+            const auto err = std::format(
+                "Guest memory {:#x} (size {:#x}) is not mapped",
+                guest_addr, data.size()
+            );
+            return std::unexpected(err);
+        }
+
+        const auto host = static_cast<u8*>(region->memory.addr()) + offset;
+        std::copy_n(host, data.size(), data.data());
+
+        return None {};
+    }
+
+    auto GuestMemory::write(u64 guest_addr, std::span<const u8> data)
+    const noexcept -> VmmResult<None> {
+        std::shared_lock lock(m_lock);
+
+        const auto region = lookup(guest_addr);
+        const auto offset = guest_addr - (region ? region->guest_addr : 0);
+
+        if (!region || data.size() > region->size - offset) {
+            const auto err = std::format(
+                "Guest memory {:#x} (size {:#x}) is not mapped",
+                guest_addr, data.size()
+            );
+            return std::unexpected(err);
+        }
+
+        const auto host = static_cast<u8*>(region->memory.addr()) + offset;
+        std::ranges::copy(data, host);
+
+        if (region->dirty && !data.empty()) {
+            const auto first = offset / GUEST_PAGE_SIZE;
+            const auto last = (offset + data.size() - 1) / GUEST_PAGE_SIZE;
+
+            for (auto page = first; page <= last; ++page) {
+                region->dirty[page / 64].fetch_or(
+                    u64 {1} << (page % 64), std::memory_order_relaxed
+                );
+            }
+        }
+
+        return None {};
+    }
+
+    auto GuestMemory::merge_dirty_log(std::span<const DirtyBitmap> dirty)
+    const noexcept -> void {
+        for (const auto& bitmap : dirty) {
+            const auto region = lookup(bitmap.guest_addr);
+
+            // Region was remapped or tracking disabled since bitmap fetch.
+            if (!region || !region->dirty ||
+                region->guest_addr != bitmap.guest_addr ||
+                region->size != bitmap.size)
+                continue;
+
+            for (usize i = 0; i < bitmap.bits.size(); ++i) {
+                region->dirty[i].fetch_or(
+                    bitmap.bits[i], std::memory_order_relaxed
+                );
+            }
+        }
+    }
+
+    auto GuestMemory::lookup(u64 guest_addr) const noexcept
+    -> const GuestRegion* {
+        auto next = std::upper_bound(
+            m_regions.begin(), m_regions.end(), guest_addr,
+            [](u64 value, const GuestRegion& region) {
+                return value < region.guest_addr;
+            }
+        );
+
+        if (next == m_regions.begin())
+            return nullptr;
+
+        const auto& region = *std::prev(next);
+
+        if (guest_addr - region.guest_addr >= region.size)
+            return nullptr;
+
+        return &region;
+    }
+
+    auto GuestMemory::register_region(const GuestRegion& region)
+    const noexcept -> VmmResult<None> {
+        auto flags = region.flags;
+
+        if (m_dirty_logging && !(flags & KVM_MEM_READONLY))
+            flags |= KVM_MEM_LOG_DIRTY_PAGES;
+
+        const MemoryRegion mem_region = {
+            .slot            = region.slot,
+            .flags           = flags,
+            .guest_phys_addr = region.guest_addr,
+            .memory_size     = region.size,
+            .userspace_addr  = std::bit_cast<u64>(region.memory.addr()),
+        };
+
+        return m_vmfd->set_user_mem_region(mem_region);
+    }
+
+}
@@ -10,6 +10,7 @@
 #include <linux/kvm.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <cerrno>
 
 namespace nullvm::core {
 
@@ -51,7 +52,7 @@ namespace nullvm::core {
         return m_fd.fd();
     }
 
-    auto Kvm::vcpu_mmap_size() -> VmmResult<usize> {
+    auto Kvm::vcpu_mmap_size() const -> VmmResult<usize> {
         const auto ret = ioctl(m_fd.fd(), KVM_GET_VCPU_MMAP_SIZE, 0);
 
         if (ret == -1)
@@ -60,6 +61,32 @@ namespace nullvm::core {
         return static_cast<usize>(ret);
     }
 
+    auto Kvm::check_extension(i32 cap) const noexcept -> i32 {
+        const auto ret = ioctl(m_fd.fd(), KVM_CHECK_EXTENSION, cap);
+        return ret == -1 ? 0 : ret;
+    }
+
+    auto Kvm::msr_index_list() const -> VmmResult<std::vector<u32>> {
+        // Buffer is kvm_msr_list: number of MSRs followed by indices.
+        // First query fails with E2BIG and reports number of MSRs.
+        std::vector<u32> buffer {0};
+        auto ret = ioctl(m_fd.fd(), KVM_GET_MSR_INDEX_LIST, buffer.data());
+
+        if (ret == -1 && errno != E2BIG)
+            return std::unexpected("Error to get MSR index list");
+
+        buffer.resize(buffer.front() + 1);
+        ret = ioctl(m_fd.fd(), KVM_GET_MSR_INDEX_LIST, buffer.data());
+
+        if (ret == -1)
+            return std::unexpected("Error to get MSR index list");
+
+        buffer.resize(buffer.front() + 1);
+        buffer.erase(buffer.begin());
+
+        return buffer;
+    }
+
     auto Kvm::create_vm() const -> VmmResult<i32> {
 
         const auto vmfd = ioctl(m_fd.fd(), KVM_CREATE_VM, 0);
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// KVM binary statistics related declarations.
+
+#include <nullvm/core/kvm_stats.hpp>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <cerrno>
+#include <bit>
+
+namespace nullvm::core {
+
+    namespace {
+        /// @brief Read bytes at file offset.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [out] buffer given buffer to fill.
+        /// @param [in] offset given file offset.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto read_at(i32 fd, std::span<std::byte> buffer, u64 offset)
+        noexcept -> VmmResult<None> {
+            auto ret = pread(
+                fd, buffer.data(), buffer.size(), static_cast<off_t>(offset)
+            );
+
+            while (ret == -1 && errno == EINTR) {
+                ret = pread(
+                    fd, buffer.data(), buffer.size(),
+                    static_cast<off_t>(offset)
+                );
+            }
+
+            if (ret == -1) {
+                const auto err = std::format(
+                    "Error to read KVM statistics: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            if (static_cast<usize>(ret) != buffer.size())
+                return std::unexpected("KVM statistics are truncated");
+
+            return None {};
+        }
+    }
+
+    auto KvmStats::init(i32 fd) -> VmmResult<None> {
+        if (fd < 0)
+            return std::unexpected("Invalid KVM statistics descriptor");
+
+        m_fd = utils::FDWrapper(fd);
+
+        kvm_stats_header header {};
+        auto result = read_at(
+            fd, std::as_writable_bytes(std::span(&header, 1)), 0
+        );
+
+        if (!result)
+            return result;
+
+        // Identifier and names are NUL-terminated strings of name_size.
+        std::vector<char> id(header.name_size);
+        result = read_at(
+            fd, std::as_writable_bytes(std::span(id)), header.id_offset
+        );
+
+        if (!result)
+            return result;
+
+        m_id.assign(id.data(), strnlen(id.data(), id.size()));
+
+        const auto desc_size = sizeof(kvm_stats_desc) + header.name_size;
+        Bytes block(desc_size * header.num_desc);
+
+        result = read_at(fd, block, header.desc_offset);
+
+        if (!result)
+            return result;
+
+        m_descriptors.clear();
+        m_descriptors.reserve(header.num_desc);
+
+        usize count {0};
+
+        for (usize i = 0; i < header.num_desc; ++i) {
+            const auto entry = block.data() + i * desc_size;
+
+            kvm_stats_desc desc {};
+            std::memcpy(&desc, entry, sizeof(desc));
+
+            if (desc.offset % sizeof(u64) != 0)
+                return std::unexpected("Misaligned KVM statistic");
+
+            const auto name = std::bit_cast<const char*>(
+                entry + sizeof(kvm_stats_desc)
+            );
+
+            m_descriptors.push_back({
+                .name        = std::string(
+                    name, strnlen(name, header.name_size)
+                ),
+                .flags       = desc.flags,
+                .exponent    = desc.exponent,
+                .size        = desc.size,
+                .index       = desc.offset / sizeof(u64),
+                .bucket_size = desc.bucket_size,
+            });
+
+            count = std::max(count, desc.offset / sizeof(u64) + desc.size);
+        }
+
+        m_data_offset = header.data_offset;
+        m_values.assign(count, 0);
+
+        return None {};
+    }
+
+    auto KvmStats::id() const noexcept -> std::string_view {
+        return m_id;
+    }
+
+    auto KvmStats::descriptors() const noexcept
+    -> std::span<const StatDescriptor> {
+        return m_descriptors;
+    }
+
+    auto KvmStats::sample() noexcept -> VmmResult<std::span<const u64>> {
+        auto buffer = std::as_writable_bytes(std::span(m_values));
+
+        if (auto result = read_at(m_fd.fd(), buffer, m_data_offset); !result)
+            return std::unexpected(result.error());
+
+        return std::span<const u64>(m_values);
+    }
+
+    auto KvmStats::sample(std::span<std::byte> output) const noexcept
+    -> VmmResult<None> {
+        if (output.size() != m_values.size() * sizeof(u64))
+            return std::unexpected("KVM statistics buffer size mismatch");
+
+        return read_at(m_fd.fd(), output, m_data_offset);
+    }
+
+    auto KvmStats::values() const noexcept -> std::span<const u64> {
+        return m_values;
+    }
+
+    auto KvmStats::find(std::string_view name) const noexcept
+    -> std::optional<std::span<const u64>> {
+        const auto it = std::ranges::find(
+            m_descriptors, name, &StatDescriptor::name
+        );
+
+        if (it == m_descriptors.end())
+            return std::nullopt;
+
+        return std::span(m_values).subspan(it->index, it->size);
+    }
+
+}
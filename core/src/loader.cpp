@@ -0,0 +1,392 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest kernel image loaders related declarations.
+
+#include <nullvm/core/utils/parallel.hpp>
+#include <nullvm/core/loader.hpp>
+#include <linux/kvm.h>
+#include <algorithm>
+#include <ranges>
+#include <cstring>
+#include <format>
+#include <array>
+#include <elf.h>
+
+namespace nullvm::core::loader {
+
+    namespace {
+        /// Size of boot sector and setup sector in bytes.
+        constexpr usize SECTOR_SIZE {512};
+
+        /// Size of boot parameters (zero page) in bytes.
+        constexpr usize BOOT_PARAMS_SIZE {4096};
+
+        /// Offset of number of setup sectors.
+        constexpr usize SETUP_SECTS_OFFSET {0x1f1};
+        /// Offset of setup header jump instruction length.
+        constexpr usize JUMP_LENGTH_OFFSET {0x201};
+        /// Offset of setup header magic.
+        constexpr usize HEADER_OFFSET {0x202};
+        /// Offset of boot protocol version.
+        constexpr usize VERSION_OFFSET {0x206};
+        /// Offset of boot loader type.
+        constexpr usize TYPE_OF_LOADER_OFFSET {0x210};
+        /// Offset of boot protocol flags.
+        constexpr usize LOADFLAGS_OFFSET {0x211};
+        /// Offset of initial ramdisk address.
+        constexpr usize RAMDISK_IMAGE_OFFSET {0x218};
+        /// Offset of initial ramdisk size.
+        constexpr usize RAMDISK_SIZE_OFFSET {0x21c};
+        /// Offset of setup heap end pointer.
+        constexpr usize HEAP_END_PTR_OFFSET {0x224};
+        /// Offset of command line address.
+        constexpr usize CMD_LINE_PTR_OFFSET {0x228};
+        /// Offset of maximal initial ramdisk address.
+        constexpr usize INITRD_ADDR_MAX_OFFSET {0x22c};
+        /// Offset of maximal command line size.
+        constexpr usize CMDLINE_SIZE_OFFSET {0x238};
+        /// End of setup header fields read by loader.
+        constexpr usize SETUP_HEADER_END {0x23c};
+        /// Offset of number of E820 map entries.
+        constexpr usize E820_ENTRIES_OFFSET {0x1e8};
+        /// Offset of E820 map.
+        constexpr usize E820_TABLE_OFFSET {0x2d0};
+
+        /// Setup header magic ("HdrS").
+        constexpr u32 HEADER_MAGIC {0x53726448};
+        /// Minimal supported boot protocol version (command line pointer).
+        constexpr u32 MIN_VERSION {0x0202};
+        /// Boot protocol version with command line size field.
+        constexpr u32 CMDLINE_SIZE_VERSION {0x0206};
+        /// Boot protocol version with initial ramdisk limit field.
+        constexpr u32 INITRD_ADDR_MAX_VERSION {0x0203};
+        /// Default number of setup sectors.
+        constexpr u8 DEFAULT_SETUP_SECTS {4};
+        /// Default command line size limit.
+        constexpr u32 DEFAULT_CMDLINE_SIZE {255};
+        /// Default maximal initial ramdisk address.
+        constexpr u32 DEFAULT_INITRD_ADDR_MAX {0x37ffffff};
+        /// Undefined boot loader type.
+        constexpr u8 LOADER_TYPE_UNDEFINED {0xff};
+        /// Protected-mode kernel is loaded at 0x100000.
+        constexpr u8 LOADED_HIGH {0x01};
+        /// Heap end pointer is valid.
+        constexpr u8 CAN_USE_HEAP {0x80};
+        /// Setup heap end pointer (relative to real-mode code).
+        constexpr std::uint16_t HEAP_END_PTR {0xfe00};
+
+        /// Size of single E820 map entry in bytes.
+        constexpr usize E820_ENTRY_SIZE {20};
+        /// Maximal number of E820 map entries.
+        constexpr usize E820_MAX_ENTRIES {128};
+        /// Usable RAM E820 entry type.
+        constexpr u32 E820_RAM {1};
+        /// Reserved E820 entry type.
+        constexpr u32 E820_RESERVED {2};
+
+        /// Initial ramdisk alignment in bytes.
+        constexpr u64 INITRD_ALIGNMENT {0x1000};
+
+        /// @brief Read little-endian value from bytes.
+        ///
+        /// @param [in] bytes given bytes to read from.
+        /// @param [in] offset given value offset.
+        ///
+        /// @return Read value.
+        template <typename T>
+        auto read_value(std::span<const u8> bytes, usize offset) noexcept
+        -> T {
+            T value {};
+            std::memcpy(&value, bytes.data() + offset, sizeof(T));
+            return value;
+        }
+
+        /// @brief Write little-endian value to bytes.
+        ///
+        /// @param [out] bytes given bytes to write to.
+        /// @param [in] offset given value offset.
+        /// @param [in] value given value to write.
+        template <typename T>
+        auto write_value(std::span<u8> bytes, usize offset, T value) noexcept
+        -> void {
+            std::memcpy(bytes.data() + offset, &value, sizeof(T));
+        }
+
+        /// @brief Copy bytes into guest memory zero-filling the rest.
+        ///
+        /// @param [in] memory given guest memory.
+        /// @param [in] addr given guest physical address.
+        /// @param [in] data given bytes to copy.
+        /// @param [in] size given total size to place, at least data size.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto place(
+            const GuestMemory& memory, u64 addr, std::span<const u8> data,
+            u64 size
+        ) noexcept -> VmmResult<None> {
+            auto result = memory.translate(addr, size);
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            const auto dst = std::span(result.value(), size);
+
+            utils::parallel_copy(dst, data);
+            utils::parallel_fill(dst.subspan(data.size()), 0);
+
+            return None {};
+        }
+
+        /// @brief Build E820 map from guest memory ranges.
+        ///
+        /// @param [in] memory given guest memory.
+        /// @param [out] params given boot parameters to fill.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto setup_e820(const GuestMemory& memory, std::span<u8> params)
+        -> VmmResult<None> {
+            const auto ranges = memory.ranges();
+
+            if (ranges.size() > E820_MAX_ENTRIES)
+                return std::unexpected("Too many guest memory ranges for E820");
+
+            for (usize i = 0; i < ranges.size(); ++i) {
+                const auto& range = ranges[i];
+                const auto offset = E820_TABLE_OFFSET + i * E820_ENTRY_SIZE;
+                const auto type = (range.flags & KVM_MEM_READONLY) ?
+                                  E820_RESERVED : E820_RAM;
+
+                write_value<u64>(params, offset, range.guest_addr);
+                write_value<u64>(params, offset + 8, range.size);
+                write_value<u32>(params, offset + 16, type);
+            }
+
+            write_value<u8>(
+                params, E820_ENTRIES_OFFSET, static_cast<u8>(ranges.size())
+            );
+
+            return None {};
+        }
+
+        /// @brief Place initial ramdisk at the top of allowed RAM.
+        ///
+        /// @param [in] memory given guest memory.
+        /// @param [in] initrd given initial ramdisk bytes.
+        /// @param [in] low given lowest allowed guest physical address.
+        /// @param [in] high given highest allowed guest physical address.
+        ///
+        /// @return Initial ramdisk address - in case of success.
+        /// @return VmmError - otherwise.
+        auto place_initrd(
+            const GuestMemory& memory, std::span<const u8> initrd,
+            u64 low, u64 high
+        ) -> VmmResult<u64> {
+            const auto ranges = memory.ranges();
+
+            for (const auto& range : ranges | std::views::reverse) {
+                if (range.flags & KVM_MEM_READONLY)
+                    continue;
+
+                const auto end = range.guest_addr + range.size;
+                const auto top = std::min(end, high);
+                const auto bottom = std::max(range.guest_addr, low);
+
+                if (top < bottom || top - bottom < initrd.size())
+                    continue;
+
+                const auto addr =
+                    (top - initrd.size()) & ~(INITRD_ALIGNMENT - 1);
+
+                if (addr < bottom)
+                    continue;
+
+                auto result = place(memory, addr, initrd, initrd.size());
+
+                if (!result)
+                    return std::unexpected(result.error());
+
+                return addr;
+            }
+
+            return std::unexpected("No guest memory to place initial ramdisk");
+        }
+    }
+
+    auto load_elf(const GuestMemory& memory, std::span<const u8> image)
+    noexcept -> VmmResult<KernelEntry> {
+        if (image.size() < sizeof(Elf64_Ehdr))
+            return std::unexpected("ELF image is too small");
+
+        const auto header = read_value<Elf64_Ehdr>(image, 0);
+
+        if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0)
+            return std::unexpected("Invalid ELF magic");
+
+        if (header.e_ident[EI_CLASS] != ELFCLASS64 ||
+            header.e_ident[EI_DATA] != ELFDATA2LSB ||
+            header.e_machine != EM_X86_64)
+            return std::unexpected("ELF image is not x86-64 executable");
+
+        if (header.e_phentsize != sizeof(Elf64_Phdr))
+            return std::unexpected("Invalid ELF program header size");
+
+        const auto headers_size = static_cast<u64>(header.e_phnum) *
+                                  sizeof(Elf64_Phdr);
+
+        if (header.e_phoff > image.size() ||
+            headers_size > image.size() - header.e_phoff)
+            return std::unexpected("ELF program headers are out of image");
+
+        usize loaded {0};
+
+        for (usize i = 0; i < header.e_phnum; ++i) {
+            const auto offset = header.e_phoff + i * sizeof(Elf64_Phdr);
+            const auto segment = read_value<Elf64_Phdr>(image, offset);
+
+            if (segment.p_type != PT_LOAD || segment.p_memsz == 0)
+                continue;
+
+            if (segment.p_filesz > segment.p_memsz ||
+                segment.p_offset > image.size() ||
+                segment.p_filesz > image.size() - segment.p_offset)
+                return std::unexpected("Invalid ELF segment size");
+
+            const auto data = image.subspan(
+                segment.p_offset, segment.p_filesz
+            );
+
+            auto result = place(memory, segment.p_paddr, data, segment.p_memsz);
+
+            if (!result) {
+                const auto err = std::format(
+                    "Error to load ELF segment at {:#x}: {}",
+                    segment.p_paddr, result.error()
+                );
+                return std::unexpected(err);
+            }
+
+            ++loaded;
+        }
+
+        if (loaded == 0)
+            return std::unexpected("ELF image has no loadable segments");
+
+        return KernelEntry {.entry = header.e_entry, .boot_params = 0};
+    }
+
+    auto load_bzimage(
+        const GuestMemory& memory, std::span<const u8> image,
+        std::string_view cmdline, std::span<const u8> initrd
+    ) noexcept -> VmmResult<KernelEntry> {
+        if (image.size() < SETUP_HEADER_END)
+            return std::unexpected("bzImage is too small");
+
+        if (read_value<u32>(image, HEADER_OFFSET) != HEADER_MAGIC)
+            return std::unexpected("Invalid bzImage setup header magic");
+
+        const auto version = read_value<std::uint16_t>(image, VERSION_OFFSET);
+
+        if (version < MIN_VERSION) {
+            const auto err = std::format(
+                "Unsupported boot protocol version {:#x}", version
+            );
+            return std::unexpected(err);
+        }
+
+        const auto loadflags = read_value<u8>(image, LOADFLAGS_OFFSET);
+
+        if (!(loadflags & LOADED_HIGH))
+            return std::unexpected("Kernel is not loadable at 0x100000");
+
+        auto setup_sects = read_value<u8>(image, SETUP_SECTS_OFFSET);
+
+        if (setup_sects == 0)
+            setup_sects = DEFAULT_SETUP_SECTS;
+
+        const auto kernel_offset = (setup_sects + 1u) * SECTOR_SIZE;
+
+        if (kernel_offset >= image.size())
+            return std::unexpected("bzImage has no protected-mode kernel");
+
+        // Setup header is copied to boot parameters below, it must not run
+        // past setup sectors.
+        const auto header_end = HEADER_OFFSET +
+            read_value<u8>(image, JUMP_LENGTH_OFFSET);
+
+        if (header_end > kernel_offset)
+            return std::unexpected("Invalid bzImage setup header length");
+
+        const auto cmdline_size = version >= CMDLINE_SIZE_VERSION ?
+            read_value<u32>(image, CMDLINE_SIZE_OFFSET) : DEFAULT_CMDLINE_SIZE;
+
+        if (cmdline.size() > cmdline_size)
+            return std::unexpected("Kernel command line is too long");
+
+        const auto kernel = image.subspan(kernel_offset);
+
+        if (auto result = place(memory, KERNEL_ADDR, kernel, kernel.size());
+            !result)
+            return std::unexpected(result.error());
+
+        // Command line is null-terminated.
+        const auto cmdline_bytes = std::span(
+            std::bit_cast<const u8*>(cmdline.data()), cmdline.size()
+        );
+
+        if (auto result = place(
+                memory, CMDLINE_ADDR, cmdline_bytes, cmdline.size() + 1
+            ); !result)
+            return std::unexpected(result.error());
+
+        // Boot parameters start with copy of setup header from image.
+        std::array<u8, BOOT_PARAMS_SIZE> params {};
+
+        std::copy(
+            image.begin() + SETUP_SECTS_OFFSET,
+            image.begin() + static_cast<std::ptrdiff_t>(header_end),
+            params.begin() + SETUP_SECTS_OFFSET
+        );
+
+        write_value<u8>(params, TYPE_OF_LOADER_OFFSET, LOADER_TYPE_UNDEFINED);
+        write_value<u8>(params, LOADFLAGS_OFFSET, loadflags | CAN_USE_HEAP);
+        write_value<std::uint16_t>(params, HEAP_END_PTR_OFFSET, HEAP_END_PTR);
+        write_value<u32>(
+            params, CMD_LINE_PTR_OFFSET, static_cast<u32>(CMDLINE_ADDR)
+        );
+
+        if (auto result = setup_e820(memory, params); !result)
+            return std::unexpected(result.error());
+
+        if (!initrd.empty()) {
+            const u64 initrd_max = version >= INITRD_ADDR_MAX_VERSION ?
+                read_value<u32>(image, INITRD_ADDR_MAX_OFFSET) :
+                DEFAULT_INITRD_ADDR_MAX;
+
+            auto result = place_initrd(
+                memory, initrd, KERNEL_ADDR + kernel.size(), initrd_max + 1
+            );
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            write_value<u32>(
+                params, RAMDISK_IMAGE_OFFSET, static_cast<u32>(result.value())
+            );
+            write_value<u32>(
+                params, RAMDISK_SIZE_OFFSET, static_cast<u32>(initrd.size())
+            );
+        }
+
+        if (auto result = memory.write(BOOT_PARAMS_ADDR, params); !result)
+            return std::unexpected(result.error());
+
+        return KernelEntry {
+            .entry       = KERNEL_ADDR,
+            .boot_params = BOOT_PARAMS_ADDR,
+        };
+    }
+
+}
@@ -0,0 +1,434 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest memory backing related declarations.
+
+#include <nullvm/core/memory_backing.hpp>
+#include <nullvm/log.hpp>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string_view>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <array>
+#include <bit>
+
+namespace nullvm::core {
+
+    namespace {
+        /// Size of 2M huge page in bytes.
+        constexpr usize HUGE_PAGE_2M {2 * 1024 * 1024};
+
+        /// Size of 1G huge page in bytes.
+        constexpr usize HUGE_PAGE_1G {1024 * 1024 * 1024};
+
+        /// Guest memory protection flags.
+        constexpr i32 MEMORY_PROT {PROT_READ | PROT_WRITE};
+
+        /// Mapping flags of guest memory not backed by file. Memory is
+        /// private for every backing, processes share guest memory only
+        /// through memory file.
+        constexpr i32 PRIVATE_FLAGS {MAP_PRIVATE | MAP_ANONYMOUS};
+
+        /// Transparent huge pages mode of anonymous memory.
+        constexpr auto THP_ENABLED_PATH {
+            "/sys/kernel/mm/transparent_hugepage/enabled"
+        };
+
+        /// Transparent huge pages mode of memory files.
+        constexpr auto THP_SHMEM_ENABLED_PATH {
+            "/sys/kernel/mm/transparent_hugepage/shmem_enabled"
+        };
+
+        /// @brief Round value up to alignment.
+        ///
+        /// @param [in] value given value to round.
+        /// @param [in] alignment given power of two alignment.
+        ///
+        /// @return Rounded value.
+        auto align_up(usize value, usize alignment) noexcept -> usize {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        /// @brief Read selected transparent huge pages mode.
+        ///
+        /// Mode file lists all modes with selected one in brackets, e.g.
+        /// "always [madvise] never".
+        ///
+        /// @param [in] path given sysfs mode file path.
+        ///
+        /// @return Selected mode - in case of success.
+        /// @return Empty string - if mode cannot be read.
+        auto read_thp_mode(const char* path) noexcept -> std::string {
+            const utils::FDWrapper file(open(path, O_RDONLY | O_CLOEXEC));
+            std::array<char, 128> buffer {};
+
+            if (file.fd() == -1)
+                return {};
+
+            const auto ret = read(file.fd(), buffer.data(), buffer.size());
+
+            if (ret <= 0)
+                return {};
+
+            const auto text = std::string_view(
+                buffer.data(), static_cast<usize>(ret)
+            );
+            const auto start = text.find('[');
+            const auto end = text.find(']', start);
+
+            if (start == text.npos || end == text.npos)
+                return {};
+
+            return std::string(text.substr(start + 1, end - start - 1));
+        }
+
+        /// @brief Reserve address range aligned to 2M huge page size.
+        ///
+        /// @param [in] size given range size in bytes, multiple of base
+        /// page size.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_aligned(usize size) noexcept
+        -> VmmResult<utils::MMapWrapper> {
+            const auto length = size + HUGE_PAGE_2M;
+            const auto addr = mmap(
+                nullptr, length, MEMORY_PROT, PRIVATE_FLAGS, -1, 0
+            );
+
+            if (addr == MAP_FAILED)
+                return std::unexpected(std::strerror(errno));
+
+            // Trim unaligned head and tail of the mapping.
+            const auto start = std::bit_cast<usize>(addr);
+            const auto aligned = align_up(start, HUGE_PAGE_2M);
+            const auto head = aligned - start;
+            const auto tail = length - head - size;
+            const auto base = static_cast<u8*>(addr);
+
+            if (head > 0)
+                munmap(base, head);
+
+            if (tail > 0)
+                munmap(base + head + size, tail);
+
+            utils::MMapWrapper memory;
+
+            if (auto result = memory.init(base + head, size); !result)
+                return std::unexpected(result.error());
+
+            return memory;
+        }
+
+        /// @brief Map memory from huge TLB pool.
+        ///
+        /// @param [in] size given memory size in bytes.
+        /// @param [in] page given huge page size in bytes.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_hugetlb(usize size, usize page) noexcept
+        -> VmmResult<utils::MMapWrapper> {
+            // Huge page size is encoded as its log2 in mmap flags.
+            const auto page_flag = std::countr_zero(page) << MAP_HUGE_SHIFT;
+            const auto flags = PRIVATE_FLAGS | MAP_HUGETLB | page_flag;
+
+            const auto length = align_up(size, page);
+            const auto addr = mmap(nullptr, length, MEMORY_PROT, flags, -1, 0);
+
+            if (addr == MAP_FAILED)
+                return std::unexpected(std::strerror(errno));
+
+            utils::MMapWrapper memory;
+
+            if (auto result = memory.init(addr, length); !result)
+                return std::unexpected(result.error());
+
+            return memory;
+        }
+
+        /// @brief Map anonymous memory advised to use transparent huge pages.
+        ///
+        /// Mapping is aligned to huge page size, so that the whole memory
+        /// can be backed by huge pages.
+        ///
+        /// @param [in] size given memory size in bytes.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_transparent_huge(usize size) noexcept
+        -> VmmResult<utils::MMapWrapper> {
+            // madvise() succeeds even if transparent huge pages are off.
+            if (!transparent_huge_pages(false)) {
+                return std::unexpected(
+                    "Transparent huge pages are disabled on host"
+                );
+            }
+
+            // Tail past the last huge page boundary could only be backed
+            // by base pages.
+            const auto page = page_size(MemoryBacking::TransparentHuge);
+            auto memory = map_aligned(align_up(size, page));
+
+            if (!memory)
+                return std::unexpected(memory.error());
+
+            if (madvise(memory->addr(), memory->size(), MADV_HUGEPAGE) == -1)
+                return std::unexpected(std::strerror(errno));
+
+            return memory;
+        }
+
+        /// @brief Map anonymous memory with base pages.
+        ///
+        /// @param [in] size given memory size in bytes.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_anonymous(usize size) noexcept
+        -> VmmResult<utils::MMapWrapper> {
+            const auto addr = mmap(
+                nullptr, size, MEMORY_PROT, PRIVATE_FLAGS, -1, 0
+            );
+
+            if (addr == MAP_FAILED) {
+                const auto err = std::format(
+                    "Error to map guest memory: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            utils::MMapWrapper memory;
+
+            if (auto result = memory.init(addr, size); !result)
+                return std::unexpected(result.error());
+
+            return memory;
+        }
+
+        /// @brief Create sealed memory file for guest memory.
+        ///
+        /// File size is sealed, so process sharing it can never see
+        /// mapped memory truncated under it.
+        ///
+        /// @param [in] size given memory size in bytes.
+        /// @param [in] backing given memory backing.
+        ///
+        /// @return Memory file descriptor - in case of success.
+        /// @return VmmError - otherwise.
+        auto create_memfd(usize size, MemoryBacking backing) noexcept
+        -> VmmResult<utils::FDWrapper> {
+            auto flags = MFD_CLOEXEC | MFD_ALLOW_SEALING;
+
+            if (backing == MemoryBacking::HugeTlb2M ||
+                backing == MemoryBacking::HugeTlb1G) {
+                const auto page = page_size(backing);
+                const auto page_flag = static_cast<u32>(
+                    std::countr_zero(page) << MFD_HUGE_SHIFT
+                );
+                flags |= MFD_HUGETLB | page_flag;
+            }
+
+            const auto fd = memfd_create("nullvm-guest-memory", flags);
+
+            if (fd == -1)
+                return std::unexpected(std::strerror(errno));
+
+            auto memfd = utils::FDWrapper(fd);
+
+            if (ftruncate(fd, static_cast<off_t>(size)) == -1)
+                return std::unexpected(std::strerror(errno));
+
+            const auto seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+            if (fcntl(fd, F_ADD_SEALS, seals) == -1)
+                return std::unexpected(std::strerror(errno));
+
+            return memfd;
+        }
+
+        /// @brief Map sealed memory file with specified backing.
+        ///
+        /// @param [in] size given memory size in bytes.
+        /// @param [in] backing given memory backing.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_shared(usize size, MemoryBacking backing) noexcept
+        -> VmmResult<MemoryMapping> {
+            const auto huge = backing == MemoryBacking::TransparentHuge;
+
+            // Memory files follow their own transparent huge pages mode.
+            if (huge && !transparent_huge_pages(true)) {
+                return std::unexpected(
+                    "Transparent huge pages are disabled for memory files"
+                );
+            }
+
+            const auto length = align_up(size, page_size(backing));
+            auto memfd = create_memfd(length, backing);
+
+            if (!memfd)
+                return std::unexpected(memfd.error());
+
+            const auto fd = memfd->fd();
+            utils::MMapWrapper memory;
+
+            // Aligned reservation is replaced by file mapping, so that the
+            // whole memory can be backed by huge pages.
+            if (huge) {
+                auto area = map_aligned(length);
+
+                if (!area)
+                    return std::unexpected(area.error());
+
+                memory = std::move(area.value());
+            }
+
+            const auto flags = MAP_SHARED | (huge ? MAP_FIXED : 0);
+            const auto addr = mmap(
+                memory.addr(), length, MEMORY_PROT, flags, fd, 0
+            );
+
+            if (addr == MAP_FAILED)
+                return std::unexpected(std::strerror(errno));
+
+            if (!huge) {
+                if (auto result = memory.init(addr, length); !result)
+                    return std::unexpected(result.error());
+            }
+
+            if (huge && madvise(addr, length, MADV_HUGEPAGE) == -1)
+                return std::unexpected(std::strerror(errno));
+
+            return MemoryMapping {
+                std::move(memory), backing, std::move(memfd.value())
+            };
+        }
+
+        /// @brief Map memory with specified backing.
+        ///
+        /// @param [in] size given memory size in bytes.
+        /// @param [in] backing given memory backing.
+        ///
+        /// @return Memory mapping - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_backing(usize size, MemoryBacking backing) noexcept
+        -> VmmResult<utils::MMapWrapper> {
+            switch (backing) {
+                case MemoryBacking::HugeTlb1G:
+                    return map_hugetlb(size, HUGE_PAGE_1G);
+
+                case MemoryBacking::HugeTlb2M:
+                    return map_hugetlb(size, HUGE_PAGE_2M);
+
+                case MemoryBacking::TransparentHuge:
+                    return map_transparent_huge(size);
+
+                default:
+                    return map_anonymous(size);
+            }
+        }
+    }
+
+    auto to_string(MemoryBacking backing) noexcept -> std::string_view {
+        switch (backing) {
+            case MemoryBacking::Anonymous:
+                return "anonymous";
+
+            case MemoryBacking::TransparentHuge:
+                return "transparent huge pages";
+
+            case MemoryBacking::HugeTlb2M:
+                return "2M huge pages";
+
+            case MemoryBacking::HugeTlb1G:
+                return "1G huge pages";
+
+            default:
+                return "unknown";
+        }
+    }
+
+    auto transparent_huge_pages(bool shared) noexcept -> bool {
+        if (!shared) {
+            const auto mode = read_thp_mode(THP_ENABLED_PATH);
+            return mode == "always" || mode == "madvise";
+        }
+
+        const auto mode = read_thp_mode(THP_SHMEM_ENABLED_PATH);
+
+        return mode == "always" || mode == "within_size" ||
+               mode == "advise" || mode == "force";
+    }
+
+    auto page_size(MemoryBacking backing) noexcept -> usize {
+        switch (backing) {
+            // Transparent huge pages are PMD-sized.
+            case MemoryBacking::TransparentHuge:
+            case MemoryBacking::HugeTlb2M:
+                return HUGE_PAGE_2M;
+
+            case MemoryBacking::HugeTlb1G:
+                return HUGE_PAGE_1G;
+
+            default:
+                return static_cast<usize>(sysconf(_SC_PAGESIZE));
+        }
+    }
+
+    auto map_guest_memory(usize size, MemoryBacking backing, bool shared)
+    noexcept -> VmmResult<MemoryMapping> {
+        if (size == 0) {
+            return std::unexpected(
+                "Error to map guest memory: memory size is zero"
+            );
+        }
+
+        // Backings are ordered by page size, try requested one and then
+        // each smaller one.
+        auto current = static_cast<u8>(backing);
+
+        while (true) {
+            const auto candidate = static_cast<MemoryBacking>(current);
+
+            if (shared) {
+                auto mapping = map_shared(size, candidate);
+
+                if (mapping)
+                    return mapping;
+
+                if (candidate == MemoryBacking::Anonymous)
+                    return std::unexpected(mapping.error());
+
+                log::info(
+                    "Shared guest memory backing '{}' is unavailable: {}",
+                    to_string(candidate), mapping.error()
+                );
+
+                --current;
+                continue;
+            }
+
+            auto result = map_backing(size, candidate);
+
+            if (result)
+                return MemoryMapping {std::move(result.value()), candidate};
+
+            if (candidate == MemoryBacking::Anonymous)
+                return std::unexpected(result.error());
+
+            log::info(
+                "Guest memory backing '{}' is unavailable: {}",
+                to_string(candidate), result.error()
+            );
+
+            --current;
+        }
+    }
+
+}
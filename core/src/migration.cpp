@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine live migration related declarations.
+
+#include <nullvm/core/utils/utils.hpp>
+#include <nullvm/core/migration.hpp>
+#include <nullvm/log.hpp>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
+#include <array>
+#include <cerrno>
+#include <format>
+#include <bit>
+
+namespace nullvm::core::migration {
+
+    namespace {
+        /// Requested capacity of pipe used for splicing pages.
+        constexpr usize PIPE_SIZE {1024 * 1024};
+
+        /// @brief Write all bytes to file descriptor.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [in] data given bytes to write.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write_all(i32 fd, std::span<const u8> data) noexcept
+        -> VmmResult<None> {
+            while (!data.empty()) {
+                const auto ret = write(fd, data.data(), data.size());
+
+                if (ret == -1) {
+                    if (errno == EINTR)
+                        continue;
+
+                    const auto err = std::format(
+                        "Error to send migration data: {}",
+                        std::strerror(errno)
+                    );
+                    return std::unexpected(err);
+                }
+
+                data = data.subspan(static_cast<usize>(ret));
+            }
+
+            return None {};
+        }
+
+        /// @brief Read exact number of bytes from file descriptor.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [out] data given buffer to fill.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto read_all(i32 fd, std::span<u8> data) noexcept
+        -> VmmResult<None> {
+            while (!data.empty()) {
+                const auto ret = read(fd, data.data(), data.size());
+
+                if (ret == -1 && errno == EINTR)
+                    continue;
+
+                if (ret <= 0) {
+                    const auto err = std::format(
+                        "Error to receive migration data: {}",
+                        ret == 0 ? "connection closed" : std::strerror(errno)
+                    );
+                    return std::unexpected(err);
+                }
+
+                data = data.subspan(static_cast<usize>(ret));
+            }
+
+            return None {};
+        }
+
+        /// @brief Send pages of range selected by predicate in runs.
+        ///
+        /// @param [in] channel given migration channel.
+        /// @param [in] memory given guest memory.
+        /// @param [in] range given guest memory range.
+        /// @param [in] selected given predicate taking page index.
+        ///
+        /// @return Number of pages sent - in case of success.
+        /// @return VmmError - otherwise.
+        template <typename Predicate>
+        auto send_range(
+            Channel& channel, const GuestMemory& memory,
+            const GuestRange& range, Predicate&& selected
+        ) -> VmmResult<u64> {
+            auto host = memory.translate(range.guest_addr, range.size);
+
+            if (!host)
+                return std::unexpected(host.error());
+
+            const auto data = std::span<const u8>(host.value(), range.size);
+            const auto pages = (range.size + GUEST_PAGE_SIZE - 1) /
+                GUEST_PAGE_SIZE;
+
+            u64 sent = 0;
+
+            for (u64 page = 0; page < pages;) {
+                if (!selected(data, page)) {
+                    ++page;
+                    continue;
+                }
+
+                auto end = page + 1;
+
+                while (end < pages && selected(data, end))
+                    ++end;
+
+                const auto pos = page * GUEST_PAGE_SIZE;
+                const auto size = std::min(
+                    end * GUEST_PAGE_SIZE, range.size
+                ) - pos;
+
+                auto result = channel.send(
+                    MessageType::Pages, range.guest_addr + pos,
+                    data.subspan(pos, size)
+                );
+
+                if (!result)
+                    return std::unexpected(result.error());
+
+                sent += end - page;
+                page = end;
+            }
+
+            return sent;
+        }
+    }
+
+    auto Channel::init(i32 fd) noexcept -> VmmResult<None> {
+        if (fd < 0)
+            return std::unexpected("Invalid migration socket");
+
+        m_fd = fd;
+
+        i32 pipe_fds[2] {-1, -1};
+
+        // Without pipe pages are written with plain write().
+        if (pipe2(pipe_fds, O_CLOEXEC) == -1) {
+            log::info("Migration pages are not spliced: no pipe");
+            return None {};
+        }
+
+        m_pipe_read = utils::FDWrapper(pipe_fds[0]);
+        m_pipe_write = utils::FDWrapper(pipe_fds[1]);
+
+        const auto size = fcntl(
+            m_pipe_write.fd(), F_SETPIPE_SZ, static_cast<i32>(PIPE_SIZE)
+        );
+
+        // Unprivileged processes may be limited by pipe-max-size.
+        m_pipe_size = static_cast<usize>(
+            size != -1 ? size : fcntl(m_pipe_write.fd(), F_GETPIPE_SZ)
+        );
+
+        return None {};
+    }
+
+    auto Channel::send(
+        MessageType type, u64 addr, std::span<const u8> payload
+    ) noexcept -> VmmResult<None> {
+        const MessageHeader header {
+            .type    = type,
+            .version = MIGRATION_VERSION,
+            .addr    = addr,
+            .size    = payload.size(),
+        };
+
+        const auto bytes = std::bit_cast<std::array<u8, sizeof(header)>>(
+            header
+        );
+
+        if (auto result = write_all(m_fd, bytes); !result)
+            return result;
+
+        if (type == MessageType::Pages && m_pipe_size != 0)
+            return splice_out(payload);
+
+        return write_all(m_fd, payload);
+    }
+
+    auto Channel::recv_header() noexcept -> VmmResult<MessageHeader> {
+        std::array<u8, sizeof(MessageHeader)> bytes {};
+
+        if (auto result = read_all(m_fd, bytes); !result)
+            return std::unexpected(result.error());
+
+        const auto header = std::bit_cast<MessageHeader>(bytes);
+
+        if (header.version != MIGRATION_VERSION) {
+            const auto err = std::format(
+                "Unsupported migration version {}, expected {}",
+                header.version, MIGRATION_VERSION
+            );
+            return std::unexpected(err);
+        }
+
+        return header;
+    }
+
+    auto Channel::recv_payload(std::span<u8> payload) noexcept
+    -> VmmResult<None> {
+        return read_all(m_fd, payload);
+    }
+
+    auto Channel::splice_out(std::span<const u8> data) noexcept
+    -> VmmResult<None> {
+        while (!data.empty()) {
+            iovec iov {
+                .iov_base = const_cast<u8*>(data.data()),
+                .iov_len  = std::min(data.size(), m_pipe_size),
+            };
+
+            // Pipe references guest pages instead of copying them.
+            const auto ret = vmsplice(m_pipe_write.fd(), &iov, 1, 0);
+
+            if (ret == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                // Pipe is empty, so stream can continue without splicing.
+                log::info(
+                    "Migration pages are not spliced: {}", std::strerror(errno)
+                );
+                m_pipe_size = 0;
+
+                return write_all(m_fd, data);
+            }
+
+            auto left = static_cast<usize>(ret);
+
+            while (left != 0) {
+                const auto moved = splice(
+                    m_pipe_read.fd(), nullptr, m_fd, nullptr, left,
+                    SPLICE_F_MOVE | SPLICE_F_MORE
+                );
+
+                if (moved == -1) {
+                    if (errno == EINTR)
+                        continue;
+
+                    const auto err = std::format(
+                        "Error to send migration pages: {}",
+                        std::strerror(errno)
+                    );
+                    return std::unexpected(err);
+                }
+
+                left -= static_cast<usize>(moved);
+            }
+
+            data = data.subspan(static_cast<usize>(ret));
+        }
+
+        return None {};
+    }
+
+    auto send_memory(Channel& channel, const GuestMemory& memory)
+    -> VmmResult<u64> {
+        u64 sent = 0;
+
+        for (const auto& range : memory.ranges()) {
+            auto result = send_range(
+                channel, memory, range,
+                [&range](std::span<const u8> data, u64 page) {
+                    const auto pos = page * GUEST_PAGE_SIZE;
+                    const auto size = std::min(
+                        GUEST_PAGE_SIZE, range.size - pos
+                    );
+                    return !utils::is_zero(data.subspan(pos, size));
+                }
+            );
+
+            if (!result)
+                return result;
+
+            sent += result.value();
+        }
+
+        return sent;
+    }
+
+    auto send_dirty(
+        Channel& channel, const GuestMemory& memory,
+        std::span<const DirtyBitmap> dirty
+    ) -> VmmResult<u64> {
+        const auto ranges = memory.ranges();
+
+        if (ranges.size() != dirty.size())
+            return std::unexpected("Dirty bitmaps do not match guest memory");
+
+        u64 sent = 0;
+
+        for (usize i = 0; i < ranges.size(); ++i) {
+            const auto& bitmap = dirty[i];
+
+            auto result = send_range(
+                channel, memory, ranges[i],
+                [&bitmap](std::span<const u8>, u64 page) {
+                    return bitmap.test(page);
+                }
+            );
+
+            if (!result)
+                return result;
+
+            sent += result.value();
+        }
+
+        return sent;
+    }
+
+    auto count_dirty(std::span<const DirtyBitmap> dirty) noexcept -> u64 {
+        u64 count = 0;
+
+        for (const auto& bitmap : dirty) {
+            for (const auto word : bitmap.bits)
+                count += static_cast<u64>(std::popcount(word));
+        }
+
+        return count;
+    }
+
+}
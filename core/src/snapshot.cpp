@@ -0,0 +1,722 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine snapshot related declarations.
+
+#include <nullvm/core/utils/file_mapping.hpp>
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/utils/utils.hpp>
+#include <nullvm/core/snapshot.hpp>
+#include <nullvm/log.hpp>
+#include <type_traits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <format>
+
+namespace nullvm::core::snapshot {
+
+    namespace {
+        /// State file magic value ("NULLVMSS").
+        constexpr u64 SNAPSHOT_MAGIC {0x53534d564c4c554e};
+
+        /// State file header.
+        struct Header {
+            /// Magic value.
+            u64 magic {SNAPSHOT_MAGIC};
+            /// Format version.
+            u32 version {SNAPSHOT_VERSION};
+            /// Number of virtual CPUs.
+            u32 vcpus {0};
+            /// Number of memory regions.
+            u32 regions {0};
+            /// Flag whether irqchip state follows KVM clock.
+            u32 irqchip {0};
+        };
+
+        /// Saved virtual CPU state header.
+        struct VCpuHeader {
+            /// Number of MSR entries.
+            u32 msrs {0};
+            /// Flag whether LAPIC state follows.
+            u32 lapic {0};
+        };
+
+        /// Binary state serializer.
+        class Writer final {
+            /// Serialized bytes.
+            std::vector<u8> m_data;
+
+        public:
+            /// @brief Append values to state.
+            ///
+            /// @param [in] values given values to append.
+            template <typename T>
+            requires std::is_trivially_copyable_v<T>
+            auto put(std::span<const T> values) -> void {
+                const auto bytes = std::as_bytes(values);
+                const auto data = std::bit_cast<const u8*>(bytes.data());
+                m_data.insert(m_data.end(), data, data + bytes.size());
+            }
+
+            /// @brief Append value to state.
+            ///
+            /// @param [in] value given value to append.
+            template <typename T>
+            requires std::is_trivially_copyable_v<T>
+            auto put(const T& value) -> void {
+                put(std::span(&value, 1));
+            }
+
+            /// @brief Take serialized bytes.
+            ///
+            /// @return Serialized state.
+            auto take() noexcept -> std::vector<u8> {
+                return std::move(m_data);
+            }
+        };
+
+        /// Binary state deserializer.
+        class Reader final {
+            /// Serialized bytes.
+            std::span<const u8> m_data;
+
+        public:
+            /// @brief Construct new Reader object.
+            ///
+            /// @param [in] data given serialized state.
+            explicit Reader(std::span<const u8> data) noexcept
+                : m_data(data) {}
+
+            /// @brief Take values from state.
+            ///
+            /// @param [out] values given buffer to fill.
+            ///
+            /// @return true - in case of success.
+            /// @return false - if state is truncated.
+            template <typename T>
+            requires std::is_trivially_copyable_v<T>
+            auto get(std::span<T> values) noexcept -> bool {
+                const auto size = values.size_bytes();
+
+                if (size > m_data.size())
+                    return false;
+
+                std::memcpy(values.data(), m_data.data(), size);
+                m_data = m_data.subspan(size);
+
+                return true;
+            }
+
+            /// @brief Take value from state.
+            ///
+            /// @param [out] value given value to fill.
+            ///
+            /// @return true - in case of success.
+            /// @return false - if state is truncated.
+            template <typename T>
+            requires std::is_trivially_copyable_v<T>
+            auto get(T& value) noexcept -> bool {
+                return get(std::span(&value, 1));
+            }
+
+            /// @brief Get number of bytes left.
+            ///
+            /// @return Number of bytes not taken yet.
+            auto remaining() const noexcept -> usize {
+                return m_data.size();
+            }
+        };
+
+        /// @brief Write bytes to file at offset.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [in] data given bytes to write.
+        /// @param [in] offset given file offset.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write_at(i32 fd, std::span<const u8> data, u64 offset)
+        -> VmmResult<None> {
+            while (!data.empty()) {
+                const auto ret = pwrite(
+                    fd, data.data(), data.size(), static_cast<off_t>(offset)
+                );
+
+                if (ret == -1) {
+                    if (errno == EINTR)
+                        continue;
+
+                    const auto err = std::format(
+                        "Error to write snapshot: {}", std::strerror(errno)
+                    );
+                    return std::unexpected(err);
+                }
+
+                const auto written = static_cast<usize>(ret);
+                data = data.subspan(written);
+                offset += written;
+            }
+
+            return None {};
+        }
+
+        /// @brief Write non-zero pages of region to file.
+        ///
+        /// @param [in] fd given file descriptor.
+        /// @param [in] data given region host memory.
+        /// @param [in] offset given region offset in file.
+        /// @param [in] page_size given page size in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write_region(
+            i32 fd, std::span<const u8> data, u64 offset, usize page_size
+        ) -> VmmResult<None> {
+            const auto zero_page = [&](usize pos) {
+                return utils::is_zero(
+                    data.subspan(pos, std::min(page_size, data.size() - pos))
+                );
+            };
+
+            usize pos = 0;
+
+            while (pos < data.size()) {
+                // Skip zero pages, they stay holes in file.
+                while (pos < data.size() && zero_page(pos))
+                    pos += page_size;
+
+                // Write run of non-zero pages at once.
+                auto end = pos;
+
+                while (end < data.size() && !zero_page(end))
+                    end += page_size;
+
+                end = std::min(end, data.size());
+
+                if (end <= pos)
+                    continue;
+
+                const auto run = data.subspan(pos, end - pos);
+
+                if (auto result = write_at(fd, run, offset + pos); !result)
+                    return result;
+
+                pos = end;
+            }
+
+            return None {};
+        }
+
+        /// @brief Write guest memory regions to file one after another.
+        ///
+        /// @param [in] fd given memory file descriptor.
+        /// @param [in] memory given guest memory.
+        /// @param [in] write given function writing region data at file
+        /// offset, takes region index.
+        ///
+        /// @return Regions layout in file - in case of success.
+        /// @return VmmError - otherwise.
+        template <typename Write>
+        auto write_layout(i32 fd, const GuestMemory& memory, Write&& write)
+        -> VmmResult<std::vector<RegionState>> {
+            const auto page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+            const auto ranges = memory.ranges();
+
+            std::vector<RegionState> regions;
+            u64 offset = 0;
+
+            for (usize i = 0; i < ranges.size(); ++i) {
+                const auto& range = ranges[i];
+                auto host = memory.translate(range.guest_addr, range.size);
+
+                if (!host)
+                    return std::unexpected(host.error());
+
+                const auto data = std::span<const u8>(host.value(), range.size);
+
+                if (auto result = write(fd, data, offset, i); !result)
+                    return std::unexpected(result.error());
+
+                regions.push_back({
+                    .guest_addr = range.guest_addr,
+                    .size       = range.size,
+                    .offset     = offset,
+                    .flags      = range.flags,
+                    .reserved   = 0,
+                });
+
+                offset += (range.size + page_size - 1) & ~(page_size - 1);
+            }
+
+            // Trailing holes are not written, extend file over them.
+            if (ftruncate(fd, static_cast<off_t>(offset)) == -1) {
+                const auto err = std::format(
+                    "Error to resize memory file: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            return regions;
+        }
+    }
+
+    auto save_vcpu(VCpu& vcpu, std::span<const u32> msr_indices)
+    -> VmmResult<VCpuState> {
+        VCpuState state;
+
+        // Getting multiprocessing state applies pending INIT/SIPI and may
+        // change the rest of state, so it goes first.
+        auto mp_state = vcpu.mp_state();
+
+        if (!mp_state)
+            return std::unexpected(mp_state.error());
+
+        auto regs = vcpu.regs();
+
+        if (!regs)
+            return std::unexpected(regs.error());
+
+        auto sregs = vcpu.sregs();
+
+        if (!sregs)
+            return std::unexpected(sregs.error());
+
+        auto fpu = vcpu.fpu();
+
+        if (!fpu)
+            return std::unexpected(fpu.error());
+
+        auto xsave = vcpu.xsave();
+
+        if (!xsave)
+            return std::unexpected(xsave.error());
+
+        auto xcrs = vcpu.xcrs();
+
+        if (!xcrs)
+            return std::unexpected(xcrs.error());
+
+        auto debugregs = vcpu.debugregs();
+
+        if (!debugregs)
+            return std::unexpected(debugregs.error());
+
+        auto lapic = vcpu.lapic();
+
+        if (!lapic)
+            return std::unexpected(lapic.error());
+
+        state.mp_state = mp_state.value();
+        state.regs = regs.value();
+        state.sregs = sregs.value();
+        state.fpu = fpu.value();
+        state.xsave = xsave.value();
+        state.xcrs = xcrs.value();
+        state.debugregs = debugregs.value();
+        state.lapic = lapic.value();
+
+        // KVM stops at the first MSR it cannot read, skip it and continue
+        // with the rest.
+        while (!msr_indices.empty()) {
+            auto msrs = vcpu.msrs(msr_indices);
+
+            if (!msrs)
+                return std::unexpected(msrs.error());
+
+            state.msrs.insert(state.msrs.end(), msrs->begin(), msrs->end());
+            msr_indices = msr_indices.subspan(
+                std::min(msrs->size() + 1, msr_indices.size())
+            );
+        }
+
+        // Pending events are saved last, reading LAPIC and MSRs above
+        // may still raise them.
+        auto events = vcpu.vcpu_events();
+
+        if (!events)
+            return std::unexpected(events.error());
+
+        state.events = events.value();
+
+        return state;
+    }
+
+    auto restore_vcpu(VCpu& vcpu, const VCpuState& state)
+    -> VmmResult<None> {
+        if (auto result = vcpu.set_mp_state(state.mp_state); !result)
+            return result;
+
+        if (auto result = vcpu.set_regs(state.regs); !result)
+            return result;
+
+        // Special registers go before MSRs and LAPIC, which depend on CPU
+        // mode.
+        if (auto result = vcpu.set_sregs(state.sregs); !result)
+            return result;
+
+        // XSAVE area includes x87 and SSE state, so it is set after FPU.
+        if (auto result = vcpu.set_fpu(state.fpu); !result)
+            return result;
+
+        if (auto result = vcpu.set_xsave(state.xsave); !result)
+            return result;
+
+        if (auto result = vcpu.set_xcrs(state.xcrs); !result)
+            return result;
+
+        if (auto result = vcpu.set_debugregs(state.debugregs); !result)
+            return result;
+
+        if (state.lapic) {
+            if (auto result = vcpu.set_lapic(state.lapic.value()); !result)
+                return result;
+        }
+
+        // MSRs depending on guest CPUID features may be readable but not
+        // writable, skip them the same way as on save.
+        auto msrs = std::span(state.msrs);
+
+        while (!msrs.empty()) {
+            auto count = vcpu.set_msrs(msrs);
+
+            if (!count)
+                return std::unexpected(count.error());
+
+            if (count.value() < msrs.size()) {
+                log::debug(
+                    "MSR {:#x} is not restored", msrs[count.value()].index
+                );
+            }
+
+            msrs = msrs.subspan(std::min(count.value() + 1, msrs.size()));
+        }
+
+        return vcpu.set_vcpu_events(state.events);
+    }
+
+    auto create_file(const std::string& path) -> VmmResult<utils::FDWrapper> {
+        const auto flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        utils::FDWrapper file(open(path.c_str(), flags, 0600));
+
+        if (file.fd() == -1) {
+            const auto err = std::format(
+                "Error to create file '{}': {}", path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return file;
+    }
+
+    auto write_memory(i32 fd, const GuestMemory& memory)
+    -> VmmResult<std::vector<RegionState>> {
+        return write_layout(
+            fd, memory,
+            [](i32 fd, std::span<const u8> data, u64 offset, usize) {
+                return write_region(fd, data, offset, GUEST_PAGE_SIZE);
+            }
+        );
+    }
+
+    auto write_memory_diff(
+        i32 fd, const GuestMemory& memory,
+        std::span<const DirtyBitmap> dirty
+    ) -> VmmResult<std::vector<RegionState>> {
+        if (dirty.size() != memory.regions_count())
+            return std::unexpected("Dirty bitmaps do not match guest memory");
+
+        return write_layout(
+            fd, memory,
+            [dirty](i32 fd, std::span<const u8> data, u64 offset, usize index)
+            -> VmmResult<None> {
+                const auto& bitmap = dirty[index];
+                const auto pages = (data.size() + GUEST_PAGE_SIZE - 1) /
+                    GUEST_PAGE_SIZE;
+
+                // Dirty pages are written even if zero, holes mean that
+                // page did not change.
+                for (u64 page = 0; page < pages;) {
+                    if (!bitmap.test(page)) {
+                        ++page;
+                        continue;
+                    }
+
+                    auto end = page;
+
+                    while (end < pages && bitmap.test(end))
+                        ++end;
+
+                    const auto pos = page * GUEST_PAGE_SIZE;
+                    const auto size = std::min(
+                        end * GUEST_PAGE_SIZE, data.size()
+                    ) - pos;
+
+                    auto result = write_at(
+                        fd, data.subspan(pos, size), offset + pos
+                    );
+
+                    if (!result)
+                        return result;
+
+                    page = end;
+                }
+
+                return None {};
+            }
+        );
+    }
+
+    auto merge_memory(
+        const std::string& diff_path, const std::string& base_path
+    ) -> VmmResult<None> {
+        const utils::FDWrapper diff(
+            open(diff_path.c_str(), O_RDONLY | O_CLOEXEC)
+        );
+        const utils::FDWrapper base(
+            open(base_path.c_str(), O_WRONLY | O_CLOEXEC)
+        );
+
+        if (diff.fd() == -1 || base.fd() == -1) {
+            const auto err = std::format(
+                "Error to open memory files '{}' and '{}': {}",
+                diff_path, base_path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        // Only allocated extents of diff hold changed pages, copy them in
+        // kernel without passing data through userspace.
+        off_t data = 0;
+
+        while ((data = lseek(diff.fd(), data, SEEK_DATA)) != -1) {
+            const auto hole = lseek(diff.fd(), data, SEEK_HOLE);
+
+            if (hole == -1)
+                break;
+
+            auto in = data;
+            auto out = data;
+            auto left = static_cast<usize>(hole - data);
+
+            while (left != 0) {
+                const auto ret = copy_file_range(
+                    diff.fd(), &in, base.fd(), &out, left, 0
+                );
+
+                if (ret <= 0) {
+                    const auto err = std::format(
+                        "Error to merge memory file '{}': {}",
+                        diff_path, ret == 0 ? "unexpected end of file" :
+                                              std::strerror(errno)
+                    );
+                    return std::unexpected(err);
+                }
+
+                left -= static_cast<usize>(ret);
+            }
+
+            data = hole;
+        }
+
+        // ENXIO means there is no data past offset.
+        if (errno != ENXIO) {
+            const auto err = std::format(
+                "Error to read memory file '{}': {}",
+                diff_path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto map_memory(
+        const std::string& path, std::span<const RegionState> regions,
+        GuestMemory& memory
+    ) -> VmmResult<None> {
+        const utils::FDWrapper file(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+
+        if (file.fd() == -1) {
+            const auto err = std::format(
+                "Error to open memory file '{}': {}", path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        for (const auto& region : regions) {
+            // Read-only regions are read-only for guest only, host keeps
+            // writing to them through GuestMemory.
+            auto mapping = utils::map_file(
+                file.fd(), region.offset, region.size, true
+            );
+
+            if (!mapping) {
+                const auto err = std::format(
+                    "Error to map memory region {:#x}: {}",
+                    region.guest_addr, mapping.error()
+                );
+                return std::unexpected(err);
+            }
+
+            auto slot = memory.add_region(
+                region.guest_addr, region.size, std::move(mapping.value()),
+                region.flags
+            );
+
+            if (!slot)
+                return std::unexpected(slot.error());
+        }
+
+        return None {};
+    }
+
+    auto serialize_state(const VmState& state) -> std::vector<u8> {
+        Writer writer;
+
+        writer.put(Header {
+            .magic    = SNAPSHOT_MAGIC,
+            .version  = SNAPSHOT_VERSION,
+            .vcpus    = static_cast<u32>(state.vcpus.size()),
+            .regions  = static_cast<u32>(state.regions.size()),
+            .irqchip  = state.irqchip.has_value(),
+        });
+
+        writer.put(std::span(state.regions));
+        writer.put(state.clock);
+
+        if (state.irqchip)
+            writer.put(state.irqchip.value());
+
+        for (const auto& vcpu : state.vcpus) {
+            writer.put(VCpuHeader {
+                .msrs  = static_cast<u32>(vcpu.msrs.size()),
+                .lapic = vcpu.lapic.has_value(),
+            });
+
+            writer.put(vcpu.regs);
+            writer.put(vcpu.sregs);
+            writer.put(vcpu.fpu);
+            writer.put(vcpu.xsave);
+            writer.put(vcpu.xcrs);
+            writer.put(vcpu.debugregs);
+            writer.put(vcpu.mp_state);
+            writer.put(vcpu.events);
+            writer.put(std::span(vcpu.msrs));
+
+            if (vcpu.lapic)
+                writer.put(vcpu.lapic.value());
+        }
+
+        return writer.take();
+    }
+
+    auto deserialize_state(std::span<const u8> data) -> VmmResult<VmState> {
+        Reader reader(data);
+
+        const auto truncated = [] {
+            return std::unexpected("Snapshot state is truncated");
+        };
+
+        Header header;
+
+        if (!reader.get(header))
+            return truncated();
+
+        if (header.magic != SNAPSHOT_MAGIC)
+            return std::unexpected("Data is not snapshot state");
+
+        if (header.version != SNAPSHOT_VERSION) {
+            const auto err = std::format(
+                "Unsupported snapshot version {}, expected {}",
+                header.version, SNAPSHOT_VERSION
+            );
+            return std::unexpected(err);
+        }
+
+        // Counts are checked against data size before allocation.
+        const auto min_size = header.regions * sizeof(RegionState) +
+            header.vcpus * sizeof(VCpuHeader);
+
+        if (min_size > reader.remaining())
+            return truncated();
+
+        VmState state;
+        state.regions.resize(header.regions);
+        state.vcpus.resize(header.vcpus);
+
+        if (!reader.get(std::span(state.regions)) || !reader.get(state.clock))
+            return truncated();
+
+        if (header.irqchip) {
+            state.irqchip.emplace();
+
+            if (!reader.get(state.irqchip.value()))
+                return truncated();
+        }
+
+        for (auto& vcpu : state.vcpus) {
+            VCpuHeader vcpu_header;
+
+            if (!reader.get(vcpu_header))
+                return truncated();
+
+            if (vcpu_header.msrs * sizeof(kvm_msr_entry) > reader.remaining())
+                return truncated();
+
+            vcpu.msrs.resize(vcpu_header.msrs);
+
+            const auto ok = reader.get(vcpu.regs) &&
+                reader.get(vcpu.sregs) &&
+                reader.get(vcpu.fpu) &&
+                reader.get(vcpu.xsave) &&
+                reader.get(vcpu.xcrs) &&
+                reader.get(vcpu.debugregs) &&
+                reader.get(vcpu.mp_state) &&
+                reader.get(vcpu.events) &&
+                reader.get(std::span(vcpu.msrs));
+
+            if (!ok)
+                return truncated();
+
+            if (vcpu_header.lapic) {
+                vcpu.lapic.emplace();
+
+                if (!reader.get(vcpu.lapic.value()))
+                    return truncated();
+            }
+        }
+
+        return state;
+    }
+
+    auto write_state(i32 fd, const VmState& state) -> VmmResult<None> {
+        const auto data = serialize_state(state);
+        return write_at(fd, data, 0);
+    }
+
+    auto read_state(const std::string& path) -> VmmResult<VmState> {
+        auto file = utils::map_file(path, false);
+
+        if (!file)
+            return std::unexpected(file.error());
+
+        const auto data = std::span(
+            static_cast<const u8*>(file->addr()), file->size()
+        );
+
+        auto state = deserialize_state(data);
+
+        if (!state) {
+            const auto err = std::format(
+                "Error to read snapshot state '{}': {}", path, state.error()
+            );
+            return std::unexpected(err);
+        }
+
+        return state;
+    }
+
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Event notification file descriptor related declarations.
+
+#include <nullvm/core/utils/eventfd.hpp>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <format>
+#include <cerrno>
+
+namespace nullvm::core::utils {
+
+    auto EventFd::init(bool nonblock) noexcept -> VmmResult<None> {
+        i32 flags = EFD_CLOEXEC;
+
+        if (nonblock)
+            flags |= EFD_NONBLOCK;
+
+        const auto fd = eventfd(0, flags);
+
+        if (fd == -1) {
+            const auto err = std::format(
+                "Error to create event file descriptor: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        m_fd = FDWrapper(fd);
+        return None {};
+    }
+
+    auto EventFd::fd() const noexcept -> i32 {
+        return m_fd.fd();
+    }
+
+    auto EventFd::write(u64 value) const noexcept -> VmmResult<None> {
+        const auto ret = ::write(m_fd.fd(), &value, sizeof(value));
+
+        if (ret != sizeof(value))
+            return std::unexpected("Error to write event counter");
+
+        return None {};
+    }
+
+    auto EventFd::read() const noexcept -> VmmResult<u64> {
+        u64 value {0};
+        const auto ret = ::read(m_fd.fd(), &value, sizeof(value));
+
+        if (ret != sizeof(value)) {
+            if (errno == EAGAIN)
+                return 0;
+
+            return std::unexpected("Error to read event counter");
+        }
+
+        return value;
+    }
+
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// File memory mapping related declarations.
+
+#include <nullvm/core/utils/file_mapping.hpp>
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <cerrno>
+#include <format>
+
+namespace nullvm::core::utils {
+
+    auto map_file(const std::string& path, bool writable) noexcept
+    -> VmmResult<MMapWrapper> {
+        const FDWrapper file(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+
+        if (file.fd() == -1) {
+            const auto err = std::format(
+                "Error to open file '{}': {}", path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        struct stat info {};
+
+        if (fstat(file.fd(), &info) == -1) {
+            const auto err = std::format(
+                "Error to get size of file '{}': {}", path, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        if (info.st_size <= 0) {
+            const auto err = std::format("File '{}' is empty", path);
+            return std::unexpected(err);
+        }
+
+        const auto page_size = static_cast<usize>(sysconf(_SC_PAGESIZE));
+        const auto file_size = static_cast<usize>(info.st_size);
+        const auto size = (file_size + page_size - 1) & ~(page_size - 1);
+
+        auto mapping = map_file(file.fd(), 0, size, writable);
+
+        if (!mapping) {
+            const auto err = std::format(
+                "Error to map file '{}': {}", path, mapping.error()
+            );
+            return std::unexpected(err);
+        }
+
+        return mapping;
+    }
+
+    auto map_file(i32 fd, u64 offset, usize size, bool writable) noexcept
+    -> VmmResult<MMapWrapper> {
+        // Private mapping never writes back to file, so read-only file
+        // descriptor is enough for copy-on-write mapping.
+        const auto prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        const auto addr = mmap(
+            nullptr, size, prot, MAP_PRIVATE, fd, static_cast<off_t>(offset)
+        );
+
+        if (addr == MAP_FAILED)
+            return std::unexpected(std::strerror(errno));
+
+        MMapWrapper mapping;
+
+        if (auto result = mapping.init(addr, size); !result)
+            return std::unexpected(result.error());
+
+        return mapping;
+    }
+
+}
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// io_uring submission and completion rings related declarations.
+
+#include <nullvm/core/utils/io_uring.hpp>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <atomic>
+#include <cerrno>
+#include <bit>
+
+namespace nullvm::core::utils {
+
+    namespace {
+        /// @brief Map io_uring region.
+        ///
+        /// @param [in] fd given io_uring file descriptor.
+        /// @param [in] size given region size in bytes.
+        /// @param [in] offset given IORING_OFF_* region offset.
+        /// @param [out] mapping given mapping to initialize.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto map_region(i32 fd, usize size, u64 offset, MMapWrapper& mapping)
+        noexcept -> VmmResult<None> {
+            auto addr = mmap(
+                nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(offset)
+            );
+
+            if (addr == MAP_FAILED) {
+                const auto err = std::format(
+                    "Error to map io_uring region: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            return mapping.init(addr, size);
+        }
+
+        /// @brief Get pointer into mapped region.
+        ///
+        /// @param [in] mapping given mapped region.
+        /// @param [in] offset given offset in bytes.
+        ///
+        /// @return Pointer into region.
+        template <typename T>
+        auto at(const MMapWrapper& mapping, u32 offset) noexcept -> T* {
+            return std::bit_cast<T*>(
+                static_cast<u8*>(mapping.addr()) + offset
+            );
+        }
+    }
+
+    auto IoUring::init(u32 entries, u32 flags) noexcept -> VmmResult<None> {
+        io_uring_params params {};
+        params.flags = flags;
+
+        const auto ret = syscall(SYS_io_uring_setup, entries, &params);
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to create io_uring: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        const auto fd = static_cast<i32>(ret);
+        m_fd = FDWrapper(fd);
+
+        const auto sq_size = params.sq_off.array +
+            params.sq_entries * sizeof(u32);
+        const auto cq_size = params.cq_off.cqes +
+            params.cq_entries * sizeof(io_uring_cqe);
+        const auto single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+        // Both rings may share single mapping.
+        auto result = map_region(
+            fd, single ? std::max(sq_size, cq_size) : sq_size,
+            IORING_OFF_SQ_RING, m_sq_ring
+        );
+
+        if (!result)
+            return result;
+
+        if (!single) {
+            result = map_region(fd, cq_size, IORING_OFF_CQ_RING, m_cq_ring);
+
+            if (!result)
+                return result;
+        }
+
+        result = map_region(
+            fd, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES,
+            m_sqes
+        );
+
+        if (!result)
+            return result;
+
+        const auto& cq_ring = single ? m_sq_ring : m_cq_ring;
+
+        m_sq_head    = at<u32>(m_sq_ring, params.sq_off.head);
+        m_sq_tail    = at<u32>(m_sq_ring, params.sq_off.tail);
+        m_sq_mask    = *at<u32>(m_sq_ring, params.sq_off.ring_mask);
+        m_sq_entries = params.sq_entries;
+        m_cq_head    = at<u32>(cq_ring, params.cq_off.head);
+        m_cq_tail    = at<u32>(cq_ring, params.cq_off.tail);
+        m_cq_mask    = *at<u32>(cq_ring, params.cq_off.ring_mask);
+        m_cqes       = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+        m_tail       = *m_sq_tail;
+
+        // Submission queue entries are used in ring order.
+        auto array = at<u32>(m_sq_ring, params.sq_off.array);
+
+        for (u32 i = 0; i < m_sq_entries; ++i)
+            array[i] = i;
+
+        return None {};
+    }
+
+    auto IoUring::fd() const noexcept -> i32 {
+        return m_fd.fd();
+    }
+
+    auto IoUring::get_sqe() noexcept -> VmmResult<io_uring_sqe*> {
+        const auto head = std::atomic_ref(*m_sq_head).load(
+            std::memory_order_acquire
+        );
+
+        if (m_tail - head >= m_sq_entries) {
+            if (auto result = submit(); !result)
+                return std::unexpected(result.error());
+
+            const auto consumed = std::atomic_ref(*m_sq_head).load(
+                std::memory_order_acquire
+            );
+
+            if (m_tail - consumed >= m_sq_entries)
+                return std::unexpected("io_uring submission queue is full");
+        }
+
+        auto sqe = static_cast<io_uring_sqe*>(m_sqes.addr()) +
+            (m_tail & m_sq_mask);
+        ++m_tail;
+
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    auto IoUring::submit(u32 wait) noexcept -> VmmResult<u32> {
+        const auto count = m_tail - *m_sq_tail;
+
+        std::atomic_ref(*m_sq_tail).store(m_tail, std::memory_order_release);
+
+        const auto flags = wait != 0 ? IORING_ENTER_GETEVENTS : 0u;
+
+        for (;;) {
+            const auto ret = syscall(
+                SYS_io_uring_enter, m_fd.fd(), count, wait, flags, nullptr, 0
+            );
+
+            if (ret != -1)
+                return static_cast<u32>(ret);
+
+            // Interrupted wait is retried only if nothing was submitted.
+            if (errno == EINTR && count == 0)
+                continue;
+
+            if (errno == EINTR)
+                return 0u;
+
+            const auto err = std::format(
+                "Error to submit io_uring entries: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+    }
+
+    auto IoUring::peek_cqe() const noexcept -> const io_uring_cqe* {
+        const auto head = *m_cq_head;
+        const auto tail = std::atomic_ref(*m_cq_tail).load(
+            std::memory_order_acquire
+        );
+
+        if (head == tail)
+            return nullptr;
+
+        return m_cqes + (head & m_cq_mask);
+    }
+
+    auto IoUring::cqe_seen() noexcept -> void {
+        std::atomic_ref(*m_cq_head).store(
+            *m_cq_head + 1, std::memory_order_release
+        );
+    }
+
+    auto BufferGroup::init(
+        IoUring& ring, std::uint16_t group, u32 entries, u32 size
+    ) noexcept -> VmmResult<None> {
+        // Buffer IDs are 16-bit.
+        if (entries == 0 || entries > 65536 || size == 0)
+            return std::unexpected("Invalid io_uring buffer group size");
+
+        const auto buffers_size = static_cast<usize>(entries) * size;
+        const auto addr = mmap(
+            nullptr, buffers_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+
+        if (auto result = m_buffers.init(addr, buffers_size); !result)
+            return result;
+
+        m_group = group;
+        m_size  = size;
+
+        auto sqe = provide(ring, 0, entries);
+
+        if (!sqe)
+            return std::unexpected(sqe.error());
+
+        if (auto result = ring.submit(1); !result)
+            return std::unexpected(result.error());
+
+        const auto cqe = ring.peek_cqe();
+
+        if (!cqe)
+            return std::unexpected("Error to provide io_uring buffers");
+
+        const auto res = cqe->res;
+        ring.cqe_seen();
+
+        if (res < 0) {
+            const auto err = std::format(
+                "Error to provide io_uring buffers: {}", std::strerror(-res)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto BufferGroup::group() const noexcept -> std::uint16_t {
+        return m_group;
+    }
+
+    auto BufferGroup::data(std::uint16_t id, usize size) const noexcept
+    -> std::span<const std::byte> {
+        const auto buffers = static_cast<const std::byte*>(m_buffers.addr());
+        return {buffers + static_cast<usize>(id) * m_size, size};
+    }
+
+    auto BufferGroup::recycle(IoUring& ring, std::uint16_t id) noexcept
+    -> VmmResult<None> {
+        auto sqe = provide(ring, id, 1);
+
+        if (!sqe)
+            return std::unexpected(sqe.error());
+
+        // Successful return needs no handling, so it posts no completion.
+        (*sqe)->flags = IOSQE_CQE_SKIP_SUCCESS;
+
+        return None {};
+    }
+
+    auto BufferGroup::provide(IoUring& ring, std::uint16_t id, u32 count)
+    noexcept -> VmmResult<io_uring_sqe*> {
+        auto sqe = ring.get_sqe();
+
+        if (!sqe)
+            return sqe;
+
+        (*sqe)->opcode    = IORING_OP_PROVIDE_BUFFERS;
+        (*sqe)->fd        = static_cast<i32>(count);
+        (*sqe)->addr      = std::bit_cast<u64>(data(id, 0).data());
+        (*sqe)->len       = m_size;
+        (*sqe)->off       = id;
+        (*sqe)->buf_group = m_group;
+
+        return sqe;
+    }
+
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Parallel memory operations related declarations.
+
+#include <nullvm/core/utils/parallel.hpp>
+#include <system_error>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace nullvm::core::utils {
+
+    namespace {
+        /// Alignment of per-thread chunks in bytes.
+        constexpr usize CHUNK_ALIGNMENT {4096};
+
+        /// @brief Run operation on chunks of range using multiple threads.
+        ///
+        /// Calling thread processes the last chunk. If threads cannot be
+        /// created, remaining chunks are processed by calling thread.
+        ///
+        /// @param [in] size given range size in bytes.
+        /// @param [in] operation given operation taking chunk offset and size.
+        template <typename Operation>
+        auto for_each_chunk(usize size, Operation&& operation) noexcept
+        -> void {
+            const auto hardware =
+                std::max(std::thread::hardware_concurrency(), 1u);
+            const auto threads = std::min({
+                static_cast<usize>(hardware),
+                size / PARALLEL_CHUNK_SIZE,
+                PARALLEL_MAX_THREADS
+            });
+
+            if (threads <= 1) {
+                operation(0, size);
+                return;
+            }
+
+            const auto chunk = (size / threads + CHUNK_ALIGNMENT - 1) &
+                               ~(CHUNK_ALIGNMENT - 1);
+
+            std::vector<std::jthread> workers;
+            usize offset {0};
+
+            try {
+                workers.reserve(threads - 1);
+
+                for (; workers.size() < threads - 1; offset += chunk) {
+                    workers.emplace_back([&operation, offset, chunk] {
+                        operation(offset, chunk);
+                    });
+                }
+            }
+            catch (const std::exception&) {
+                // Remaining chunks are processed by calling thread.
+            }
+
+            operation(offset, size - offset);
+        }
+    }
+
+    auto parallel_copy(std::span<u8> dst, std::span<const u8> src) noexcept
+    -> void {
+        for_each_chunk(src.size(), [&](usize offset, usize size) {
+            std::memcpy(dst.data() + offset, src.data() + offset, size);
+        });
+    }
+
+    auto parallel_fill(std::span<u8> dst, u8 value) noexcept -> void {
+        for_each_chunk(dst.size(), [&](usize offset, usize size) {
+            std::memset(dst.data() + offset, value, size);
+        });
+    }
+
+}
@@ -5,6 +5,7 @@
 
 #include <nullvm/core/utils/utils.hpp>
 #include <fcntl.h>
+#include <cstring>
 
 namespace nullvm::core::utils {
 
@@ -12,4 +13,15 @@ namespace nullvm::core::utils {
         return fcntl(fd, F_GETFD) != -1;
     }
 
+    auto is_zero(std::span<const u8> data) noexcept -> bool {
+        if (data.empty())
+            return true;
+
+        // First byte check and self-overlapping compare avoid a separate
+        // zero buffer.
+        const auto size = data.size() - 1;
+        return data.front() == 0 &&
+            std::memcmp(data.data(), data.data() + 1, size) == 0;
+    }
+
 }
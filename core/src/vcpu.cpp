@@ -7,10 +7,42 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <format>
+#include <bit>
 
 namespace nullvm::core {
 
-    auto VCpu::init(i32 fd, usize size) noexcept -> VmmResult<None> {
+    namespace {
+        /// Standard registers set flag.
+        constexpr u32 SYNC_REGS {KVM_SYNC_X86_REGS};
+
+        /// Special registers set flag.
+        constexpr u32 SYNC_SREGS {KVM_SYNC_X86_SREGS};
+
+        /// Register sets cached and synchronized through kvm_run.
+        constexpr u32 CACHED_REGS {SYNC_REGS | SYNC_SREGS};
+
+        /// @brief Allocate kvm_msrs buffer with flexible entries array.
+        ///
+        /// @param [in] count given number of MSR entries.
+        ///
+        /// @return Zeroed buffer with header's number of MSRs set.
+        auto make_msrs_buffer(usize count) -> std::vector<u64> {
+            const auto size = sizeof(kvm_msrs) + count * sizeof(kvm_msr_entry);
+            std::vector<u64> buffer((size + sizeof(u64) - 1) / sizeof(u64));
+
+            std::bit_cast<kvm_msrs*>(buffer.data())->nmsrs =
+                static_cast<u32>(count);
+
+            return buffer;
+        }
+    }
+
+    auto VCpu::init(i32 fd, usize size, u32 sync) noexcept
+    -> VmmResult<None> {
         if (fd < 0) {
             return std::unexpected(
                 "Invalid file descriptor: must be non-negative"
@@ -38,6 +70,13 @@ namespace nullvm::core {
         if(auto result = m_state.init(addr, size); !result)
             return std::unexpected(result.error());
 
+        m_sync   = sync & CACHED_REGS;
+        m_synced = 0;
+        m_cached = 0;
+
+        // Kernel stores requested register sets on every exit.
+        state()->kvm_valid_regs = m_sync;
+
         if (auto result = setup_registers(); !result)
             return std::unexpected(result.error());
 
@@ -57,50 +96,372 @@ namespace nullvm::core {
         if (auto result = set_sregs(m_sregs); !result)
             return std::unexpected(result.error());
 
-        m_regs.rflags = 0x2;
+        // Only reserved flag bit is set, other registers are zero.
+        kvm_regs regs {};
+        regs.rflags = 0x2;
 
-        if (auto result = set_regs(m_regs); !result)
+        if (auto result = set_regs(regs); !result)
             return std::unexpected(result.error());
 
         return None {};
     }
 
+    auto VCpu::sync_regs() const noexcept -> u32 {
+        return m_sync;
+    }
+
     auto VCpu::sregs() noexcept -> VmmResult<kvm_sregs> {
-        const auto ret = ioctl(m_fd.fd(), KVM_GET_SREGS, &m_sregs);
+        if ((m_cached & SYNC_SREGS) != 0)
+            return m_sregs;
 
-        if (ret == -1)
+        if ((m_synced & SYNC_SREGS) != 0)
+            m_sregs = state()->s.regs.sregs;
+        else if (ioctl(m_fd.fd(), KVM_GET_SREGS, &m_sregs) == -1)
             return std::unexpected("Error to get special registers state");
 
+        m_cached |= SYNC_SREGS;
         return m_sregs;
     }
 
     auto VCpu::set_sregs(const kvm_sregs& sregs) noexcept -> VmmResult<None> {
-        const auto ret = ioctl(m_fd.fd(), KVM_SET_SREGS, &sregs);
-
-        if (ret == -1)
+        // Synchronized registers are loaded by kernel on next entry.
+        if ((m_sync & SYNC_SREGS) != 0) {
+            state()->s.regs.sregs = sregs;
+            state()->kvm_dirty_regs |= SYNC_SREGS;
+        }
+        else if (ioctl(m_fd.fd(), KVM_SET_SREGS, &sregs) == -1) {
+            m_cached &= ~SYNC_SREGS;
             return std::unexpected("Error to set special registers state");
+        }
+
+        m_sregs = sregs;
+        m_cached |= SYNC_SREGS;
 
         return None {};
     }
 
     auto VCpu::regs() noexcept -> VmmResult<kvm_regs> {
-        const auto ret = ioctl(m_fd.fd(), KVM_GET_REGS, &m_regs);
+        if ((m_cached & SYNC_REGS) != 0)
+            return m_regs;
 
-        if (ret == -1)
+        if ((m_synced & SYNC_REGS) != 0)
+            m_regs = state()->s.regs.regs;
+        else if (ioctl(m_fd.fd(), KVM_GET_REGS, &m_regs) == -1)
             return std::unexpected("Error to get standard registers state");
 
+        m_cached |= SYNC_REGS;
         return m_regs;
     }
 
     auto VCpu::set_regs(const kvm_regs& regs) noexcept -> VmmResult<None> {
-        const auto ret = ioctl(m_fd.fd(), KVM_SET_REGS, &regs);
-
-        if (ret == -1)
+        // Synchronized registers are loaded by kernel on next entry.
+        if ((m_sync & SYNC_REGS) != 0) {
+            state()->s.regs.regs = regs;
+            state()->kvm_dirty_regs |= SYNC_REGS;
+        }
+        else if (ioctl(m_fd.fd(), KVM_SET_REGS, &regs) == -1) {
+            m_cached &= ~SYNC_REGS;
             return std::unexpected("Error to set standard registers state");
+        }
+
+        m_regs = regs;
+        m_cached |= SYNC_REGS;
+
+        return None {};
+    }
+
+    auto VCpu::flush() noexcept -> VmmResult<None> {
+        auto run = state();
+
+        // Special registers go first, standard ones do not depend on them.
+        if ((run->kvm_dirty_regs & SYNC_SREGS) != 0) {
+            if (ioctl(m_fd.fd(), KVM_SET_SREGS, &m_sregs) == -1)
+                return std::unexpected("Error to set special registers state");
+
+            run->kvm_dirty_regs &= ~SYNC_SREGS;
+        }
+
+        if ((run->kvm_dirty_regs & SYNC_REGS) != 0) {
+            if (ioctl(m_fd.fd(), KVM_SET_REGS, &m_regs) == -1)
+                return std::unexpected("Error to set standard registers state");
+
+            run->kvm_dirty_regs &= ~SYNC_REGS;
+        }
+
+        return None {};
+    }
+
+    auto VCpu::fpu() noexcept -> VmmResult<kvm_fpu> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_fpu fpu {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_FPU, &fpu) == -1)
+            return std::unexpected("Error to get FPU state");
+
+        return fpu;
+    }
+
+    auto VCpu::set_fpu(const kvm_fpu& fpu) noexcept -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_FPU, &fpu) == -1)
+            return std::unexpected("Error to set FPU state");
+
+        return None {};
+    }
+
+    auto VCpu::msrs(std::span<const u32> indices)
+    -> VmmResult<std::vector<kvm_msr_entry>> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        auto buffer = make_msrs_buffer(indices.size());
+        auto header = std::bit_cast<kvm_msrs*>(buffer.data());
+
+        for (usize i = 0; i < indices.size(); ++i)
+            header->entries[i].index = indices[i];
+
+        const auto ret = ioctl(m_fd.fd(), KVM_GET_MSRS, header);
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to get model specific registers: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        const auto count = static_cast<usize>(ret);
+        return std::vector(header->entries, header->entries + count);
+    }
+
+    auto VCpu::set_msrs(std::span<const kvm_msr_entry> msrs)
+    -> VmmResult<usize> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        auto buffer = make_msrs_buffer(msrs.size());
+        auto header = std::bit_cast<kvm_msrs*>(buffer.data());
+
+        std::ranges::copy(msrs, header->entries);
+
+        const auto ret = ioctl(m_fd.fd(), KVM_SET_MSRS, header);
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to set model specific registers: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return static_cast<usize>(ret);
+    }
+
+    auto VCpu::lapic() noexcept
+    -> VmmResult<std::optional<kvm_lapic_state>> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_lapic_state lapic {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_LAPIC, &lapic) == -1) {
+            // LAPIC is not emulated in kernel (no in-kernel irqchip).
+            if (errno == EINVAL)
+                return std::nullopt;
+
+            return std::unexpected("Error to get local APIC state");
+        }
+
+        return lapic;
+    }
+
+    auto VCpu::set_lapic(const kvm_lapic_state& lapic) noexcept
+    -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_LAPIC, &lapic) == -1)
+            return std::unexpected("Error to set local APIC state");
+
+        return None {};
+    }
+
+    auto VCpu::xsave() noexcept -> VmmResult<XSaveArea> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        XSaveArea xsave {};
+        const auto header = std::bit_cast<kvm_xsave*>(xsave.data());
+
+        if (ioctl(m_fd.fd(), KVM_GET_XSAVE, header) == -1) {
+            const auto err = std::format(
+                "Error to get XSAVE state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return xsave;
+    }
+
+    auto VCpu::set_xsave(const XSaveArea& xsave) noexcept -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        const auto header = std::bit_cast<const kvm_xsave*>(xsave.data());
+
+        if (ioctl(m_fd.fd(), KVM_SET_XSAVE, header) == -1) {
+            const auto err = std::format(
+                "Error to set XSAVE state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VCpu::xcrs() noexcept -> VmmResult<kvm_xcrs> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_xcrs xcrs {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_XCRS, &xcrs) == -1) {
+            const auto err = std::format(
+                "Error to get extended control registers: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return xcrs;
+    }
+
+    auto VCpu::set_xcrs(const kvm_xcrs& xcrs) noexcept -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_XCRS, &xcrs) == -1) {
+            const auto err = std::format(
+                "Error to set extended control registers: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VCpu::debugregs() noexcept -> VmmResult<kvm_debugregs> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_debugregs debugregs {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_DEBUGREGS, &debugregs) == -1) {
+            const auto err = std::format(
+                "Error to get debug registers: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return debugregs;
+    }
+
+    auto VCpu::set_debugregs(const kvm_debugregs& debugregs) noexcept
+    -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_DEBUGREGS, &debugregs) == -1) {
+            const auto err = std::format(
+                "Error to set debug registers: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
 
         return None {};
     }
 
+    auto VCpu::mp_state() noexcept -> VmmResult<kvm_mp_state> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_mp_state mp_state {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_MP_STATE, &mp_state) == -1) {
+            const auto err = std::format(
+                "Error to get multiprocessing state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return mp_state;
+    }
+
+    auto VCpu::set_mp_state(const kvm_mp_state& mp_state) noexcept
+    -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_MP_STATE, &mp_state) == -1) {
+            const auto err = std::format(
+                "Error to set multiprocessing state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VCpu::vcpu_events() noexcept -> VmmResult<kvm_vcpu_events> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        kvm_vcpu_events vcpu_events {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_VCPU_EVENTS, &vcpu_events) == -1) {
+            const auto err = std::format(
+                "Error to get pending events: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return vcpu_events;
+    }
+
+    auto VCpu::set_vcpu_events(const kvm_vcpu_events& vcpu_events) noexcept
+    -> VmmResult<None> {
+        if (auto result = flush(); !result)
+            return std::unexpected(result.error());
+
+        if (ioctl(m_fd.fd(), KVM_SET_VCPU_EVENTS, &vcpu_events) == -1) {
+            const auto err = std::format(
+                "Error to set pending events: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VCpu::stats_fd() const noexcept -> VmmResult<i32> {
+        const auto result = ioctl(m_fd.fd(), KVM_GET_STATS_FD, 0);
+
+        if (result == -1) {
+            const auto err = std::format(
+                "Error to get vCPU statistics descriptor: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return result;
+    }
+
     auto VCpu::state() noexcept -> kvm_run* {
         return std::bit_cast<kvm_run*>(m_state.addr());
     }
@@ -108,8 +469,20 @@ namespace nullvm::core {
     auto VCpu::run() noexcept -> VmmResult<None> {
         const auto ret = ioctl(m_fd.fd(), KVM_RUN, 0);
 
-        if (ret == -1)
+        // Guest may have changed any register, cached copies are stale.
+        m_cached = 0;
+        m_synced = ret == -1 && errno != EINTR ? 0 : m_sync;
+
+        if (ret == -1) {
+            // Run was interrupted by a signal or by an immediate exit
+            // request, let the caller decide whether to re-enter the guest.
+            if (errno == EINTR) {
+                state()->exit_reason = KVM_EXIT_INTR;
+                return None {};
+            }
+
             return std::unexpected("Error to run virtual machine");
+        }
 
         return None {};
     }
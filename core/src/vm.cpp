@@ -3,20 +3,166 @@
 
 /// Virtual machine related declarations.
 
+#include <nullvm/core/utils/file_mapping.hpp>
+#include <nullvm/core/snapshot.hpp>
+#include <nullvm/core/loader.hpp>
 #include <nullvm/core/vm.hpp>
 #include <nullvm/log.hpp>
 #include <linux/kvm.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <csignal>
+#include <utility>
+#include <thread>
+#include <chrono>
+#include <array>
 #include <bit>
 
 namespace nullvm::core {
 
-    auto VirtualMachine::init() noexcept -> VmmResult<None> {
-        if (auto result = m_kvm.init(); !result)
+    namespace {
+        /// @brief Get signal used to kick virtual CPU threads out of guest.
+        ///
+        /// @return Kick signal number.
+        auto kick_signal() noexcept -> i32 {
+            return SIGRTMIN;
+        }
+
+        /// Maximal size of migrated virtual machine state in bytes.
+        constexpr usize MAX_MIGRATION_STATE_SIZE {16 * 1024 * 1024};
+
+        /// @brief Install no-op handler for kick signal.
+        ///
+        /// Handler is required so that the signal interrupts KVM_RUN with
+        /// EINTR instead of terminating the process.
+        auto install_kick_handler() noexcept -> void {
+            static std::once_flag flag;
+
+            std::call_once(flag, [] {
+                struct sigaction action {};
+                action.sa_handler = [](i32) {};
+                sigemptyset(&action.sa_mask);
+                sigaction(kick_signal(), &action, nullptr);
+            });
+        }
+
+        /// @brief Pin current thread to host CPU core.
+        ///
+        /// @param [in] core given host CPU core index.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto pin_current_thread(usize core) noexcept -> VmmResult<None> {
+            if (core >= CPU_SETSIZE) {
+                const auto err = std::format("Invalid host CPU core: {}", core);
+                return std::unexpected(err);
+            }
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+
+            const auto self = pthread_self();
+
+            if (pthread_setaffinity_np(self, sizeof(set), &set) != 0) {
+                const auto err = std::format(
+                    "Error to pin virtual CPU thread to host CPU core {}", core
+                );
+                return std::unexpected(err);
+            }
+
+            return None {};
+        }
+
+        /// @brief Set virtual CPU to 32-bit flat protected mode.
+        ///
+        /// @param [in] vcpu given virtual CPU.
+        /// @param [in] entry given entry point address.
+        /// @param [in] boot_params given boot parameters address.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto enter_protected_mode(VCpu& vcpu, u64 entry, u64 boot_params)
+        noexcept -> VmmResult<None> {
+            auto sregs_result = vcpu.sregs();
+
+            if (!sregs_result)
+                return std::unexpected(sregs_result.error());
+
+            auto sregs = sregs_result.value();
+
+            // Boot protocol requires __BOOT_CS and __BOOT_DS selectors.
+            const kvm_segment code = {
+                .base = 0, .limit = 0xffffffff, .selector = 0x10,
+                .type = 0xb, .present = 1, .dpl = 0, .db = 1, .s = 1,
+                .l = 0, .g = 1, .avl = 0, .unusable = 0, .padding = 0,
+            };
+
+            auto data = code;
+            data.selector = 0x18;
+            data.type = 0x3;
+
+            sregs.cs = code;
+            sregs.ds = sregs.es = sregs.fs = sregs.gs = sregs.ss = data;
+
+            // Protection enabled, paging disabled.
+            sregs.cr0 = (sregs.cr0 | 0x1) & ~0x80000000ull;
+
+            if (auto result = vcpu.set_sregs(sregs); !result)
+                return result;
+
+            kvm_regs regs {};
+            regs.rflags = 0x2;
+            regs.rip = entry;
+            regs.rsi = boot_params;
+
+            return vcpu.set_regs(regs);
+        }
+    }
+
+    auto VirtualMachine::init(const VmConfig& config) noexcept
+    -> VmmResult<None> {
+        auto kvm = std::make_shared<Kvm>();
+
+        if (auto result = kvm->init(); !result)
             return result;
 
-        auto vmfd_result = m_kvm.create_vm();
+        return init(config, std::move(kvm));
+    }
+
+    auto VirtualMachine::init(
+        const VmConfig& config, std::shared_ptr<const Kvm> kvm
+    ) noexcept -> VmmResult<None> {
+        if (!kvm)
+            return std::unexpected("KVM handle is not set");
+
+        if (config.vcpus == 0)
+            return std::unexpected("Number of virtual CPUs cannot be 0");
+
+        if (config.affinity.size() > config.vcpus) {
+            return std::unexpected(
+                "Number of affinity entries exceeds number of virtual CPUs"
+            );
+        }
+
+        m_kvm = std::move(kvm);
+
+        auto max_vcpus = m_kvm->check_extension(KVM_CAP_MAX_VCPUS);
+
+        if (max_vcpus == 0)
+            max_vcpus = m_kvm->check_extension(KVM_CAP_NR_VCPUS);
+
+        if (config.vcpus > static_cast<usize>(max_vcpus)) {
+            const auto err = std::format(
+                "Number of virtual CPUs {} exceeds KVM limit {}",
+                config.vcpus, max_vcpus
+            );
+            return std::unexpected(err);
+        }
+
+        auto vmfd_result = m_kvm->create_vm();
 
         if (!vmfd_result)
             return std::unexpected(vmfd_result.error());
@@ -24,92 +170,690 @@ namespace nullvm::core {
         if (auto result = m_vmfd.init(vmfd_result.value()); !result)
             return std::unexpected(result.error());
 
-        auto vcpu_result = m_vmfd.create_vcpu();
+        auto slots = m_kvm->check_extension(KVM_CAP_NR_MEMSLOTS);
+
+        // Minimal number of memory slots supported by KVM.
+        if (slots <= 0)
+            slots = 32;
+
+        if (auto result = m_memory.init(m_vmfd, static_cast<u32>(slots));
+            !result)
+            return result;
+
+        if (auto result = m_memory.set_dirty_logging(config.dirty_logging);
+            !result)
+            return result;
+
+        // Local APICs are created along with virtual CPUs, so irqchip
+        // must exist before them.
+        if (config.irqchip) {
+            if (m_kvm->check_extension(KVM_CAP_IRQCHIP) <= 0)
+                return std::unexpected("In-kernel irqchip is not supported");
+
+            if (auto result = m_vmfd.create_irqchip(); !result)
+                return result;
+
+            if (m_kvm->check_extension(KVM_CAP_PIT2) <= 0)
+                return std::unexpected("In-kernel PIT is not supported");
+
+            if (auto result = m_vmfd.create_pit2(); !result)
+                return result;
+        }
+
+        auto size_result = m_kvm->vcpu_mmap_size();
+
+        if (!size_result)
+            return std::unexpected(size_result.error());
+
+        auto size = size_result.value();
+
+        // Register sets kernel can pass through kvm_run, 0 if unsupported.
+        const auto sync = std::max(
+            m_kvm->check_extension(KVM_CAP_SYNC_REGS), 0
+        );
+
+        m_vcpus.resize(config.vcpus);
 
-        if (!vcpu_result)
-            return std::unexpected(vcpu_result.error());
+        for (usize id = 0; id < config.vcpus; ++id) {
+            auto vcpu_result = m_vmfd.create_vcpu(static_cast<u32>(id));
 
-        const auto vcpufd = vcpu_result.value();
+            if (!vcpu_result)
+                return std::unexpected(vcpu_result.error());
 
-        auto result = m_kvm.vcpu_mmap_size();
+            const auto vcpufd = vcpu_result.value();
+
+            auto result = m_vcpus[id].init(
+                vcpufd, size, static_cast<u32>(sync)
+            );
+
+            if (!result)
+                return std::unexpected(result.error());
+        }
+
+        m_exit_stats = std::make_unique<ExitStats[]>(config.vcpus);
+
+        // Coalesced ring is located inside the virtual CPU mapping at page
+        // offset reported by the capability.
+        const auto ring_offset = m_kvm->check_extension(KVM_CAP_COALESCED_MMIO);
+
+        if (ring_offset > 0) {
+            const auto page_size = static_cast<usize>(sysconf(_SC_PAGESIZE));
+            auto base = std::bit_cast<u8*>(m_vcpus.front().state());
+
+            m_coalesced_ring = std::bit_cast<kvm_coalesced_mmio_ring*>(
+                base + static_cast<usize>(ring_offset) * page_size
+            );
+            m_coalesced_max = static_cast<u32>(
+                (page_size - sizeof(kvm_coalesced_mmio_ring)) /
+                sizeof(kvm_coalesced_mmio)
+            );
+        }
+
+        if (auto result = setup_exit_handlers(); !result)
+            return result;
+
+        m_serial = std::make_shared<devices::Serial>();
+
+        if (auto result = m_serial->init(config.console_fd); !result)
+            return result;
+
+        auto result = m_pio_bus.insert(
+            devices::SERIAL_COM1_PORT, devices::SERIAL_PORTS_COUNT, m_serial
+        );
 
         if (!result)
+            return result;
+
+        // Serial transmitter is write-only, batch it instead of exiting on
+        // each byte.
+        if (m_coalesced_ring && m_kvm->check_extension(KVM_CAP_COALESCED_PIO)) {
+            const auto port = devices::SERIAL_COM1_PORT;
+
+            if (auto result = register_coalesced_io(port, 1, true); !result)
+                return result;
+        }
+
+        m_config = config;
+        m_threads.assign(config.vcpus, std::nullopt);
+        install_kick_handler();
+
+        return None {};
+    }
+
+    auto VirtualMachine::vcpu() & noexcept -> VCpu& {
+        return m_vcpus.front();
+    }
+
+    auto VirtualMachine::vcpu(usize id) & noexcept -> VCpu& {
+        return m_vcpus[id];
+    }
+
+    auto VirtualMachine::vcpus_count() const noexcept -> usize {
+        return m_vcpus.size();
+    }
+
+    auto VirtualMachine::exit_stats(usize id) const noexcept
+    -> ExitStatsSnapshot {
+        return m_exit_stats[id].snapshot();
+    }
+
+    auto VirtualMachine::exit_stats() const noexcept -> ExitStatsSnapshot {
+        ExitStatsSnapshot total;
+
+        for (usize id = 0; id < m_vcpus.size(); ++id)
+            total.merge(m_exit_stats[id].snapshot());
+
+        return total;
+    }
+
+    auto VirtualMachine::kvm_stats() const -> VmmResult<KvmStats> {
+        auto fd = m_vmfd.stats_fd();
+
+        if (!fd)
+            return std::unexpected(fd.error());
+
+        KvmStats stats;
+
+        if (auto result = stats.init(fd.value()); !result)
             return std::unexpected(result.error());
 
-        auto size = result.value();
+        return stats;
+    }
+
+    auto VirtualMachine::kvm_stats(usize id) const -> VmmResult<KvmStats> {
+        auto fd = m_vcpus[id].stats_fd();
+
+        if (!fd)
+            return std::unexpected(fd.error());
+
+        KvmStats stats;
 
-        if (auto result = m_vcpu.init(vcpufd, size); !result)
+        if (auto result = stats.init(fd.value()); !result)
             return std::unexpected(result.error());
 
+        return stats;
+    }
+
+    auto VirtualMachine::snapshot(
+        const std::string& state_path, const std::string& memory_path,
+        SnapshotType type
+    ) -> VmmResult<None> {
+        const auto diff = type == SnapshotType::Diff;
+
+        if (diff && !m_memory.dirty_logging())
+            return std::unexpected("Diff snapshot requires dirty logging");
+
+        auto state = save_state();
+
+        if (!state)
+            return std::unexpected(state.error());
+
+        // Files are created before dirty log is fetched and cleared.
+        auto state_file = snapshot::create_file(state_path);
+
+        if (!state_file)
+            return std::unexpected(state_file.error());
+
+        auto memory_file = snapshot::create_file(memory_path);
+
+        if (!memory_file)
+            return std::unexpected(memory_file.error());
+
+        // Dirty log is fetched even for full snapshot, so that next diff
+        // is relative to this snapshot.
+        std::vector<DirtyBitmap> dirty;
+
+        if (m_memory.dirty_logging()) {
+            auto result = m_memory.dirty_log();
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            dirty = std::move(result.value());
+        }
+
+        // Failed snapshot must not lose pages for the next diff one.
+        const auto fail = [this, &dirty](const VmmError& error) {
+            m_memory.restore_dirty_log(dirty);
+            return std::unexpected(error);
+        };
+
+        auto regions = diff ?
+            snapshot::write_memory_diff(memory_file->fd(), m_memory, dirty) :
+            snapshot::write_memory(memory_file->fd(), m_memory);
+
+        if (!regions)
+            return fail(regions.error());
+
+        state->regions = std::move(regions.value());
+
+        if (auto result = snapshot::write_state(state_file->fd(), *state);
+            !result)
+            return fail(result.error());
+
+        log::info(
+            "VM snapshot saved to '{}' (memory '{}')", state_path, memory_path
+        );
+
         return None {};
     }
 
-    auto VirtualMachine::vcpu() & noexcept -> VCpu& {
-        return m_vcpu;
+    auto VirtualMachine::restore(
+        const std::string& state_path, const std::string& memory_path
+    ) -> VmmResult<None> {
+        if (m_memory.regions_count() != 0)
+            return std::unexpected("Cannot restore VM with memory regions");
+
+        auto state = snapshot::read_state(state_path);
+
+        if (!state)
+            return std::unexpected(state.error());
+
+        if (state->vcpus.size() != m_vcpus.size()) {
+            const auto err = std::format(
+                "Snapshot has {} virtual CPUs, but VM has {}",
+                state->vcpus.size(), m_vcpus.size()
+            );
+            return std::unexpected(err);
+        }
+
+        auto result = snapshot::map_memory(
+            memory_path, state->regions, m_memory
+        );
+
+        if (!result)
+            return result;
+
+        return restore_state(state.value());
     }
 
-    auto VirtualMachine::set_vm_memory(usize size) noexcept -> VmmResult<None> {
-        if (size == 0) {
-            return std::unexpected(
-                "Error to set VM's memory: mapping memory size is zero"
+    auto VirtualMachine::migrate_to(
+        i32 fd, const migration::MigrationConfig& config
+    ) -> VmmResult<migration::MigrationStats> {
+        using migration::MessageType;
+
+        migration::Channel channel;
+
+        if (auto result = channel.init(fd); !result)
+            return std::unexpected(result.error());
+
+        const auto logging = m_memory.dirty_logging();
+
+        if (auto result = m_memory.set_dirty_logging(true); !result)
+            return std::unexpected(result.error());
+
+        // Dirty logging is restored to its previous mode on any return.
+        const auto restore_logging = [this, logging](auto result) {
+            if (!logging)
+                static_cast<void>(m_memory.set_dirty_logging(false));
+
+            return result;
+        };
+
+        using Result = VmmResult<migration::MigrationStats>;
+
+        // Pages written before this point are covered by the first round.
+        if (auto result = m_memory.dirty_log(); !result)
+            return restore_logging(Result(std::unexpected(result.error())));
+
+        std::vector<snapshot::RegionState> layout;
+
+        for (const auto& range : m_memory.ranges()) {
+            layout.push_back({
+                .guest_addr = range.guest_addr,
+                .size       = range.size,
+                .offset     = 0,
+                .flags      = range.flags,
+                .reserved   = 0,
+            });
+        }
+
+        const auto layout_bytes = std::as_bytes(std::span(layout));
+        auto result = channel.send(
+            MessageType::Layout, 0,
+            std::span(
+                std::bit_cast<const u8*>(layout_bytes.data()),
+                layout_bytes.size()
+            )
+        );
+
+        if (!result)
+            return restore_logging(Result(std::unexpected(result.error())));
+
+        migration::MigrationStats stats;
+
+        auto sent = migration::send_memory(channel, m_memory);
+
+        if (!sent)
+            return restore_logging(Result(std::unexpected(sent.error())));
+
+        stats.pages += sent.value();
+        stats.rounds = 1;
+
+        // Pre-copy rounds: resend pages guest dirtied meanwhile until the
+        // dirty set is small enough to be sent with guest paused.
+        std::vector<DirtyBitmap> pending;
+
+        while (true) {
+            auto dirty = m_memory.dirty_log();
+
+            if (!dirty)
+                return restore_logging(Result(std::unexpected(dirty.error())));
+
+            const auto count = migration::count_dirty(dirty.value());
+            log::debug(
+                "Migration round {}: {} dirty pages", stats.rounds, count
             );
+
+            if (count <= config.max_dirty_pages ||
+                stats.rounds >= config.max_rounds) {
+                pending = std::move(dirty.value());
+                break;
+            }
+
+            sent = migration::send_dirty(channel, m_memory, dirty.value());
+
+            if (!sent)
+                return restore_logging(Result(std::unexpected(sent.error())));
+
+            stats.pages += sent.value();
+            ++stats.rounds;
+        }
+
+        // Stop-and-copy.
+        const auto paused = std::chrono::steady_clock::now();
+        pause();
+
+        auto dirty = m_memory.dirty_log();
+
+        if (!dirty)
+            return restore_logging(Result(std::unexpected(dirty.error())));
+
+        for (usize i = 0; i < pending.size(); ++i) {
+            for (usize word = 0; word < pending[i].bits.size(); ++word)
+                pending[i].bits[word] |= dirty.value()[i].bits[word];
         }
 
-        // Mapping protection flags.
-        auto prot = PROT_READ | PROT_WRITE;
+        sent = migration::send_dirty(channel, m_memory, pending);
+
+        if (!sent)
+            return restore_logging(Result(std::unexpected(sent.error())));
+
+        stats.pages += sent.value();
+        stats.downtime_pages = sent.value();
 
-        // MAP_SHARED flag ensures that both the host and guest can see the
-        // same changes to the memory.
-        // MAP_ANONYMOUS flag indicates that the mapping is not
-        // backed by any file.
-        auto flags = MAP_SHARED | MAP_ANONYMOUS;
+        auto state = save_state();
 
-        auto addr = mmap(nullptr, size, prot, flags, -1, 0);
+        if (!state)
+            return restore_logging(Result(std::unexpected(state.error())));
+
+        const auto state_bytes = snapshot::serialize_state(state.value());
+        result = channel.send(MessageType::State, 0, state_bytes);
+
+        if (!result)
+            return restore_logging(Result(std::unexpected(result.error())));
+
+        stats.downtime = std::chrono::steady_clock::now() - paused;
+
+        log::info(
+            "VM migrated: {} rounds, {} pages, {} pages in {} us downtime",
+            stats.rounds, stats.pages, stats.downtime_pages,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                stats.downtime
+            ).count()
+        );
+
+        return restore_logging(Result(stats));
+    }
 
-        if (auto result = m_memory.init(addr, size); !result)
+    auto VirtualMachine::migrate_from(i32 fd) -> VmmResult<None> {
+        using migration::MessageType;
+
+        if (m_memory.regions_count() != 0)
+            return std::unexpected("Cannot migrate to VM with memory regions");
+
+        migration::Channel channel;
+
+        if (auto result = channel.init(fd); !result)
+            return result;
+
+        auto header = channel.recv_header();
+
+        if (!header)
+            return std::unexpected(header.error());
+
+        const auto entry_size = sizeof(snapshot::RegionState);
+
+        if (header->type != MessageType::Layout ||
+            header->size % entry_size != 0 ||
+            header->size / entry_size > static_cast<u64>(
+                m_kvm->check_extension(KVM_CAP_NR_MEMSLOTS)
+            )) {
+            return std::unexpected("Invalid migration memory layout");
+        }
+
+        std::vector<snapshot::RegionState> layout(header->size / entry_size);
+        const auto layout_bytes = std::as_writable_bytes(std::span(layout));
+
+        auto result = channel.recv_payload(std::span(
+            std::bit_cast<u8*>(layout_bytes.data()), layout_bytes.size()
+        ));
+
+        if (!result)
             return result;
 
+        for (const auto& region : layout) {
+            result = set_vm_memory(
+                region.guest_addr, region.size, region.flags
+            );
+
+            if (!result)
+                return result;
+        }
+
+        // Pages are received straight into guest memory.
+        while (true) {
+            header = channel.recv_header();
+
+            if (!header)
+                return std::unexpected(header.error());
+
+            if (header->type != MessageType::Pages)
+                break;
+
+            auto host = m_memory.translate(header->addr, header->size);
+
+            if (!host)
+                return std::unexpected(host.error());
+
+            result = channel.recv_payload(
+                std::span(host.value(), header->size)
+            );
+
+            if (!result)
+                return result;
+        }
+
+        if (header->type != MessageType::State ||
+            header->size > MAX_MIGRATION_STATE_SIZE)
+            return std::unexpected("Invalid migration state");
+
+        std::vector<u8> state_bytes(header->size);
+
+        if (auto result = channel.recv_payload(state_bytes); !result)
+            return result;
+
+        auto state = snapshot::deserialize_state(state_bytes);
+
+        if (!state)
+            return std::unexpected(state.error());
+
+        if (state->vcpus.size() != m_vcpus.size()) {
+            const auto err = std::format(
+                "Migrated VM has {} virtual CPUs, but VM has {}",
+                state->vcpus.size(), m_vcpus.size()
+            );
+            return std::unexpected(err);
+        }
+
+        if (auto result = restore_state(state.value()); !result)
+            return result;
+
+        log::info("VM received with {} memory regions", layout.size());
+
         return None {};
     }
 
-    auto VirtualMachine::set_mem_region(u64 addr, usize size) noexcept
-    -> VmmResult<None> {
-        if (auto result = set_vm_memory(size); !result)
-            return std::unexpected(result.error());
+    auto VirtualMachine::save_state() -> VmmResult<snapshot::VmState> {
+        auto msr_indices = m_kvm->msr_index_list();
 
-        kvm_userspace_memory_region mem_region = {
-            // Memory slot number.
-            .slot = 0,
-            // Flags that specify attributes of the memory region.
-            .flags = 0,
-            // Starting physical address in the guest's address space where
-            // this memory region is mapped.
-            .guest_phys_addr = addr,
-            // Size of the memory region in bytes.
-            .memory_size = size,
-            // Starting address of the memory allocated in userspace that
-            // will be mapped to the guest's physical address.
-            .userspace_addr = std::bit_cast<u64>(m_memory.addr()),
+        if (!msr_indices)
+            return std::unexpected(msr_indices.error());
+
+        snapshot::VmState state;
+
+        for (auto& vcpu : m_vcpus) {
+            auto result = snapshot::save_vcpu(vcpu, msr_indices.value());
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            state.vcpus.push_back(std::move(result.value()));
+        }
+
+        auto clock = m_vmfd.clock();
+
+        if (!clock)
+            return std::unexpected(clock.error());
+
+        state.clock = clock.value();
+
+        if (m_config.irqchip) {
+            auto irqchip = save_irqchip();
+
+            if (!irqchip)
+                return std::unexpected(irqchip.error());
+
+            state.irqchip = irqchip.value();
+        }
+
+        return state;
+    }
+
+    auto VirtualMachine::save_irqchip() const
+    -> VmmResult<snapshot::IrqchipState> {
+        snapshot::IrqchipState state;
+
+        const std::array chips {
+            std::pair {KVM_IRQCHIP_PIC_MASTER, &state.pic_master},
+            std::pair {KVM_IRQCHIP_PIC_SLAVE, &state.pic_slave},
+            std::pair {KVM_IRQCHIP_IOAPIC, &state.ioapic},
         };
 
-        // Set virtual CPU registers.
-        auto result = m_vcpu.regs();
+        for (const auto& [id, chip] : chips) {
+            auto result = m_vmfd.irqchip(id);
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            *chip = result.value();
+        }
+
+        auto pit = m_vmfd.pit2();
+
+        if (!pit)
+            return std::unexpected(pit.error());
+
+        state.pit = pit.value();
+
+        return state;
+    }
+
+    auto VirtualMachine::restore_state(const snapshot::VmState& state)
+    -> VmmResult<None> {
+        if (state.irqchip && !m_config.irqchip) {
+            return std::unexpected(
+                "Saved VM has in-kernel irqchip, but VM has not"
+            );
+        }
+
+        // VM-wide state goes first, local APICs restored with virtual
+        // CPUs then see interrupt controllers they are wired to.
+        if (state.irqchip) {
+            const auto& irqchip = state.irqchip.value();
+
+            for (const auto& chip :
+                 {irqchip.pic_master, irqchip.pic_slave, irqchip.ioapic}) {
+                if (auto result = m_vmfd.set_irqchip(chip); !result)
+                    return result;
+            }
+
+            if (auto result = m_vmfd.set_pit2(irqchip.pit); !result)
+                return result;
+        }
+
+        // Guest clock continues from saved value, time between save and
+        // restore is not visible to guest (KVM_CLOCK_REALTIME is not set).
+        auto clock = state.clock;
+        clock.flags = 0;
+
+        if (auto result = m_vmfd.set_clock(clock); !result)
+            return result;
+
+        for (usize id = 0; id < m_vcpus.size(); ++id) {
+            auto result = snapshot::restore_vcpu(m_vcpus[id], state.vcpus[id]);
+
+            if (!result)
+                return result;
+        }
+
+        return None {};
+    }
+
+    auto VirtualMachine::pio_bus() & noexcept -> devices::Bus& {
+        return m_pio_bus;
+    }
+
+    auto VirtualMachine::mmio_bus() & noexcept -> devices::Bus& {
+        return m_mmio_bus;
+    }
+
+    auto VirtualMachine::set_exit_handler(u32 reason, ExitHandler handler)
+    noexcept -> VmmResult<None> {
+        return m_dispatcher.set_handler(reason, std::move(handler));
+    }
+
+    auto VirtualMachine::set_vm_memory(u64 addr, usize size, u32 flags)
+    noexcept -> VmmResult<None> {
+        if (size == 0) {
+            return std::unexpected(
+                "Error to set VM's memory: mapping memory size is zero"
+            );
+        }
+
+        auto result = map_guest_memory(
+            size, m_config.memory_backing, m_config.shared_memory
+        );
 
         if (!result)
             return std::unexpected(result.error());
 
-        auto regs = result.value();
-        regs.rip = addr;
+        const auto backing = result->backing;
+        auto slot = m_memory.add_region(
+            addr, size, std::move(result->memory), flags,
+            std::move(result->fd)
+        );
 
-        if (auto result = m_vcpu.set_regs(regs); !result)
-            return std::unexpected(result.error());
+        if (!slot)
+            return std::unexpected(slot.error());
+
+        m_memory_backing = backing;
+
+        log::info(
+            "VM's memory region {:#x} (slot {}) backing: {}",
+            addr, slot.value(), to_string(backing)
+        );
+
+        return None {};
+    }
 
-        if (auto result = m_vmfd.set_user_mem_region(mem_region); !result)
+    auto VirtualMachine::set_mem_region(u64 addr, usize size) noexcept
+    -> VmmResult<None> {
+        if (auto result = set_vm_memory(addr, size); !result)
             return std::unexpected(result.error());
 
+        // Set virtual CPUs registers.
+        for (auto& vcpu : m_vcpus) {
+            auto result = vcpu.regs();
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            auto regs = result.value();
+            regs.rip = addr;
+
+            if (auto result = vcpu.set_regs(regs); !result)
+                return std::unexpected(result.error());
+        }
+
+        m_load_addr = addr;
+
         return None {};
     }
 
+    auto VirtualMachine::add_mem_region(u64 addr, usize size) noexcept
+    -> VmmResult<None> {
+        return set_vm_memory(addr, size);
+    }
+
+    auto VirtualMachine::memory() & noexcept -> GuestMemory& {
+        return m_memory;
+    }
+
+    auto VirtualMachine::memory_backing() const noexcept -> MemoryBacking {
+        return m_memory_backing;
+    }
+
     auto VirtualMachine::load_raw(const std::vector<u8>& raw) noexcept
     -> VmmResult<None> {
         const auto size = raw.size();
@@ -117,62 +861,420 @@ namespace nullvm::core {
         if (size == 0)
             return std::unexpected("Raw binary size is zero");
 
-        auto addr = static_cast<u8*>(m_memory.addr());
-        auto data = raw.data();
-        std::copy(data, data + size, addr);
+        return m_memory.write(m_load_addr, raw);
+    }
+
+    auto VirtualMachine::load_image(
+        const std::string& path, u64 addr, ImageMapping mapping
+    ) noexcept -> VmmResult<None> {
+        const auto page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+
+        if (addr % page_size != 0) {
+            const auto err = std::format(
+                "Image address {:#x} is not page-aligned", addr
+            );
+            return std::unexpected(err);
+        }
+
+        const auto readonly = mapping == ImageMapping::ReadOnly;
+
+        if (readonly && !m_kvm->check_extension(KVM_CAP_READONLY_MEM))
+            return std::unexpected("Read-only memory slots are not supported");
+
+        // Read-only applies to guest only: host mapping stays writable
+        // copy-on-write, so loaders may still patch image through it.
+        auto file = utils::map_file(path, true);
+
+        if (!file)
+            return std::unexpected(file.error());
+
+        const auto size = file->size();
+        const auto flags = readonly ? static_cast<u32>(KVM_MEM_READONLY) : 0;
+
+        auto slot = m_memory.add_region(
+            addr, size, std::move(file.value()), flags
+        );
+
+        if (!slot)
+            return std::unexpected(slot.error());
+
+        log::info(
+            "Image '{}' mapped at {:#x} (slot {}, size {:#x})",
+            path, addr, slot.value(), size
+        );
+
+        return None {};
+    }
+
+    auto VirtualMachine::load_elf(const std::string& path) noexcept
+    -> VmmResult<None> {
+        auto image = utils::map_file(path, false);
+
+        if (!image)
+            return std::unexpected(image.error());
+
+        const auto bytes = std::span(
+            static_cast<const u8*>(image->addr()), image->size()
+        );
+
+        auto entry = loader::load_elf(m_memory, bytes);
+
+        if (!entry)
+            return std::unexpected(entry.error());
+
+        auto regs = vcpu().regs();
+
+        if (!regs)
+            return std::unexpected(regs.error());
+
+        regs->rip = entry->entry;
+
+        if (auto result = vcpu().set_regs(regs.value()); !result)
+            return result;
+
+        log::info("ELF image '{}' loaded, entry {:#x}", path, entry->entry);
 
         return None {};
     }
 
+    auto VirtualMachine::load_bzimage(
+        const std::string& path, std::string_view cmdline,
+        const std::string& initrd
+    ) noexcept -> VmmResult<None> {
+        auto image = utils::map_file(path, false);
+
+        if (!image)
+            return std::unexpected(image.error());
+
+        MMapWrapper ramdisk;
+
+        if (!initrd.empty()) {
+            auto result = utils::map_file(initrd, false);
+
+            if (!result)
+                return std::unexpected(result.error());
+
+            ramdisk = std::move(result.value());
+        }
+
+        const auto bytes = std::span(
+            static_cast<const u8*>(image->addr()), image->size()
+        );
+        const auto ramdisk_bytes = std::span(
+            static_cast<const u8*>(ramdisk.addr()), ramdisk.size()
+        );
+
+        auto entry = loader::load_bzimage(
+            m_memory, bytes, cmdline, ramdisk_bytes
+        );
+
+        if (!entry)
+            return std::unexpected(entry.error());
+
+        auto result = enter_protected_mode(
+            vcpu(), entry->entry, entry->boot_params
+        );
+
+        if (!result)
+            return result;
+
+        log::info("bzImage '{}' loaded, cmdline: '{}'", path, cmdline);
+
+        return None {};
+    }
+
+    auto VirtualMachine::register_coalesced_io(u64 addr, u32 size, bool pio)
+    noexcept -> VmmResult<None> {
+        if (!m_coalesced_ring)
+            return std::unexpected("Coalesced MMIO is not supported");
+
+        return m_vmfd.register_coalesced_mmio(addr, size, pio);
+    }
+
+    auto VirtualMachine::register_ioeventfd(
+        const utils::EventFd& eventfd, u64 addr, u32 len, bool pio,
+        std::optional<u64> datamatch
+    ) noexcept -> VmmResult<None> {
+        return m_vmfd.register_ioeventfd(
+            eventfd.fd(), addr, len, pio, datamatch
+        );
+    }
+
+    auto VirtualMachine::register_irqfd(
+        const utils::EventFd& eventfd, u32 gsi
+    ) noexcept -> VmmResult<None> {
+        if (!m_config.irqchip)
+            return std::unexpected("In-kernel irqchip is not enabled");
+
+        return m_vmfd.register_irqfd(eventfd.fd(), gsi);
+    }
+
+    auto VirtualMachine::unregister_irqfd(
+        const utils::EventFd& eventfd, u32 gsi
+    ) noexcept -> VmmResult<None> {
+        return m_vmfd.unregister_irqfd(eventfd.fd(), gsi);
+    }
+
     auto VirtualMachine::run() noexcept -> VmmResult<None> {
-        auto state = m_vcpu.state();
+        const auto count = m_vcpus.size();
 
-        while (true) {
-            if (auto result = m_vcpu.run(); !result)
+        if (count == 0)
+            return std::unexpected("Virtual machine is not initialized");
+
+        {
+            std::lock_guard lock(m_threads_lock);
+            m_active = count;
+        }
+
+        std::vector<VmmResult<None>> results(count, None {});
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(count);
+
+            for (usize id = 0; id < count; ++id) {
+                threads.emplace_back([this, id, &results] {
+                    {
+                        std::lock_guard lock(m_threads_lock);
+                        m_threads[id] = pthread_self();
+                    }
+
+                    results[id] = run_vcpu(id);
+
+                    // Error on one virtual CPU stops the whole machine.
+                    if (!results[id])
+                        stop();
+
+                    std::lock_guard lock(m_threads_lock);
+                    m_threads[id] = std::nullopt;
+
+                    if (--m_active == 0)
+                        m_threads_done.notify_all();
+                });
+            }
+        }
+
+        // Stop request is consumed on exit, not on entry, so that one that
+        // arrived before this call is not lost.
+        clear_stop();
+
+        if (m_serial)
+            m_serial->flush();
+
+        for (auto& result : results) {
+            if (!result)
+                return result;
+        }
+
+        return None {};
+    }
+
+    auto VirtualMachine::stop() noexcept -> void {
+        m_stop.store(true);
+        kick_vcpus();
+    }
+
+    auto VirtualMachine::pause() noexcept -> void {
+        stop();
+
+        std::unique_lock lock(m_threads_lock);
+        m_threads_done.wait(lock, [this] { return m_active == 0; });
+
+        // Paused machine is resumed by next run() even if it was not
+        // running when paused.
+        clear_stop();
+    }
+
+    auto VirtualMachine::clear_stop() noexcept -> void {
+        m_stop.store(false);
+
+        for (auto& vcpu : m_vcpus)
+            std::atomic_ref(vcpu.state()->immediate_exit).store(0);
+    }
+
+    auto VirtualMachine::kick_vcpus() noexcept -> void {
+        // Immediate exit flag covers virtual CPUs that are about to enter
+        // the guest, signal covers those that are already running it.
+        for (auto& vcpu : m_vcpus)
+            std::atomic_ref(vcpu.state()->immediate_exit).store(1);
+
+        std::lock_guard lock(m_threads_lock);
+
+        for (const auto& thread : m_threads) {
+            if (thread)
+                pthread_kill(*thread, kick_signal());
+        }
+    }
+
+    auto VirtualMachine::run_vcpu(usize id) noexcept -> VmmResult<None> {
+        const auto& affinity = m_config.affinity;
+
+        if (id < affinity.size() && affinity[id]) {
+            if (auto result = pin_current_thread(*affinity[id]); !result)
+                return result;
+        }
+
+        auto& vcpu = m_vcpus[id];
+        auto& stats = m_exit_stats[id];
+        auto state = vcpu.state();
+
+        using Clock = std::chrono::steady_clock;
+
+        // Handling of one exit ends where next KVM_RUN begins, so only two
+        // clock reads are done per exit.
+        auto entered = Clock::now();
+
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (auto result = vcpu.run(); !result)
                 return std::unexpected(result.error());
 
-            log::debug("Exit reason: {}", state->exit_reason);
-            switch (state->exit_reason) {
+            const auto exited = Clock::now();
+            const auto reason = state->exit_reason;
 
-                case KVM_EXIT_HLT:
-                    log::debug("KVM_EXIT_HLT");
-                    return None {};
+            // Writes batched before this exit precede it in guest order.
+            if (auto result = drain_coalesced_io(); !result)
+                return result;
 
-                case KVM_EXIT_IO:
-                    log::debug("KVM_EXIT_IO");
+            log::debug("vCPU {} exit reason: {}", id, reason);
+            auto result = m_dispatcher.dispatch(*state);
 
-                    if (auto result = handle_exit_io(state); !result)
-                        return std::unexpected(result.error());
+            if (!result)
+                return std::unexpected(result.error());
 
-                    break;
+            const auto handled = Clock::now();
+            stats.record(reason, exited - entered, handled - exited);
+            entered = handled;
 
-                default:
-                    log::debug("Unhandled exit reason: {}", state->exit_reason);
-                    return std::unexpected("Unhandled exit reason");
+            if (result.value() == ExitAction::Halt)
+                return None {};
+        }
+
+        return None {};
+    }
+
+    auto VirtualMachine::setup_exit_handlers() noexcept -> VmmResult<None> {
+        auto result = m_dispatcher.set_handler(
+            KVM_EXIT_HLT,
+            [](kvm_run&) -> VmmResult<ExitAction> {
+                log::debug("KVM_EXIT_HLT");
+                return ExitAction::Halt;
             }
+        );
+
+        if (!result)
+            return result;
+
+        result = m_dispatcher.set_handler(
+            KVM_EXIT_IO,
+            [this](kvm_run& state) { return handle_exit_io(state); }
+        );
+
+        if (!result)
+            return result;
+
+        result = m_dispatcher.set_handler(
+            KVM_EXIT_MMIO,
+            [this](kvm_run& state) { return handle_exit_mmio(state); }
+        );
+
+        if (!result)
+            return result;
+
+        // Stop flag is checked by the run loop condition.
+        return m_dispatcher.set_handler(
+            KVM_EXIT_INTR,
+            [](kvm_run&) -> VmmResult<ExitAction> {
+                return ExitAction::Continue;
+            }
+        );
+    }
+
+    auto VirtualMachine::drain_coalesced_io() noexcept -> VmmResult<None> {
+        if (!m_coalesced_ring)
+            return None {};
+
+        auto ring = m_coalesced_ring;
+        auto first = std::atomic_ref(ring->first);
+        auto last = std::atomic_ref(ring->last);
+
+        if (first.load(std::memory_order_relaxed) ==
+            last.load(std::memory_order_acquire))
+            return None {};
+
+        std::lock_guard lock(m_coalesced_lock);
+
+        while (true) {
+            const auto index = first.load(std::memory_order_relaxed);
+
+            if (index == last.load(std::memory_order_acquire))
+                break;
+
+            const auto& entry = ring->coalesced_mmio[index];
+
+            const auto& bus = entry.pio ? m_pio_bus : m_mmio_bus;
+            const auto data = std::span(entry.data, entry.len);
+
+            if (auto result = bus.write(entry.phys_addr, data, entry.len);
+                !result)
+                return result;
+
+            // Release entry back to the kernel.
+            first.store(
+                (index + 1) % m_coalesced_max, std::memory_order_release
+            );
         }
 
+        return None {};
     }
 
-    auto VirtualMachine::handle_exit_io(const kvm_run *state) noexcept
-    -> VmmResult<None> {
-        auto io = state->io;
+    auto VirtualMachine::handle_exit_io(kvm_run& state) noexcept
+    -> VmmResult<ExitAction> {
+        const auto& io = state.io;
+
+        const auto data = std::span(
+            std::bit_cast<u8*>(&state) + io.data_offset,
+            static_cast<usize>(io.size) * io.count
+        );
+
+        VmmResult<None> result = None {};
 
         if (io.direction == KVM_EXIT_IO_IN) {
             log::debug("PORT IN ({:#x})", io.port);
+            result = m_pio_bus.read(io.port, data, io.size);
         }
-        else if (state->io.direction == KVM_EXIT_IO_OUT) {
+        else if (io.direction == KVM_EXIT_IO_OUT) {
             log::debug("PORT OUT ({:#x})", io.port);
+            result = m_pio_bus.write(io.port, data, io.size);
+        }
 
-            if (io.port == 0x3f8 && io.size == 1 && io.count == 1) {
-                const auto byte = *(
-                    std::bit_cast<const u8*>(state) + io.data_offset
-                );
+        if (!result)
+            return std::unexpected(result.error());
 
-                std::putchar(byte);
-            }
+        return ExitAction::Continue;
+    }
+
+    auto VirtualMachine::handle_exit_mmio(kvm_run& state) noexcept
+    -> VmmResult<ExitAction> {
+        auto& mmio = state.mmio;
+
+        if (mmio.len > sizeof(mmio.data))
+            return std::unexpected("Invalid MMIO access size");
+
+        const auto data = std::span(mmio.data, mmio.len);
+        VmmResult<None> result = None {};
+
+        if (mmio.is_write) {
+            log::debug("MMIO WRITE ({:#x})", mmio.phys_addr);
+            result = m_mmio_bus.write(mmio.phys_addr, data, mmio.len);
+        }
+        else {
+            log::debug("MMIO READ ({:#x})", mmio.phys_addr);
+            result = m_mmio_bus.read(mmio.phys_addr, data, mmio.len);
         }
 
-        return None {};
+        if (!result)
+            return std::unexpected(result.error());
+
+        return ExitAction::Continue;
     }
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 #include <nullvm/core/vmfd.hpp>
 #include <sys/ioctl.h>
+#include <cstring>
+#include <format>
+#include <cerrno>
 
 namespace nullvm::core {
 
@@ -40,8 +43,266 @@ namespace nullvm::core {
         return None {};
     }
 
-    auto VmFd::create_vcpu() const -> VmmResult<i32> {
-        const auto result = ioctl(m_fd.fd(), KVM_CREATE_VCPU, 0);
+    auto VmFd::get_dirty_log(u32 slot, std::span<u64> bitmap) const noexcept
+    -> VmmResult<None> {
+        kvm_dirty_log log {};
+        log.slot = slot;
+        log.dirty_bitmap = bitmap.data();
+
+        if (ioctl(m_fd.fd(), KVM_GET_DIRTY_LOG, &log) == -1) {
+            const auto err = std::format(
+                "Error to get dirty log of memory slot {}: {}",
+                slot, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::register_coalesced_mmio(u64 addr, u32 size, bool pio)
+    const noexcept -> VmmResult<None> {
+        kvm_coalesced_mmio_zone zone {};
+        zone.addr = addr;
+        zone.size = size;
+        zone.pio  = pio ? 1 : 0;
+
+        const auto ret = ioctl(m_fd.fd(), KVM_REGISTER_COALESCED_MMIO, &zone);
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to register coalesced zone {:#x}: {}",
+                addr, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::unregister_coalesced_mmio(u64 addr, u32 size, bool pio)
+    const noexcept -> VmmResult<None> {
+        kvm_coalesced_mmio_zone zone {};
+        zone.addr = addr;
+        zone.size = size;
+        zone.pio  = pio ? 1 : 0;
+
+        const auto ret = ioctl(
+            m_fd.fd(), KVM_UNREGISTER_COALESCED_MMIO, &zone
+        );
+
+        if (ret == -1)
+            return std::unexpected("Error to unregister coalesced zone");
+
+        return None {};
+    }
+
+    namespace {
+        /// @brief Assign or deassign event file descriptor on guest write.
+        ///
+        /// @param [in] vmfd given raw virtual machine file descriptor.
+        /// @param [in] eventfd given raw event file descriptor.
+        /// @param [in] addr given guest physical address or port.
+        /// @param [in] len given access length in bytes (0 to ignore).
+        /// @param [in] pio given flag whether address is in I/O port space.
+        /// @param [in] datamatch given value written data must match.
+        /// @param [in] deassign given flag whether to remove assignment.
+        ///
+        /// @return ioctl return value.
+        auto ioeventfd(
+            i32 vmfd, i32 eventfd, u64 addr, u32 len, bool pio,
+            std::optional<u64> datamatch, bool deassign
+        ) noexcept -> i32 {
+            kvm_ioeventfd request {};
+            request.addr = addr;
+            request.len  = len;
+            request.fd   = eventfd;
+
+            if (pio)
+                request.flags |= KVM_IOEVENTFD_FLAG_PIO;
+
+            if (datamatch) {
+                request.flags |= KVM_IOEVENTFD_FLAG_DATAMATCH;
+                request.datamatch = *datamatch;
+            }
+
+            if (deassign)
+                request.flags |= KVM_IOEVENTFD_FLAG_DEASSIGN;
+
+            return ioctl(vmfd, KVM_IOEVENTFD, &request);
+        }
+    }
+
+    auto VmFd::register_ioeventfd(
+        i32 eventfd, u64 addr, u32 len, bool pio, std::optional<u64> datamatch
+    ) const noexcept -> VmmResult<None> {
+        const auto ret = ioeventfd(
+            m_fd.fd(), eventfd, addr, len, pio, datamatch, false
+        );
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to register ioeventfd at {:#x}: {}",
+                addr, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::unregister_ioeventfd(
+        i32 eventfd, u64 addr, u32 len, bool pio, std::optional<u64> datamatch
+    ) const noexcept -> VmmResult<None> {
+        const auto ret = ioeventfd(
+            m_fd.fd(), eventfd, addr, len, pio, datamatch, true
+        );
+
+        if (ret == -1)
+            return std::unexpected("Error to unregister ioeventfd");
+
+        return None {};
+    }
+
+    auto VmFd::create_irqchip() const noexcept -> VmmResult<None> {
+        if (ioctl(m_fd.fd(), KVM_CREATE_IRQCHIP) == -1) {
+            const auto err = std::format(
+                "Error to create in-kernel irqchip: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::create_pit2() const noexcept -> VmmResult<None> {
+        kvm_pit_config config {};
+
+        if (ioctl(m_fd.fd(), KVM_CREATE_PIT2, &config) == -1) {
+            const auto err = std::format(
+                "Error to create in-kernel PIT: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::irqchip(u32 chip) const noexcept -> VmmResult<kvm_irqchip> {
+        kvm_irqchip irqchip {};
+        irqchip.chip_id = chip;
+
+        if (ioctl(m_fd.fd(), KVM_GET_IRQCHIP, &irqchip) == -1) {
+            const auto err = std::format(
+                "Error to get irqchip {} state: {}", chip, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return irqchip;
+    }
+
+    auto VmFd::set_irqchip(const kvm_irqchip& irqchip) const noexcept
+    -> VmmResult<None> {
+        if (ioctl(m_fd.fd(), KVM_SET_IRQCHIP, &irqchip) == -1) {
+            const auto err = std::format(
+                "Error to set irqchip {} state: {}",
+                irqchip.chip_id, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::pit2() const noexcept -> VmmResult<kvm_pit_state2> {
+        kvm_pit_state2 pit {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_PIT2, &pit) == -1) {
+            const auto err = std::format(
+                "Error to get in-kernel PIT state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return pit;
+    }
+
+    auto VmFd::set_pit2(const kvm_pit_state2& pit) const noexcept
+    -> VmmResult<None> {
+        if (ioctl(m_fd.fd(), KVM_SET_PIT2, &pit) == -1) {
+            const auto err = std::format(
+                "Error to set in-kernel PIT state: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::register_irqfd(
+        i32 eventfd, u32 gsi, std::optional<i32> resamplefd
+    ) const noexcept -> VmmResult<None> {
+        kvm_irqfd request {};
+        request.fd  = static_cast<u32>(eventfd);
+        request.gsi = gsi;
+
+        if (resamplefd) {
+            request.flags |= KVM_IRQFD_FLAG_RESAMPLE;
+            request.resamplefd = static_cast<u32>(*resamplefd);
+        }
+
+        if (ioctl(m_fd.fd(), KVM_IRQFD, &request) == -1) {
+            const auto err = std::format(
+                "Error to register irqfd on GSI {}: {}",
+                gsi, std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::unregister_irqfd(i32 eventfd, u32 gsi) const noexcept
+    -> VmmResult<None> {
+        kvm_irqfd request {};
+        request.fd    = static_cast<u32>(eventfd);
+        request.gsi   = gsi;
+        request.flags = KVM_IRQFD_FLAG_DEASSIGN;
+
+        if (ioctl(m_fd.fd(), KVM_IRQFD, &request) == -1)
+            return std::unexpected("Error to unregister irqfd");
+
+        return None {};
+    }
+
+    auto VmFd::clock() const noexcept -> VmmResult<kvm_clock_data> {
+        kvm_clock_data clock {};
+
+        if (ioctl(m_fd.fd(), KVM_GET_CLOCK, &clock) == -1) {
+            const auto err = std::format(
+                "Error to get KVM clock: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return clock;
+    }
+
+    auto VmFd::set_clock(const kvm_clock_data& clock) const noexcept
+    -> VmmResult<None> {
+        if (ioctl(m_fd.fd(), KVM_SET_CLOCK, &clock) == -1) {
+            const auto err = std::format(
+                "Error to set KVM clock: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return None {};
+    }
+
+    auto VmFd::create_vcpu(u32 id) const -> VmmResult<i32> {
+        const auto result = ioctl(m_fd.fd(), KVM_CREATE_VCPU, id);
 
         if (result == -1)
             return std::unexpected("Error to create virtual CPU");
@@ -49,4 +310,18 @@ namespace nullvm::core {
         return result;
     }
 
-}
\ No newline at end of file
+    auto VmFd::stats_fd() const noexcept -> VmmResult<i32> {
+        const auto result = ioctl(m_fd.fd(), KVM_GET_STATS_FD, 0);
+
+        if (result == -1) {
+            const auto err = std::format(
+                "Error to get VM statistics descriptor: {}",
+                std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        return result;
+    }
+
+}
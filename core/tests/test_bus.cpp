@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Device bus tests.
+
+#include <nullvm/core/devices/bus.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <array>
+
+using namespace nullvm::core;
+using namespace nullvm;
+using devices::Device;
+using devices::Bus;
+
+namespace {
+    /// Device recording last access offset.
+    class TestDevice final : public Device {
+    public:
+        u64 last_offset {0};
+        std::vector<u8> written;
+
+        auto read(u64 offset, std::span<u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            last_offset = offset;
+            std::ranges::fill(data, 0x42);
+            return None {};
+        }
+
+        auto write(u64 offset, std::span<const u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            last_offset = offset;
+            written.assign(data.begin(), data.end());
+            return None {};
+        }
+    };
+}
+
+TEST(test_bus, test_bus_insert_correct) {
+    Bus bus;
+
+    auto result = bus.insert(0x10, 0x8, std::make_shared<TestDevice>());
+    EXPECT_TRUE(result.has_value());
+
+    result = bus.insert(0x18, 0x8, std::make_shared<TestDevice>());
+    EXPECT_TRUE(result.has_value());
+
+    result = bus.insert(0x0, 0x10, std::make_shared<TestDevice>());
+    EXPECT_TRUE(result.has_value());
+
+    EXPECT_EQ(bus.size(), 3);
+}
+
+TEST(test_bus, test_bus_insert_overlapping) {
+    Bus bus;
+
+    auto result = bus.insert(0x10, 0x8, std::make_shared<TestDevice>());
+    EXPECT_TRUE(result.has_value());
+
+    result = bus.insert(0x14, 0x8, std::make_shared<TestDevice>());
+    EXPECT_FALSE(result.has_value());
+
+    result = bus.insert(0x8, 0x9, std::make_shared<TestDevice>());
+    EXPECT_FALSE(result.has_value());
+
+    result = bus.insert(0x0, 0x100, std::make_shared<TestDevice>());
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_bus, test_bus_insert_incorrect) {
+    Bus bus;
+
+    auto result = bus.insert(0x10, 0, std::make_shared<TestDevice>());
+    EXPECT_FALSE(result.has_value());
+
+    result = bus.insert(0x10, 0x8, nullptr);
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_bus, test_bus_dispatch) {
+    Bus bus;
+    auto first = std::make_shared<TestDevice>();
+    auto second = std::make_shared<TestDevice>();
+
+    EXPECT_TRUE(bus.insert(0x3f8, 0x8, first).has_value());
+    EXPECT_TRUE(bus.insert(0x2f8, 0x8, second).has_value());
+
+    const std::array<u8, 2> data = {1, 2};
+    EXPECT_TRUE(bus.write(0x3fb, data, 1).has_value());
+    EXPECT_EQ(first->last_offset, 3);
+    EXPECT_EQ(first->written, std::vector<u8>(data.begin(), data.end()));
+
+    std::array<u8, 1> value {};
+    EXPECT_TRUE(bus.read(0x2ff, value, 1).has_value());
+    EXPECT_EQ(second->last_offset, 7);
+    EXPECT_EQ(value[0], 0x42);
+}
+
+TEST(test_bus, test_bus_unmapped_access) {
+    Bus bus;
+    auto result = bus.insert(0x10, 0x8, std::make_shared<TestDevice>());
+    EXPECT_TRUE(result.has_value());
+
+    std::array<u8, 2> value {};
+    EXPECT_TRUE(bus.read(0x18, value, 2).has_value());
+    EXPECT_EQ(value[0], 0xff);
+    EXPECT_EQ(value[1], 0xff);
+
+    const std::array<u8, 1> data = {1};
+    EXPECT_TRUE(bus.write(0x0, data, 1).has_value());
+}
+
+TEST(test_bus, test_bus_remove) {
+    Bus bus;
+    auto device = std::make_shared<TestDevice>();
+
+    EXPECT_TRUE(bus.insert(0x10, 0x8, device).has_value());
+    EXPECT_TRUE(bus.remove(0x10).has_value());
+    EXPECT_FALSE(bus.remove(0x10).has_value());
+    EXPECT_EQ(bus.size(), 0);
+
+    std::array<u8, 1> value {};
+    EXPECT_TRUE(bus.read(0x10, value, 1).has_value());
+    EXPECT_EQ(value[0], 0xff);
+}
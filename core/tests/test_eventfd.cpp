@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Event notification file descriptor tests.
+
+#include <nullvm/core/utils/eventfd.hpp>
+#include <nullvm/core/utils/utils.hpp>
+#include <gtest/gtest.h>
+
+using namespace nullvm::core;
+using utils::EventFd;
+
+TEST(test_eventfd, test_eventfd_write_read) {
+    EventFd eventfd;
+    auto result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = eventfd.write(2);
+    EXPECT_TRUE(result.has_value());
+
+    result = eventfd.write(3);
+    EXPECT_TRUE(result.has_value());
+
+    auto value = eventfd.read();
+    EXPECT_TRUE(value.has_value());
+    EXPECT_EQ(value.value(), 5);
+}
+
+TEST(test_eventfd, test_eventfd_read_empty) {
+    EventFd eventfd;
+    auto result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    auto value = eventfd.read();
+    EXPECT_TRUE(value.has_value());
+    EXPECT_EQ(value.value(), 0);
+}
+
+TEST(test_eventfd, test_eventfd_destruction) {
+    EventFd eventfd;
+    auto result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    const auto fd = eventfd.fd();
+    eventfd.~EventFd();
+
+    EXPECT_FALSE(utils::is_fd_open(fd));
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit dispatch table tests.
+
+#include <nullvm/core/exit_dispatcher.hpp>
+#include <gtest/gtest.h>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+TEST(test_exit_dispatcher, test_exit_dispatcher_dispatch) {
+    ExitDispatcher dispatcher;
+    kvm_run state {};
+    u32 calls {0};
+
+    auto result = dispatcher.set_handler(
+        KVM_EXIT_HLT,
+        [&calls](kvm_run&) -> VmmResult<ExitAction> {
+            ++calls;
+            return ExitAction::Halt;
+        }
+    );
+    EXPECT_TRUE(result.has_value());
+
+    state.exit_reason = KVM_EXIT_HLT;
+    auto action = dispatcher.dispatch(state);
+
+    EXPECT_TRUE(action.has_value());
+    EXPECT_EQ(action.value(), ExitAction::Halt);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(test_exit_dispatcher, test_exit_dispatcher_unhandled) {
+    ExitDispatcher dispatcher;
+    kvm_run state {};
+
+    state.exit_reason = KVM_EXIT_SHUTDOWN;
+    auto action = dispatcher.dispatch(state);
+    EXPECT_FALSE(action.has_value());
+
+    state.exit_reason = EXIT_REASONS_COUNT + 1;
+    action = dispatcher.dispatch(state);
+    EXPECT_FALSE(action.has_value());
+}
+
+TEST(test_exit_dispatcher, test_exit_dispatcher_invalid_reason) {
+    ExitDispatcher dispatcher;
+
+    auto result = dispatcher.set_handler(
+        EXIT_REASONS_COUNT,
+        [](kvm_run&) -> VmmResult<ExitAction> { return ExitAction::Halt; }
+    );
+
+    EXPECT_FALSE(result.has_value());
+}
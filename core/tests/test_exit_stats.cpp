@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit statistics tests.
+
+#include <nullvm/core/exit_stats.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <memory>
+
+using namespace nullvm::core;
+using namespace nullvm;
+using namespace std::chrono_literals;
+
+TEST(test_exit_stats, test_exit_stats_histogram_buckets) {
+    // Small values are exact, larger ones keep 1/8 precision.
+    for (u64 value = 0; value < 8; ++value) {
+        EXPECT_EQ(Histogram::bucket(value), value);
+        EXPECT_EQ(Histogram::bucket_limit(value), value);
+    }
+
+    usize previous {0};
+
+    for (u64 value = 8; value < (1u << 20); value += value / 7 + 1) {
+        const auto bucket = Histogram::bucket(value);
+        const auto limit = Histogram::bucket_limit(bucket);
+
+        EXPECT_GE(bucket, previous);
+        EXPECT_GE(limit, value);
+        EXPECT_LE(limit - value, value / 8);
+        EXPECT_EQ(Histogram::bucket(limit), bucket);
+        EXPECT_EQ(Histogram::bucket(limit + 1), bucket + 1);
+
+        previous = bucket;
+    }
+
+    EXPECT_EQ(Histogram::bucket(UINT64_MAX), HISTOGRAM_BUCKETS - 1);
+    EXPECT_EQ(Histogram::bucket_limit(HISTOGRAM_BUCKETS - 1), UINT64_MAX);
+}
+
+TEST(test_exit_stats, test_exit_stats_histogram_percentile) {
+    Histogram histogram;
+
+    EXPECT_EQ(histogram.snapshot().percentile(50), 0u);
+
+    for (u64 value = 1; value <= 1000; ++value)
+        histogram.record(value);
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000u);
+    EXPECT_EQ(snapshot.max, 1000u);
+
+    const auto median = snapshot.percentile(50);
+    EXPECT_GE(median, 500u);
+    EXPECT_LE(median, 500u + 500u / 8);
+
+    EXPECT_EQ(snapshot.percentile(0), 1u);
+    EXPECT_EQ(snapshot.percentile(100), 1000u);
+
+    auto merged = snapshot;
+    merged.merge(snapshot);
+    EXPECT_EQ(merged.count, 2000u);
+    EXPECT_EQ(merged.percentile(50), median);
+}
+
+TEST(test_exit_stats, test_exit_stats_record) {
+    ExitStats stats;
+
+    stats.record(KVM_EXIT_IO, 100ns, 20ns);
+    stats.record(KVM_EXIT_IO, 300ns, 40ns);
+    stats.record(KVM_EXIT_HLT, 50ns, 5ns);
+
+    // Unknown reasons show up only in histograms.
+    stats.record(EXIT_REASONS_COUNT, 1ns, 1ns);
+
+    const auto snapshot = stats.snapshot();
+    const auto& io = snapshot.reasons[KVM_EXIT_IO];
+
+    EXPECT_EQ(io.count, 2u);
+    EXPECT_EQ(io.guest, 400ns);
+    EXPECT_EQ(io.handle, 60ns);
+    EXPECT_EQ(snapshot.reasons[KVM_EXIT_HLT].count, 1u);
+
+    EXPECT_EQ(snapshot.exits(), 3u);
+    EXPECT_EQ(snapshot.guest_time(), 450ns);
+    EXPECT_EQ(snapshot.handle_time(), 65ns);
+    EXPECT_EQ(snapshot.guest.count, 4u);
+    EXPECT_EQ(snapshot.guest.max, 300u);
+    EXPECT_EQ(snapshot.handle.max, 40u);
+}
+
+TEST(test_exit_stats, test_exit_stats_concurrent_snapshot) {
+    constexpr u64 EXITS {100'000};
+
+    auto stats = std::make_unique<ExitStats>();
+
+    auto writer = std::jthread([&stats] {
+        for (u64 i = 0; i < EXITS; ++i)
+            stats->record(KVM_EXIT_IO, 1ns, 1ns);
+    });
+
+    // Counters seen by reader never go backwards.
+    u64 previous {0};
+
+    for (usize i = 0; i < 100; ++i) {
+        const auto count = stats->snapshot().reasons[KVM_EXIT_IO].count;
+        EXPECT_GE(count, previous);
+        previous = count;
+    }
+
+    writer.join();
+    EXPECT_EQ(stats->snapshot().reasons[KVM_EXIT_IO].count, EXITS);
+}
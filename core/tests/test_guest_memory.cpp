@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest physical memory map tests.
+
+#include <nullvm/core/guest_memory.hpp>
+#include <nullvm/core/kvm.hpp>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <utility>
+#include <thread>
+#include <array>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Size of memory regions used in tests.
+    constexpr usize REGION_SIZE {0x2000};
+
+    /// @brief Map anonymous host memory.
+    ///
+    /// Mapping failure is fatal for the calling test, wrap the call in
+    /// ASSERT_NO_FATAL_FAILURE().
+    ///
+    /// @param [in] size given memory size in bytes.
+    /// @param [out] memory given memory to initialize.
+    auto map_memory(usize size, utils::MMapWrapper& memory) -> void {
+        const auto prot  = PROT_READ | PROT_WRITE;
+        const auto flags = MAP_SHARED | MAP_ANONYMOUS;
+
+        auto addr = mmap(nullptr, size, prot, flags, -1, 0);
+        ASSERT_TRUE(memory.init(addr, size).has_value());
+    }
+
+    /// Guest memory test fixture owning virtual machine.
+    class test_guest_memory : public testing::Test {
+    protected:
+        Kvm kvm;
+        VmFd vmfd;
+        GuestMemory memory;
+
+        auto SetUp() -> void override {
+            ASSERT_TRUE(kvm.init().has_value());
+
+            auto fd = kvm.create_vm();
+            ASSERT_TRUE(fd.has_value());
+            ASSERT_TRUE(vmfd.init(fd.value()).has_value());
+            ASSERT_TRUE(memory.init(vmfd, 4).has_value());
+        }
+    };
+}
+
+TEST_F(test_guest_memory, test_guest_memory_add_regions) {
+    utils::MMapWrapper host;
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    auto slot = memory.add_region(0x0, REGION_SIZE, std::move(host));
+    EXPECT_TRUE(slot.has_value());
+    EXPECT_EQ(slot.value(), 0);
+
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    slot = memory.add_region(0x10000, REGION_SIZE, std::move(host));
+    EXPECT_TRUE(slot.has_value());
+    EXPECT_EQ(slot.value(), 1);
+
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    slot = memory.add_region(0x1000, REGION_SIZE, std::move(host));
+    EXPECT_FALSE(slot.has_value());
+
+    EXPECT_EQ(memory.regions_count(), 2);
+}
+
+TEST_F(test_guest_memory, test_guest_memory_slots_exhausted) {
+    for (u64 i = 0; i < 4; ++i) {
+        utils::MMapWrapper host;
+        ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+        auto slot = memory.add_region(
+            i * REGION_SIZE, REGION_SIZE, std::move(host)
+        );
+        EXPECT_TRUE(slot.has_value());
+    }
+
+    utils::MMapWrapper host;
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    auto slot = memory.add_region(
+        4 * REGION_SIZE, REGION_SIZE, std::move(host)
+    );
+    EXPECT_FALSE(slot.has_value());
+
+    EXPECT_TRUE(memory.remove_region(REGION_SIZE).has_value());
+
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    slot = memory.add_region(
+        4 * REGION_SIZE, REGION_SIZE, std::move(host)
+    );
+    EXPECT_TRUE(slot.has_value());
+    EXPECT_EQ(slot.value(), 1);
+}
+
+TEST_F(test_guest_memory, test_guest_memory_translate) {
+    utils::MMapWrapper host;
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    auto slot = memory.add_region(0x4000, REGION_SIZE, std::move(host));
+    ASSERT_TRUE(slot.has_value());
+
+    const std::array<u8, 4> input = {1, 2, 3, 4};
+    EXPECT_TRUE(memory.write(0x5ffc, input).has_value());
+
+    std::array<u8, 4> output {};
+    EXPECT_TRUE(memory.read(0x5ffc, output).has_value());
+    EXPECT_EQ(input, output);
+
+    EXPECT_TRUE(memory.translate(0x4000).has_value());
+    EXPECT_FALSE(memory.translate(0x3fff).has_value());
+    EXPECT_FALSE(memory.translate(0x6000).has_value());
+    EXPECT_FALSE(memory.translate(0x5ffd, 4).has_value());
+}
+
+TEST_F(test_guest_memory, test_guest_memory_remove_region) {
+    utils::MMapWrapper host;
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    auto slot = memory.add_region(0x4000, REGION_SIZE, std::move(host));
+    ASSERT_TRUE(slot.has_value());
+
+    EXPECT_FALSE(memory.remove_region(0x5000).has_value());
+    EXPECT_TRUE(memory.remove_region(0x4000).has_value());
+
+    EXPECT_EQ(memory.regions_count(), 0);
+    EXPECT_FALSE(memory.translate(0x4000).has_value());
+}
+
+TEST_F(test_guest_memory, test_guest_memory_dirty_log) {
+    EXPECT_FALSE(memory.dirty_log().has_value());
+
+    utils::MMapWrapper host;
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    auto slot = memory.add_region(0x4000, REGION_SIZE, std::move(host));
+    ASSERT_TRUE(slot.has_value());
+    EXPECT_TRUE(memory.set_dirty_logging(true).has_value());
+
+    const std::array<u8, 4> input = {1, 2, 3, 4};
+    EXPECT_TRUE(memory.write(0x4ffe, input).has_value());
+
+    // Write crossing page boundary marks both pages.
+    auto dirty = memory.dirty_log();
+    ASSERT_TRUE(dirty.has_value());
+    ASSERT_EQ(dirty->size(), 1);
+    EXPECT_EQ(dirty->front().guest_addr, 0x4000);
+    EXPECT_TRUE(dirty->front().test(0));
+    EXPECT_TRUE(dirty->front().test(1));
+
+    ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+    slot = memory.add_region(0x8000, REGION_SIZE, std::move(host));
+    ASSERT_TRUE(slot.has_value());
+    EXPECT_TRUE(memory.write(0x8000, input).has_value());
+
+    // Log is cleared on read, new regions are tracked too.
+    dirty = memory.dirty_log();
+    ASSERT_TRUE(dirty.has_value());
+    ASSERT_EQ(dirty->size(), 2);
+    EXPECT_FALSE(dirty->front().test(1));
+    EXPECT_TRUE(dirty->back().test(0));
+
+    // Pages of unconsumed log are reported again.
+    memory.restore_dirty_log(dirty.value());
+    dirty = memory.dirty_log();
+    ASSERT_TRUE(dirty.has_value());
+    EXPECT_TRUE(dirty->back().test(0));
+    EXPECT_FALSE(dirty->back().test(1));
+
+    EXPECT_TRUE(memory.set_dirty_logging(false).has_value());
+    EXPECT_FALSE(memory.dirty_log().has_value());
+}
+
+TEST_F(test_guest_memory, test_guest_memory_read_while_removed) {
+    constexpr usize ROUNDS {1000};
+
+    std::jthread reader([this](std::stop_token stop) {
+        std::array<u8, REGION_SIZE> output {};
+
+        // Read either copies mapped region or fails, never faults.
+        while (!stop.stop_requested())
+            static_cast<void>(memory.read(0x4000, output));
+    });
+
+    utils::MMapWrapper host;
+
+    for (usize i = 0; i < ROUNDS; ++i) {
+        ASSERT_NO_FATAL_FAILURE(map_memory(REGION_SIZE, host));
+
+        auto slot = memory.add_region(0x4000, REGION_SIZE, std::move(host));
+        EXPECT_TRUE(slot.has_value());
+        EXPECT_TRUE(memory.remove_region(0x4000).has_value());
+    }
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// io_uring submission and completion rings tests.
+
+#include <nullvm/core/utils/io_uring.hpp>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string_view>
+#include <array>
+#include <bit>
+
+using namespace nullvm::core;
+using namespace nullvm;
+using utils::IoUring;
+using utils::BufferGroup;
+
+TEST(test_io_uring, test_io_uring_nop) {
+    IoUring ring;
+    auto result = ring.init(4);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(ring.peek_cqe(), nullptr);
+
+    // More requests than ring entries are submitted in two parts.
+    for (u64 i = 0; i < 6; ++i) {
+        auto sqe = ring.get_sqe();
+        ASSERT_TRUE(sqe.has_value());
+
+        (*sqe)->opcode    = IORING_OP_NOP;
+        (*sqe)->user_data = i;
+    }
+
+    auto submitted = ring.submit(2);
+    EXPECT_TRUE(submitted.has_value());
+
+    for (u64 i = 0; i < 6; ++i) {
+        if (!ring.peek_cqe()) {
+            ASSERT_TRUE(ring.submit(1).has_value());
+        }
+
+        const auto cqe = ring.peek_cqe();
+        ASSERT_NE(cqe, nullptr);
+        EXPECT_EQ(cqe->user_data, i);
+        EXPECT_EQ(cqe->res, 0);
+        ring.cqe_seen();
+    }
+
+    EXPECT_EQ(ring.peek_cqe(), nullptr);
+}
+
+TEST(test_io_uring, test_io_uring_buffer_select) {
+    constexpr std::string_view MESSAGE {"hello"};
+
+    IoUring ring;
+    auto result = ring.init(8);
+    EXPECT_TRUE(result.has_value());
+
+    BufferGroup buffers;
+    result = buffers.init(ring, 1, 1, 64);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(buffers.group(), 1);
+
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()), 0);
+
+    // Single buffer is reused after recycle.
+    for (u64 i = 0; i < 2; ++i) {
+        EXPECT_EQ(write(fds[1], MESSAGE.data(), MESSAGE.size()), 5);
+
+        auto sqe = ring.get_sqe();
+        ASSERT_TRUE(sqe.has_value());
+
+        (*sqe)->opcode    = IORING_OP_RECV;
+        (*sqe)->fd        = fds[0];
+        (*sqe)->flags     = IOSQE_BUFFER_SELECT;
+        (*sqe)->buf_group = buffers.group();
+        (*sqe)->user_data = i + 1;
+
+        ASSERT_TRUE(ring.submit(1).has_value());
+
+        const auto cqe = ring.peek_cqe();
+        ASSERT_NE(cqe, nullptr);
+        ASSERT_EQ(cqe->res, 5);
+        ASSERT_NE(cqe->flags & IORING_CQE_F_BUFFER, 0u);
+
+        const auto id = static_cast<std::uint16_t>(
+            cqe->flags >> IORING_CQE_BUFFER_SHIFT
+        );
+        ring.cqe_seen();
+
+        const auto data = buffers.data(id, MESSAGE.size());
+        EXPECT_EQ(
+            std::string_view(
+                std::bit_cast<const char*>(data.data()), data.size()
+            ),
+            MESSAGE
+        );
+
+        result = buffers.recycle(ring, id);
+        EXPECT_TRUE(result.has_value());
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(test_io_uring, test_io_uring_buffer_group_invalid) {
+    IoUring ring;
+    auto result = ring.init(4);
+    EXPECT_TRUE(result.has_value());
+
+    BufferGroup buffers;
+    result = buffers.init(ring, 0, 0, 64);
+    EXPECT_FALSE(result.has_value());
+
+    result = buffers.init(ring, 0, 4, 0);
+    EXPECT_FALSE(result.has_value());
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// KVM binary statistics tests.
+
+#include <nullvm/core/kvm_stats.hpp>
+#include <nullvm/core/vm.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+TEST(test_kvm_stats, test_kvm_stats_vm) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    auto stats = vm.kvm_stats();
+    ASSERT_TRUE(stats.has_value()) << stats.error();
+
+    EXPECT_TRUE(stats->id().starts_with("kvm-"));
+    EXPECT_FALSE(stats->descriptors().empty());
+
+    // Values of every descriptor fit into sampled buffer.
+    auto values = stats->sample();
+    ASSERT_TRUE(values.has_value());
+
+    for (const auto& desc : stats->descriptors())
+        EXPECT_LE(desc.index + desc.size, values->size());
+
+    EXPECT_FALSE(stats->find("nullvm_missing").has_value());
+}
+
+TEST(test_kvm_stats, test_kvm_stats_vcpu) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    auto stats = vm.kvm_stats(0);
+    ASSERT_TRUE(stats.has_value()) << stats.error();
+    ASSERT_TRUE(stats->sample().has_value());
+
+    const auto before = stats->find("halt_exits");
+    ASSERT_TRUE(before.has_value());
+    const auto halts = before->front();
+
+    const std::vector<u8> code = {
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    // Descriptors are kept, only values are read again.
+    ASSERT_TRUE(stats->sample().has_value());
+    EXPECT_EQ(stats->find("halt_exits")->front(), halts + 1);
+    EXPECT_GE(stats->find("exits")->front(), 1u);
+}
+
+TEST(test_kvm_stats, test_kvm_stats_invalid) {
+    KvmStats stats;
+
+    EXPECT_FALSE(stats.init(-1).has_value());
+}
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest kernel image loaders tests.
+
+#include <nullvm/core/loader.hpp>
+#include <nullvm/core/vm.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+#include <elf.h>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Size of guest RAM used in tests.
+    constexpr usize RAM_SIZE {4 * 1024 * 1024};
+
+    /// @brief Build ELF64 executable with single loadable segment.
+    ///
+    /// @param [in] paddr given segment physical address and entry point.
+    /// @param [in] code given segment contents.
+    /// @param [in] memsz given segment size in memory.
+    ///
+    /// @return ELF image bytes.
+    auto make_elf(u64 paddr, std::span<const u8> code, u64 memsz)
+    -> std::vector<u8> {
+        Elf64_Ehdr header {};
+        std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+        header.e_ident[EI_CLASS]   = ELFCLASS64;
+        header.e_ident[EI_DATA]    = ELFDATA2LSB;
+        header.e_ident[EI_VERSION] = EV_CURRENT;
+        header.e_type      = ET_EXEC;
+        header.e_machine   = EM_X86_64;
+        header.e_version   = EV_CURRENT;
+        header.e_entry     = paddr;
+        header.e_phoff     = sizeof(Elf64_Ehdr);
+        header.e_ehsize    = sizeof(Elf64_Ehdr);
+        header.e_phentsize = sizeof(Elf64_Phdr);
+        header.e_phnum     = 1;
+
+        Elf64_Phdr segment {};
+        segment.p_type   = PT_LOAD;
+        segment.p_flags  = PF_R | PF_W | PF_X;
+        segment.p_offset = sizeof(Elf64_Ehdr) + sizeof(Elf64_Phdr);
+        segment.p_vaddr  = paddr;
+        segment.p_paddr  = paddr;
+        segment.p_filesz = code.size();
+        segment.p_memsz  = memsz;
+
+        std::vector<u8> image(segment.p_offset + code.size());
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::memcpy(image.data() + sizeof(header), &segment, sizeof(segment));
+        std::ranges::copy(code, image.begin() + segment.p_offset);
+
+        return image;
+    }
+
+    /// @brief Build bzImage with given protected-mode kernel.
+    ///
+    /// @param [in] kernel given protected-mode kernel code.
+    ///
+    /// @return bzImage bytes.
+    auto make_bzimage(std::span<const u8> kernel) -> std::vector<u8> {
+        // Boot sector and one setup sector.
+        std::vector<u8> image(1024);
+
+        const auto write = [&image](usize offset, auto value) {
+            std::memcpy(image.data() + offset, &value, sizeof(value));
+        };
+
+        write(0x1f1, std::uint8_t {1});             // setup_sects
+        write(0x200, std::uint8_t {0xeb});          // jmp short
+        write(0x201, std::uint8_t {0x66});          // setup header end
+        write(0x202, std::uint32_t {0x53726448});   // "HdrS"
+        write(0x206, std::uint16_t {0x020f});       // version
+        write(0x211, std::uint8_t {0x01});          // LOADED_HIGH
+        write(0x22c, std::uint32_t {0x37ffffff});   // initrd_addr_max
+        write(0x238, std::uint32_t {2048});         // cmdline_size
+
+        image.insert(image.end(), kernel.begin(), kernel.end());
+        return image;
+    }
+
+    /// @brief Write bytes to temporary file.
+    ///
+    /// @param [in] bytes given file contents.
+    ///
+    /// @return Path to temporary file.
+    auto write_temp_file(std::span<const u8> bytes) -> std::string {
+        std::string path = "/tmp/nullvm_loader_XXXXXX";
+        const auto fd = mkstemp(path.data());
+
+        [[maybe_unused]]
+        const auto ret = write(fd, bytes.data(), bytes.size());
+        close(fd);
+
+        return path;
+    }
+
+    /// @brief Read value from guest memory.
+    ///
+    /// @param [in] vm given virtual machine.
+    /// @param [in] addr given guest physical address.
+    ///
+    /// @return Read value.
+    template <typename T>
+    auto read_guest(VirtualMachine& vm, u64 addr) -> T {
+        std::array<u8, sizeof(T)> bytes {};
+        EXPECT_TRUE(vm.memory().read(addr, bytes).has_value());
+
+        T value {};
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+}
+
+TEST(test_loader, test_loader_elf_invalid) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.add_mem_region(0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 1> code = {0xf4};
+    auto image = make_elf(0x1000, code, code.size());
+
+    // Segment outside guest memory.
+    auto elf = make_elf(RAM_SIZE, code, code.size());
+    EXPECT_FALSE(loader::load_elf(vm.memory(), elf).has_value());
+
+    image[EI_CLASS] = ELFCLASS32;
+    EXPECT_FALSE(loader::load_elf(vm.memory(), image).has_value());
+
+    EXPECT_FALSE(loader::load_elf(vm.memory(), code).has_value());
+}
+
+TEST(test_loader, test_loader_elf_boot) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.add_mem_region(0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    // Memory past segment file size must be zero-filled.
+    const std::vector<u8> garbage(0x1000, 0xff);
+    EXPECT_TRUE(vm.memory().write(0x1000, garbage).has_value());
+
+    const std::array<u8, 6> code = {
+        0xc6, 0x06, 0x00, 0x1f, 0x42,   // movb $0x42, 0x1f00
+        0xf4,                           // hlt
+    };
+
+    const auto path = write_temp_file(make_elf(0x1000, code, 0x800));
+
+    result = vm.load_elf(path);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    EXPECT_EQ(read_guest<u8>(vm, 0x1700), 0);
+    EXPECT_EQ(read_guest<u8>(vm, 0x1f00), 0x42);
+
+    unlink(path.c_str());
+}
+
+TEST(test_loader, test_loader_bzimage_invalid) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.add_mem_region(0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 1> kernel = {0xf4};
+    auto image = make_bzimage(kernel);
+
+    const std::string cmdline(4096, 'x');
+    EXPECT_FALSE(loader::load_bzimage(vm.memory(), image, cmdline));
+
+    // Setup sectors run past end of image.
+    image[0x1f1] = 8;
+    EXPECT_FALSE(loader::load_bzimage(vm.memory(), image, ""));
+    image[0x1f1] = 1;
+
+    // Image truncated inside setup header.
+    const auto truncated = std::span(image).first(0x210);
+    EXPECT_FALSE(loader::load_bzimage(vm.memory(), truncated, ""));
+
+    image[0x202] = 0;
+    EXPECT_FALSE(loader::load_bzimage(vm.memory(), image, ""));
+}
+
+TEST(test_loader, test_loader_bzimage_boot) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.add_mem_region(0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 14> kernel = {
+        0xc6, 0x05, 0x00, 0x00, 0x20, 0x00, 0x42,   // movb $0x42, 0x200000
+        0x89, 0x35, 0x04, 0x00, 0x20, 0x00,         // mov %esi, 0x200004
+        0xf4,                                       // hlt
+    };
+
+    const std::vector<u8> initrd(0x3000, 0xab);
+
+    const auto path = write_temp_file(make_bzimage(kernel));
+    const auto initrd_path = write_temp_file(initrd);
+
+    result = vm.load_bzimage(path, "console=ttyS0", initrd_path);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    const auto params = loader::BOOT_PARAMS_ADDR;
+
+    EXPECT_EQ(read_guest<u8>(vm, 0x200000), 0x42);
+    EXPECT_EQ(read_guest<u32>(vm, 0x200004), params);
+
+    EXPECT_EQ(read_guest<u32>(vm, params + 0x202), 0x53726448);
+    EXPECT_EQ(read_guest<u8>(vm, params + 0x210), 0xff);
+    EXPECT_EQ(read_guest<u32>(vm, params + 0x228), loader::CMDLINE_ADDR);
+    EXPECT_EQ(read_guest<u8>(vm, params + 0x1e8), 1);
+    EXPECT_EQ(read_guest<u64>(vm, params + 0x2d8), RAM_SIZE);
+
+    std::string cmdline(14, '\0');
+    EXPECT_TRUE(vm.memory().read(
+        loader::CMDLINE_ADDR,
+        std::span(std::bit_cast<u8*>(cmdline.data()), cmdline.size())
+    ).has_value());
+    EXPECT_EQ(cmdline, std::string("console=ttyS0") + '\0');
+
+    const auto initrd_addr = read_guest<u32>(vm, params + 0x218);
+    EXPECT_EQ(initrd_addr, RAM_SIZE - initrd.size());
+    EXPECT_EQ(read_guest<u32>(vm, params + 0x21c), initrd.size());
+    EXPECT_EQ(read_guest<u8>(vm, initrd_addr), 0xab);
+
+    unlink(path.c_str());
+    unlink(initrd_path.c_str());
+}
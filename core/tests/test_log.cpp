@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Logging templates tests.
+
+#include <nullvm/log.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <thread>
+#include <string>
+#include <array>
+
+using namespace nullvm;
+
+TEST(test_log, test_log_runtime_level) {
+    const auto previous = log::level();
+
+    log::set_level(log::Level::Error);
+    EXPECT_FALSE(log::enabled(log::Level::Debug));
+    EXPECT_FALSE(log::enabled(log::Level::Info));
+    EXPECT_TRUE(log::enabled(log::Level::Error));
+    EXPECT_TRUE(log::enabled(log::Level::Panic));
+
+    log::set_level(previous);
+    EXPECT_EQ(log::level(), previous);
+}
+
+TEST(test_log, test_log_compiled_level) {
+    log::set_level(log::Level::Debug);
+
+    EXPECT_EQ(
+        log::enabled(log::Level::Debug),
+        log::COMPILED_LEVEL == log::Level::Debug
+    );
+    EXPECT_TRUE(log::enabled(log::Level::Error));
+
+    log::set_level(log::COMPILED_LEVEL);
+}
+
+TEST(test_log, test_log_custom_format) {
+    const auto msg = log::custom_format("TEST", "value: {}", 42);
+
+    EXPECT_TRUE(msg.ends_with("[TEST] value: 42\n"));
+}
+
+namespace {
+    /// @brief Read all available bytes from non-blocking pipe.
+    ///
+    /// @param [in] fd given pipe read end.
+    ///
+    /// @return Read bytes.
+    auto read_pipe(i32 fd) -> std::string {
+        std::string output;
+        std::array<char, 4096> buffer {};
+
+        while (true) {
+            const auto ret = read(fd, buffer.data(), buffer.size());
+
+            if (ret <= 0)
+                break;
+
+            output.append(buffer.data(), static_cast<usize>(ret));
+        }
+
+        return output;
+    }
+}
+
+TEST(test_log, test_log_async_output) {
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(pipe2(fds.data(), O_NONBLOCK), 0);
+
+    log::set_output(fds[1]);
+
+    std::thread producer([] {
+        log::test("thread {} {}", std::string("value"), 1.5);
+    });
+    producer.join();
+
+    log::test("main {} {}", "value", 42);
+    log::flush();
+    log::set_output(STDOUT_FILENO);
+
+    const auto output = read_pipe(fds[0]);
+    EXPECT_NE(output.find("[TEST] thread value 1.5\n"), std::string::npos);
+    EXPECT_NE(output.find("[TEST] main value 42\n"), std::string::npos);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(test_log, test_log_oversized_record) {
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(pipe2(fds.data(), O_NONBLOCK), 0);
+
+    log::set_output(fds[1]);
+
+    const std::string message(2 * log::backend::MAX_RECORD_SIZE, 'x');
+    log::test("{}", message);
+    log::flush();
+    log::set_output(STDOUT_FILENO);
+
+    const auto output = read_pipe(fds[0]);
+    EXPECT_NE(output.find("[TEST] xxxx"), std::string::npos);
+    EXPECT_LT(output.size(), log::backend::MAX_RECORD_SIZE);
+
+    close(fds[0]);
+    close(fds[1]);
+}
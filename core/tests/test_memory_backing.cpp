@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest memory backing tests.
+
+#include <nullvm/core/memory_backing.hpp>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <bit>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Guest memory size used in tests.
+    constexpr usize MEMORY_SIZE {4 * 1024 * 1024};
+}
+
+TEST(test_memory_backing, test_memory_backing_anonymous) {
+    auto result = map_guest_memory(MEMORY_SIZE, MemoryBacking::Anonymous);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->backing, MemoryBacking::Anonymous);
+    EXPECT_EQ(result->memory.size(), MEMORY_SIZE);
+
+    static_cast<u8*>(result->memory.addr())[MEMORY_SIZE - 1] = 0xff;
+}
+
+TEST(test_memory_backing, test_memory_backing_transparent_huge) {
+    const auto backing = MemoryBacking::TransparentHuge;
+    auto result = map_guest_memory(MEMORY_SIZE, backing);
+
+    ASSERT_TRUE(result.has_value());
+
+    // Transparent huge pages may be disabled on host.
+    if (!transparent_huge_pages()) {
+        EXPECT_EQ(result->backing, MemoryBacking::Anonymous);
+        return;
+    }
+
+    EXPECT_EQ(result->backing, backing);
+
+    const auto addr = std::bit_cast<usize>(result->memory.addr());
+    EXPECT_EQ(addr % page_size(MemoryBacking::HugeTlb2M), 0);
+}
+
+TEST(test_memory_backing, test_memory_backing_unaligned_size) {
+    constexpr usize size {MEMORY_SIZE + 100};
+
+    auto result = map_guest_memory(size, MemoryBacking::TransparentHuge);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_GE(result->memory.size(), size);
+
+    // Tail is rounded up to whole page of resulting backing.
+    const auto page = page_size(result->backing);
+    EXPECT_EQ(result->memory.size() % page, 0);
+
+    static_cast<u8*>(result->memory.addr())[size - 1] = 0xff;
+}
+
+TEST(test_memory_backing, test_memory_backing_fallback) {
+    auto result = map_guest_memory(MEMORY_SIZE, MemoryBacking::HugeTlb1G);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_GE(result->memory.size(), MEMORY_SIZE);
+
+    static_cast<u8*>(result->memory.addr())[MEMORY_SIZE - 1] = 0xff;
+
+    // Fallback never reports transparent huge pages disabled on host.
+    if (result->backing == MemoryBacking::TransparentHuge) {
+        EXPECT_TRUE(transparent_huge_pages());
+    }
+}
+
+TEST(test_memory_backing, test_memory_backing_zero_size) {
+    const auto result = map_guest_memory(0, MemoryBacking::Anonymous);
+
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_memory_backing, test_memory_backing_shared) {
+    auto result = map_guest_memory(
+        MEMORY_SIZE, MemoryBacking::Anonymous, true
+    );
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->backing, MemoryBacking::Anonymous);
+    EXPECT_EQ(result->memory.size(), MEMORY_SIZE);
+
+    const auto fd = result->fd.fd();
+    ASSERT_NE(fd, -1);
+
+    // Memory file size is sealed.
+    const auto seals = fcntl(fd, F_GET_SEALS);
+    EXPECT_NE(seals & F_SEAL_SHRINK, 0);
+    EXPECT_NE(seals & F_SEAL_GROW, 0);
+    EXPECT_NE(seals & F_SEAL_SEAL, 0);
+    EXPECT_EQ(ftruncate(fd, MEMORY_SIZE / 2), -1);
+
+    // Another mapping of memory file shares guest pages.
+    auto view = mmap(nullptr, MEMORY_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    ASSERT_NE(view, MAP_FAILED);
+
+    static_cast<u8*>(result->memory.addr())[MEMORY_SIZE - 1] = 0xff;
+    EXPECT_EQ(static_cast<const u8*>(view)[MEMORY_SIZE - 1], 0xff);
+
+    munmap(view, MEMORY_SIZE);
+}
+
+TEST(test_memory_backing, test_memory_backing_shared_fallback) {
+    auto result = map_guest_memory(
+        MEMORY_SIZE, MemoryBacking::TransparentHuge, true
+    );
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_GE(result->memory.size(), MEMORY_SIZE);
+
+    // Memory files use huge pages only if shmem mode allows it.
+    if (transparent_huge_pages(true)) {
+        EXPECT_EQ(result->backing, MemoryBacking::TransparentHuge);
+
+        const auto addr = std::bit_cast<usize>(result->memory.addr());
+        EXPECT_EQ(addr % page_size(MemoryBacking::HugeTlb2M), 0);
+    }
+    else {
+        EXPECT_EQ(result->backing, MemoryBacking::Anonymous);
+    }
+
+    // Fallback mapping is still a sealed memory file.
+    const auto fd = result->fd.fd();
+    ASSERT_NE(fd, -1);
+
+    const auto seals = fcntl(fd, F_GET_SEALS);
+    EXPECT_NE(seals & F_SEAL_SHRINK, 0);
+    EXPECT_NE(seals & F_SEAL_GROW, 0);
+    EXPECT_NE(seals & F_SEAL_SEAL, 0);
+
+    auto view = mmap(nullptr, MEMORY_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    ASSERT_NE(view, MAP_FAILED);
+
+    static_cast<u8*>(result->memory.addr())[MEMORY_SIZE - 1] = 0xff;
+    EXPECT_EQ(static_cast<const u8*>(view)[MEMORY_SIZE - 1], 0xff);
+
+    munmap(view, MEMORY_SIZE);
+}
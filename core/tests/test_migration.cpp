@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine live migration tests.
+
+#include <nullvm/core/migration.hpp>
+#include <nullvm/core/vm.hpp>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+#include <array>
+#include <bit>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Size of guest RAM used in tests.
+    constexpr usize RAM_SIZE {1024 * 1024};
+
+    /// Guest address of counter incremented by test program.
+    constexpr u64 COUNTER_ADDR {0x1f00};
+
+    /// Real-mode program incrementing counter in a loop.
+    const std::vector<u8> LOOP_CODE = {
+        0x66, 0xff, 0x06, 0x00, 0x1f,   // incl 0x1f00
+        0xeb, 0xf9,                     // jmp 0
+    };
+
+    /// Connected socket pair closed on destruction.
+    struct SocketPair {
+        /// Socket file descriptors.
+        std::array<i32, 2> fds {-1, -1};
+
+        SocketPair() {
+            EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()), 0);
+        }
+
+        ~SocketPair() {
+            close(fds[0]);
+            close(fds[1]);
+        }
+    };
+
+    /// @brief Read counter from guest memory.
+    ///
+    /// @param [in] vm given virtual machine.
+    ///
+    /// @return Counter value.
+    auto read_counter(VirtualMachine& vm) -> u32 {
+        std::array<u8, 4> value {};
+        EXPECT_TRUE(vm.memory().read(COUNTER_ADDR, value).has_value());
+        return std::bit_cast<u32>(value);
+    }
+}
+
+TEST(test_migration, test_migration_running_vm) {
+    const SocketPair sockets;
+
+    VirtualMachine source;
+
+    auto result = source.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = source.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = source.load_raw(LOOP_CODE);
+    EXPECT_TRUE(result.has_value());
+
+    std::jthread guest([&source] {
+        EXPECT_TRUE(source.run().has_value());
+    });
+
+    while (read_counter(source) == 0)
+        std::this_thread::yield();
+
+    VirtualMachine target;
+
+    result = target.init();
+    EXPECT_TRUE(result.has_value());
+
+    VmmResult<None> received = None {};
+
+    std::jthread receiver([&target, &received, &sockets] {
+        received = target.migrate_from(sockets.fds[1]);
+    });
+
+    // Guest may dirty counter page in every round, so rounds are limited.
+    auto stats = source.migrate_to(
+        sockets.fds[0], {.max_rounds = 3, .max_dirty_pages = 0}
+    );
+    receiver.join();
+    guest.join();
+
+    EXPECT_TRUE(stats.has_value());
+    EXPECT_TRUE(received.has_value());
+    EXPECT_GE(stats->rounds, 1);
+    EXPECT_LE(stats->rounds, 3);
+    EXPECT_LT(stats->pages, RAM_SIZE / GUEST_PAGE_SIZE);
+
+    // Target continues from exact state source was paused in.
+    const auto counter = read_counter(source);
+    EXPECT_EQ(read_counter(target), counter);
+
+    auto source_regs = source.vcpu().regs();
+    auto target_regs = target.vcpu().regs();
+    EXPECT_TRUE(source_regs.has_value());
+    EXPECT_TRUE(target_regs.has_value());
+    EXPECT_EQ(source_regs->rip, target_regs->rip);
+
+    std::jthread resumed([&target] {
+        EXPECT_TRUE(target.run().has_value());
+    });
+
+    while (read_counter(target) == counter)
+        std::this_thread::yield();
+
+    target.stop();
+    resumed.join();
+
+    EXPECT_EQ(read_counter(source), counter);
+}
+
+TEST(test_migration, test_migration_target_with_memory) {
+    const SocketPair sockets;
+
+    VirtualMachine target;
+
+    auto result = target.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = target.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = target.migrate_from(sockets.fds[1]);
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_migration, test_migration_invalid_stream) {
+    const SocketPair sockets;
+
+    migration::Channel channel;
+
+    auto result = channel.init(sockets.fds[0]);
+    EXPECT_TRUE(result.has_value());
+
+    // State message arrives before memory layout.
+    const std::array<u8, 4> payload {1, 2, 3, 4};
+    result = channel.send(migration::MessageType::State, 0, payload);
+    EXPECT_TRUE(result.has_value());
+
+    VirtualMachine target;
+
+    result = target.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = target.migrate_from(sockets.fds[1]);
+    EXPECT_FALSE(result.has_value());
+}
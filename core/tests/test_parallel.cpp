@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Parallel memory operations tests.
+
+#include <nullvm/core/utils/parallel.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+TEST(test_parallel, test_parallel_copy_small) {
+    const std::vector<u8> src = {1, 2, 3, 4, 5};
+    std::vector<u8> dst(src.size());
+
+    utils::parallel_copy(dst, src);
+    EXPECT_EQ(dst, src);
+}
+
+TEST(test_parallel, test_parallel_copy_large) {
+    const auto size = 5 * utils::PARALLEL_CHUNK_SIZE + 123;
+
+    std::vector<u8> src(size);
+    std::vector<u8> dst(size + 1, 0xff);
+
+    for (usize i = 0; i < size; ++i)
+        src[i] = static_cast<u8>(i * 7);
+
+    utils::parallel_copy(dst, src);
+
+    EXPECT_TRUE(std::equal(src.begin(), src.end(), dst.begin()));
+    EXPECT_EQ(dst.back(), 0xff);
+}
+
+TEST(test_parallel, test_parallel_fill_large) {
+    const auto size = 3 * utils::PARALLEL_CHUNK_SIZE + 4097;
+    std::vector<u8> dst(size, 0xff);
+
+    utils::parallel_fill(dst, 0);
+
+    EXPECT_TRUE(std::ranges::all_of(dst, [](u8 byte) { return byte == 0; }));
+}
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// 16550 UART serial console device tests.
+
+#include <nullvm/core/devices/serial.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string>
+#include <array>
+
+using namespace nullvm::core;
+using namespace nullvm;
+using devices::Serial;
+
+namespace {
+    auto read_pipe(i32 fd) -> std::string {
+        std::string output(4096, '\0');
+        const auto ret = read(fd, output.data(), output.size());
+        output.resize(ret > 0 ? static_cast<usize>(ret) : 0);
+        return output;
+    }
+}
+
+TEST(test_serial, test_serial_write_string) {
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(pipe2(fds.data(), O_NONBLOCK), 0);
+
+    {
+        Serial serial;
+        auto result = serial.init(fds[1]);
+        EXPECT_TRUE(result.has_value());
+
+        const std::string text = "hello, world\n";
+        const auto data = std::span(
+            std::bit_cast<const u8*>(text.data()), text.size()
+        );
+
+        result = serial.write(0, data, 1);
+        EXPECT_TRUE(result.has_value());
+
+        serial.flush();
+        EXPECT_EQ(read_pipe(fds[0]), text);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(test_serial, test_serial_divisor_latch) {
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(pipe2(fds.data(), O_NONBLOCK), 0);
+
+    {
+        Serial serial;
+        auto result = serial.init(fds[1]);
+        EXPECT_TRUE(result.has_value());
+
+        // Set DLAB and write divisor, it should not be transmitted.
+        const std::array<u8, 1> lcr = {0x80};
+        const std::array<u8, 1> dll = {0x01};
+        EXPECT_TRUE(serial.write(3, lcr, 1).has_value());
+        EXPECT_TRUE(serial.write(0, dll, 1).has_value());
+
+        std::array<u8, 1> value {};
+        EXPECT_TRUE(serial.read(0, value, 1).has_value());
+        EXPECT_EQ(value[0], 0x01);
+
+        serial.flush();
+        EXPECT_EQ(read_pipe(fds[0]), "");
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(test_serial, test_serial_line_status) {
+    Serial serial;
+    auto result = serial.init(STDOUT_FILENO);
+    EXPECT_TRUE(result.has_value());
+
+    std::array<u8, 2> value {};
+    result = serial.read(5, value, 1);
+    EXPECT_TRUE(result.has_value());
+
+    // Transmitter is always ready, string reads fill every access.
+    EXPECT_EQ(value[0] & 0x60, 0x60);
+    EXPECT_EQ(value[1] & 0x60, 0x60);
+}
+
+TEST(test_serial, test_serial_invalid_access_size) {
+    Serial serial;
+
+    const std::array<u8, 3> data = {1, 2, 3};
+    auto result = serial.write(0, data, 2);
+    EXPECT_FALSE(result.has_value());
+
+    result = serial.write(0, data, 0);
+    EXPECT_FALSE(result.has_value());
+}
@@ -0,0 +1,391 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine snapshot tests.
+
+#include <nullvm/core/snapshot.hpp>
+#include <nullvm/core/vm.hpp>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <array>
+
+using namespace nullvm::core;
+using namespace nullvm;
+
+namespace {
+    /// Size of guest RAM used in tests.
+    constexpr usize RAM_SIZE {1024 * 1024};
+
+    /// Guest address of counter incremented by test program.
+    constexpr u64 COUNTER_ADDR {0x1f00};
+
+    /// Real-mode program incrementing counter before each halt.
+    const std::vector<u8> COUNTER_CODE = {
+        0xfe, 0x06, 0x00, 0x1f,     // incb 0x1f00
+        0xf4,                       // hlt
+        0xeb, 0xf9,                 // jmp 0
+    };
+
+    /// Snapshot files removed on destruction.
+    struct SnapshotFiles {
+        /// State file path.
+        std::string state {"/tmp/nullvm_snapshot_state_XXXXXX"};
+        /// Memory file path.
+        std::string memory {"/tmp/nullvm_snapshot_memory_XXXXXX"};
+
+        SnapshotFiles() {
+            close(mkstemp(state.data()));
+            close(mkstemp(memory.data()));
+        }
+
+        ~SnapshotFiles() {
+            unlink(state.c_str());
+            unlink(memory.c_str());
+        }
+    };
+
+    /// @brief Read counter from guest memory.
+    ///
+    /// @param [in] vm given virtual machine.
+    ///
+    /// @return Counter value.
+    auto read_counter(VirtualMachine& vm) -> u8 {
+        std::array<u8, 1> value {};
+        EXPECT_TRUE(vm.memory().read(COUNTER_ADDR, value).has_value());
+        return value[0];
+    }
+
+    /// @brief Run counter program once and save snapshot.
+    ///
+    /// @param [in] files given snapshot files.
+    auto create_template(const SnapshotFiles& files) -> void {
+        VirtualMachine vm;
+
+        auto result = vm.init();
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.set_mem_region(0x0, RAM_SIZE);
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.load_raw(COUNTER_CODE);
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.run();
+        EXPECT_TRUE(result.has_value());
+        EXPECT_EQ(read_counter(vm), 1);
+
+        result = vm.snapshot(files.state, files.memory);
+        EXPECT_TRUE(result.has_value());
+    }
+}
+
+TEST(test_snapshot, test_snapshot_restore) {
+    const SnapshotFiles files;
+    create_template(files);
+
+    // Each clone continues after halt and increments its own copy.
+    for (usize i = 0; i < 2; ++i) {
+        VirtualMachine vm;
+
+        auto result = vm.init();
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.restore(files.state, files.memory);
+        EXPECT_TRUE(result.has_value());
+        EXPECT_EQ(read_counter(vm), 1);
+
+        auto regs = vm.vcpu().regs();
+        EXPECT_TRUE(regs.has_value());
+        EXPECT_EQ(regs->rip, 0x5);
+
+        result = vm.run();
+        EXPECT_TRUE(result.has_value());
+        EXPECT_EQ(read_counter(vm), 2);
+    }
+}
+
+TEST(test_snapshot, test_snapshot_memory_file_sparse) {
+    const SnapshotFiles files;
+    create_template(files);
+
+    struct stat info {};
+    EXPECT_EQ(stat(files.memory.c_str(), &info), 0);
+
+    // Only pages with code and counter are stored.
+    EXPECT_EQ(static_cast<usize>(info.st_size), RAM_SIZE);
+    EXPECT_LT(static_cast<usize>(info.st_blocks) * 512, RAM_SIZE / 4);
+
+    auto state = snapshot::read_state(files.state);
+    EXPECT_TRUE(state.has_value());
+    EXPECT_EQ(state->vcpus.size(), 1);
+    EXPECT_EQ(state->regions.size(), 1);
+    EXPECT_FALSE(state->vcpus[0].msrs.empty());
+}
+
+TEST(test_snapshot, test_snapshot_extended_state) {
+    // XMM0 and XSTATE_BV offsets in XSAVE area, in 32-bit words.
+    constexpr usize XMM0_INDEX {160 / sizeof(u32)};
+    constexpr usize XSTATE_BV_INDEX {512 / sizeof(u32)};
+
+    const SnapshotFiles files;
+    VirtualMachine source;
+
+    auto result = source.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = source.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = source.load_raw(COUNTER_CODE);
+    EXPECT_TRUE(result.has_value());
+
+    result = source.run();
+    EXPECT_TRUE(result.has_value());
+
+    // State not covered by registers, FPU and MSRs.
+    auto& vcpu = source.vcpu();
+
+    auto xsave = vcpu.xsave();
+    ASSERT_TRUE(xsave.has_value()) << xsave.error();
+    xsave.value()[XMM0_INDEX] = 0x12345678;
+    // SSE state is marked as used, otherwise XMM registers are zeroed.
+    xsave.value()[XSTATE_BV_INDEX] |= 0x2;
+    EXPECT_TRUE(vcpu.set_xsave(xsave.value()).has_value());
+
+    auto debugregs = vcpu.debugregs();
+    ASSERT_TRUE(debugregs.has_value());
+    debugregs->db[0] = 0x1000;
+    EXPECT_TRUE(vcpu.set_debugregs(debugregs.value()).has_value());
+
+    auto events = vcpu.vcpu_events();
+    ASSERT_TRUE(events.has_value());
+    events->nmi.masked = 1;
+    EXPECT_TRUE(vcpu.set_vcpu_events(events.value()).has_value());
+
+    const auto xcrs = vcpu.xcrs();
+    ASSERT_TRUE(xcrs.has_value());
+
+    result = source.snapshot(files.state, files.memory);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    auto state = snapshot::read_state(files.state);
+    ASSERT_TRUE(state.has_value());
+    const auto clock = state->clock.clock;
+
+    VirtualMachine target;
+
+    result = target.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = target.restore(files.state, files.memory);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    auto& restored = target.vcpu();
+
+    xsave = restored.xsave();
+    ASSERT_TRUE(xsave.has_value());
+    EXPECT_EQ(xsave.value()[XMM0_INDEX], 0x12345678u);
+
+    debugregs = restored.debugregs();
+    ASSERT_TRUE(debugregs.has_value());
+    EXPECT_EQ(debugregs->db[0], 0x1000u);
+
+    events = restored.vcpu_events();
+    ASSERT_TRUE(events.has_value());
+    EXPECT_EQ(events->nmi.masked, 1);
+
+    const auto restored_xcrs = restored.xcrs();
+    ASSERT_TRUE(restored_xcrs.has_value());
+    ASSERT_EQ(restored_xcrs->nr_xcrs, xcrs->nr_xcrs);
+    EXPECT_EQ(restored_xcrs->xcrs[0].value, xcrs->xcrs[0].value);
+
+    // Guest clock continues from saved value.
+    const SnapshotFiles second;
+    result = target.snapshot(second.state, second.memory);
+    ASSERT_TRUE(result.has_value());
+
+    state = snapshot::read_state(second.state);
+    ASSERT_TRUE(state.has_value());
+    EXPECT_GE(state->clock.clock, clock);
+    EXPECT_LT(state->clock.clock - clock, 1'000'000'000u);
+}
+
+TEST(test_snapshot, test_snapshot_irqchip) {
+    const SnapshotFiles files;
+    VirtualMachine source;
+
+    auto result = source.init({.irqchip = true});
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    result = source.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    // PIC ports are emulated in kernel, only the last write exits.
+    const std::vector<u8> code = {
+        0xb0, 0x11,         // mov $0x11, %al (ICW1: edge, ICW4 needed)
+        0xe6, 0x20,         // out %al, $0x20
+        0xb0, 0x08,         // mov $0x08, %al (ICW2: vectors 8-15)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0x04,         // mov $0x04, %al (ICW3: slave on IRQ2)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0x01,         // mov $0x01, %al (ICW4: 8086 mode)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0xdf,         // mov $0xdf, %al (unmask IRQ5 only)
+        0xe6, 0x21,         // out %al, $0x21
+        0xe6, 0xf0,         // out %al, $0xf0
+    };
+
+    result = source.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    const auto halt = [](kvm_run&) -> VmmResult<ExitAction> {
+        return ExitAction::Halt;
+    };
+
+    result = source.set_exit_handler(KVM_EXIT_IO, halt);
+    EXPECT_TRUE(result.has_value());
+
+    result = source.run();
+    EXPECT_TRUE(result.has_value());
+
+    result = source.snapshot(files.state, files.memory);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    auto state = snapshot::read_state(files.state);
+    ASSERT_TRUE(state.has_value());
+    ASSERT_TRUE(state->irqchip.has_value());
+    EXPECT_TRUE(state->vcpus[0].lapic.has_value());
+    EXPECT_EQ(state->irqchip->pic_master.chip.pic.irq_base, 0x08);
+    EXPECT_EQ(state->irqchip->pic_master.chip.pic.imr, 0xdf);
+
+    const auto pit = state->irqchip->pit;
+
+    // Irqchip state cannot be restored without in-kernel irqchip.
+    VirtualMachine plain;
+
+    result = plain.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = plain.restore(files.state, files.memory);
+    EXPECT_FALSE(result.has_value());
+
+    VirtualMachine target;
+
+    result = target.init({.irqchip = true});
+    EXPECT_TRUE(result.has_value());
+
+    result = target.restore(files.state, files.memory);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    // Restored controllers are saved again unchanged.
+    const SnapshotFiles second;
+    result = target.snapshot(second.state, second.memory);
+    ASSERT_TRUE(result.has_value());
+
+    state = snapshot::read_state(second.state);
+    ASSERT_TRUE(state.has_value());
+    ASSERT_TRUE(state->irqchip.has_value());
+    EXPECT_EQ(state->irqchip->pic_master.chip.pic.irq_base, 0x08);
+    EXPECT_EQ(state->irqchip->pic_master.chip.pic.imr, 0xdf);
+    EXPECT_EQ(state->irqchip->pit.channels[0].mode, pit.channels[0].mode);
+    EXPECT_EQ(state->irqchip->pit.flags, pit.flags);
+}
+
+TEST(test_snapshot, test_snapshot_restore_invalid) {
+    const SnapshotFiles files;
+    create_template(files);
+
+    VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 2});
+    EXPECT_TRUE(result.has_value());
+
+    // Number of virtual CPUs mismatch.
+    result = vm.restore(files.state, files.memory);
+    EXPECT_FALSE(result.has_value());
+
+    // Memory file used as state file.
+    result = vm.restore(files.memory, files.memory);
+    EXPECT_FALSE(result.has_value());
+
+    result = vm.add_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.restore(files.state, files.memory);
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_snapshot, test_snapshot_diff) {
+    const SnapshotFiles base;
+    const SnapshotFiles diff;
+
+    VirtualMachine vm;
+
+    auto result = vm.init({.dirty_logging = true});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.load_raw(COUNTER_CODE);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.snapshot(base.state, base.memory);
+    EXPECT_TRUE(result.has_value());
+
+    // Guest dirties only counter page.
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(read_counter(vm), 2);
+
+    // Failed snapshot keeps dirty pages for the next one.
+    result = vm.snapshot(
+        "/nonexistent/nullvm_state", diff.memory, SnapshotType::Diff
+    );
+    EXPECT_FALSE(result.has_value());
+
+    result = vm.snapshot(diff.state, diff.memory, SnapshotType::Diff);
+    EXPECT_TRUE(result.has_value());
+
+    struct stat info {};
+    EXPECT_EQ(stat(diff.memory.c_str(), &info), 0);
+    EXPECT_EQ(static_cast<usize>(info.st_size), RAM_SIZE);
+    EXPECT_LE(static_cast<usize>(info.st_blocks) * 512, GUEST_PAGE_SIZE);
+
+    result = snapshot::merge_memory(diff.memory, base.memory);
+    EXPECT_TRUE(result.has_value());
+
+    VirtualMachine clone;
+
+    result = clone.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = clone.restore(diff.state, base.memory);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(read_counter(clone), 2);
+
+    result = clone.run();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(read_counter(clone), 3);
+}
+
+TEST(test_snapshot, test_snapshot_diff_without_dirty_logging) {
+    const SnapshotFiles files;
+
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x0, RAM_SIZE);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.snapshot(files.state, files.memory, SnapshotType::Diff);
+    EXPECT_FALSE(result.has_value());
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Lock-free single-producer single-consumer ring buffer tests.
+
+#include <nullvm/core/utils/spsc_ring.hpp>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <array>
+
+using namespace nullvm::core;
+using namespace nullvm;
+using utils::SpscRing;
+
+TEST(test_spsc_ring, test_spsc_ring_capacity) {
+    SpscRing<u8> ring(100);
+
+    EXPECT_EQ(ring.capacity(), 128);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(test_spsc_ring, test_spsc_ring_push_pop) {
+    SpscRing<u8> ring(8);
+
+    const std::array<u8, 5> input = {1, 2, 3, 4, 5};
+    EXPECT_EQ(ring.push(input), 5);
+    EXPECT_EQ(ring.size(), 5);
+
+    std::array<u8, 8> output {};
+    EXPECT_EQ(ring.pop(output), 5);
+    EXPECT_TRUE(std::equal(input.begin(), input.end(), output.begin()));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(test_spsc_ring, test_spsc_ring_full) {
+    SpscRing<u8> ring(4);
+
+    const std::array<u8, 6> input = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(ring.push(input), 4);
+    EXPECT_EQ(ring.push(input), 0);
+}
+
+TEST(test_spsc_ring, test_spsc_ring_try_push) {
+    SpscRing<u8> ring(4);
+
+    const std::array<u8, 3> input = {1, 2, 3};
+    EXPECT_TRUE(ring.try_push(input));
+    EXPECT_FALSE(ring.try_push(input));
+    EXPECT_EQ(ring.size(), 3);
+}
+
+TEST(test_spsc_ring, test_spsc_ring_wrap_around) {
+    SpscRing<u8> ring(4);
+    std::array<u8, 4> output {};
+
+    const std::array<u8, 3> first = {1, 2, 3};
+    EXPECT_EQ(ring.push(first), 3);
+    EXPECT_EQ(ring.pop(std::span(output).first(2)), 2);
+
+    const std::array<u8, 3> second = {4, 5, 6};
+    EXPECT_EQ(ring.push(second), 3);
+    EXPECT_EQ(ring.pop(output), 4);
+
+    const std::array<u8, 4> expected = {3, 4, 5, 6};
+    EXPECT_EQ(output, expected);
+}
+
+TEST(test_spsc_ring, test_spsc_ring_concurrent) {
+    constexpr usize count = 1 << 16;
+    SpscRing<u32> ring(1024);
+
+    std::vector<u32> input(count);
+    std::iota(input.begin(), input.end(), 0);
+
+    auto producer = std::thread([&ring, &input] {
+        auto data = std::span<const u32>(input);
+
+        while (!data.empty()) {
+            const auto chunk = data.first(std::min<usize>(data.size(), 100));
+            const auto pushed = ring.push(chunk);
+
+            if (pushed == 0)
+                std::this_thread::yield();
+
+            data = data.subspan(pushed);
+        }
+    });
+
+    std::vector<u32> output;
+    output.reserve(count);
+    std::array<u32, 64> buffer {};
+
+    while (output.size() < count) {
+        const auto popped = ring.pop(buffer);
+
+        if (popped == 0)
+            std::this_thread::yield();
+
+        output.insert(output.end(), buffer.begin(), buffer.begin() + popped);
+    }
+
+    producer.join();
+    EXPECT_EQ(input, output);
+}
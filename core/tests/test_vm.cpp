@@ -5,8 +5,15 @@
 
 #include <nullvm/core/vm.hpp>
 #include <gtest/gtest.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <thread>
+#include <string>
 #include <vector>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <utility>
 
 using namespace nullvm::core;
 using namespace nullvm;
@@ -101,4 +108,736 @@ TEST(test_vm, test_vm_run1) {
 
     result = vm.run();
     EXPECT_TRUE(result.has_value());
-}
\ No newline at end of file
+}
+
+TEST(test_vm, test_vm_run_huge_memory_backing) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.memory_backing = MemoryBacking::HugeTlb2M});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x0, 0x200000);
+    EXPECT_TRUE(result.has_value());
+    EXPECT_NE(vm.memory_backing(), MemoryBacking::HugeTlb1G);
+
+    const std::vector<u8> code = {
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+}
+
+TEST(test_vm, test_vm_run_shared_memory) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.shared_memory = true});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    const auto ranges = vm.memory().ranges();
+    ASSERT_EQ(ranges.size(), 1u);
+    ASSERT_NE(ranges[0].fd, -1);
+
+    const std::vector<u8> code = {
+        0xc6, 0x06, 0x00, 0x18, 0x2a,   // movb $0x2a, (0x1800)
+        0xf4,                           // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    // Guest write is visible through memory file without copying.
+    u8 value {0};
+    EXPECT_EQ(pread(ranges[0].fd, &value, 1, 0x800), 1);
+    EXPECT_EQ(value, 0x2a);
+}
+
+TEST(test_vm, test_vm_vcpu_register_cache) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    auto& vcpu = vm.vcpu();
+    const auto sync = vcpu.sync_regs();
+
+    if (sync != 0) {
+        EXPECT_NE(sync & KVM_SYNC_X86_REGS, 0u);
+        EXPECT_NE(sync & KVM_SYNC_X86_SREGS, 0u);
+    }
+
+    auto regs = vcpu.regs().value();
+    EXPECT_EQ(regs.rflags, 0x2u);
+    EXPECT_EQ(regs.rax, 0u);
+
+    regs.rax = 4;
+    regs.rbx = 2;
+    result = vcpu.set_regs(regs);
+    EXPECT_TRUE(result.has_value());
+
+    // Written registers are read back before entering the guest.
+    EXPECT_EQ(vcpu.regs().value().rax, 4u);
+    EXPECT_EQ(vcpu.sregs().value().cs.base, 0u);
+
+    if (sync != 0) {
+        EXPECT_NE(vcpu.state()->kvm_dirty_regs & KVM_SYNC_X86_REGS, 0u);
+    }
+
+    const std::vector<u8> code = {
+        0x00, 0xd8,     // add %bl, %al
+        0xf4,           // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    // Registers after exit come from kvm_run or from a fresh ioctl.
+    regs = vcpu.regs().value();
+    EXPECT_EQ(regs.rax, 6u);
+    EXPECT_EQ(regs.rbx, 2u);
+    EXPECT_EQ(regs.rip, 0x1003u);
+    EXPECT_EQ(vcpu.sregs().value().cs.selector, 0u);
+}
+
+TEST(test_vm, test_vm_vcpu_register_flush) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    auto& vcpu = vm.vcpu();
+
+    // EFER.LME is set through special registers and read back as MSR.
+    constexpr u32 MSR_EFER {0xc0000080};
+    constexpr u64 EFER_LME {1 << 8};
+
+    auto sregs = vcpu.sregs().value();
+    sregs.efer |= EFER_LME;
+    result = vcpu.set_sregs(sregs);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u32, 1> indices = {MSR_EFER};
+    const auto msrs = vcpu.msrs(indices);
+    ASSERT_TRUE(msrs.has_value());
+    ASSERT_EQ(msrs->size(), 1u);
+    EXPECT_NE(msrs->front().data & EFER_LME, 0u);
+
+    // Pending register sets are applied before MSRs are accessed.
+    EXPECT_EQ(vcpu.state()->kvm_dirty_regs, 0u);
+
+    result = vcpu.flush();
+    EXPECT_TRUE(result.has_value());
+}
+
+TEST(test_vm, test_vm_creation_zero_vcpus) {
+    VirtualMachine vm;
+    const auto result = vm.init({.vcpus = 0});
+
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_vm, test_vm_run_multiple_vcpus) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 4, .affinity = {0, std::nullopt, 0}});
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(vm.vcpus_count(), 4);
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 5> code = {
+        0xb0, '\n',         // mov $'\n', %al
+        0xe6, 0xf8,         // out %al, $0xf8
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+}
+
+TEST(test_vm, test_vm_exit_stats) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 2});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    const std::vector<u8> code = {
+        0xe6, 0xf8,         // out %al, $0xf8
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    EXPECT_EQ(vm.exit_stats().exits(), 0u);
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    for (usize id = 0; id < vm.vcpus_count(); ++id) {
+        const auto stats = vm.exit_stats(id);
+
+        EXPECT_EQ(stats.reasons[KVM_EXIT_IO].count, 1u);
+        EXPECT_EQ(stats.reasons[KVM_EXIT_HLT].count, 1u);
+        EXPECT_GT(stats.guest_time().count(), 0);
+    }
+
+    const auto total = vm.exit_stats();
+    EXPECT_EQ(total.reasons[KVM_EXIT_IO].count, 2u);
+    EXPECT_EQ(total.reasons[KVM_EXIT_HLT].count, 2u);
+    EXPECT_EQ(total.guest.count, total.exits());
+    EXPECT_EQ(total.handle.count, total.exits());
+}
+
+TEST(test_vm, test_vm_stop) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 2});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 4> code = {
+        0xe6, 0xf8,         // out %al,$0xf8
+        0xeb, 0xfe,         // jmp .
+    };
+
+    result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+    EXPECT_TRUE(result.has_value());
+
+    // Guest is known to be running once it reaches the exit handler.
+    std::atomic_flag entered;
+
+    result = vm.set_exit_handler(
+        KVM_EXIT_IO, [&entered](kvm_run&) -> VmmResult<ExitAction> {
+            entered.test_and_set();
+            entered.notify_all();
+            return ExitAction::Continue;
+        }
+    );
+    EXPECT_TRUE(result.has_value());
+
+    auto stopper = std::thread([&vm, &entered] {
+        entered.wait(false);
+        vm.stop();
+    });
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    stopper.join();
+}
+
+TEST(test_vm, test_vm_stop_before_run) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 4> code = {
+        0xe6, 0xf8,         // out %al,$0xf8
+        0xeb, 0xfe,         // jmp .
+    };
+
+    result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+    EXPECT_TRUE(result.has_value());
+
+    // Stop requested before run() must not be lost, guest is not entered.
+    vm.stop();
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(vm.exit_stats().exits(), 0u);
+
+    // Request is consumed, next run() enters the guest again.
+    result = vm.set_exit_handler(
+        KVM_EXIT_IO, [](kvm_run&) -> VmmResult<ExitAction> {
+            return ExitAction::Halt;
+        }
+    );
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(vm.exit_stats().reasons[KVM_EXIT_IO].count, 1u);
+}
+
+TEST(test_vm, test_vm_ioeventfd) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    utils::EventFd eventfd;
+    result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.register_ioeventfd(eventfd, 0x80, 1, true);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 7> code = {
+        0xb0, 0x01,         // mov $1, %al
+        0xe6, 0x80,         // out %al, $0x80
+        0xe6, 0x80,         // out %al, $0x80
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    auto value = eventfd.read();
+    EXPECT_TRUE(value.has_value());
+    EXPECT_EQ(value.value(), 2);
+}
+
+TEST(test_vm, test_vm_coalesced_io) {
+    /// Device recording every written byte with its offset.
+    class TestDevice final : public devices::Device {
+    public:
+        std::vector<std::pair<u64, u8>> written;
+
+        auto read(u64, std::span<u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            std::ranges::fill(data, 0xff);
+            return None {};
+        }
+
+        auto write(u64 offset, std::span<const u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            written.emplace_back(offset, data.front());
+            return None {};
+        }
+    };
+
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    auto port = std::make_shared<TestDevice>();
+    result = vm.pio_bus().insert(0x90, 1, port);
+    EXPECT_TRUE(result.has_value());
+
+    auto mmio = std::make_shared<TestDevice>();
+    result = vm.mmio_bus().insert(0xe000, 0x10, mmio);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.register_coalesced_io(0x90, 1, true);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.register_coalesced_io(0xe000, 0x10, false);
+    EXPECT_TRUE(result.has_value());
+
+    const std::vector<u8> code = {
+        0xb0, 0x01,         // mov $1, %al
+        0xe6, 0x90,         // out %al, $0x90
+        0xb0, 0x02,         // mov $2, %al
+        0xe6, 0x90,         // out %al, $0x90
+        0xb0, 0x03,         // mov $3, %al
+        0xe6, 0x90,         // out %al, $0x90
+        0xb0, 0x04,         // mov $4, %al
+        0xa2, 0x00, 0xe0,   // mov %al, (0xe000)
+        0xb0, 0x05,         // mov $5, %al
+        0xa2, 0x04, 0xe0,   // mov %al, (0xe004)
+        0xf4,               // hlt
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    // Writes are batched in ring instead of exiting one by one.
+    const auto stats = vm.exit_stats();
+    EXPECT_EQ(stats.reasons[KVM_EXIT_IO].count, 0u);
+    EXPECT_EQ(stats.reasons[KVM_EXIT_MMIO].count, 0u);
+
+    // Ring is drained to devices in guest order.
+    const std::vector<std::pair<u64, u8>> port_writes = {
+        {0, 1}, {0, 2}, {0, 3},
+    };
+    const std::vector<std::pair<u64, u8>> mmio_writes = {
+        {0, 4}, {4, 5},
+    };
+
+    EXPECT_EQ(port->written, port_writes);
+    EXPECT_EQ(mmio->written, mmio_writes);
+}
+
+TEST(test_vm, test_vm_serial_string_io) {
+    std::array<i32, 2> fds {};
+    ASSERT_EQ(pipe(fds.data()), 0);
+
+    {
+        VirtualMachine vm;
+
+        auto result = vm.init({.vcpus = 1, .console_fd = fds[1]});
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.set_mem_region(0x1000, 0x1000);
+        EXPECT_TRUE(result.has_value());
+
+        const std::array<u8, 19> code = {
+            0xbe, 0x0d, 0x10,   // mov $0x100d, %si
+            0xb9, 0x06, 0x00,   // mov $6, %cx
+            0xba, 0xf8, 0x03,   // mov $0x3f8, %dx
+            0xfc,               // cld
+            0xf3, 0x6e,         // rep outsb
+            0xf4,               // hlt
+            'h', 'e', 'l', 'l', 'o', '\n',
+        };
+
+        result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.run();
+        EXPECT_TRUE(result.has_value());
+    }
+
+    std::string output(16, '\0');
+    const auto ret = read(fds[0], output.data(), output.size());
+    ASSERT_GT(ret, 0);
+    output.resize(static_cast<usize>(ret));
+
+    EXPECT_EQ(output, "hello\n");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(test_vm, test_vm_mmio_device) {
+    /// Device returning constant value and recording last written byte.
+    class TestDevice final : public devices::Device {
+    public:
+        u8 written {0};
+
+        auto read(u64, std::span<u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            std::ranges::fill(data, 0x24);
+            return None {};
+        }
+
+        auto write(u64, std::span<const u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            written = data.front();
+            return None {};
+        }
+    };
+
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    auto device = std::make_shared<TestDevice>();
+    result = vm.mmio_bus().insert(0xd000, 0x1000, device);
+    EXPECT_TRUE(result.has_value());
+
+    const std::array<u8, 9> code = {
+        0xc6, 0x06, 0x00, 0xd0, 0x42,   // movb $0x42, 0xd000
+        0xa0, 0x04, 0xd0,               // mov 0xd004, %al
+        0xf4,                           // hlt
+    };
+
+    result = vm.load_raw(std::vector<u8>(code.begin(), code.end()));
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    auto regs = vm.vcpu().regs();
+    EXPECT_TRUE(regs.has_value());
+
+    EXPECT_EQ(device->written, 0x42);
+    EXPECT_EQ(regs.value().rax & 0xff, 0x24);
+}
+
+TEST(test_vm, test_vm_irqchip) {
+    VirtualMachine vm;
+
+    auto result = vm.init({.irqchip = true});
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    // Local APIC is emulated in kernel.
+    auto lapic = vm.vcpu().lapic();
+    EXPECT_TRUE(lapic.has_value());
+    EXPECT_TRUE(lapic.value().has_value());
+
+    utils::EventFd eventfd;
+    result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.register_irqfd(eventfd, 4);
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.unregister_irqfd(eventfd, 4);
+    EXPECT_TRUE(result.has_value());
+
+    // Interrupts cannot be injected without in-kernel irqchip.
+    VirtualMachine plain;
+    result = plain.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = plain.register_irqfd(eventfd, 4);
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_vm, test_vm_irqfd) {
+    /// Device recording last written byte.
+    class TestDevice final : public devices::Device {
+    public:
+        std::atomic<u8> written {0};
+
+        auto read(u64, std::span<u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            std::ranges::fill(data, 0xff);
+            return None {};
+        }
+
+        auto write(u64, std::span<const u8> data, u32) noexcept
+        -> VmmResult<None> override {
+            written.store(data.front());
+            return None {};
+        }
+    };
+
+    VirtualMachine vm;
+
+    auto result = vm.init({.irqchip = true});
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    // Real mode interrupt vector table.
+    result = vm.add_mem_region(0x0, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    auto device = std::make_shared<TestDevice>();
+    result = vm.pio_bus().insert(0xf0, 1, device);
+    EXPECT_TRUE(result.has_value());
+
+    utils::EventFd eventfd;
+    result = eventfd.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.register_irqfd(eventfd, 5);
+    EXPECT_TRUE(result.has_value());
+
+    // IRQ5 is vector 13 after PIC remapping, its handler is at 0x1018.
+    const std::array<u8, 4> vector = {0x18, 0x10, 0x00, 0x00};
+    result = vm.memory().write(13 * 4, vector);
+    EXPECT_TRUE(result.has_value());
+
+    auto regs = vm.vcpu().regs().value();
+    regs.rsp = 0x2000;
+    result = vm.vcpu().set_regs(regs);
+    EXPECT_TRUE(result.has_value());
+
+    const std::vector<u8> code = {
+        0xb0, 0x11,         // mov $0x11, %al (ICW1: edge, ICW4 needed)
+        0xe6, 0x20,         // out %al, $0x20
+        0xb0, 0x08,         // mov $0x08, %al (ICW2: vectors 8-15)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0x04,         // mov $0x04, %al (ICW3: slave on IRQ2)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0x01,         // mov $0x01, %al (ICW4: 8086 mode)
+        0xe6, 0x21,         // out %al, $0x21
+        0xb0, 0xdf,         // mov $0xdf, %al (unmask IRQ5 only)
+        0xe6, 0x21,         // out %al, $0x21
+        0xfb,               // sti
+        0xf4,               // 1: hlt
+        0xeb, 0xfd,         // jmp 1b
+        0xb0, 0x2a,         // handler: mov $0x2a, %al
+        0xe6, 0xf0,         // out %al, $0xf0
+        0xb0, 0x20,         // mov $0x20, %al (EOI)
+        0xe6, 0x20,         // out %al, $0x20
+        0xcf,               // iret
+    };
+
+    result = vm.load_raw(code);
+    EXPECT_TRUE(result.has_value());
+
+    // Interrupt is raised from another thread while guest sleeps in
+    // kernel on hlt.
+    std::thread trigger([&vm, &eventfd, &device] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_TRUE(eventfd.write().has_value());
+
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (device->written.load() == 0 &&
+               std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        vm.stop();
+    });
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    trigger.join();
+    EXPECT_EQ(device->written.load(), 0x2a);
+}
+
+namespace {
+    /// @brief Create temporary image file storing byte to 0x1f00 and halting.
+    ///
+    /// @return Path to image file.
+    auto create_store_image() -> std::string {
+        std::string path = "/tmp/nullvm_image_XXXXXX";
+        const auto fd = mkstemp(path.data());
+
+        std::vector<u8> image(0x1000, 0);
+        const std::array<u8, 6> code = {
+            0xc6, 0x06, 0x00, 0x1f, 0x42,   // movb $0x42, 0x1f00
+            0xf4,                           // hlt
+        };
+        std::ranges::copy(code, image.begin());
+
+        [[maybe_unused]]
+        const auto ret = write(fd, image.data(), image.size());
+        close(fd);
+
+        return path;
+    }
+
+    /// @brief Run image mapped at 0x1000 and read byte at 0x1f00.
+    ///
+    /// @param [in] path given path to image file.
+    /// @param [in] mapping given image mapping mode.
+    ///
+    /// @return Guest byte at 0x1f00 after run.
+    auto run_image(const std::string& path, ImageMapping mapping) -> u8 {
+        VirtualMachine vm;
+
+        auto result = vm.init();
+        EXPECT_TRUE(result.has_value());
+
+        result = vm.load_image(path, 0x1000, mapping);
+        EXPECT_TRUE(result.has_value());
+
+        auto regs = vm.vcpu().regs();
+        EXPECT_TRUE(regs.has_value());
+
+        regs->rip = 0x1000;
+        EXPECT_TRUE(vm.vcpu().set_regs(regs.value()).has_value());
+
+        result = vm.run();
+        EXPECT_TRUE(result.has_value());
+
+        std::array<u8, 1> value {};
+        EXPECT_TRUE(vm.memory().read(0x1f00, value).has_value());
+
+        return value.front();
+    }
+
+    /// @brief Read byte of file.
+    ///
+    /// @param [in] path given path to file.
+    /// @param [in] offset given byte offset.
+    ///
+    /// @return File byte.
+    auto read_file_byte(const std::string& path, off_t offset) -> u8 {
+        const auto fd = open(path.c_str(), O_RDONLY);
+        u8 value {0xff};
+
+        [[maybe_unused]]
+        const auto ret = pread(fd, &value, 1, offset);
+        close(fd);
+
+        return value;
+    }
+}
+
+TEST(test_vm, test_vm_load_image_copy_on_write) {
+    const auto path = create_store_image();
+
+    EXPECT_EQ(run_image(path, ImageMapping::CopyOnWrite), 0x42);
+    EXPECT_EQ(read_file_byte(path, 0xf00), 0);
+
+    unlink(path.c_str());
+}
+
+TEST(test_vm, test_vm_load_image_readonly) {
+    const auto path = create_store_image();
+
+    EXPECT_EQ(run_image(path, ImageMapping::ReadOnly), 0);
+    EXPECT_EQ(read_file_byte(path, 0xf00), 0);
+
+    unlink(path.c_str());
+}
+
+TEST(test_vm, test_vm_load_image_readonly_host_write) {
+    const auto path = create_store_image();
+
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.load_image(path, 0x1000, ImageMapping::ReadOnly);
+    EXPECT_TRUE(result.has_value());
+
+    // Host patches read-only image without touching file.
+    const std::array<u8, 1> value = {0x24};
+    result = vm.memory().write(0x1f00, value);
+    EXPECT_TRUE(result.has_value());
+
+    std::array<u8, 1> read {};
+    EXPECT_TRUE(vm.memory().read(0x1f00, read).has_value());
+    EXPECT_EQ(read.front(), 0x24);
+    EXPECT_EQ(read_file_byte(path, 0xf00), 0);
+
+    unlink(path.c_str());
+}
+
+TEST(test_vm, test_vm_load_image_missing_file) {
+    VirtualMachine vm;
+
+    auto result = vm.init();
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.load_image("/nonexistent/nullvm_image", 0x1000);
+    EXPECT_FALSE(result.has_value());
+}
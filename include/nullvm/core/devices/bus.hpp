@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Device bus mapping address ranges to devices related declarations.
+
+#ifndef NULLVM_CORE_DEVICES_BUS_HPP
+#define NULLVM_CORE_DEVICES_BUS_HPP
+
+#include <nullvm/core/devices/device.hpp>
+#include <nullvm/types.hpp>
+#include <shared_mutex>
+#include <memory>
+#include <vector>
+#include <span>
+
+namespace nullvm::core::devices {
+
+    /// Address range occupied by device on bus.
+    struct BusRange {
+        /// Range base address.
+        u64 base;
+        /// Range size in bytes.
+        u64 size;
+        /// Device handling accesses to range.
+        std::shared_ptr<Device> device;
+    };
+
+    /// Device bus (I/O port or MMIO address space).
+    ///
+    /// Ranges are kept sorted by base address, so device lookup is a
+    /// binary search regardless of number of registered devices.
+    class Bus final {
+        /// Non-overlapping device ranges sorted by base address.
+        std::vector<BusRange> m_ranges;
+        /// Lock protecting ranges against concurrent modification.
+        mutable std::shared_mutex m_lock;
+
+    public:
+        /// @brief Register device on bus.
+        ///
+        /// @param [in] base given range base address.
+        /// @param [in] size given range size in bytes.
+        /// @param [in] device given device handling the range.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto insert(u64 base, u64 size, std::shared_ptr<Device> device)
+        noexcept -> VmmResult<None>;
+
+        /// @brief Unregister device from bus.
+        ///
+        /// @param [in] base given range base address.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto remove(u64 base) noexcept -> VmmResult<None>;
+
+        /// @brief Get number of registered devices.
+        ///
+        /// @return Number of registered devices.
+        auto size() const noexcept -> usize;
+
+        /// @brief Dispatch read access to device.
+        ///
+        /// Reads from unmapped addresses return all ones.
+        ///
+        /// @param [in] addr given accessed address.
+        /// @param [out] data given buffer for `count` accesses of `size`.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto read(u64 addr, std::span<u8> data, u32 size) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Dispatch write access to device.
+        ///
+        /// Writes to unmapped addresses are ignored.
+        ///
+        /// @param [in] addr given accessed address.
+        /// @param [in] data given `count` accesses of `size` bytes.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write(u64 addr, std::span<const u8> data, u32 size) const noexcept
+        -> VmmResult<None>;
+
+    private:
+        /// @brief Find device range containing address.
+        ///
+        /// @param [in] addr given address to look up.
+        ///
+        /// @return Device range - if address is mapped.
+        /// @return nullptr - otherwise.
+        auto lookup(u64 addr) const noexcept -> const BusRange*;
+    };
+
+}
+
+#endif // NULLVM_CORE_DEVICES_BUS_HPP
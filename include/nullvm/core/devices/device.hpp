@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Emulated device abstract class related declarations.
+
+#ifndef NULLVM_CORE_DEVICES_DEVICE_HPP
+#define NULLVM_CORE_DEVICES_DEVICE_HPP
+
+#include <nullvm/types.hpp>
+#include <span>
+
+namespace nullvm::core::devices {
+
+    /// Emulated device abstract class.
+    class Device {
+    public:
+        /// @brief Destroy Device object.
+        virtual ~Device() noexcept = default;
+
+        /// @brief Handle guest read from device.
+        ///
+        /// @param [in] offset given offset from device base address.
+        /// @param [out] data given buffer for `count` accesses of `size`.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        virtual auto read(u64 offset, std::span<u8> data, u32 size) noexcept
+        -> VmmResult<None> = 0;
+
+        /// @brief Handle guest write to device.
+        ///
+        /// @param [in] offset given offset from device base address.
+        /// @param [in] data given `count` accesses of `size` bytes.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        virtual auto write(u64 offset, std::span<const u8> data, u32 size)
+        noexcept -> VmmResult<None> = 0;
+    };
+
+}
+
+#endif // NULLVM_CORE_DEVICES_DEVICE_HPP
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// 16550 UART serial console device related declarations.
+
+#ifndef NULLVM_CORE_DEVICES_SERIAL_HPP
+#define NULLVM_CORE_DEVICES_SERIAL_HPP
+
+#include <nullvm/core/utils/spsc_ring.hpp>
+#include <nullvm/core/devices/device.hpp>
+#include <nullvm/types.hpp>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <span>
+
+namespace nullvm::core::devices {
+
+    /// Base I/O port of first serial port (COM1).
+    constexpr u32 SERIAL_COM1_PORT {0x3f8};
+
+    /// Number of serial port registers.
+    constexpr u32 SERIAL_PORTS_COUNT {8};
+
+    /// 16550 UART serial console device.
+    ///
+    /// Transmitted bytes are queued in a lock-free ring by virtual CPU
+    /// threads and written to the host by a dedicated drain thread in
+    /// large batches.
+    class Serial final : public Device {
+        /// Transmitted bytes queue.
+        utils::SpscRing<u8> m_ring;
+        /// Host output file descriptor.
+        i32 m_output_fd {STDOUT_FILENO};
+        /// Lock serializing register access and ring producers.
+        std::mutex m_lock;
+
+        /// Interrupt enable register.
+        u8 m_ier {0};
+        /// Line control register.
+        u8 m_lcr {0};
+        /// Modem control register.
+        u8 m_mcr {0};
+        /// FIFO control register.
+        u8 m_fcr {0};
+        /// Scratch register.
+        u8 m_scr {0};
+        /// Divisor latch low byte.
+        u8 m_dll {0x0c};
+        /// Divisor latch high byte.
+        u8 m_dlm {0};
+
+        /// Number of bytes queued for transmission.
+        std::atomic<u32> m_queued {0};
+        /// Counter of events waking drain thread.
+        std::atomic<u32> m_events {0};
+        /// Number of bytes written to host.
+        std::atomic<u32> m_written {0};
+        /// Flag indicating that drain thread should exit.
+        std::atomic<bool> m_stop {false};
+        /// Console drain thread.
+        std::jthread m_thread;
+
+    public:
+        /// @brief Construct new Serial object.
+        Serial() noexcept;
+
+        /// @brief Destroy Serial object.
+        ///
+        /// Flushes pending output and stops drain thread.
+        ~Serial() noexcept override;
+
+        /// @brief Initialize Serial object.
+        ///
+        /// @param [in] output_fd given host file descriptor to write to.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(i32 output_fd = STDOUT_FILENO) noexcept -> VmmResult<None>;
+
+        /// @brief Handle guest read from serial registers.
+        ///
+        /// @param [in] offset given register offset from base port.
+        /// @param [out] data given buffer for `count` accesses of `size`.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto read(u64 offset, std::span<u8> data, u32 size) noexcept
+        -> VmmResult<None> override;
+
+        /// @brief Handle guest write to serial registers.
+        ///
+        /// @param [in] offset given register offset from base port.
+        /// @param [in] data given `count` accesses of `size` bytes.
+        /// @param [in] size given size of single access in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write(u64 offset, std::span<const u8> data, u32 size) noexcept
+        -> VmmResult<None> override;
+
+        /// @brief Wait until all queued output is written to host.
+        auto flush() noexcept -> void;
+
+    private:
+        /// @brief Queue bytes for transmission, waiting for ring space.
+        ///
+        /// @param [in] data given bytes to transmit.
+        auto transmit(std::span<const u8> data) noexcept -> void;
+
+        /// @brief Read single register.
+        ///
+        /// @param [in] offset given register offset from base port.
+        ///
+        /// @return Register value.
+        auto read_register(u64 offset) noexcept -> u8;
+
+        /// @brief Write single register.
+        ///
+        /// @param [in] offset given register offset from base port.
+        /// @param [in] value given value to write.
+        auto write_register(u64 offset, u8 value) noexcept -> void;
+
+        /// @brief Drain thread loop writing queued output to host.
+        auto drain() noexcept -> void;
+    };
+
+}
+
+#endif // NULLVM_CORE_DEVICES_SERIAL_HPP
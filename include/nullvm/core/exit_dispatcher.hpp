@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit dispatch table related declarations.
+
+#ifndef NULLVM_CORE_EXIT_DISPATCHER_HPP
+#define NULLVM_CORE_EXIT_DISPATCHER_HPP
+
+#include <nullvm/types.hpp>
+#include <linux/kvm.h>
+#include <functional>
+#include <array>
+
+namespace nullvm::core {
+
+    /// Maximum number of KVM exit reasons handled by dispatcher.
+    constexpr u32 EXIT_REASONS_COUNT {64};
+
+    /// Action to take after handling virtual CPU exit.
+    enum class ExitAction : u8 {
+        /// Re-enter the guest.
+        Continue,
+        /// Stop running virtual CPU.
+        Halt
+    };
+
+    /// Virtual CPU exit handler.
+    using ExitHandler = std::function<auto (kvm_run&) -> VmmResult<ExitAction>>;
+
+    /// Virtual CPU exit dispatch table indexed by exit reason.
+    class ExitDispatcher final {
+        /// Exit handlers indexed by KVM exit reason.
+        std::array<ExitHandler, EXIT_REASONS_COUNT> m_handlers;
+
+    public:
+        /// @brief Set handler for exit reason.
+        ///
+        /// @param [in] reason given KVM exit reason.
+        /// @param [in] handler given exit handler (empty to remove).
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_handler(u32 reason, ExitHandler handler) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Dispatch virtual CPU exit to its handler.
+        ///
+        /// @param [in] state given virtual CPU state.
+        ///
+        /// @return Action to take after exit - in case of success.
+        /// @return VmmError - otherwise.
+        auto dispatch(kvm_run& state) const noexcept -> VmmResult<ExitAction>;
+    };
+
+}
+
+#endif // NULLVM_CORE_EXIT_DISPATCHER_HPP
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual CPU exit statistics related declarations.
+
+#ifndef NULLVM_CORE_EXIT_STATS_HPP
+#define NULLVM_CORE_EXIT_STATS_HPP
+
+#include <nullvm/core/utils/spsc_ring.hpp>
+#include <nullvm/core/exit_dispatcher.hpp>
+#include <nullvm/types.hpp>
+#include <chrono>
+#include <atomic>
+#include <array>
+
+namespace nullvm::core {
+
+    /// Number of bits of value kept by histogram bucket (precision 1/8).
+    constexpr u32 HISTOGRAM_SUB_BITS {3};
+
+    /// Number of significant bits of values histogram tells apart, larger
+    /// values (above ~18 minutes in nanoseconds) fall into last bucket.
+    constexpr u32 HISTOGRAM_MAX_BITS {40};
+
+    /// Number of histogram buckets.
+    constexpr usize HISTOGRAM_BUCKETS {
+        (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS
+    };
+
+    /// Histogram contents at some point of time.
+    struct HistogramSnapshot {
+        /// Number of recorded values per bucket.
+        std::array<u64, HISTOGRAM_BUCKETS> counts {};
+        /// Total number of recorded values.
+        u64 count {0};
+        /// Largest recorded value.
+        u64 max {0};
+
+        /// @brief Get value below which given percentage of values fall.
+        ///
+        /// @param [in] percentile given percentile in range [0, 100].
+        ///
+        /// @return Upper bound of bucket containing percentile (0 if
+        /// histogram is empty).
+        auto percentile(f64 percentile) const noexcept -> u64;
+
+        /// @brief Add values of other histogram.
+        ///
+        /// @param [in] other given histogram snapshot to add.
+        auto merge(const HistogramSnapshot& other) noexcept -> void;
+    };
+
+    /// Log-linear (HDR-style) histogram of non-negative values.
+    ///
+    /// Each power of two range is split into 2^HISTOGRAM_SUB_BITS equal
+    /// buckets, so relative error is constant across the whole range.
+    /// Only one thread may record values, any thread may take snapshots
+    /// without locking.
+    class Histogram final {
+        /// Number of recorded values per bucket.
+        std::array<std::atomic<u64>, HISTOGRAM_BUCKETS> m_counts {};
+        /// Largest recorded value.
+        std::atomic<u64> m_max {0};
+
+    public:
+        /// @brief Record value (writer side).
+        ///
+        /// @param [in] value given value to record.
+        auto record(u64 value) noexcept -> void;
+
+        /// @brief Take snapshot of histogram.
+        ///
+        /// @return Histogram contents.
+        auto snapshot() const noexcept -> HistogramSnapshot;
+
+        /// @brief Get bucket index of value.
+        ///
+        /// @param [in] value given value.
+        ///
+        /// @return Bucket index.
+        static auto bucket(u64 value) noexcept -> usize;
+
+        /// @brief Get largest value falling into bucket.
+        ///
+        /// @param [in] index given bucket index.
+        ///
+        /// @return Bucket upper bound.
+        static auto bucket_limit(usize index) noexcept -> u64;
+    };
+
+    /// Statistics of single exit reason.
+    struct ExitReasonStats {
+        /// Number of exits.
+        u64 count {0};
+        /// Time spent in KVM_RUN before exits.
+        std::chrono::nanoseconds guest {0};
+        /// Time spent handling exits in userspace.
+        std::chrono::nanoseconds handle {0};
+    };
+
+    /// Virtual CPU exit statistics at some point of time.
+    struct ExitStatsSnapshot {
+        /// Statistics indexed by KVM exit reason.
+        std::array<ExitReasonStats, EXIT_REASONS_COUNT> reasons {};
+        /// Latency of KVM_RUN calls in nanoseconds.
+        HistogramSnapshot guest {};
+        /// Latency of userspace exit handling in nanoseconds.
+        HistogramSnapshot handle {};
+
+        /// @brief Get total number of exits.
+        ///
+        /// @return Number of exits.
+        auto exits() const noexcept -> u64;
+
+        /// @brief Get total time spent in KVM_RUN.
+        ///
+        /// @return Time spent running guest.
+        auto guest_time() const noexcept -> std::chrono::nanoseconds;
+
+        /// @brief Get total time spent handling exits in userspace.
+        ///
+        /// @return Time spent in VMM.
+        auto handle_time() const noexcept -> std::chrono::nanoseconds;
+
+        /// @brief Add statistics of other virtual CPU.
+        ///
+        /// @param [in] other given statistics snapshot to add.
+        auto merge(const ExitStatsSnapshot& other) noexcept -> void;
+    };
+
+    /// Always-on exit statistics of single virtual CPU.
+    ///
+    /// Updated only by thread running virtual CPU with plain relaxed
+    /// stores, padded to cache lines so that virtual CPUs do not share
+    /// them. Snapshots are taken without locking and may mix counters of
+    /// two consecutive exits.
+    class alignas(utils::CACHE_LINE_SIZE) ExitStats final {
+        /// Number of exits indexed by exit reason.
+        std::array<std::atomic<u64>, EXIT_REASONS_COUNT> m_count {};
+        /// Time in KVM_RUN in nanoseconds indexed by exit reason.
+        std::array<std::atomic<u64>, EXIT_REASONS_COUNT> m_guest {};
+        /// Handling time in nanoseconds indexed by exit reason.
+        std::array<std::atomic<u64>, EXIT_REASONS_COUNT> m_handle {};
+        /// Latency of KVM_RUN calls.
+        Histogram m_guest_latency;
+        /// Latency of userspace exit handling.
+        Histogram m_handle_latency;
+
+    public:
+        /// @brief Record handled exit (writer side).
+        ///
+        /// @param [in] reason given KVM exit reason.
+        /// @param [in] guest given time spent in KVM_RUN.
+        /// @param [in] handle given time spent handling exit.
+        auto record(
+            u32 reason, std::chrono::nanoseconds guest,
+            std::chrono::nanoseconds handle
+        ) noexcept -> void;
+
+        /// @brief Take snapshot of statistics.
+        ///
+        /// @return Exit statistics.
+        auto snapshot() const noexcept -> ExitStatsSnapshot;
+    };
+
+}
+
+#endif // NULLVM_CORE_EXIT_STATS_HPP
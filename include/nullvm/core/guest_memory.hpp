@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest physical memory map related declarations.
+
+#ifndef NULLVM_CORE_GUEST_MEMORY_HPP
+#define NULLVM_CORE_GUEST_MEMORY_HPP
+
+#include <nullvm/core/utils/mmap_wrapper.hpp>
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/vmfd.hpp>
+#include <nullvm/types.hpp>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <span>
+
+namespace nullvm::core {
+
+    /// Granularity of guest dirty pages tracking in bytes.
+    constexpr u64 GUEST_PAGE_SIZE {4096};
+
+    /// Guest physical memory region backed by host memory.
+    struct GuestRegion {
+        /// KVM memory slot.
+        u32 slot {0};
+        /// KVM memory region flags (e.g. KVM_MEM_READONLY).
+        u32 flags {0};
+        /// Region guest physical address.
+        u64 guest_addr {0};
+        /// Region size in bytes.
+        u64 size {0};
+        /// Host memory backing the region.
+        utils::MMapWrapper memory {};
+        /// Memory file backing the region (-1 for anonymous memory).
+        utils::FDWrapper fd {};
+        /// Pages written by host while dirty logging is enabled.
+        std::unique_ptr<std::atomic<u64>[]> dirty {};
+    };
+
+    /// Guest physical memory range info.
+    struct GuestRange {
+        /// Range guest physical address.
+        u64 guest_addr {0};
+        /// Range size in bytes.
+        u64 size {0};
+        /// KVM memory region flags.
+        u32 flags {0};
+        /// Memory file backing the range, mapped from offset 0 (-1 for
+        /// anonymous memory). Valid while region is mapped.
+        i32 fd {-1};
+    };
+
+    /// Dirty pages bitmap of guest memory range.
+    struct DirtyBitmap {
+        /// Range guest physical address.
+        u64 guest_addr {0};
+        /// Range size in bytes.
+        u64 size {0};
+        /// Bit per GUEST_PAGE_SIZE page, set if page was written.
+        std::vector<u64> bits {};
+
+        /// @brief Check whether page is dirty.
+        ///
+        /// @param [in] page given page index inside range.
+        ///
+        /// @return true - if page was written.
+        /// @return false - otherwise.
+        auto test(u64 page) const noexcept -> bool {
+            return (bits[page / 64] >> (page % 64)) & 1;
+        }
+    };
+
+    /// Guest physical memory map.
+    ///
+    /// Manages KVM memory slots. Regions are kept sorted by guest physical
+    /// address, so address translation is a binary search regardless of
+    /// number of regions. Unmapped gaps are left for holes, ROM and device
+    /// windows.
+    class GuestMemory final {
+        /// Virtual machine file descriptor.
+        const VmFd *m_vmfd {nullptr};
+        /// Non-overlapping regions sorted by guest physical address.
+        std::vector<GuestRegion> m_regions;
+        /// Flags of used KVM memory slots, indexed by slot.
+        std::vector<bool> m_slots;
+        /// Lock protecting regions against concurrent modification.
+        mutable std::shared_mutex m_lock;
+        /// Flag whether pages written by guest and host are tracked.
+        bool m_dirty_logging {false};
+
+    public:
+        /// @brief Initialize GuestMemory object.
+        ///
+        /// @param [in] vmfd given virtual machine file descriptor.
+        /// @param [in] slots given number of usable KVM memory slots.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(const VmFd& vmfd, u32 slots) noexcept -> VmmResult<None>;
+
+        /// @brief Map host memory into guest physical address space.
+        ///
+        /// @param [in] guest_addr given region guest physical address.
+        /// @param [in] size given region size in bytes.
+        /// @param [in] memory given host memory, at least `size` bytes.
+        /// @param [in] flags given KVM memory region flags.
+        /// @param [in] fd given memory file host memory is mapped from.
+        ///
+        /// @return KVM memory slot of region - in case of success.
+        /// @return VmmError - otherwise.
+        auto add_region(
+            u64 guest_addr, u64 size, utils::MMapWrapper memory,
+            u32 flags = 0, utils::FDWrapper fd = {}
+        ) noexcept -> VmmResult<u32>;
+
+        /// @brief Unmap region from guest physical address space.
+        ///
+        /// @param [in] guest_addr given region guest physical address.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto remove_region(u64 guest_addr) noexcept -> VmmResult<None>;
+
+        /// @brief Get number of mapped regions.
+        ///
+        /// @return Number of mapped regions.
+        auto regions_count() const noexcept -> usize;
+
+        /// @brief Get mapped ranges.
+        ///
+        /// @return Mapped ranges sorted by guest physical address.
+        auto ranges() const -> std::vector<GuestRange>;
+
+        /// @brief Enable or disable dirty pages tracking.
+        ///
+        /// Writable regions are registered with KVM_MEM_LOG_DIRTY_PAGES,
+        /// regions added later inherit the setting. Host writes through
+        /// write() are tracked as well, writes through translated host
+        /// addresses are not.
+        ///
+        /// @param [in] enable given flag whether to track dirty pages.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_dirty_logging(bool enable) noexcept -> VmmResult<None>;
+
+        /// @brief Check whether dirty pages tracking is enabled.
+        ///
+        /// @return true - if dirty pages are tracked.
+        /// @return false - otherwise.
+        auto dirty_logging() const noexcept -> bool;
+
+        /// @brief Get and clear dirty pages bitmaps.
+        ///
+        /// @return Bitmap per mapped range, sorted by guest physical
+        /// address - in case of success.
+        /// @return VmmError - otherwise.
+        auto dirty_log() const -> VmmResult<std::vector<DirtyBitmap>>;
+
+        /// @brief Mark pages of fetched bitmaps dirty again.
+        ///
+        /// Used when consumer of dirty_log() failed, so that pages are
+        /// reported by next call.
+        ///
+        /// @param [in] dirty given bitmaps returned by dirty_log().
+        auto restore_dirty_log(std::span<const DirtyBitmap> dirty)
+        const noexcept -> void;
+
+        /// @brief Translate guest physical address to host address.
+        ///
+        /// @param [in] guest_addr given guest physical address.
+        /// @param [in] size given number of bytes to be accessed.
+        ///
+        /// @return Host address - if whole range is inside single region.
+        /// @return VmmError - otherwise.
+        auto translate(u64 guest_addr, u64 size = 1) const noexcept
+        -> VmmResult<u8*>;
+
+        /// @brief Read guest memory.
+        ///
+        /// @param [in] guest_addr given guest physical address.
+        /// @param [out] data given buffer to read to.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto read(u64 guest_addr, std::span<u8> data) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Write guest memory.
+        ///
+        /// Read-only regions are writable by host, host memory of every
+        /// region is mapped writable.
+        ///
+        /// @param [in] guest_addr given guest physical address.
+        /// @param [in] data given bytes to write.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write(u64 guest_addr, std::span<const u8> data) const noexcept
+        -> VmmResult<None>;
+
+    private:
+        /// @brief Merge bitmaps into host dirty bitmaps without locking.
+        ///
+        /// @param [in] dirty given bitmaps returned by dirty_log().
+        auto merge_dirty_log(std::span<const DirtyBitmap> dirty)
+        const noexcept -> void;
+
+        /// @brief Find region containing guest physical address.
+        ///
+        /// @param [in] guest_addr given guest physical address.
+        ///
+        /// @return Region - if address is mapped.
+        /// @return nullptr - otherwise.
+        auto lookup(u64 guest_addr) const noexcept -> const GuestRegion*;
+
+        /// @brief Register region in KVM with current dirty logging mode.
+        ///
+        /// @param [in] region given region to register.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_region(const GuestRegion& region) const noexcept
+        -> VmmResult<None>;
+    };
+
+}
+
+#endif // NULLVM_CORE_GUEST_MEMORY_HPP
@@ -8,6 +8,7 @@
 
 #include "nullvm/types.hpp"
 #include <nullvm/core/vmfd.hpp>
+#include <vector>
 
 namespace nullvm::core {
 
@@ -32,7 +33,20 @@ namespace nullvm::core {
         ///
         /// @return Virtual CPU memory map size in bytes - in case of success.
         /// @return VmmError - otherwise.
-        auto vcpu_mmap_size() -> VmmResult<usize>;
+        auto vcpu_mmap_size() const -> VmmResult<usize>;
+
+        /// @brief Check whether KVM extension is supported.
+        ///
+        /// @param [in] cap given KVM capability to check.
+        ///
+        /// @return Extension specific value (0 if unsupported).
+        auto check_extension(i32 cap) const noexcept -> i32;
+
+        /// @brief Get list of model specific registers supported by KVM.
+        ///
+        /// @return MSR indices - in case of success.
+        /// @return VmmError - otherwise.
+        auto msr_index_list() const -> VmmResult<std::vector<u32>>;
 
         /// @brief Create virtual machine.
         ///
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// KVM binary statistics related declarations.
+
+#ifndef NULLVM_CORE_KVM_STATS_HPP
+#define NULLVM_CORE_KVM_STATS_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/types.hpp>
+#include <linux/kvm.h>
+#include <string_view>
+#include <optional>
+#include <string>
+#include <vector>
+#include <span>
+
+namespace nullvm::core {
+
+    /// KVM statistic descriptor.
+    struct StatDescriptor {
+        /// Statistic name.
+        std::string name {};
+        /// Statistic type, unit and base (KVM_STATS_*).
+        u32 flags {0};
+        /// Unit exponent.
+        std::int16_t exponent {0};
+        /// Number of values (buckets for histograms).
+        std::uint16_t size {0};
+        /// Index of first value in sampled values.
+        usize index {0};
+        /// Linear histogram bucket size.
+        u32 bucket_size {0};
+    };
+
+    /// KVM binary statistics of virtual machine or virtual CPU.
+    ///
+    /// Descriptors are read once on initialization, then values are
+    /// sampled with single pread() into preallocated buffer.
+    class KvmStats final {
+        /// Binary statistics file descriptor.
+        utils::FDWrapper m_fd;
+        /// Statistics source identifier (e.g. "kvm-1234/vcpu-0").
+        std::string m_id;
+        /// Statistic descriptors.
+        std::vector<StatDescriptor> m_descriptors;
+        /// Offset of values block in statistics file.
+        u32 m_data_offset {0};
+        /// Last sampled values.
+        std::vector<u64> m_values;
+
+    public:
+        /// @brief Initialize KvmStats object.
+        ///
+        /// @param [in] fd given raw binary statistics file descriptor,
+        /// owned by object afterwards.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(i32 fd) -> VmmResult<None>;
+
+        /// @brief Get statistics source identifier.
+        ///
+        /// @return Statistics identifier.
+        auto id() const noexcept -> std::string_view;
+
+        /// @brief Get statistic descriptors.
+        ///
+        /// @return Statistic descriptors.
+        auto descriptors() const noexcept -> std::span<const StatDescriptor>;
+
+        /// @brief Read current values of all statistics.
+        ///
+        /// @return Values indexed by StatDescriptor::index - in case of
+        /// success.
+        /// @return VmmError - otherwise.
+        auto sample() noexcept -> VmmResult<std::span<const u64>>;
+
+        /// @brief Read current values of all statistics into buffer.
+        ///
+        /// Last sampled values are not updated.
+        ///
+        /// @param [out] output given buffer of values().size() u64 values.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto sample(std::span<std::byte> output) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get last sampled values.
+        ///
+        /// @return Values indexed by StatDescriptor::index.
+        auto values() const noexcept -> std::span<const u64>;
+
+        /// @brief Get last sampled values of statistic.
+        ///
+        /// @param [in] name given statistic name.
+        ///
+        /// @return Statistic values - if statistic exists.
+        /// @return std::nullopt - otherwise.
+        auto find(std::string_view name) const noexcept
+        -> std::optional<std::span<const u64>>;
+    };
+
+}
+
+#endif // NULLVM_CORE_KVM_STATS_HPP
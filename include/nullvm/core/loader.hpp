@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest kernel image loaders related declarations.
+
+#ifndef NULLVM_CORE_LOADER_HPP
+#define NULLVM_CORE_LOADER_HPP
+
+#include <nullvm/core/guest_memory.hpp>
+#include <nullvm/types.hpp>
+#include <string_view>
+#include <span>
+
+namespace nullvm::core::loader {
+
+    /// Guest physical address of Linux boot parameters (zero page).
+    constexpr u64 BOOT_PARAMS_ADDR {0x7000};
+
+    /// Guest physical address of Linux kernel command line.
+    constexpr u64 CMDLINE_ADDR {0x20000};
+
+    /// Guest physical address of Linux protected-mode kernel.
+    constexpr u64 KERNEL_ADDR {0x100000};
+
+    /// Loaded kernel entry info struct.
+    struct KernelEntry {
+        /// Entry point guest physical address.
+        u64 entry {0};
+        /// Boot parameters guest physical address (0 if not used).
+        u64 boot_params {0};
+    };
+
+    /// @brief Load ELF64 executable into guest memory.
+    ///
+    /// PT_LOAD segments are placed at their physical addresses, memory
+    /// past segment file size is zero-filled.
+    ///
+    /// @param [in] memory given guest memory.
+    /// @param [in] image given ELF image bytes.
+    ///
+    /// @return Kernel entry - in case of success.
+    /// @return VmmError - otherwise.
+    auto load_elf(const GuestMemory& memory, std::span<const u8> image)
+    noexcept -> VmmResult<KernelEntry>;
+
+    /// @brief Load Linux bzImage into guest memory.
+    ///
+    /// Follows 32-bit boot protocol: protected-mode kernel is placed at
+    /// KERNEL_ADDR, boot parameters with E820 map built from guest memory
+    /// ranges at BOOT_PARAMS_ADDR and command line at CMDLINE_ADDR.
+    /// Initial ramdisk is placed at the top of RAM allowed by kernel.
+    ///
+    /// @param [in] memory given guest memory.
+    /// @param [in] image given bzImage bytes.
+    /// @param [in] cmdline given kernel command line.
+    /// @param [in] initrd given initial ramdisk bytes (may be empty).
+    ///
+    /// @return Kernel entry - in case of success.
+    /// @return VmmError - otherwise.
+    auto load_bzimage(
+        const GuestMemory& memory, std::span<const u8> image,
+        std::string_view cmdline, std::span<const u8> initrd = {}
+    ) noexcept -> VmmResult<KernelEntry>;
+
+}
+
+#endif // NULLVM_CORE_LOADER_HPP
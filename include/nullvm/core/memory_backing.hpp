@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Guest memory backing related declarations.
+
+#ifndef NULLVM_CORE_MEMORY_BACKING_HPP
+#define NULLVM_CORE_MEMORY_BACKING_HPP
+
+#include <nullvm/core/utils/mmap_wrapper.hpp>
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/types.hpp>
+#include <string_view>
+
+namespace nullvm::core {
+
+    /// Guest memory backing enumeration.
+    ///
+    /// Larger pages reduce number of TLB misses and nested page table walks
+    /// of guest memory accesses.
+    enum class MemoryBacking : u8 {
+        /// Anonymous memory with base pages.
+        Anonymous,
+        /// Anonymous memory advised to use transparent huge pages.
+        TransparentHuge,
+        /// Huge TLB memory with 2M pages.
+        HugeTlb2M,
+        /// Huge TLB memory with 1G pages.
+        HugeTlb1G
+    };
+
+    /// Guest memory mapping struct.
+    struct MemoryMapping {
+        /// Mapped memory.
+        utils::MMapWrapper memory {};
+        /// Backing actually used for mapping.
+        MemoryBacking backing {MemoryBacking::Anonymous};
+        /// Sealed memory file backing shared mapping (-1 otherwise).
+        utils::FDWrapper fd {};
+    };
+
+    /// @brief Get memory backing name.
+    ///
+    /// @param [in] backing given memory backing.
+    ///
+    /// @return Memory backing name.
+    auto to_string(MemoryBacking backing) noexcept -> std::string_view;
+
+    /// @brief Check whether transparent huge pages back advised memory.
+    ///
+    /// @param [in] shared given flag whether memory is backed by memory
+    /// file, which has its own mode (shmem_enabled).
+    ///
+    /// @return true - if transparent huge pages are enabled on host.
+    /// @return false - otherwise.
+    auto transparent_huge_pages(bool shared = false) noexcept -> bool;
+
+    /// @brief Get page size of memory backing.
+    ///
+    /// @param [in] backing given memory backing.
+    ///
+    /// @return Page size in bytes.
+    auto page_size(MemoryBacking backing) noexcept -> usize;
+
+    /// @brief Map guest memory.
+    ///
+    /// If requested backing is not available (e.g. huge page pool is empty),
+    /// falls back to the next smaller page size down to base pages.
+    ///
+    /// Shared memory is created with memfd_create() and sealed against
+    /// resizing, so its file descriptor can be passed to other processes
+    /// which map the same pages. Otherwise memory is private for every
+    /// backing and is not shared with forked children.
+    ///
+    /// @param [in] size given memory size in bytes.
+    /// @param [in] backing given preferred memory backing.
+    /// @param [in] shared given flag whether to back memory with file.
+    ///
+    /// @return Memory mapping - in case of success.
+    /// @return VmmError - otherwise.
+    auto map_guest_memory(
+        usize size, MemoryBacking backing, bool shared = false
+    ) noexcept -> VmmResult<MemoryMapping>;
+
+}
+
+#endif // NULLVM_CORE_MEMORY_BACKING_HPP
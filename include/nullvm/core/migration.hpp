@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine live migration related declarations.
+
+#ifndef NULLVM_CORE_MIGRATION_HPP
+#define NULLVM_CORE_MIGRATION_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/guest_memory.hpp>
+#include <nullvm/types.hpp>
+#include <chrono>
+#include <span>
+
+namespace nullvm::core::migration {
+
+    /// Migration stream format version.
+    constexpr u32 MIGRATION_VERSION {1};
+
+    /// Live migration configuration struct.
+    struct MigrationConfig {
+        /// Maximum number of pre-copy rounds while guest is running.
+        usize max_rounds {8};
+        /// Number of dirty pages small enough to stop guest and copy them.
+        u64 max_dirty_pages {256};
+    };
+
+    /// Live migration statistics struct.
+    struct MigrationStats {
+        /// Number of pre-copy rounds done while guest was running.
+        usize rounds {0};
+        /// Total number of pages sent.
+        u64 pages {0};
+        /// Number of pages sent while guest was paused.
+        u64 downtime_pages {0};
+        /// Time guest was paused.
+        std::chrono::nanoseconds downtime {0};
+    };
+
+    /// Migration stream message type enumeration.
+    enum class MessageType : u32 {
+        /// Guest memory layout, array of snapshot::RegionState.
+        Layout = 1,
+        /// Guest memory pages at guest physical address.
+        Pages,
+        /// Serialized virtual machine state, last message.
+        State
+    };
+
+    /// Migration stream message header.
+    struct MessageHeader {
+        /// Message type.
+        MessageType type {MessageType::Layout};
+        /// Stream format version.
+        u32 version {MIGRATION_VERSION};
+        /// Guest physical address of pages.
+        u64 addr {0};
+        /// Payload size in bytes.
+        u64 size {0};
+    };
+
+    /// Migration stream over connected socket.
+    ///
+    /// Guest pages are sent with vmsplice() and splice(), so they reach
+    /// the socket without copying through intermediate buffer.
+    class Channel final {
+        /// Connected socket file descriptor (not owned).
+        i32 m_fd {-1};
+        /// Read end of pipe used for splicing pages.
+        utils::FDWrapper m_pipe_read;
+        /// Write end of pipe used for splicing pages.
+        utils::FDWrapper m_pipe_write;
+        /// Pipe capacity in bytes (0 if splicing is not available).
+        usize m_pipe_size {0};
+
+    public:
+        /// @brief Initialize Channel object.
+        ///
+        /// @param [in] fd given connected stream socket file descriptor.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(i32 fd) noexcept -> VmmResult<None>;
+
+        /// @brief Send message.
+        ///
+        /// @param [in] type given message type.
+        /// @param [in] addr given guest physical address of pages.
+        /// @param [in] payload given message payload.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto send(MessageType type, u64 addr, std::span<const u8> payload)
+        noexcept -> VmmResult<None>;
+
+        /// @brief Receive message header.
+        ///
+        /// @return Message header - in case of success.
+        /// @return VmmError - otherwise.
+        auto recv_header() noexcept -> VmmResult<MessageHeader>;
+
+        /// @brief Receive message payload.
+        ///
+        /// @param [out] payload given buffer of exact payload size.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto recv_payload(std::span<u8> payload) noexcept -> VmmResult<None>;
+
+    private:
+        /// @brief Send bytes through pipe with splice.
+        ///
+        /// @param [in] data given bytes to send.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto splice_out(std::span<const u8> data) noexcept -> VmmResult<None>;
+    };
+
+    /// @brief Send all non-zero guest pages.
+    ///
+    /// Destination memory is zero-filled, so zero pages are skipped.
+    ///
+    /// @param [in] channel given migration channel.
+    /// @param [in] memory given guest memory.
+    ///
+    /// @return Number of pages sent - in case of success.
+    /// @return VmmError - otherwise.
+    auto send_memory(Channel& channel, const GuestMemory& memory)
+    -> VmmResult<u64>;
+
+    /// @brief Send dirty guest pages.
+    ///
+    /// @param [in] channel given migration channel.
+    /// @param [in] memory given guest memory.
+    /// @param [in] dirty given dirty bitmaps, one per guest memory range.
+    ///
+    /// @return Number of pages sent - in case of success.
+    /// @return VmmError - otherwise.
+    auto send_dirty(
+        Channel& channel, const GuestMemory& memory,
+        std::span<const DirtyBitmap> dirty
+    ) -> VmmResult<u64>;
+
+    /// @brief Count dirty pages.
+    ///
+    /// @param [in] dirty given dirty bitmaps.
+    ///
+    /// @return Number of dirty pages.
+    auto count_dirty(std::span<const DirtyBitmap> dirty) noexcept -> u64;
+
+}
+
+#endif // NULLVM_CORE_MIGRATION_HPP
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine snapshot related declarations.
+
+#ifndef NULLVM_CORE_SNAPSHOT_HPP
+#define NULLVM_CORE_SNAPSHOT_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/guest_memory.hpp>
+#include <nullvm/core/vcpu.hpp>
+#include <nullvm/types.hpp>
+#include <linux/kvm.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include <span>
+
+namespace nullvm::core::snapshot {
+
+    /// Snapshot state file format version.
+    constexpr u32 SNAPSHOT_VERSION {2};
+
+    /// Saved virtual CPU state.
+    struct VCpuState {
+        /// Standard registers.
+        kvm_regs regs {};
+        /// Special registers.
+        kvm_sregs sregs {};
+        /// Floating point unit state.
+        kvm_fpu fpu {};
+        /// Extended state (AVX and others), supersedes x87 and SSE state
+        /// of fpu.
+        XSaveArea xsave {};
+        /// Extended control registers.
+        kvm_xcrs xcrs {};
+        /// Debug registers.
+        kvm_debugregs debugregs {};
+        /// Multiprocessing state.
+        kvm_mp_state mp_state {};
+        /// Pending exceptions, interrupts, NMIs and interrupt shadow.
+        kvm_vcpu_events events {};
+        /// Model specific registers.
+        std::vector<kvm_msr_entry> msrs {};
+        /// Local APIC state (only with in-kernel irqchip).
+        std::optional<kvm_lapic_state> lapic {};
+    };
+
+    /// Saved guest memory region info.
+    struct RegionState {
+        /// Region guest physical address.
+        u64 guest_addr {0};
+        /// Region size in bytes.
+        u64 size {0};
+        /// Region offset in memory file.
+        u64 offset {0};
+        /// KVM memory region flags.
+        u32 flags {0};
+        /// Reserved.
+        u32 reserved {0};
+    };
+
+    /// Saved in-kernel interrupt controllers and timer state.
+    struct IrqchipState {
+        /// Master PIC (i8259) state.
+        kvm_irqchip pic_master {};
+        /// Slave PIC (i8259) state.
+        kvm_irqchip pic_slave {};
+        /// IOAPIC state.
+        kvm_irqchip ioapic {};
+        /// PIT (i8254) state.
+        kvm_pit_state2 pit {};
+    };
+
+    /// Saved virtual machine state.
+    struct VmState {
+        /// Virtual CPUs states, indexed by virtual CPU ID.
+        std::vector<VCpuState> vcpus {};
+        /// Guest memory regions, laid out in memory file.
+        std::vector<RegionState> regions {};
+        /// KVM clock state.
+        kvm_clock_data clock {};
+        /// In-kernel irqchip state (only with in-kernel irqchip). Local
+        /// APICs are saved with virtual CPUs.
+        std::optional<IrqchipState> irqchip {};
+    };
+
+    /// @brief Save virtual CPU state.
+    ///
+    /// Virtual CPU must not be running.
+    ///
+    /// @param [in] vcpu given virtual CPU.
+    /// @param [in] msr_indices given MSR indices to save. Registers
+    /// KVM cannot read are skipped.
+    ///
+    /// @return Virtual CPU state - in case of success.
+    /// @return VmmError - otherwise.
+    auto save_vcpu(VCpu& vcpu, std::span<const u32> msr_indices)
+    -> VmmResult<VCpuState>;
+
+    /// @brief Restore virtual CPU state.
+    ///
+    /// State is set in the order Firecracker and QEMU use: special
+    /// registers before MSRs and LAPIC, pending events last.
+    ///
+    /// @param [in] vcpu given virtual CPU.
+    /// @param [in] state given virtual CPU state.
+    ///
+    /// @return None - in case of success.
+    /// @return VmmError - otherwise.
+    auto restore_vcpu(VCpu& vcpu, const VCpuState& state)
+    -> VmmResult<None>;
+
+    /// @brief Create snapshot file for writing, truncating existing one.
+    ///
+    /// Files are created before state is collected, so that failure to
+    /// create them does not consume dirty pages log.
+    ///
+    /// @param [in] path given file path.
+    ///
+    /// @return File handle - in case of success.
+    /// @return VmmError - otherwise.
+    auto create_file(const std::string& path) -> VmmResult<utils::FDWrapper>;
+
+    /// @brief Write guest memory to sparse file.
+    ///
+    /// Regions are laid out at page-aligned offsets. Zero pages are not
+    /// written and stay holes, so file only occupies pages guest touched.
+    ///
+    /// @param [in] fd given memory file descriptor.
+    /// @param [in] memory given guest memory.
+    ///
+    /// @return Regions layout in file - in case of success.
+    /// @return VmmError - otherwise.
+    auto write_memory(i32 fd, const GuestMemory& memory)
+    -> VmmResult<std::vector<RegionState>>;
+
+    /// @brief Write dirty guest pages to sparse file.
+    ///
+    /// File has the same layout as full memory file, but only pages set
+    /// in bitmaps are written, everything else stays holes.
+    ///
+    /// @param [in] fd given memory diff file descriptor.
+    /// @param [in] memory given guest memory.
+    /// @param [in] dirty given dirty bitmaps, one per guest memory range.
+    ///
+    /// @return Regions layout in file - in case of success.
+    /// @return VmmError - otherwise.
+    auto write_memory_diff(
+        i32 fd, const GuestMemory& memory,
+        std::span<const DirtyBitmap> dirty
+    ) -> VmmResult<std::vector<RegionState>>;
+
+    /// @brief Apply memory diff file on top of memory file.
+    ///
+    /// Pages are copied in kernel with copy_file_range. Memory file must
+    /// not be mapped by running virtual machines, they would observe the
+    /// change in pages they did not write yet.
+    ///
+    /// @param [in] diff_path given memory diff file path.
+    /// @param [in] base_path given memory file path to update.
+    ///
+    /// @return None - in case of success.
+    /// @return VmmError - otherwise.
+    auto merge_memory(
+        const std::string& diff_path, const std::string& base_path
+    ) -> VmmResult<None>;
+
+    /// @brief Map memory file regions into guest memory.
+    ///
+    /// Regions are mapped privately: pages are faulted in lazily from page
+    /// cache, guest writes are copied on write and never reach the file,
+    /// so single memory file may back any number of guests.
+    ///
+    /// @param [in] path given memory file path.
+    /// @param [in] regions given regions layout in file.
+    /// @param [out] memory given guest memory to add regions to.
+    ///
+    /// @return None - in case of success.
+    /// @return VmmError - otherwise.
+    auto map_memory(
+        const std::string& path, std::span<const RegionState> regions,
+        GuestMemory& memory
+    ) -> VmmResult<None>;
+
+    /// @brief Serialize virtual machine state.
+    ///
+    /// @param [in] state given virtual machine state.
+    ///
+    /// @return Serialized state.
+    auto serialize_state(const VmState& state) -> std::vector<u8>;
+
+    /// @brief Deserialize virtual machine state.
+    ///
+    /// @param [in] data given serialized state.
+    ///
+    /// @return Virtual machine state - in case of success.
+    /// @return VmmError - otherwise.
+    auto deserialize_state(std::span<const u8> data) -> VmmResult<VmState>;
+
+    /// @brief Write virtual machine state file.
+    ///
+    /// @param [in] fd given state file descriptor.
+    /// @param [in] state given virtual machine state.
+    ///
+    /// @return None - in case of success.
+    /// @return VmmError - otherwise.
+    auto write_state(i32 fd, const VmState& state)
+    -> VmmResult<None>;
+
+    /// @brief Read virtual machine state file.
+    ///
+    /// @param [in] path given state file path.
+    ///
+    /// @return Virtual machine state - in case of success.
+    /// @return VmmError - otherwise.
+    auto read_state(const std::string& path) -> VmmResult<VmState>;
+
+}
+
+#endif // NULLVM_CORE_SNAPSHOT_HPP
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Event notification file descriptor related declarations.
+
+#ifndef NULLVM_CORE_UTILS_EVENTFD_HPP
+#define NULLVM_CORE_UTILS_EVENTFD_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/types.hpp>
+
+namespace nullvm::core::utils {
+
+    /// Event notification file descriptor wrapper.
+    class EventFd final {
+        /// Event file descriptor.
+        FDWrapper m_fd;
+
+    public:
+        /// @brief Initialize EventFd object.
+        ///
+        /// @param [in] nonblock given flag whether reads should not block.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(bool nonblock = true) noexcept -> VmmResult<None>;
+
+        /// @brief Get raw file descriptor value.
+        ///
+        /// @return Raw file descriptor value.
+        auto fd() const noexcept -> i32;
+
+        /// @brief Add value to event counter.
+        ///
+        /// @param [in] value given value to add.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write(u64 value = 1) const noexcept -> VmmResult<None>;
+
+        /// @brief Read and reset event counter.
+        ///
+        /// @return Event counter value - in case of success.
+        /// @return VmmError - otherwise.
+        auto read() const noexcept -> VmmResult<u64>;
+    };
+
+}
+
+#endif // NULLVM_CORE_UTILS_EVENTFD_HPP
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// File memory mapping related declarations.
+
+#ifndef NULLVM_CORE_UTILS_FILE_MAPPING_HPP
+#define NULLVM_CORE_UTILS_FILE_MAPPING_HPP
+
+#include <nullvm/core/utils/mmap_wrapper.hpp>
+#include <nullvm/types.hpp>
+#include <string>
+
+namespace nullvm::core::utils {
+
+    /// @brief Map file into memory privately.
+    ///
+    /// Pages are faulted in lazily from page cache. Writes to writable
+    /// mapping are copied on write and never reach the file. Mapping size
+    /// is rounded up to page size, tail of the last page is zero-filled.
+    ///
+    /// @param [in] path given path to file.
+    /// @param [in] writable given flag whether mapping is copy-on-write.
+    ///
+    /// @return Mapped file - in case of success.
+    /// @return VmmError - otherwise.
+    auto map_file(const std::string& path, bool writable) noexcept
+    -> VmmResult<MMapWrapper>;
+
+    /// @brief Map part of opened file into memory privately.
+    ///
+    /// @param [in] fd given file descriptor.
+    /// @param [in] offset given page-aligned file offset.
+    /// @param [in] size given mapping size in bytes.
+    /// @param [in] writable given flag whether mapping is copy-on-write.
+    ///
+    /// @return Mapped file part - in case of success.
+    /// @return VmmError - otherwise.
+    auto map_file(i32 fd, u64 offset, usize size, bool writable) noexcept
+    -> VmmResult<MMapWrapper>;
+
+}
+
+#endif // NULLVM_CORE_UTILS_FILE_MAPPING_HPP
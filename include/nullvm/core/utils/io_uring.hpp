@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// io_uring submission and completion rings related declarations.
+
+#ifndef NULLVM_CORE_UTILS_IO_URING_HPP
+#define NULLVM_CORE_UTILS_IO_URING_HPP
+
+#include <nullvm/core/utils/mmap_wrapper.hpp>
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/types.hpp>
+#include <linux/io_uring.h>
+#include <span>
+
+namespace nullvm::core::utils {
+
+    /// io_uring instance with mapped submission and completion rings.
+    ///
+    /// Thin wrapper over raw io_uring syscalls. Not thread-safe, ring is
+    /// meant to be owned by single event loop thread.
+    class IoUring final {
+        /// io_uring file descriptor.
+        FDWrapper m_fd;
+        /// Mapped submission queue ring.
+        MMapWrapper m_sq_ring;
+        /// Mapped completion queue ring (empty if shared with SQ ring).
+        MMapWrapper m_cq_ring;
+        /// Mapped submission queue entries.
+        MMapWrapper m_sqes;
+        /// Submission queue head, advanced by kernel.
+        u32 *m_sq_head {nullptr};
+        /// Submission queue tail, advanced by user.
+        u32 *m_sq_tail {nullptr};
+        /// Submission queue index mask.
+        u32 m_sq_mask {0};
+        /// Number of submission queue entries.
+        u32 m_sq_entries {0};
+        /// Completion queue head, advanced by user.
+        u32 *m_cq_head {nullptr};
+        /// Completion queue tail, advanced by kernel.
+        u32 *m_cq_tail {nullptr};
+        /// Completion queue index mask.
+        u32 m_cq_mask {0};
+        /// Completion queue entries.
+        io_uring_cqe *m_cqes {nullptr};
+        /// Local submission queue tail, published on submit.
+        u32 m_tail {0};
+
+    public:
+        /// @brief Initialize IoUring object.
+        ///
+        /// @param [in] entries given submission queue size.
+        /// @param [in] flags given IORING_SETUP_* flags.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(u32 entries, u32 flags = 0) noexcept -> VmmResult<None>;
+
+        /// @brief Get raw file descriptor value.
+        ///
+        /// @return Raw file descriptor value.
+        auto fd() const noexcept -> i32;
+
+        /// @brief Get zeroed submission queue entry.
+        ///
+        /// Submits prepared entries if submission queue is full.
+        ///
+        /// @return Submission queue entry - in case of success.
+        /// @return VmmError - otherwise.
+        auto get_sqe() noexcept -> VmmResult<io_uring_sqe*>;
+
+        /// @brief Submit prepared entries and wait for completions.
+        ///
+        /// @param [in] wait given number of completions to wait for.
+        ///
+        /// @return Number of submitted entries - in case of success.
+        /// @return VmmError - otherwise.
+        auto submit(u32 wait = 0) noexcept -> VmmResult<u32>;
+
+        /// @brief Get next completion queue entry.
+        ///
+        /// @return Completion queue entry - if there is one.
+        /// @return nullptr - otherwise.
+        auto peek_cqe() const noexcept -> const io_uring_cqe*;
+
+        /// @brief Mark completion queue entry returned by peek_cqe() seen.
+        auto cqe_seen() noexcept -> void;
+    };
+
+    /// Group of buffers provided to kernel for buffer-select receives.
+    ///
+    /// Kernel picks free buffer for each received chunk and reports its
+    /// ID in completion, so multishot receives need no per-operation
+    /// buffer. Buffers must be returned with recycle() after use.
+    class BufferGroup final {
+        /// Mapped buffers memory.
+        MMapWrapper m_buffers;
+        /// Buffer group ID.
+        std::uint16_t m_group {0};
+        /// Size of single buffer in bytes.
+        u32 m_size {0};
+
+    public:
+        /// @brief Initialize BufferGroup object and provide it to ring.
+        ///
+        /// Waits for completion of provide request, so it must be called
+        /// before any other request is submitted to ring.
+        ///
+        /// @param [in] ring given io_uring instance.
+        /// @param [in] group given buffer group ID.
+        /// @param [in] entries given number of buffers.
+        /// @param [in] size given size of single buffer in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(
+            IoUring& ring, std::uint16_t group, u32 entries, u32 size
+        ) noexcept -> VmmResult<None>;
+
+        /// @brief Get buffer group ID.
+        ///
+        /// @return Buffer group ID.
+        auto group() const noexcept -> std::uint16_t;
+
+        /// @brief Get received data in buffer.
+        ///
+        /// @param [in] id given buffer ID.
+        /// @param [in] size given number of received bytes.
+        ///
+        /// @return Received data.
+        auto data(std::uint16_t id, usize size) const noexcept
+        -> std::span<const std::byte>;
+
+        /// @brief Return buffer to kernel.
+        ///
+        /// Request is submitted with next submit() call. It completes
+        /// with zero user data and only if it fails.
+        ///
+        /// @param [in] ring given io_uring instance.
+        /// @param [in] id given buffer ID.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto recycle(IoUring& ring, std::uint16_t id) noexcept
+        -> VmmResult<None>;
+
+    private:
+        /// @brief Prepare request providing buffers.
+        ///
+        /// @param [in] ring given io_uring instance.
+        /// @param [in] id given first buffer ID.
+        /// @param [in] count given number of buffers.
+        ///
+        /// @return Submission queue entry - in case of success.
+        /// @return VmmError - otherwise.
+        auto provide(IoUring& ring, std::uint16_t id, u32 count) noexcept
+        -> VmmResult<io_uring_sqe*>;
+    };
+
+}
+
+#endif // NULLVM_CORE_UTILS_IO_URING_HPP
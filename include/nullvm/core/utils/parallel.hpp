@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Parallel memory operations related declarations.
+
+#ifndef NULLVM_CORE_UTILS_PARALLEL_HPP
+#define NULLVM_CORE_UTILS_PARALLEL_HPP
+
+#include <nullvm/types.hpp>
+#include <span>
+
+namespace nullvm::core::utils {
+
+    /// Minimal number of bytes processed by single thread.
+    constexpr usize PARALLEL_CHUNK_SIZE {4 * 1024 * 1024};
+
+    /// Maximal number of threads used by single operation.
+    constexpr usize PARALLEL_MAX_THREADS {8};
+
+    /// @brief Copy bytes splitting large copies across threads.
+    ///
+    /// @param [out] dst given destination, at least `src.size()` bytes.
+    /// @param [in] src given bytes to copy.
+    auto parallel_copy(std::span<u8> dst, std::span<const u8> src) noexcept
+    -> void;
+
+    /// @brief Fill bytes splitting large fills across threads.
+    ///
+    /// @param [out] dst given bytes to fill.
+    /// @param [in] value given value to fill with.
+    auto parallel_fill(std::span<u8> dst, u8 value) noexcept -> void;
+
+}
+
+#endif // NULLVM_CORE_UTILS_PARALLEL_HPP
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Lock-free single-producer single-consumer ring buffer.
+
+#ifndef NULLVM_CORE_UTILS_SPSC_RING_HPP
+#define NULLVM_CORE_UTILS_SPSC_RING_HPP
+
+#include <nullvm/types.hpp>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <bit>
+
+namespace nullvm::core::utils {
+
+    /// Size of cache line in bytes.
+    constexpr usize CACHE_LINE_SIZE {64};
+
+    /// Lock-free single-producer single-consumer ring buffer.
+    ///
+    /// Exactly one thread may push and exactly one thread may pop at a time.
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    class SpscRing final {
+        /// Ring storage.
+        std::unique_ptr<T[]> m_data;
+        /// Ring capacity (power of two).
+        usize m_capacity;
+        /// Index mask for wrapping positions.
+        usize m_mask;
+
+        /// Position of next element to pop (written by consumer).
+        alignas(CACHE_LINE_SIZE) std::atomic<usize> m_head {0};
+        /// Producer's cached copy of consumer position.
+        usize m_head_cache {0};
+
+        /// Position of next element to push (written by producer).
+        alignas(CACHE_LINE_SIZE) std::atomic<usize> m_tail {0};
+        /// Consumer's cached copy of producer position.
+        usize m_tail_cache {0};
+
+    public:
+        /// @brief Construct new SpscRing object.
+        ///
+        /// @param [in] capacity given minimal ring capacity in elements,
+        /// rounded up to the power of two.
+        explicit SpscRing(usize capacity)
+            : m_data(std::make_unique_for_overwrite<T[]>(
+                  std::bit_ceil(std::max<usize>(capacity, 2))
+              )),
+              m_capacity(std::bit_ceil(std::max<usize>(capacity, 2))),
+              m_mask(m_capacity - 1) {}
+
+        /// @brief Push elements to ring (producer side).
+        ///
+        /// @param [in] data given elements to push.
+        ///
+        /// @return Number of elements pushed, may be less than requested
+        /// if ring is full.
+        auto push(std::span<const T> data) noexcept -> usize {
+            const auto tail = m_tail.load(std::memory_order_relaxed);
+
+            if (m_capacity - (tail - m_head_cache) < data.size())
+                m_head_cache = m_head.load(std::memory_order_acquire);
+
+            const auto free = m_capacity - (tail - m_head_cache);
+            const auto count = std::min(free, data.size());
+
+            copy_in(tail, data.first(count));
+            m_tail.store(tail + count, std::memory_order_release);
+
+            return count;
+        }
+
+        /// @brief Push all elements to ring or nothing (producer side).
+        ///
+        /// @param [in] data given elements to push.
+        ///
+        /// @return true - if all elements were pushed.
+        /// @return false - if ring has not enough free space.
+        auto try_push(std::span<const T> data) noexcept -> bool {
+            const auto tail = m_tail.load(std::memory_order_relaxed);
+
+            if (m_capacity - (tail - m_head_cache) < data.size()) {
+                m_head_cache = m_head.load(std::memory_order_acquire);
+
+                if (m_capacity - (tail - m_head_cache) < data.size())
+                    return false;
+            }
+
+            copy_in(tail, data);
+            m_tail.store(tail + data.size(), std::memory_order_release);
+
+            return true;
+        }
+
+        /// @brief Pop elements from ring (consumer side).
+        ///
+        /// @param [out] data given buffer to pop elements into.
+        ///
+        /// @return Number of elements popped.
+        auto pop(std::span<T> data) noexcept -> usize {
+            const auto head = m_head.load(std::memory_order_relaxed);
+
+            if (m_tail_cache - head < data.size())
+                m_tail_cache = m_tail.load(std::memory_order_acquire);
+
+            const auto count = std::min(m_tail_cache - head, data.size());
+
+            copy_out(head, data.first(count));
+            m_head.store(head + count, std::memory_order_release);
+
+            return count;
+        }
+
+        /// @brief Get number of elements stored in ring.
+        ///
+        /// @return Approximate number of stored elements.
+        auto size() const noexcept -> usize {
+            const auto head = m_head.load(std::memory_order_acquire);
+            const auto tail = m_tail.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        /// @brief Check whether ring is empty.
+        ///
+        /// @return true - if ring has no elements.
+        /// @return false - otherwise.
+        auto empty() const noexcept -> bool {
+            return size() == 0;
+        }
+
+        /// @brief Get ring capacity.
+        ///
+        /// @return Ring capacity in elements.
+        auto capacity() const noexcept -> usize {
+            return m_capacity;
+        }
+
+    private:
+        /// @brief Copy elements into ring storage, wrapping around the end.
+        ///
+        /// @param [in] pos given ring position to copy to.
+        /// @param [in] data given elements to copy.
+        auto copy_in(usize pos, std::span<const T> data) noexcept -> void {
+            const auto index = pos & m_mask;
+            const auto first = std::min(data.size(), m_capacity - index);
+
+            std::copy_n(data.data(), first, m_data.get() + index);
+            std::copy_n(data.data() + first, data.size() - first, m_data.get());
+        }
+
+        /// @brief Copy elements out of ring storage, wrapping around the end.
+        ///
+        /// @param [in] pos given ring position to copy from.
+        /// @param [out] data given buffer to copy elements into.
+        auto copy_out(usize pos, std::span<T> data) const noexcept -> void {
+            const auto index = pos & m_mask;
+            const auto first = std::min(data.size(), m_capacity - index);
+
+            std::copy_n(m_data.get() + index, first, data.data());
+            std::copy_n(m_data.get(), data.size() - first, data.data() + first);
+        }
+    };
+
+}
+
+#endif // NULLVM_CORE_UTILS_SPSC_RING_HPP
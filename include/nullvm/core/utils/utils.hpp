@@ -7,6 +7,7 @@
 #define NULLVM_CORE_UTILS_HPP
 
 #include <nullvm/types.hpp>
+#include <span>
 
 namespace nullvm::core::utils {
 
@@ -18,6 +19,14 @@ namespace nullvm::core::utils {
     /// @return false - otherwise.
     auto is_fd_open(const nullvm::i32 fd) -> bool;
 
+    /// @brief Check whether memory contains only zero bytes.
+    ///
+    /// @param [in] data given memory to check.
+    ///
+    /// @return true - if all bytes are zero.
+    /// @return false - otherwise.
+    auto is_zero(std::span<const u8> data) noexcept -> bool;
+
 }
 
 #endif // NULLVM_CORE_UTILS_HPP
@@ -10,31 +10,61 @@
 #include <nullvm/core/utils/fd_wrapper.hpp>
 #include <nullvm/types.hpp>
 #include <linux/kvm.h>
+#include <optional>
+#include <vector>
+#include <array>
+#include <span>
 
 namespace nullvm::core {
     using utils::FDWrapper;
     using utils::MMapWrapper;
 
+    /// XSAVE area of KVM_GET_XSAVE. kvm_xsave ends with flexible array
+    /// member, so it cannot be stored in other structs.
+    using XSaveArea = std::array<u32, sizeof(kvm_xsave::region) / sizeof(u32)>;
+
     /// Virtual CPU file descriptor management struct.
+    ///
+    /// Standard and special registers are cached until next run, so exit
+    /// handlers inspecting them pay for at most one ioctl per register
+    /// set. With KVM_CAP_SYNC_REGS kernel stores registers into kvm_run
+    /// on every exit and loads modified ones on entry, so they are read
+    /// and written without any ioctl. Pending register sets are flushed
+    /// before any other state is read or written, since the rest of
+    /// virtual CPU state depends on CPU mode.
     class VCpu final {
         /// Virtual CPU file descriptor.
         FDWrapper m_fd;
         /// Virtual CPU state.
         MMapWrapper m_state;
         /// Virtual CPU's special registers.
-        kvm_sregs m_sregs;
+        kvm_sregs m_sregs {};
         /// Virtual CPU's standard registers.
-        kvm_regs m_regs;
+        kvm_regs m_regs {};
+        /// Register sets (KVM_SYNC_X86_*) synchronized through kvm_run.
+        u32 m_sync {0};
+        /// Register sets stored into kvm_run on last exit.
+        u32 m_synced {0};
+        /// Register sets whose cached copies are valid.
+        u32 m_cached {0};
 
     public:
         /// @brief Initialize VCpu object.
         ///
         /// @param [in] fd given raw virtual CPU file descriptor.
         /// @param [in] size given mmap size in bytes for virtual CPU state.
+        /// @param [in] sync given register sets supported by
+        /// KVM_CAP_SYNC_REGS.
         ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
-        auto init(i32 fd, usize size) noexcept -> VmmResult<None>;
+        auto init(i32 fd, usize size, u32 sync = 0) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get register sets synchronized through kvm_run.
+        ///
+        /// @return KVM_SYNC_X86_* register sets mask.
+        auto sync_regs() const noexcept -> u32;
 
         /// @brief Get special register state of virtual CPU.
         ///
@@ -52,7 +82,7 @@ namespace nullvm::core {
 
         /// @brief Get standard register state of virtual CPU.
         ///
-        /// @return Special registers - in case of success.
+        /// @return Standard registers - in case of success.
         /// @return VmmError - otherwise.
         auto regs() noexcept -> VmmResult<kvm_regs>;
 
@@ -60,10 +90,153 @@ namespace nullvm::core {
         ///
         /// @param [in] regs given standard registers to set.
         ///
-        /// @return Standard registers - in case of success.
+        /// @return None - in case of success.
         /// @return VmmError - otherwise.
         auto set_regs(const kvm_regs& regs) noexcept -> VmmResult<None>;
 
+        /// @brief Apply registers set through kvm_run but not yet loaded.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto flush() noexcept -> VmmResult<None>;
+
+        /// @brief Get floating point unit state of virtual CPU.
+        ///
+        /// @return FPU state - in case of success.
+        /// @return VmmError - otherwise.
+        auto fpu() noexcept -> VmmResult<kvm_fpu>;
+
+        /// @brief Set floating point unit state of virtual CPU.
+        ///
+        /// @param [in] fpu given FPU state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_fpu(const kvm_fpu& fpu) noexcept -> VmmResult<None>;
+
+        /// @brief Get model specific registers of virtual CPU.
+        ///
+        /// KVM stops at the first register it cannot read, so fewer
+        /// entries than requested may be returned.
+        ///
+        /// @param [in] indices given MSR indices to read.
+        ///
+        /// @return Read MSR entries - in case of success.
+        /// @return VmmError - otherwise.
+        auto msrs(std::span<const u32> indices)
+        -> VmmResult<std::vector<kvm_msr_entry>>;
+
+        /// @brief Set model specific registers of virtual CPU.
+        ///
+        /// KVM stops at the first register it rejects, so fewer entries
+        /// than requested may be set.
+        ///
+        /// @param [in] msrs given MSR entries to set.
+        ///
+        /// @return Number of MSRs set - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_msrs(std::span<const kvm_msr_entry> msrs)
+        -> VmmResult<usize>;
+
+        /// @brief Get local APIC state of virtual CPU.
+        ///
+        /// @return LAPIC state or std::nullopt if LAPIC is emulated in
+        /// userspace - in case of success.
+        /// @return VmmError - otherwise.
+        auto lapic() noexcept -> VmmResult<std::optional<kvm_lapic_state>>;
+
+        /// @brief Set local APIC state of virtual CPU.
+        ///
+        /// @param [in] lapic given LAPIC state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_lapic(const kvm_lapic_state& lapic) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get XSAVE area of virtual CPU.
+        ///
+        /// Covers x87, SSE, AVX and other extended state, unlike fpu().
+        ///
+        /// @return XSAVE state - in case of success.
+        /// @return VmmError - otherwise.
+        auto xsave() noexcept -> VmmResult<XSaveArea>;
+
+        /// @brief Set XSAVE area of virtual CPU.
+        ///
+        /// @param [in] xsave given XSAVE state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_xsave(const XSaveArea& xsave) noexcept -> VmmResult<None>;
+
+        /// @brief Get extended control registers (XCR0) of virtual CPU.
+        ///
+        /// @return Extended control registers - in case of success.
+        /// @return VmmError - otherwise.
+        auto xcrs() noexcept -> VmmResult<kvm_xcrs>;
+
+        /// @brief Set extended control registers (XCR0) of virtual CPU.
+        ///
+        /// @param [in] xcrs given extended control registers to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_xcrs(const kvm_xcrs& xcrs) noexcept -> VmmResult<None>;
+
+        /// @brief Get debug registers of virtual CPU.
+        ///
+        /// @return Debug registers - in case of success.
+        /// @return VmmError - otherwise.
+        auto debugregs() noexcept -> VmmResult<kvm_debugregs>;
+
+        /// @brief Set debug registers of virtual CPU.
+        ///
+        /// @param [in] debugregs given debug registers to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_debugregs(const kvm_debugregs& debugregs) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get multiprocessing state of virtual CPU.
+        ///
+        /// @return Multiprocessing state - in case of success.
+        /// @return VmmError - otherwise.
+        auto mp_state() noexcept -> VmmResult<kvm_mp_state>;
+
+        /// @brief Set multiprocessing state of virtual CPU.
+        ///
+        /// @param [in] mp_state given multiprocessing state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_mp_state(const kvm_mp_state& mp_state) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get pending exceptions, interrupts, NMIs and interrupt
+        /// shadow of virtual CPU.
+        ///
+        /// @return Pending events - in case of success.
+        /// @return VmmError - otherwise.
+        auto vcpu_events() noexcept -> VmmResult<kvm_vcpu_events>;
+
+        /// @brief Set pending exceptions, interrupts, NMIs and interrupt
+        /// shadow of virtual CPU.
+        ///
+        /// @param [in] vcpu_events given pending events to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_vcpu_events(const kvm_vcpu_events& vcpu_events) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get binary statistics file descriptor.
+        ///
+        /// @return New statistics file descriptor - in case of success.
+        /// @return VmmError - otherwise.
+        auto stats_fd() const noexcept -> VmmResult<i32>;
+
         /// @brief Get virtual CPU state info.
         ///
         /// @return Virtual CPU state info.
@@ -71,6 +244,9 @@ namespace nullvm::core {
 
         /// @brief Run virtual CPU.
         ///
+        /// If run was interrupted by a signal, exit reason is set to
+        /// KVM_EXIT_INTR and the call is considered successful.
+        ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
         auto run() noexcept -> VmmResult<None>;
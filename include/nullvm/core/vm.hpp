@@ -7,37 +7,186 @@
 #define NULLVM_CORE_VM_HPP
 
 #include <nullvm/core/utils/mmap_wrapper.hpp>
+#include <nullvm/core/memory_backing.hpp>
+#include <nullvm/core/guest_memory.hpp>
+#include <nullvm/core/snapshot.hpp>
+#include <nullvm/core/utils/eventfd.hpp>
+#include <nullvm/core/devices/serial.hpp>
+#include <nullvm/core/devices/bus.hpp>
+#include <nullvm/core/exit_dispatcher.hpp>
+#include <nullvm/core/exit_stats.hpp>
+#include <nullvm/core/kvm_stats.hpp>
+#include <nullvm/core/migration.hpp>
 #include <nullvm/core/vcpu.hpp>
 #include <nullvm/core/kvm.hpp>
+#include <pthread.h>
+#include <condition_variable>
+#include <optional>
+#include <memory>
+#include <atomic>
 #include <vector>
+#include <span>
+#include <mutex>
 
 namespace nullvm::core {
 
+    /// Virtual machine configuration struct.
+    struct VmConfig {
+        /// Number of virtual CPUs.
+        usize vcpus {1};
+        /// Host CPU core to pin each virtual CPU thread to.
+        /// Indexed by virtual CPU ID, missing entries are not pinned.
+        std::vector<std::optional<usize>> affinity {};
+        /// Host file descriptor receiving serial console output.
+        i32 console_fd {STDOUT_FILENO};
+        /// Preferred guest memory backing, smaller pages are used if it
+        /// is not available.
+        MemoryBacking memory_backing {MemoryBacking::Anonymous};
+        /// Back guest memory with sealed memory files, so that it can be
+        /// mapped by other processes (see GuestRange::fd).
+        bool shared_memory {false};
+        /// Track pages written by guest for incremental snapshots.
+        bool dirty_logging {false};
+        /// Emulate interrupt controllers (PIC, IOAPIC, local APICs) and
+        /// PIT in kernel. Halted virtual CPUs then sleep in kernel until
+        /// interrupt arrives instead of exiting to userspace. Their state
+        /// is saved in snapshots and migrated along with virtual CPUs.
+        bool irqchip {false};
+    };
+
+    /// Image file mapping mode enumeration.
+    enum class ImageMapping : u8 {
+        /// Guest writes are not applied (read-only memory slot).
+        ReadOnly,
+        /// Guest writes go to private copies of pages.
+        CopyOnWrite
+    };
+
+    /// Virtual machine snapshot type enumeration.
+    enum class SnapshotType : u8 {
+        /// Whole guest memory is saved.
+        Full,
+        /// Only pages written since previous snapshot are saved.
+        Diff
+    };
+
     /// Virtual machine info struct.
     class VirtualMachine final {
-        /// KVM subsystem handle.
-        Kvm m_kvm;
+        /// KVM subsystem handle (may be shared between virtual machines).
+        std::shared_ptr<const Kvm> m_kvm;
         /// Virtual machine file descriptor.
         VmFd m_vmfd;
-        /// Memory allocated to VM.
-        MMapWrapper m_memory;
-        /// Virtual CPU handle.
-        VCpu m_vcpu;
+        /// Guest physical memory map.
+        GuestMemory m_memory;
+        /// Backing of last memory region allocated to VM.
+        MemoryBacking m_memory_backing {MemoryBacking::Anonymous};
+        /// Guest physical address raw binaries are loaded to.
+        u64 m_load_addr {0};
+        /// Virtual CPU handles.
+        std::vector<VCpu> m_vcpus;
+        /// Virtual machine configuration.
+        VmConfig m_config;
+        /// Host threads running virtual CPUs, indexed by virtual CPU ID.
+        std::vector<std::optional<pthread_t>> m_threads;
+        /// Lock protecting host threads list.
+        std::mutex m_threads_lock;
+        /// Number of virtual CPU threads still running guest code.
+        usize m_active {0};
+        /// Condition signaled when virtual CPU thread finishes.
+        std::condition_variable m_threads_done;
+        /// Flag indicating that virtual CPUs should stop.
+        std::atomic<bool> m_stop {false};
+        /// Kernel ring of coalesced MMIO/PIO writes (shared by virtual CPUs).
+        kvm_coalesced_mmio_ring *m_coalesced_ring {nullptr};
+        /// Maximum number of entries in coalesced ring.
+        u32 m_coalesced_max {0};
+        /// Lock serializing coalesced ring consumers.
+        std::mutex m_coalesced_lock;
+        /// Serial console device.
+        std::shared_ptr<devices::Serial> m_serial;
+        /// I/O port space device bus.
+        devices::Bus m_pio_bus;
+        /// MMIO space device bus.
+        devices::Bus m_mmio_bus;
+        /// Virtual CPU exit handlers.
+        ExitDispatcher m_dispatcher;
+        /// Exit statistics indexed by virtual CPU ID.
+        std::unique_ptr<ExitStats[]> m_exit_stats;
 
     public:
         /// @brief Initialize VirtualMachine object.
         ///
+        /// @param [in] config given virtual machine configuration.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(const VmConfig& config = {}) noexcept -> VmmResult<None>;
+
+        /// @brief Initialize VirtualMachine object using shared KVM handle.
+        ///
+        /// Skips opening /dev/kvm, so many virtual machines can be created
+        /// from one initialized handle.
+        ///
+        /// @param [in] config given virtual machine configuration.
+        /// @param [in] kvm given initialized KVM subsystem handle.
+        ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
-        auto init() noexcept -> VmmResult<None>;
+        auto init(const VmConfig& config, std::shared_ptr<const Kvm> kvm)
+        noexcept -> VmmResult<None>;
+
+        /// @brief Get boot virtual CPU.
+        ///
+        /// @return VM's boot virtual CPU.
+        auto vcpu() & noexcept -> VCpu&;
 
         /// @brief Get virtual CPU.
         ///
+        /// @param [in] id given virtual CPU ID.
+        ///
         /// @return VM's virtual CPU.
-        auto vcpu() & noexcept -> VCpu&;
+        auto vcpu(usize id) & noexcept -> VCpu&;
+
+        /// @brief Get number of virtual CPUs.
+        ///
+        /// @return Number of virtual CPUs.
+        auto vcpus_count() const noexcept -> usize;
+
+        /// @brief Get exit statistics of virtual CPU.
+        ///
+        /// Safe to call from any thread while virtual machine runs.
+        ///
+        /// @param [in] id given virtual CPU ID.
+        ///
+        /// @return Exit statistics snapshot.
+        auto exit_stats(usize id) const noexcept -> ExitStatsSnapshot;
+
+        /// @brief Get exit statistics summed over all virtual CPUs.
+        ///
+        /// Safe to call from any thread while virtual machine runs.
+        ///
+        /// @return Exit statistics snapshot.
+        auto exit_stats() const noexcept -> ExitStatsSnapshot;
+
+        /// @brief Open kernel binary statistics of virtual machine.
+        ///
+        /// @return KVM statistics - in case of success.
+        /// @return VmmError - otherwise.
+        auto kvm_stats() const -> VmmResult<KvmStats>;
+
+        /// @brief Open kernel binary statistics of virtual CPU.
+        ///
+        /// @param [in] id given virtual CPU ID.
+        ///
+        /// @return KVM statistics - in case of success.
+        /// @return VmmError - otherwise.
+        auto kvm_stats(usize id) const -> VmmResult<KvmStats>;
 
         /// @brief Set userspace memory region.
         ///
+        /// Allocates memory region, sets virtual CPUs to start execution at
+        /// its beginning and makes it destination of raw binaries.
+        ///
         /// @param addr given guest's starting address.
         /// @param size given size of the memory region in bytes.
         ///
@@ -45,6 +194,27 @@ namespace nullvm::core {
         /// @return VmmError - otherwise.
         auto set_mem_region(u64 addr, usize size) noexcept -> VmmResult<None>;
 
+        /// @brief Add userspace memory region.
+        ///
+        /// Allocates memory region without changing virtual CPUs state.
+        ///
+        /// @param addr given region guest physical address.
+        /// @param size given size of the memory region in bytes.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto add_mem_region(u64 addr, usize size) noexcept -> VmmResult<None>;
+
+        /// @brief Get guest physical memory map.
+        ///
+        /// @return VM's guest memory.
+        auto memory() & noexcept -> GuestMemory&;
+
+        /// @brief Get backing actually used for last VM's memory region.
+        ///
+        /// @return Memory backing.
+        auto memory_backing() const noexcept -> MemoryBacking;
+
         /// @brief Load raw binary contents to VM's memory.
         ///
         /// @param raw given raw binary bytes to load.
@@ -53,28 +223,287 @@ namespace nullvm::core {
         /// @return VmmError - otherwise.
         auto load_raw(const std::vector<u8>& raw) noexcept -> VmmResult<None>;
 
+        /// @brief Map image file into guest memory as separate memory slot.
+        ///
+        /// File is not read upfront, guest pages are faulted in lazily from
+        /// page cache and the file itself is never modified.
+        ///
+        /// @param [in] path given path to image file.
+        /// @param [in] addr given page-aligned guest physical address.
+        /// @param [in] mapping given image mapping mode.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto load_image(
+            const std::string& path, u64 addr,
+            ImageMapping mapping = ImageMapping::CopyOnWrite
+        ) noexcept -> VmmResult<None>;
+
+        /// @brief Load ELF64 executable image file into guest memory.
+        ///
+        /// Image is mapped instead of read. Boot virtual CPU starts at
+        /// ELF entry point in its current CPU mode.
+        ///
+        /// @param [in] path given path to ELF image file.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto load_elf(const std::string& path) noexcept -> VmmResult<None>;
+
+        /// @brief Load Linux bzImage file into guest memory.
+        ///
+        /// Images are mapped instead of read. Boot virtual CPU is set up
+        /// according to 32-bit boot protocol (flat protected mode, paging
+        /// disabled, boot parameters address in %esi).
+        ///
+        /// @param [in] path given path to bzImage file.
+        /// @param [in] cmdline given kernel command line.
+        /// @param [in] initrd given path to initial ramdisk (may be empty).
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto load_bzimage(
+            const std::string& path, std::string_view cmdline,
+            const std::string& initrd = {}
+        ) noexcept -> VmmResult<None>;
+
+        /// @brief Save virtual machine snapshot.
+        ///
+        /// Virtual machine must not be running. Virtual CPUs state is
+        /// written to state file, guest memory to sparse memory file.
+        /// Diff snapshot requires dirty logging and writes only pages
+        /// changed since previous snapshot. Diff memory file is applied
+        /// to previous memory file with snapshot::merge_memory().
+        ///
+        /// @param [in] state_path given state file path.
+        /// @param [in] memory_path given memory file path.
+        /// @param [in] type given snapshot type.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto snapshot(
+            const std::string& state_path, const std::string& memory_path,
+            SnapshotType type = SnapshotType::Full
+        ) -> VmmResult<None>;
+
+        /// @brief Restore virtual machine from snapshot.
+        ///
+        /// Virtual machine must be initialized with the same number of
+        /// virtual CPUs and have no memory regions. Memory file is mapped
+        /// copy-on-write, so many virtual machines can be cloned from one
+        /// snapshot without copying guest memory.
+        ///
+        /// @param [in] state_path given state file path.
+        /// @param [in] memory_path given memory file path.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto restore(
+            const std::string& state_path, const std::string& memory_path
+        ) -> VmmResult<None>;
+
+        /// @brief Migrate running virtual machine to another process.
+        ///
+        /// Guest memory is copied while guest keeps running, pages dirtied
+        /// meanwhile are resent in rounds until their number converges or
+        /// rounds limit is reached. Then virtual machine is paused and the
+        /// rest of pages and virtual CPUs state are sent. Virtual machine
+        /// stays paused afterwards, run() resumes it if migration failed.
+        ///
+        /// @param [in] fd given connected stream socket.
+        /// @param [in] config given migration configuration.
+        ///
+        /// @return Migration statistics - in case of success.
+        /// @return VmmError - otherwise.
+        auto migrate_to(i32 fd, const migration::MigrationConfig& config = {})
+        -> VmmResult<migration::MigrationStats>;
+
+        /// @brief Receive virtual machine migrated from another process.
+        ///
+        /// Virtual machine must be initialized with the same number of
+        /// virtual CPUs and have no memory regions. Guest continues on
+        /// next run() call.
+        ///
+        /// @param [in] fd given connected stream socket.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto migrate_from(i32 fd) -> VmmResult<None>;
+
+        /// @brief Get I/O port space device bus.
+        ///
+        /// @return VM's I/O port bus.
+        auto pio_bus() & noexcept -> devices::Bus&;
+
+        /// @brief Get MMIO space device bus.
+        ///
+        /// @return VM's MMIO bus.
+        auto mmio_bus() & noexcept -> devices::Bus&;
+
+        /// @brief Set handler for virtual CPU exit reason.
+        ///
+        /// Handlers must be set before virtual machine runs.
+        ///
+        /// @param [in] reason given KVM exit reason.
+        /// @param [in] handler given exit handler.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_exit_handler(u32 reason, ExitHandler handler) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Register coalesced MMIO/PIO zone.
+        ///
+        /// Guest writes to the zone are batched in the kernel ring and
+        /// handled on the next VM exit instead of exiting on each write.
+        ///
+        /// @param [in] addr given zone guest physical address or port.
+        /// @param [in] size given zone size in bytes.
+        /// @param [in] pio given flag whether zone is in I/O port space.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_coalesced_io(u64 addr, u32 size, bool pio) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Register event file descriptor signaled on guest write.
+        ///
+        /// Write is completed in kernel without exit to userspace.
+        ///
+        /// @param [in] eventfd given event file descriptor to signal.
+        /// @param [in] addr given guest physical address or port.
+        /// @param [in] len given access length in bytes (0 to ignore).
+        /// @param [in] pio given flag whether address is in I/O port space.
+        /// @param [in] datamatch given value written data must match.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_ioeventfd(
+            const utils::EventFd& eventfd, u64 addr, u32 len, bool pio,
+            std::optional<u64> datamatch = std::nullopt
+        ) noexcept -> VmmResult<None>;
+
+        /// @brief Register event file descriptor raising guest interrupt.
+        ///
+        /// Device backends raise interrupt by writing to event file
+        /// descriptor from any thread, interrupt is injected in kernel
+        /// without stopping virtual CPUs. Requires in-kernel irqchip.
+        ///
+        /// @param [in] eventfd given event file descriptor to watch.
+        /// @param [in] gsi given global system interrupt number (IRQ
+        /// line of PIC/IOAPIC).
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_irqfd(const utils::EventFd& eventfd, u32 gsi) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Unregister event file descriptor raising guest interrupt.
+        ///
+        /// @param [in] eventfd given registered event file descriptor.
+        /// @param [in] gsi given global system interrupt number.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto unregister_irqfd(const utils::EventFd& eventfd, u32 gsi)
+        noexcept -> VmmResult<None>;
+
         /// @brief Run virtual machine.
         ///
+        /// Each virtual CPU runs on its own host thread. Returns when all
+        /// virtual CPUs halted, after stop request or on first error.
+        ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
         auto run() noexcept -> VmmResult<None>;
 
+        /// @brief Request all virtual CPUs to stop.
+        ///
+        /// Request made before run() makes it return without entering the
+        /// guest. Safe to call from any thread.
+        auto stop() noexcept -> void;
+
+        /// @brief Stop virtual CPUs and wait until they leave guest.
+        ///
+        /// Virtual CPUs state is consistent afterwards and execution is
+        /// resumed by next run() call. Safe to call from any thread.
+        auto pause() noexcept -> void;
+
     private:
         /// @brief Set VM's memory.
         ///
+        /// @param addr given region guest physical address.
         /// @param size given size of the memory region in bytes to allocate.
+        /// @param flags given KVM memory region flags.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_vm_memory(u64 addr, usize size, u32 flags = 0) noexcept
+        -> VmmResult<None>;
+
+        /// @brief Save state of all virtual CPUs and VM-wide KVM state.
+        ///
+        /// @return Virtual machine state without memory layout - in case
+        /// of success.
+        /// @return VmmError - otherwise.
+        auto save_state() -> VmmResult<snapshot::VmState>;
+
+        /// @brief Save in-kernel interrupt controllers and timer state.
+        ///
+        /// @return Irqchip state - in case of success.
+        /// @return VmmError - otherwise.
+        auto save_irqchip() const -> VmmResult<snapshot::IrqchipState>;
+
+        /// @brief Restore state of all virtual CPUs and VM-wide KVM state.
+        ///
+        /// @param [in] state given virtual machine state.
         ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
-        auto set_vm_memory(usize size) noexcept -> VmmResult<None>;
+        auto restore_state(const snapshot::VmState& state) -> VmmResult<None>;
+
+        /// @brief Run virtual CPU loop on current thread.
+        ///
+        /// @param [in] id given virtual CPU ID.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto run_vcpu(usize id) noexcept -> VmmResult<None>;
+
+        /// @brief Interrupt virtual CPUs running guest code.
+        auto kick_vcpus() noexcept -> void;
+
+        /// @brief Clear stop request left by stop() or pause().
+        auto clear_stop() noexcept -> void;
+
+        /// @brief Handle writes accumulated in coalesced ring.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto drain_coalesced_io() noexcept -> VmmResult<None>;
+
+        /// @brief Set default virtual CPU exit handlers.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto setup_exit_handlers() noexcept -> VmmResult<None>;
 
         /// @brief Handle VM exit on I/O port.
         ///
         /// @param state given virtual CPU state.
         ///
-        /// @return None - in case of success.
+        /// @return Action to take after exit - in case of success.
+        /// @return VmmError - otherwise.
+        auto handle_exit_io(kvm_run& state) noexcept -> VmmResult<ExitAction>;
+
+        /// @brief Handle VM exit on MMIO access.
+        ///
+        /// @param state given virtual CPU state.
+        ///
+        /// @return Action to take after exit - in case of success.
         /// @return VmmError - otherwise.
-        auto handle_exit_io(const kvm_run *state) noexcept -> VmmResult<None>;
+        auto handle_exit_mmio(kvm_run& state) noexcept
+        -> VmmResult<ExitAction>;
     };
 
 }
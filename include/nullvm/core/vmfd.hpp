@@ -9,6 +9,8 @@
 #include <nullvm/core/utils/fd_wrapper.hpp>
 #include <nullvm/types.hpp>
 #include <linux/kvm.h>
+#include <optional>
+#include <span>
 
 namespace nullvm::core {
     using utils::FDWrapper;
@@ -42,11 +44,180 @@ namespace nullvm::core {
         auto set_user_mem_region(const MemoryRegion& region) const noexcept
         -> VmmResult<None>;
 
+        /// @brief Get and clear dirty pages bitmap of memory slot.
+        ///
+        /// Slot must be registered with KVM_MEM_LOG_DIRTY_PAGES flag.
+        ///
+        /// @param [in] slot given memory slot.
+        /// @param [out] bitmap given bitmap with bit per slot page, its
+        /// size must be rounded up to 64 pages.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto get_dirty_log(u32 slot, std::span<u64> bitmap) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Register coalesced MMIO/PIO zone.
+        ///
+        /// Guest writes to the zone are queued in the kernel ring buffer
+        /// instead of causing VM exit.
+        ///
+        /// @param [in] addr given zone guest physical address or port.
+        /// @param [in] size given zone size in bytes.
+        /// @param [in] pio given flag whether zone is in I/O port space.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_coalesced_mmio(u64 addr, u32 size, bool pio)
+        const noexcept -> VmmResult<None>;
+
+        /// @brief Unregister coalesced MMIO/PIO zone.
+        ///
+        /// @param [in] addr given zone guest physical address or port.
+        /// @param [in] size given zone size in bytes.
+        /// @param [in] pio given flag whether zone is in I/O port space.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto unregister_coalesced_mmio(u64 addr, u32 size, bool pio)
+        const noexcept -> VmmResult<None>;
+
+        /// @brief Register event file descriptor signaled on guest write.
+        ///
+        /// @param [in] eventfd given raw event file descriptor.
+        /// @param [in] addr given guest physical address or port.
+        /// @param [in] len given access length in bytes (0 to ignore).
+        /// @param [in] pio given flag whether address is in I/O port space.
+        /// @param [in] datamatch given value written data must match.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_ioeventfd(
+            i32 eventfd, u64 addr, u32 len, bool pio,
+            std::optional<u64> datamatch = std::nullopt
+        ) const noexcept -> VmmResult<None>;
+
+        /// @brief Unregister event file descriptor signaled on guest write.
+        ///
+        /// @param [in] eventfd given raw event file descriptor.
+        /// @param [in] addr given guest physical address or port.
+        /// @param [in] len given access length in bytes (0 to ignore).
+        /// @param [in] pio given flag whether address is in I/O port space.
+        /// @param [in] datamatch given value written data must match.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto unregister_ioeventfd(
+            i32 eventfd, u64 addr, u32 len, bool pio,
+            std::optional<u64> datamatch = std::nullopt
+        ) const noexcept -> VmmResult<None>;
+
+        /// @brief Create in-kernel interrupt controllers.
+        ///
+        /// Creates PIC, IOAPIC and per virtual CPU local APICs, so it must
+        /// be called before virtual CPUs are created.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto create_irqchip() const noexcept -> VmmResult<None>;
+
+        /// @brief Create in-kernel programmable interval timer (i8254).
+        ///
+        /// In-kernel interrupt controllers must be created first.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto create_pit2() const noexcept -> VmmResult<None>;
+
+        /// @brief Get in-kernel interrupt controller state.
+        ///
+        /// @param [in] chip given chip ID (KVM_IRQCHIP_PIC_MASTER,
+        /// KVM_IRQCHIP_PIC_SLAVE or KVM_IRQCHIP_IOAPIC).
+        ///
+        /// @return Interrupt controller state - in case of success.
+        /// @return VmmError - otherwise.
+        auto irqchip(u32 chip) const noexcept -> VmmResult<kvm_irqchip>;
+
+        /// @brief Set in-kernel interrupt controller state.
+        ///
+        /// @param [in] irqchip given interrupt controller state, chip ID
+        /// selects controller.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_irqchip(const kvm_irqchip& irqchip) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get in-kernel programmable interval timer state.
+        ///
+        /// @return PIT state - in case of success.
+        /// @return VmmError - otherwise.
+        auto pit2() const noexcept -> VmmResult<kvm_pit_state2>;
+
+        /// @brief Set in-kernel programmable interval timer state.
+        ///
+        /// @param [in] pit given PIT state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_pit2(const kvm_pit_state2& pit) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Register event file descriptor raising interrupt.
+        ///
+        /// Each write to event file descriptor injects interrupt on GSI in
+        /// kernel without stopping virtual CPUs. With resample file
+        /// descriptor interrupt is level-triggered: it stays asserted until
+        /// guest acknowledges it, then resample event is signaled.
+        ///
+        /// @param [in] eventfd given raw event file descriptor.
+        /// @param [in] gsi given global system interrupt number.
+        /// @param [in] resamplefd given raw resample event file descriptor.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto register_irqfd(
+            i32 eventfd, u32 gsi, std::optional<i32> resamplefd = std::nullopt
+        ) const noexcept -> VmmResult<None>;
+
+        /// @brief Unregister event file descriptor raising interrupt.
+        ///
+        /// @param [in] eventfd given raw event file descriptor.
+        /// @param [in] gsi given global system interrupt number.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto unregister_irqfd(i32 eventfd, u32 gsi) const noexcept
+        -> VmmResult<None>;
+
+        /// @brief Get KVM clock (kvmclock) state.
+        ///
+        /// @return Clock state - in case of success.
+        /// @return VmmError - otherwise.
+        auto clock() const noexcept -> VmmResult<kvm_clock_data>;
+
+        /// @brief Set KVM clock (kvmclock) state.
+        ///
+        /// @param [in] clock given clock state to set.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto set_clock(const kvm_clock_data& clock) const noexcept
+        -> VmmResult<None>;
+
         /// @brief Create virtual CPU.
         ///
+        /// @param [in] id given virtual CPU identifier (APIC ID).
+        ///
         /// @return New virtual CPU file descriptor - in case of success.
         /// @return VmmError - otherwise.
-        auto create_vcpu() const -> VmmResult<i32>;
+        auto create_vcpu(u32 id) const -> VmmResult<i32>;
+
+        /// @brief Get binary statistics file descriptor.
+        ///
+        /// @return New statistics file descriptor - in case of success.
+        /// @return VmmError - otherwise.
+        auto stats_fd() const noexcept -> VmmResult<i32>;
     };
 
 }
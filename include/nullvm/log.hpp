@@ -6,15 +6,79 @@
 #ifndef NULLVM_LOG_HPP
 #define NULLVM_LOG_HPP
 
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <nullvm/log/backend.hpp>
+#include <nullvm/types.hpp>
 #include <source_location>
 #include <string_view>
 #include <stdexcept>
+#include <iterator>
+#include <atomic>
 #include <format>
-#include <print>
+
+/// Minimal log level compiled into binary (see log::Level).
+/// Messages below this level are removed at compile time.
+#ifndef NULLVM_LOG_LEVEL
+#define NULLVM_LOG_LEVEL 0
+#endif
 
 namespace nullvm::log {
 
+    /// Log levels enumeration.
+    enum class Level : u8 {
+        /// Debug messages.
+        Debug = 0,
+        /// Informational messages.
+        Info  = 1,
+        /// Error messages.
+        Error = 2,
+        /// Panic messages (never filtered).
+        Panic = 3
+    };
+
+    /// Minimal log level compiled into binary.
+    constexpr auto COMPILED_LEVEL {static_cast<Level>(NULLVM_LOG_LEVEL)};
+
+    /// Minimal log level printed at runtime.
+    inline std::atomic<Level> g_level {COMPILED_LEVEL};
+
+    /// @brief Set minimal log level printed at runtime.
+    ///
+    /// @param [in] level given minimal log level.
+    inline auto set_level(Level level) noexcept -> void {
+        g_level.store(level, std::memory_order_relaxed);
+    }
+
+    /// @brief Get minimal log level printed at runtime.
+    ///
+    /// @return Minimal log level.
+    inline auto level() noexcept -> Level {
+        return g_level.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Check whether messages of log level are printed.
+    ///
+    /// @param [in] level given log level to check.
+    ///
+    /// @return true - if messages of given level are printed.
+    /// @return false - otherwise.
+    inline auto enabled(Level level) noexcept -> bool {
+        return level >= COMPILED_LEVEL && level >= log::level();
+    }
+
+    /// @brief Set file descriptor log messages are written to.
+    ///
+    /// Messages queued before the call are written to previous output.
+    ///
+    /// @param [in] fd given output file descriptor.
+    inline auto set_output(i32 fd) noexcept -> void {
+        backend::Logger::instance().set_output(fd);
+    }
+
+    /// @brief Wait until all queued log messages are written.
+    inline auto flush() noexcept -> void {
+        backend::Logger::instance().flush();
+    }
+
     /// @brief Logs a custom message into string.
     ///
     /// @param [in] level given custom log level string.
@@ -30,17 +94,23 @@ namespace nullvm::log {
     )
     -> std::string {
 
-        const auto now = boost::posix_time::second_clock::local_time();
-        auto current_time = boost::posix_time::to_simple_string(now);
+        std::string msg {"["};
+        backend::append_time(backend::now(), msg);
 
-        auto time_str = std::format("[{}] [{}] ", current_time, level);
-        auto log_str = std::format(fmt, std::forward<Args>(args)...);
+        std::format_to(std::back_inserter(msg), "] [{}] ", level);
+        std::format_to(
+            std::back_inserter(msg), fmt, std::forward<Args>(args)...
+        );
+        msg += '\n';
 
-        return time_str + log_str + "\n";
+        return msg;
     }
 
     /// @brief Logs a custom message with a specified format and arguments.
     ///
+    /// Message is encoded into per-thread buffer and written asynchronously
+    /// by logger backend thread. Format string must be a string literal.
+    ///
     /// @param [in] level given custom log level string.
     /// @param [in] fmt given format string.
     /// @param [in] args given format string arguments.
@@ -51,8 +121,12 @@ namespace nullvm::log {
         Args&&... args
     )
     -> void {
-        auto msg = custom_format(level, fmt, std::forward<Args>(args)...);
-        std::print("{}", msg);
+        const auto format = fmt.get();
+
+        backend::submit(
+            level, std::string_view {format.data(), format.size()},
+            std::forward<Args>(args)...
+        );
     }
 
     /// @brief Logs an informational message.
@@ -61,16 +135,24 @@ namespace nullvm::log {
     /// @param [in] args given format string arguments.
     template<typename... Args>
     auto info(std::format_string<Args...> fmt, Args&&... args) -> void {
-        custom("INFO", fmt, std::forward<Args>(args)...);
+        if constexpr (COMPILED_LEVEL <= Level::Info) {
+            if (enabled(Level::Info))
+                custom("INFO", fmt, std::forward<Args>(args)...);
+        }
     }
 
     /// @brief Logs a debug message.
     ///
+    /// Compiled out unless NULLVM_LOG_LEVEL enables debug messages.
+    ///
     /// @param [in] fmt given format string.
     /// @param [in] args given format string arguments.
     template<typename... Args>
     auto debug(std::format_string<Args...> fmt, Args&&... args) -> void {
-        custom("DEBUG", fmt, std::forward<Args>(args)...);
+        if constexpr (COMPILED_LEVEL <= Level::Debug) {
+            if (enabled(Level::Debug))
+                custom("DEBUG", fmt, std::forward<Args>(args)...);
+        }
     }
 
     /// @brief Logs an error message.
@@ -79,7 +161,10 @@ namespace nullvm::log {
     /// @param [in] args given format string arguments.
     template<typename... Args>
     auto error(std::format_string<Args...> fmt, Args&&... args) -> void {
-        custom("ERROR", fmt, std::forward<Args>(args)...);
+        if constexpr (COMPILED_LEVEL <= Level::Error) {
+            if (enabled(Level::Error))
+                custom("ERROR", fmt, std::forward<Args>(args)...);
+        }
     }
 
     /// @brief Logs a message inside tests.
@@ -128,6 +213,7 @@ namespace nullvm::log {
         custom("PANIC", "On line: {}", loc.line());
         custom("PANIC", fmt.format, std::forward<Args>(args)...);
 
+        flush();
         throw std::runtime_error("Panic occured");
     }
 
@@ -0,0 +1,668 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Asynchronous logger backend.
+///
+/// Logging threads encode records in binary form into their own lock-free
+/// ring buffers. Background thread formats records and writes them to the
+/// output in batches, so producers never block on output.
+
+#ifndef NULLVM_LOG_BACKEND_HPP
+#define NULLVM_LOG_BACKEND_HPP
+
+#include <nullvm/core/utils/spsc_ring.hpp>
+#include <nullvm/types.hpp>
+#include <unistd.h>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <array>
+#include <ctime>
+#include <mutex>
+#include <tuple>
+#include <span>
+#include <bit>
+
+namespace nullvm::log::backend {
+
+    /// Capacity of per-thread records buffer in bytes.
+    constexpr usize THREAD_BUFFER_SIZE {64 * 1024};
+
+    /// Maximum size of single encoded record in bytes.
+    constexpr usize MAX_RECORD_SIZE {4 * 1024};
+
+    /// Maximum size of level string in bytes.
+    constexpr usize MAX_LEVEL_SIZE {32};
+
+    /// Number of nanoseconds in one second.
+    constexpr i64 NSEC_PER_SEC {1'000'000'000};
+
+    /// @brief Get current log timestamp.
+    ///
+    /// Coarse monotonic clock is read through vDSO without system call and
+    /// its resolution is enough for log records.
+    ///
+    /// @return Monotonic clock timestamp in nanoseconds.
+    inline auto now() noexcept -> u64 {
+        timespec ts {};
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+        return static_cast<u64>(ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec);
+    }
+
+    /// @brief Get offset between realtime and monotonic clocks.
+    ///
+    /// @return Offset in nanoseconds, captured once on first call.
+    inline auto realtime_offset() noexcept -> i64 {
+        static const i64 offset = [] {
+            timespec ts {};
+            clock_gettime(CLOCK_REALTIME, &ts);
+
+            return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec -
+                   static_cast<i64>(now());
+        }();
+
+        return offset;
+    }
+
+    /// @brief Append local time of log timestamp to string.
+    ///
+    /// Formatted time is cached per thread and refreshed once per second.
+    ///
+    /// @param [in] timestamp given monotonic clock timestamp.
+    /// @param [out] out given string to append to.
+    inline auto append_time(u64 timestamp, std::string& out) -> void {
+        thread_local time_t cached_second {-1};
+        thread_local std::array<char, 32> cached {};
+        thread_local usize cached_size {0};
+
+        const auto realtime = static_cast<i64>(timestamp) + realtime_offset();
+        const auto second = static_cast<time_t>(realtime / NSEC_PER_SEC);
+
+        if (second != cached_second) {
+            tm local {};
+            localtime_r(&second, &local);
+
+            cached_size = std::strftime(
+                cached.data(), cached.size(), "%Y-%b-%d %H:%M:%S", &local
+            );
+            cached_second = second;
+        }
+
+        out.append(cached.data(), cached_size);
+    }
+
+    /// Argument types encoded as string bytes.
+    template <typename T>
+    concept StringArg = std::convertible_to<const T&, std::string_view>;
+
+    /// Argument types which can be encoded in binary record.
+    template <typename T>
+    concept EncodableArg = StringArg<T> ||
+        (std::is_trivially_copyable_v<T> && !std::is_array_v<T>);
+
+    /// Argument type decoded from binary record.
+    template <typename T>
+    using Decoded = std::conditional_t<StringArg<T>, std::string_view, T>;
+
+    /// @brief Convert string argument to string view.
+    ///
+    /// @param [in] arg given string argument.
+    ///
+    /// @return String view of argument.
+    template <StringArg T>
+    auto to_view(const T& arg) noexcept -> std::string_view {
+        if constexpr (std::is_pointer_v<T>) {
+            if (arg == nullptr)
+                return "(null)";
+        }
+
+        return arg;
+    }
+
+    /// @brief Get size of encoded argument.
+    ///
+    /// @param [in] arg given argument.
+    ///
+    /// @return Encoded argument size in bytes.
+    template <EncodableArg T>
+    auto encoded_size(const T& arg) noexcept -> usize {
+        if constexpr (StringArg<T>)
+            return sizeof(u32) + to_view(arg).size();
+        else
+            return sizeof(T);
+    }
+
+    /// @brief Encode argument.
+    ///
+    /// @param [in] arg given argument.
+    /// @param [in,out] out given position to encode to, moved past argument.
+    template <EncodableArg T>
+    auto encode(const T& arg, std::byte *&out) noexcept -> void {
+        if constexpr (StringArg<T>) {
+            const auto view = to_view(arg);
+            const auto size = static_cast<u32>(view.size());
+
+            std::memcpy(out, &size, sizeof(size));
+            std::memcpy(out + sizeof(size), view.data(), view.size());
+            out += sizeof(size) + view.size();
+        }
+        else {
+            std::memcpy(out, &arg, sizeof(T));
+            out += sizeof(T);
+        }
+    }
+
+    /// @brief Decode argument.
+    ///
+    /// @param [in,out] in given position to decode from, moved past argument.
+    ///
+    /// @return Decoded argument.
+    template <EncodableArg T>
+    auto decode(const std::byte *&in) noexcept -> Decoded<T> {
+        if constexpr (StringArg<T>) {
+            u32 size {0};
+            std::memcpy(&size, in, sizeof(size));
+
+            const std::string_view view {
+                reinterpret_cast<const char*>(in + sizeof(size)), size
+            };
+            in += sizeof(size) + size;
+
+            return view;
+        }
+        else {
+            std::array<std::byte, sizeof(T)> raw;
+            std::memcpy(raw.data(), in, sizeof(T));
+            in += sizeof(T);
+
+            return std::bit_cast<T>(raw);
+        }
+    }
+
+    /// Function formatting encoded record arguments.
+    using Formatter = auto (*)(
+        std::string_view fmt, const std::byte *args, std::string& out
+    ) -> void;
+
+    /// Binary record header, followed by level string and arguments.
+    struct RecordHeader {
+        /// Total record size in bytes.
+        u32 size {0};
+        /// Level string size in bytes.
+        u32 level_size {0};
+        /// Monotonic clock timestamp in nanoseconds.
+        u64 timestamp {0};
+        /// Format string with static storage duration.
+        const char *format {nullptr};
+        /// Format string size in bytes.
+        usize format_size {0};
+        /// Arguments formatter.
+        Formatter formatter {nullptr};
+    };
+
+    /// @brief Format encoded record arguments.
+    ///
+    /// @param [in] fmt given format string.
+    /// @param [in] args given encoded arguments.
+    /// @param [out] out given string to append message to.
+    template <typename... Args>
+    auto format_args(
+        std::string_view fmt, [[maybe_unused]] const std::byte *args,
+        std::string& out
+    ) -> void {
+        // Braced initialization decodes arguments in order.
+        std::tuple<Decoded<Args>...> values {decode<Args>(args)...};
+
+        std::apply([&](auto&... value) {
+            std::vformat_to(
+                std::back_inserter(out), fmt, std::make_format_args(value...)
+            );
+        }, values);
+    }
+
+    /// @brief Append formatted record line to string.
+    ///
+    /// @param [in] header given record header.
+    /// @param [in] payload given record level string and arguments.
+    /// @param [out] out given string to append line to.
+    inline auto format_record(
+        const RecordHeader& header, const std::byte *payload, std::string& out
+    ) -> void {
+        out += '[';
+        append_time(header.timestamp, out);
+        out += "] [";
+        out.append(reinterpret_cast<const char*>(payload), header.level_size);
+        out += "] ";
+
+        try {
+            header.formatter(
+                {header.format, header.format_size},
+                payload + header.level_size, out
+            );
+        }
+        catch (const std::exception&) {
+            out += "<invalid log record>";
+        }
+
+        out += '\n';
+    }
+
+    /// @brief Write whole buffer to file descriptor.
+    ///
+    /// @param [in] fd given file descriptor.
+    /// @param [in] data given string to write.
+    inline auto write_all(i32 fd, std::string_view data) noexcept -> void {
+        while (!data.empty()) {
+            const auto ret = ::write(fd, data.data(), data.size());
+
+            if (ret == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                // Log output is gone, records are dropped.
+                return;
+            }
+
+            data.remove_prefix(static_cast<usize>(ret));
+        }
+    }
+
+    /// Per-thread log records buffer.
+    struct ThreadBuffer {
+        /// Encoded records queue.
+        core::utils::SpscRing<std::byte> ring {THREAD_BUFFER_SIZE};
+        /// Number of records pushed by owner thread.
+        std::atomic<u64> pushed {0};
+        /// Number of records written to output.
+        std::atomic<u64> written {0};
+        /// Flag indicating that owner thread exited.
+        std::atomic<bool> retired {false};
+    };
+
+    /// Asynchronous logger backend.
+    ///
+    /// Logger is created on first use and never destroyed, so that objects
+    /// destroyed at process exit are still able to log. Pending records are
+    /// written at exit and later records are written synchronously.
+    class Logger final {
+        /// Lock protecting registered buffers list.
+        std::mutex m_lock;
+        /// Registered per-thread buffers.
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+        /// Counter of registered buffers list changes.
+        std::atomic<u32> m_generation {0};
+        /// Counter of events waking backend thread.
+        std::atomic<u32> m_events {0};
+        /// Flag indicating that backend thread waits for events.
+        std::atomic<bool> m_sleeping {false};
+        /// Flag indicating that backend thread should exit.
+        std::atomic<bool> m_stop {false};
+        /// Flag indicating that backend thread exited.
+        std::atomic<bool> m_stopped {false};
+        /// Output file descriptor.
+        std::atomic<i32> m_output_fd {STDOUT_FILENO};
+        /// Backend thread.
+        std::thread m_thread;
+
+        /// Line of single record in formatted batch.
+        struct Line {
+            /// Record timestamp.
+            u64 timestamp;
+            /// Line start offset in batch text.
+            usize begin;
+            /// Line end offset in batch text.
+            usize end;
+        };
+
+        /// Handle retiring thread buffer on thread exit.
+        struct BufferHandle {
+            /// Owned buffer.
+            std::shared_ptr<ThreadBuffer> buffer;
+
+            /// @brief Destroy BufferHandle object.
+            ~BufferHandle() noexcept {
+                buffer->retired.store(true, std::memory_order_release);
+            }
+        };
+
+        /// @brief Construct new Logger object.
+        Logger() : m_thread([this] { run(); }) {
+            std::atexit([] { instance().shutdown(); });
+        }
+
+    public:
+        /// @brief Get logger instance.
+        ///
+        /// @return Process-wide logger.
+        static auto instance() noexcept -> Logger& {
+            static auto *logger = new Logger();
+            return *logger;
+        }
+
+        /// @brief Set output file descriptor.
+        ///
+        /// @param [in] fd given file descriptor to write records to.
+        auto set_output(i32 fd) noexcept -> void {
+            flush();
+            m_output_fd.store(fd, std::memory_order_release);
+        }
+
+        /// @brief Queue encoded record for output.
+        ///
+        /// @param [in] record given encoded record.
+        auto push(std::span<const std::byte> record) -> void {
+            if (m_stopped.load(std::memory_order_acquire)) {
+                write_now(record);
+                return;
+            }
+
+            auto& buffer = local_buffer();
+
+            while (!buffer.ring.try_push(record)) {
+                if (m_stopped.load(std::memory_order_acquire)) {
+                    write_now(record);
+                    return;
+                }
+
+                // Buffer is full, let backend thread catch up.
+                wake();
+                std::this_thread::yield();
+            }
+
+            buffer.pushed.store(
+                buffer.pushed.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release
+            );
+
+            // Pairs with fence in backend thread before it goes to sleep.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_sleeping.load(std::memory_order_relaxed))
+                wake();
+        }
+
+        /// @brief Wait until records queued so far are written.
+        auto flush() noexcept -> void {
+            std::vector<std::pair<std::shared_ptr<ThreadBuffer>, u64>> targets;
+
+            {
+                std::lock_guard lock(m_lock);
+
+                for (const auto& buffer : m_buffers) {
+                    targets.emplace_back(
+                        buffer, buffer->pushed.load(std::memory_order_acquire)
+                    );
+                }
+            }
+
+            for (const auto& [buffer, target] : targets) {
+                auto written = buffer->written.load(std::memory_order_acquire);
+
+                while (written < target) {
+                    if (m_stopped.load(std::memory_order_acquire))
+                        return;
+
+                    wake();
+                    buffer->written.wait(written, std::memory_order_acquire);
+                    written = buffer->written.load(std::memory_order_acquire);
+                }
+            }
+        }
+
+    private:
+        /// @brief Get buffer of current thread, registering it on first use.
+        ///
+        /// @return Current thread buffer.
+        auto local_buffer() -> ThreadBuffer& {
+            thread_local BufferHandle handle {register_buffer()};
+            return *handle.buffer;
+        }
+
+        /// @brief Register new thread buffer.
+        ///
+        /// @return Registered buffer.
+        auto register_buffer() -> std::shared_ptr<ThreadBuffer> {
+            auto buffer = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard lock(m_lock);
+            m_buffers.push_back(buffer);
+            m_generation.fetch_add(1, std::memory_order_release);
+
+            return buffer;
+        }
+
+        /// @brief Wake backend thread.
+        auto wake() noexcept -> void {
+            m_events.fetch_add(1, std::memory_order_release);
+            m_events.notify_one();
+        }
+
+        /// @brief Stop backend thread writing pending records.
+        auto shutdown() noexcept -> void {
+            m_stop.store(true, std::memory_order_release);
+            wake();
+            m_thread.join();
+
+            m_stopped.store(true, std::memory_order_release);
+
+            std::lock_guard lock(m_lock);
+
+            for (const auto& buffer : m_buffers)
+                buffer->written.notify_all();
+        }
+
+        /// @brief Format and write record on calling thread.
+        ///
+        /// @param [in] record given encoded record.
+        auto write_now(std::span<const std::byte> record) -> void {
+            RecordHeader header;
+            std::memcpy(&header, record.data(), sizeof(header));
+
+            std::string line;
+            format_record(header, record.data() + sizeof(header), line);
+            write_all(m_output_fd.load(std::memory_order_acquire), line);
+        }
+
+        /// @brief Pop single record from buffer.
+        ///
+        /// @param [in] buffer given thread buffer.
+        /// @param [out] header given record header.
+        /// @param [out] payload given buffer for record payload.
+        ///
+        /// @return true - if record was popped.
+        /// @return false - if buffer is empty.
+        static auto pop_record(
+            ThreadBuffer& buffer, RecordHeader& header,
+            std::vector<std::byte>& payload
+        ) noexcept -> bool {
+            std::array<std::byte, sizeof(RecordHeader)> raw;
+
+            // Records are pushed at once, so header implies whole record.
+            if (buffer.ring.pop(raw) != raw.size())
+                return false;
+
+            header = std::bit_cast<RecordHeader>(raw);
+            payload.resize(header.size - sizeof(RecordHeader));
+            buffer.ring.pop(payload);
+
+            return true;
+        }
+
+        /// @brief Format and write all queued records.
+        ///
+        /// Records of single batch are written in timestamp order.
+        ///
+        /// @param [in] buffers given thread buffers to drain.
+        ///
+        /// @return true - if any records were written.
+        /// @return false - otherwise.
+        auto drain(const std::vector<std::shared_ptr<ThreadBuffer>>& buffers)
+        -> bool {
+            thread_local std::vector<std::byte> payload;
+            thread_local std::vector<u64> counts;
+            thread_local std::vector<Line> lines;
+            thread_local std::string text;
+            thread_local std::string output;
+
+            RecordHeader header;
+            counts.assign(buffers.size(), 0);
+
+            for (usize i = 0; i < buffers.size(); ++i) {
+                while (pop_record(*buffers[i], header, payload)) {
+                    const auto begin = text.size();
+                    format_record(header, payload.data(), text);
+
+                    lines.push_back({header.timestamp, begin, text.size()});
+                    ++counts[i];
+                }
+            }
+
+            if (lines.empty())
+                return false;
+
+            std::ranges::stable_sort(lines, {}, &Line::timestamp);
+
+            for (const auto& line : lines)
+                output.append(text, line.begin, line.end - line.begin);
+
+            write_all(m_output_fd.load(std::memory_order_acquire), output);
+
+            for (usize i = 0; i < buffers.size(); ++i) {
+                if (counts[i] == 0)
+                    continue;
+
+                buffers[i]->written.fetch_add(
+                    counts[i], std::memory_order_release
+                );
+                buffers[i]->written.notify_all();
+            }
+
+            lines.clear();
+            text.clear();
+            output.clear();
+
+            return true;
+        }
+
+        /// @brief Remove buffers of exited threads which have no records.
+        auto collect_retired() -> void {
+            std::lock_guard lock(m_lock);
+
+            const auto removed = std::erase_if(m_buffers, [](const auto& b) {
+                return b->retired.load(std::memory_order_acquire) &&
+                       b->ring.empty();
+            });
+
+            if (removed > 0)
+                m_generation.fetch_add(1, std::memory_order_release);
+        }
+
+        /// @brief Backend thread loop.
+        auto run() -> void {
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            u32 generation {0};
+
+            while (true) {
+                const auto events = m_events.load(std::memory_order_acquire);
+
+                const auto current =
+                    m_generation.load(std::memory_order_acquire);
+
+                if (current != generation) {
+                    std::lock_guard lock(m_lock);
+                    buffers = m_buffers;
+                    generation = m_generation.load(std::memory_order_acquire);
+                }
+
+                if (drain(buffers))
+                    continue;
+
+                if (m_stop.load(std::memory_order_acquire))
+                    break;
+
+                collect_retired();
+
+                m_sleeping.store(true, std::memory_order_relaxed);
+
+                // Pairs with fence in push(): either producer observes
+                // sleeping flag or its record is observed here.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                const auto idle = std::ranges::all_of(buffers, [](auto& b) {
+                    return b->ring.empty();
+                });
+
+                if (idle && m_generation.load() == generation)
+                    m_events.wait(events, std::memory_order_acquire);
+
+                m_sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /// @brief Encode log record and queue it for output.
+    ///
+    /// Arguments without binary representation and oversized records are
+    /// formatted on calling thread and queued as text.
+    ///
+    /// @param [in] level given level string.
+    /// @param [in] fmt given format string with static storage duration.
+    /// @param [in] args given format string arguments.
+    template <typename... Args>
+    auto submit(std::string_view level, std::string_view fmt, Args&&... args)
+    -> void {
+        level = level.substr(0, MAX_LEVEL_SIZE);
+
+        if constexpr ((EncodableArg<std::remove_cvref_t<Args>> && ...)) {
+            const auto size = sizeof(RecordHeader) + level.size() +
+                              (encoded_size(args) + ... + usize {0});
+
+            if (size <= MAX_RECORD_SIZE) {
+                const RecordHeader header {
+                    .size        = static_cast<u32>(size),
+                    .level_size  = static_cast<u32>(level.size()),
+                    .timestamp   = now(),
+                    .format      = fmt.data(),
+                    .format_size = fmt.size(),
+                    .formatter   = &format_args<std::remove_cvref_t<Args>...>
+                };
+
+                std::array<std::byte, MAX_RECORD_SIZE> record;
+                auto *out = record.data();
+
+                std::memcpy(out, &header, sizeof(header));
+                std::memcpy(out + sizeof(header), level.data(), level.size());
+                out += sizeof(header) + level.size();
+
+                (encode(args, out), ...);
+
+                Logger::instance().push(std::span(record).first(size));
+                return;
+            }
+        }
+
+        auto message = std::vformat(fmt, std::make_format_args(args...));
+        const auto limit = MAX_RECORD_SIZE - sizeof(RecordHeader) -
+                           level.size() - sizeof(u32);
+
+        if (message.size() > limit)
+            message.resize(limit);
+
+        submit(level, "{}", std::string_view {message});
+    }
+
+}
+
+#endif // NULLVM_LOG_BACKEND_HPP
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Datagram unix domain socket (UDS) server related declarations.
+
+#ifndef NULLVM_SERVICE_DATAGRAM_UDS_HPP
+#define NULLVM_SERVICE_DATAGRAM_UDS_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/utils/eventfd.hpp>
+#include <nullvm/service/protocol.hpp>
+#include <nullvm/service/server.hpp>
+#include <nullvm/types.hpp>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nullvm::service {
+    using core::utils::FDWrapper;
+    using core::utils::EventFd;
+
+    /// Datagram UDS server socket path.
+    constexpr auto DATAGRAM_SERVER_PATH {"/tmp/nullvm_datagram_server"};
+
+    /// Datagram UDS server configuration struct.
+    struct DatagramUDSConfig {
+        /// Server socket path.
+        std::string path {DATAGRAM_SERVER_PATH};
+        /// Maximum number of datagrams received per recvmmsg() call.
+        usize batch_size {32};
+        /// Maximum datagram size in bytes, larger ones are dropped.
+        usize max_datagram {4096};
+    };
+
+    /// Datagram control message handler, appends encoded reply to output.
+    ///
+    /// Reply is sent back only if sender socket is bound to address.
+    using DatagramHandler = std::function<
+        void(const protocol::Message&, Bytes&)
+    >;
+
+    /// Datagram UDS server class.
+    ///
+    /// Each datagram carries single control message. Datagrams are
+    /// received in batches with recvmmsg() and replies of whole batch
+    /// are sent with single sendmmsg(), so bursts of small messages from
+    /// many senders cost few syscalls and need no connection each.
+    class DatagramUDS final : public Server {
+        /// Server configuration.
+        DatagramUDSConfig m_config;
+        /// Socket file descriptor.
+        FDWrapper m_sockfd;
+        /// Event signaled to stop server loop.
+        EventFd m_stop;
+        /// Control message handler.
+        DatagramHandler m_handler;
+        /// Receive buffers, max_datagram bytes per batch slot.
+        Bytes m_buffers;
+        /// Reply buffers per batch slot.
+        std::vector<Bytes> m_replies;
+        /// Sender addresses per batch slot.
+        std::vector<sockaddr_un> m_senders;
+        /// Scatter vectors per batch slot.
+        std::vector<iovec> m_iovecs;
+        /// Received messages headers per batch slot.
+        std::vector<mmsghdr> m_received;
+        /// Reply messages headers.
+        std::vector<mmsghdr> m_outgoing;
+
+    public:
+        /// @brief Construct new DatagramUDS object.
+        ///
+        /// @param [in] config given server configuration.
+        explicit DatagramUDS(const DatagramUDSConfig& config = {}) noexcept;
+
+        /// @brief Initialize DatagramUDS object.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init() noexcept -> VmmResult<None> override;
+
+        /// @brief Send data to connected peer.
+        ///
+        /// @param [in] fd given connected socket file descriptor.
+        /// @param [in] data given sequence of bytes to send.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto send(i32 fd, const Bytes& data) noexcept
+        -> VmmResult<None> override;
+
+        /// @brief Send data to client along with file descriptors.
+        ///
+        /// @param [in] fd given client connection file descriptor.
+        /// @param [in] data given sequence of bytes to send (not empty).
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto send_fds(
+            i32 fd, const Bytes& data, std::span<const i32> fds
+        ) noexcept -> VmmResult<None> override;
+
+        /// @brief Receive single datagram.
+        ///
+        /// @param [in] fd given socket file descriptor.
+        ///
+        /// @return Received sequence of bytes - in case of success.
+        /// @return VmmError - otherwise.
+        auto recv(i32 fd) noexcept -> VmmResult<Bytes> override;
+
+        /// @brief Run server.
+        ///
+        /// Blocks until stop() is called or receiving fails.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto run() noexcept -> VmmResult<None> override;
+
+        /// @brief Stop running server.
+        ///
+        /// Safe to call from any thread.
+        auto stop() noexcept -> void;
+
+        /// @brief Set control message handler.
+        ///
+        /// Must be set before run().
+        ///
+        /// @param [in] handler given control message handler.
+        auto set_handler(DatagramHandler handler) noexcept -> void;
+
+    private:
+        /// @brief Receive and handle pending datagrams in batches.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto drain() noexcept -> VmmResult<None>;
+
+        /// @brief Handle received batch and send replies.
+        ///
+        /// @param [in] count given number of received datagrams.
+        auto handle_batch(usize count) noexcept -> void;
+    };
+
+}
+
+#endif // NULLVM_SERVICE_DATAGRAM_UDS_HPP
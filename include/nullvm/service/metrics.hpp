@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine metrics related declarations.
+
+#ifndef NULLVM_SERVICE_METRICS_HPP
+#define NULLVM_SERVICE_METRICS_HPP
+
+#include <nullvm/service/protocol.hpp>
+#include <nullvm/core/kvm_stats.hpp>
+#include <nullvm/core/vm.hpp>
+#include <nullvm/types.hpp>
+#include <unordered_map>
+#include <shared_mutex>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <span>
+
+namespace nullvm::service {
+
+    /// Kernel statistics of single virtual machine served to clients.
+    ///
+    /// Statistics descriptors are read once, so each snapshot costs one
+    /// pread() per virtual machine and virtual CPU into reply buffer
+    /// allocated on initialization. Names are sent separately in schema,
+    /// snapshots carry values only.
+    class VmMetrics final {
+        /// Virtual machine ID.
+        u32 m_vm_id {0};
+        /// Virtual machine statistics.
+        core::KvmStats m_vm;
+        /// Virtual CPU statistics indexed by virtual CPU ID.
+        std::vector<core::KvmStats> m_vcpus;
+        /// Preallocated snapshot payload (protocol::VmStatsReply).
+        Bytes m_snapshot;
+
+    public:
+        /// @brief Initialize VmMetrics object.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        /// @param [in] vm given initialized virtual machine.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(u32 vm_id, const core::VirtualMachine& vm)
+        -> VmmResult<None>;
+
+        /// @brief Encode statistics schema.
+        ///
+        /// @param [out] output given buffer protocol::StatsSchemaReply
+        /// payload is appended to.
+        auto schema(Bytes& output) const -> void;
+
+        /// @brief Sample current statistics values.
+        ///
+        /// @return protocol::VmStatsReply payload, valid until next
+        /// call - in case of success.
+        /// @return VmmError - otherwise.
+        auto snapshot() noexcept -> VmmResult<std::span<const std::byte>>;
+    };
+
+    /// Kernel statistics of virtual machines managed by service.
+    ///
+    /// Serves VmStats and StatsSchema requests from stream and datagram
+    /// handlers. Requests for different virtual machines are served
+    /// concurrently, requests for the same one are serialized, since they
+    /// share its snapshot buffer.
+    class MetricsRegistry final {
+        /// Metrics of single virtual machine.
+        struct Entry {
+            /// Virtual machine metrics.
+            VmMetrics metrics;
+            /// Lock serializing snapshots.
+            std::mutex lock;
+        };
+
+        /// Metrics indexed by virtual machine ID.
+        std::unordered_map<u32, std::unique_ptr<Entry>> m_entries;
+        /// Lock protecting metrics map.
+        std::shared_mutex m_lock;
+
+    public:
+        /// @brief Start serving statistics of virtual machine.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        /// @param [in] vm given initialized virtual machine.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto add(u32 vm_id, const core::VirtualMachine& vm)
+        -> VmmResult<None>;
+
+        /// @brief Stop serving statistics of virtual machine.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        auto remove(u32 vm_id) -> void;
+
+        /// @brief Handle statistics request.
+        ///
+        /// Appends Ok reply with requested payload, or Error reply if
+        /// virtual machine is unknown or statistics cannot be read.
+        ///
+        /// @param [in] message given control request.
+        /// @param [out] output given buffer reply is appended to.
+        ///
+        /// @return true - if message is statistics request.
+        /// @return false - otherwise, nothing is appended.
+        auto handle(const protocol::Message& message, Bytes& output) -> bool;
+    };
+
+}
+
+#endif // NULLVM_SERVICE_METRICS_HPP
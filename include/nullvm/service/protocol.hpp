@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Control protocol related declarations.
+
+#ifndef NULLVM_SERVICE_PROTOCOL_HPP
+#define NULLVM_SERVICE_PROTOCOL_HPP
+
+#include <nullvm/types.hpp>
+#include <type_traits>
+#include <optional>
+#include <cstring>
+#include <span>
+
+namespace nullvm::service::protocol {
+
+    /// Control message magic number ("NVMP" in little-endian).
+    constexpr u32 PROTOCOL_MAGIC {0x504d564e};
+
+    /// Control protocol version.
+    constexpr std::uint16_t PROTOCOL_VERSION {1};
+
+    /// Default control message payload size limit in bytes.
+    constexpr u32 MAX_PAYLOAD_SIZE {16 * 1024 * 1024};
+
+    /// Control message type enumeration.
+    enum class MessageType : std::uint16_t {
+        /// Create virtual machine (CreateVmRequest), reply payload is
+        /// CreateVmReply.
+        CreateVm = 1,
+        /// Start virtual machine (VmRequest).
+        StartVm,
+        /// Stop virtual machine (VmRequest).
+        StopVm,
+        /// Snapshot virtual machine (VmRequest, state and memory paths).
+        SnapshotVm,
+        /// Get virtual machine statistics (VmRequest), reply payload is
+        /// VmStatsReply.
+        VmStats,
+        /// Get virtual machine statistics schema (VmRequest), reply
+        /// payload is StatsSchemaReply.
+        StatsSchema,
+        /// Destroy virtual machine (VmRequest).
+        DestroyVm,
+        /// Successful reply, payload depends on request.
+        Ok = 0x8000,
+        /// Failed reply, payload is error message.
+        Error
+    };
+
+    /// Control message header, followed by payload.
+    ///
+    /// Fields are in host byte order, peers are on the same host.
+    struct MessageHeader {
+        /// Magic number (PROTOCOL_MAGIC).
+        u32 magic {PROTOCOL_MAGIC};
+        /// Protocol version.
+        std::uint16_t version {PROTOCOL_VERSION};
+        /// Message type.
+        MessageType type {MessageType::Ok};
+        /// Request ID, copied to reply.
+        u32 id {0};
+        /// Payload size in bytes.
+        u32 size {0};
+    };
+
+    /// Create virtual machine request payload.
+    struct CreateVmRequest {
+        /// Number of virtual CPUs.
+        u32 vcpus {1};
+        /// Reserved.
+        u32 reserved {0};
+        /// Guest memory size in bytes.
+        u64 memory_size {0};
+    };
+
+    /// Create virtual machine reply payload.
+    struct CreateVmReply {
+        /// ID of created virtual machine.
+        u32 vm_id {0};
+        /// Reserved.
+        u32 reserved {0};
+    };
+
+    /// Request payload addressing existing virtual machine.
+    struct VmRequest {
+        /// Virtual machine ID.
+        u32 vm_id {0};
+        /// Reserved.
+        u32 reserved {0};
+    };
+
+    /// Virtual machine statistics reply payload.
+    ///
+    /// Followed by vm_values virtual machine values and vcpu_values
+    /// values of each virtual CPU, all u64 and laid out as described
+    /// by statistics schema.
+    struct VmStatsReply {
+        /// Virtual machine ID.
+        u32 vm_id {0};
+        /// Number of virtual CPUs.
+        u32 vcpus {0};
+        /// Number of virtual machine values.
+        u32 vm_values {0};
+        /// Number of values per virtual CPU.
+        u32 vcpu_values {0};
+    };
+
+    /// Statistics schema reply payload.
+    ///
+    /// Followed by vm_stats virtual machine statistics and vcpu_stats
+    /// virtual CPU statistics, each as StatsSchemaEntry and its name.
+    struct StatsSchemaReply {
+        /// Number of virtual machine statistics.
+        u32 vm_stats {0};
+        /// Number of virtual CPU statistics.
+        u32 vcpu_stats {0};
+    };
+
+    /// Statistic description in schema, followed by its name.
+    struct StatsSchemaEntry {
+        /// Statistic type, unit and base (KVM_STATS_*).
+        u32 flags {0};
+        /// Unit exponent.
+        std::int16_t exponent {0};
+        /// Number of values.
+        std::uint16_t size {0};
+        /// Index of first value in statistics reply values.
+        u32 index {0};
+        /// Linear histogram bucket size.
+        u32 bucket_size {0};
+        /// Name size in bytes.
+        u32 name_size {0};
+    };
+
+    /// Parsed control message.
+    struct Message {
+        /// Message header.
+        MessageHeader header {};
+        /// Message payload, valid until parser is written to again.
+        std::span<const std::byte> payload {};
+    };
+
+    /// Incremental control messages parser.
+    ///
+    /// Bytes are read straight into parser buffer, which is reused for
+    /// the whole connection. Parsed messages point into this buffer. Once
+    /// header arrives, space for up to 64 KiB of its payload is reserved.
+    /// Larger payloads double the buffer as they arrive, so memory follows
+    /// received bytes rather than sizes claimed in headers.
+    class Parser final {
+        /// Received bytes.
+        Bytes m_buffer;
+        /// Offset of first unparsed byte.
+        usize m_start {0};
+        /// Offset past last received byte.
+        usize m_end {0};
+        /// Payload size limit in bytes.
+        u32 m_max_payload {MAX_PAYLOAD_SIZE};
+
+    public:
+        /// @brief Construct new Parser object.
+        ///
+        /// @param [in] max_payload given payload size limit in bytes.
+        explicit Parser(u32 max_payload = MAX_PAYLOAD_SIZE) noexcept;
+
+        /// @brief Get free buffer space to receive bytes into.
+        ///
+        /// Invalidates previously parsed messages.
+        ///
+        /// @param [in] min_size given minimal free space in bytes.
+        ///
+        /// @return Free buffer space.
+        auto buffer(usize min_size = 4096) -> std::span<std::byte>;
+
+        /// @brief Mark bytes received into buffer.
+        ///
+        /// @param [in] count given number of received bytes.
+        auto commit(usize count) noexcept -> void;
+
+        /// @brief Parse next complete message.
+        ///
+        /// @return Message - if complete message is buffered.
+        /// @return std::nullopt - if more bytes are needed.
+        /// @return VmmError - if stream is malformed.
+        auto next() noexcept -> VmmResult<std::optional<Message>>;
+
+        /// @brief Get number of buffered unparsed bytes.
+        ///
+        /// @return Number of buffered bytes.
+        auto pending() const noexcept -> usize;
+    };
+
+    /// @brief Parse single complete message.
+    ///
+    /// Used for datagrams, which carry exactly one message each.
+    ///
+    /// @param [in] data given message bytes.
+    /// @param [in] max_payload given payload size limit in bytes.
+    ///
+    /// @return Message - in case of success.
+    /// @return VmmError - otherwise.
+    auto parse(std::span<const std::byte> data, u32 max_payload)
+    noexcept -> VmmResult<Message>;
+
+    /// @brief Append message to output buffer.
+    ///
+    /// @param [out] output given output buffer.
+    /// @param [in] type given message type.
+    /// @param [in] id given request ID.
+    /// @param [in] payload given message payload.
+    auto encode(
+        Bytes& output, MessageType type, u32 id,
+        std::span<const std::byte> payload = {}
+    ) -> void;
+
+    /// @brief Decode fixed-size message payload.
+    ///
+    /// @param [in] payload given message payload.
+    ///
+    /// @return Decoded payload - in case of success.
+    /// @return VmmError - otherwise.
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    auto decode(std::span<const std::byte> payload) noexcept
+    -> VmmResult<T> {
+        if (payload.size() < sizeof(T))
+            return std::unexpected("Control message payload is too short");
+
+        T value {};
+        std::memcpy(&value, payload.data(), sizeof(T));
+
+        return value;
+    }
+
+}
+
+#endif // NULLVM_SERVICE_PROTOCOL_HPP
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// File descriptors passing over unix domain sockets related declarations.
+
+#ifndef NULLVM_SERVICE_SCM_RIGHTS_HPP
+#define NULLVM_SERVICE_SCM_RIGHTS_HPP
+
+#include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/types.hpp>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+#include <span>
+
+namespace nullvm::service {
+    using core::utils::FDWrapper;
+
+    /// Maximum number of file descriptors passed with single message.
+    constexpr usize MAX_PASSED_FDS {253};
+
+    /// Message carrying file descriptors in SCM_RIGHTS control message.
+    ///
+    /// Message headers point into object, so it must stay alive and in
+    /// place while sendmsg() using it is in flight.
+    class FdMessage final {
+        /// Data buffer descriptor.
+        iovec m_iov {};
+        /// Message header.
+        msghdr m_header {};
+        /// Control message buffer.
+        std::vector<std::byte> m_control;
+
+    public:
+        /// @brief Initialize FdMessage object.
+        ///
+        /// Stream sockets pass descriptors only along with data, so data
+        /// must not be empty.
+        ///
+        /// @param [in] data given data to send along with descriptors.
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(std::span<const std::byte> data, std::span<const i32> fds)
+        noexcept -> VmmResult<None>;
+
+        /// @brief Get message header.
+        ///
+        /// @return Message header for sendmsg().
+        auto header() noexcept -> msghdr*;
+    };
+
+    /// File descriptors attached to queued reply bytes.
+    struct FdAttachment {
+        /// Offset of first reply byte descriptors are sent with.
+        usize offset {0};
+        /// Duplicated file descriptors to pass.
+        std::vector<FDWrapper> fds {};
+
+        /// @brief Get raw values of attached file descriptors.
+        ///
+        /// @return Raw file descriptor values.
+        auto raw() const noexcept -> std::vector<i32>;
+    };
+
+    /// Queued replies with attached file descriptors.
+    struct Reply {
+        /// Encoded reply messages.
+        Bytes data {};
+        /// Attached file descriptors, ordered by offset.
+        std::vector<FdAttachment> attachments {};
+
+        /// @brief Attach file descriptors to next reply appended to data.
+        ///
+        /// Descriptors are duplicated, so caller keeps its own copies.
+        /// Reply is left unchanged if any descriptor cannot be attached.
+        ///
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto attach(std::span<const i32> fds) noexcept -> VmmResult<None>;
+
+        /// @brief Remove all replies and attached descriptors.
+        auto clear() noexcept -> void;
+    };
+
+    /// @brief Send data along with file descriptors.
+    ///
+    /// Stream socket may accept only part of data, descriptors are
+    /// passed with its first byte.
+    ///
+    /// @param [in] sockfd given connected unix domain socket.
+    /// @param [in] data given data to send (must not be empty).
+    /// @param [in] fds given file descriptors to pass.
+    ///
+    /// @return Number of sent bytes - in case of success.
+    /// @return VmmError - otherwise.
+    auto send_fds(
+        i32 sockfd, std::span<const std::byte> data, std::span<const i32> fds
+    ) noexcept -> VmmResult<usize>;
+
+    /// @brief Receive data along with passed file descriptors.
+    ///
+    /// Received descriptors are close-on-exec and are appended to fds.
+    ///
+    /// @param [in] sockfd given connected unix domain socket.
+    /// @param [out] buffer given buffer for received data.
+    /// @param [out] fds given received file descriptors.
+    ///
+    /// @return Number of received bytes - in case of success.
+    /// @return VmmError - otherwise.
+    auto recv_fds(
+        i32 sockfd, std::span<std::byte> buffer, std::vector<FDWrapper>& fds
+    ) noexcept -> VmmResult<usize>;
+
+}
+
+#endif // NULLVM_SERVICE_SCM_RIGHTS_HPP
@@ -7,6 +7,7 @@
 #define NULLVM_SERVICE_SERVER_HPP
 
 #include <nullvm/types.hpp>
+#include <span>
 
 namespace nullvm::service {
 
@@ -32,6 +33,21 @@ namespace nullvm::service {
         virtual auto send(i32 fd, const Bytes& data) noexcept
         -> VmmResult<None> = 0;
 
+        /// @brief Send data to client along with file descriptors.
+        ///
+        /// Descriptors are passed with SCM_RIGHTS, so client gets its own
+        /// copies and can, for example, map guest memory directly.
+        ///
+        /// @param [in] fd given client connection file descriptor.
+        /// @param [in] data given sequence of bytes to send (not empty).
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        virtual auto send_fds(
+            i32 fd, const Bytes& data, std::span<const i32> fds
+        ) noexcept -> VmmResult<None> = 0;
+
         /// @brief Receive data from client.
         ///
         /// @param [in] fd given client connection file descriptor.
@@ -47,6 +47,18 @@ namespace nullvm::service {
         auto send(i32 fd, const Bytes& data) noexcept
         -> VmmResult<None> override;
 
+        /// @brief Send data to client along with file descriptors.
+        ///
+        /// @param [in] fd given client connection file descriptor.
+        /// @param [in] data given sequence of bytes to send (not empty).
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto send_fds(
+            i32 fd, const Bytes& data, std::span<const i32> fds
+        ) noexcept -> VmmResult<None> override;
+
         /// @brief Receive data from client.
         ///
         /// @param [in] fd given client connection file descriptor.
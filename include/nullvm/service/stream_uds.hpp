@@ -7,25 +7,94 @@
 #define NULLVM_SERVICE_STREAM_UDS_HPP
 
 #include <nullvm/core/utils/fd_wrapper.hpp>
+#include <nullvm/core/utils/eventfd.hpp>
+#include <nullvm/service/scm_rights.hpp>
+#include <nullvm/service/protocol.hpp>
 #include <nullvm/service/server.hpp>
 #include <nullvm/types.hpp>
+#include <sys/socket.h>
 #include <sys/un.h>
+#include <functional>
+#include <string>
+#include <span>
 
 namespace nullvm::service {
     using core::utils::FDWrapper;
+    using core::utils::EventFd;
 
     /// Stream UDS server socket path.
     /// TODO: change socket directory from '/tmp'.
     constexpr auto STREAM_SERVER_PATH {"/tmp/nullvm_stream_server"};
 
+    /// Server I/O backends enumeration.
+    enum class IOBackend : u8 {
+        /// io_uring if kernel supports it, epoll otherwise.
+        Auto,
+        /// Readiness-based epoll event loop.
+        Epoll,
+        /// Completion-based io_uring event loop.
+        IoUring
+    };
+
+    /// Stream UDS server configuration struct.
+    struct StreamUDSConfig {
+        /// Server socket path.
+        std::string path {STREAM_SERVER_PATH};
+        /// Pending connection requests limit.
+        i32 backlog {SOMAXCONN};
+        /// Number of event loop threads.
+        usize workers {2};
+        /// Maximum number of events handled per epoll_wait() call.
+        usize max_events {64};
+        /// Unsent reply bytes limit, slower clients are disconnected.
+        usize max_pending {1024 * 1024};
+        /// Control message payload size limit in bytes.
+        u32 max_payload {protocol::MAX_PAYLOAD_SIZE};
+        /// Event loop I/O backend.
+        IOBackend backend {IOBackend::Auto};
+    };
+
+    /// Control request handler, appends encoded replies to output.
+    ///
+    /// File descriptors attached to output are passed to client along
+    /// with first byte of next appended reply.
+    using StreamHandler = std::function<
+        void(i32, const protocol::Message&, Reply&)
+    >;
+
     /// Stream UDS server class.
+    ///
+    /// Each worker thread runs its own epoll event loop. Listening socket
+    /// is shared with EPOLLEXCLUSIVE, so connection is woken up in single
+    /// worker which then owns it. Client sockets are non-blocking and
+    /// replies that do not fit socket buffer are queued, so slow client
+    /// never stalls other connections. Clients speak length-prefixed
+    /// control protocol, malformed stream closes connection. Replies may
+    /// carry file descriptors, which are sent with SCM_RIGHTS in order.
+    ///
+    /// With io_uring backend each worker owns a ring instead: clients are
+    /// accepted and read by multishot requests into provided buffers, so
+    /// single io_uring_enter() serves all ready connections.
     class StreamUDS final : public Server {
+        /// Server configuration.
+        StreamUDSConfig m_config;
         /// Socket file descriptor.
         FDWrapper m_sockfd;
         /// Server address.
         sockaddr_un m_addr;
+        /// Event signaled to stop event loops.
+        EventFd m_stop;
+        /// Control request handler.
+        StreamHandler m_handler;
+        /// Resolved I/O backend.
+        IOBackend m_backend {IOBackend::Epoll};
 
     public:
+        /// @brief Construct new StreamUDS object.
+        ///
+        /// @param [in] config given server configuration.
+        explicit StreamUDS(const StreamUDSConfig& config = {}) noexcept;
+
         /// @brief Initialize StreamUDS object.
         ///
         /// @return None - in case of success.
@@ -42,6 +111,18 @@ namespace nullvm::service {
         auto send(i32 fd, const Bytes& data) noexcept
         -> VmmResult<None> override;
 
+        /// @brief Send data to client along with file descriptors.
+        ///
+        /// @param [in] fd given client connection file descriptor.
+        /// @param [in] data given sequence of bytes to send (not empty).
+        /// @param [in] fds given file descriptors to pass.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto send_fds(
+            i32 fd, const Bytes& data, std::span<const i32> fds
+        ) noexcept -> VmmResult<None> override;
+
         /// @brief Receive data from client.
         ///
         /// @param [in] fd given client connection file descriptor.
@@ -52,16 +133,48 @@ namespace nullvm::service {
 
         /// @brief Run server.
         ///
+        /// Blocks until stop() is called or event loop fails.
+        ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
         auto run() noexcept -> VmmResult<None> override;
 
+        /// @brief Stop running server.
+        ///
+        /// Safe to call from any thread.
+        auto stop() noexcept -> void;
+
+        /// @brief Get I/O backend used by event loops.
+        ///
+        /// @return Resolved I/O backend (valid after init()).
+        auto backend() const noexcept -> IOBackend;
+
+        /// @brief Set control request handler.
+        ///
+        /// Handler is called from worker threads concurrently, but never
+        /// concurrently for the same client. Must be set before run().
+        ///
+        /// @param [in] handler given control request handler.
+        auto set_handler(StreamHandler handler) noexcept -> void;
+
     private:
         /// @brief Bind server address.
         ///
         /// @return None - in case of success.
         /// @return VmmError - otherwise.
         auto link() noexcept -> VmmResult<None>;
+
+        /// @brief Run single worker epoll event loop.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto run_epoll_worker() noexcept -> VmmResult<None>;
+
+        /// @brief Run single worker io_uring event loop.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto run_uring_worker() noexcept -> VmmResult<None>;
     };
 
 }
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Pre-initialized virtual machines pool related declarations.
+
+#ifndef NULLVM_SERVICE_VM_POOL_HPP
+#define NULLVM_SERVICE_VM_POOL_HPP
+
+#include <nullvm/core/kvm.hpp>
+#include <nullvm/core/vm.hpp>
+#include <nullvm/types.hpp>
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <mutex>
+
+namespace nullvm::service {
+
+    /// Virtual machines pool configuration struct.
+    struct VmPoolConfig {
+        /// Configuration of pooled virtual machines.
+        core::VmConfig vm {};
+        /// Guest physical address of pooled virtual machines memory.
+        u64 memory_addr {0};
+        /// Size of pooled virtual machines memory in bytes.
+        usize memory_size {0};
+        /// Number of ready virtual machines kept in pool.
+        usize capacity {4};
+    };
+
+    /// Virtual machines pool statistics struct.
+    struct VmPoolStats {
+        /// Number of acquisitions served from pool.
+        u64 hits {0};
+        /// Number of acquisitions that created virtual machine inline.
+        u64 misses {0};
+    };
+
+    /// Pool of pre-initialized virtual machines.
+    ///
+    /// Virtual machines are created ahead of time with virtual CPUs and
+    /// memory already set up, sharing one KVM handle. Acquired virtual
+    /// machines are replaced by background thread, so creation cost is
+    /// taken off the request path.
+    class VmPool final {
+        /// Shared KVM subsystem handle.
+        std::shared_ptr<const core::Kvm> m_kvm;
+        /// Pool configuration.
+        VmPoolConfig m_config;
+        /// Ready virtual machines.
+        std::deque<std::unique_ptr<core::VirtualMachine>> m_ready;
+        /// Lock protecting ready virtual machines.
+        std::mutex m_lock;
+        /// Condition signaled when pool needs refill.
+        std::condition_variable_any m_refill;
+        /// Number of acquisitions served from pool.
+        std::atomic<u64> m_hits {0};
+        /// Number of acquisitions that created virtual machine inline.
+        std::atomic<u64> m_misses {0};
+        /// Background refill thread.
+        std::jthread m_refiller;
+
+    public:
+        /// @brief Destroy VmPool object.
+        ~VmPool() noexcept;
+
+        /// @brief Initialize VmPool object.
+        ///
+        /// Fills pool up to capacity and starts background refill.
+        ///
+        /// @param [in] config given pool configuration.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto init(const VmPoolConfig& config) -> VmmResult<None>;
+
+        /// @brief Acquire initialized virtual machine.
+        ///
+        /// Takes ready virtual machine from pool. If pool is empty, creates
+        /// one on the caller thread instead of waiting for refill.
+        ///
+        /// @return Virtual machine - in case of success.
+        /// @return VmmError - otherwise.
+        auto acquire() -> VmmResult<std::unique_ptr<core::VirtualMachine>>;
+
+        /// @brief Get number of ready virtual machines.
+        ///
+        /// @return Number of ready virtual machines.
+        auto size() -> usize;
+
+        /// @brief Get pool configuration.
+        ///
+        /// @return Pool configuration.
+        auto config() const noexcept -> const VmPoolConfig&;
+
+        /// @brief Get pool statistics.
+        ///
+        /// @return Pool statistics.
+        auto stats() const noexcept -> VmPoolStats;
+
+    private:
+        /// @brief Create and initialize virtual machine.
+        ///
+        /// @return Virtual machine - in case of success.
+        /// @return VmmError - otherwise.
+        auto create() const
+        -> VmmResult<std::unique_ptr<core::VirtualMachine>>;
+
+        /// @brief Refill pool until stop is requested.
+        ///
+        /// @param [in] stop given stop token.
+        auto refill(std::stop_token stop) -> void;
+    };
+
+}
+
+#endif // NULLVM_SERVICE_VM_POOL_HPP
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machines managed by service related declarations.
+
+#ifndef NULLVM_SERVICE_VM_REGISTRY_HPP
+#define NULLVM_SERVICE_VM_REGISTRY_HPP
+
+#include <nullvm/service/protocol.hpp>
+#include <nullvm/service/vm_pool.hpp>
+#include <nullvm/service/metrics.hpp>
+#include <nullvm/core/vm.hpp>
+#include <nullvm/types.hpp>
+#include <unordered_map>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace nullvm::service {
+
+    /// Virtual machines created by control requests.
+    ///
+    /// Serves CreateVm, StartVm, StopVm and DestroyVm requests from
+    /// stream and datagram handlers. Virtual machines are taken from
+    /// pool, so creation requests do not pay for VM initialization.
+    /// Statistics of virtual machine are served by metrics registry for
+    /// as long as it exists. Started virtual machine runs on its own
+    /// thread until it is stopped or halts.
+    class VmRegistry final {
+        /// Virtual machine managed by registry.
+        struct Entry {
+            /// Virtual machine.
+            std::unique_ptr<core::VirtualMachine> vm;
+            /// Thread running virtual machine.
+            std::jthread runner;
+            /// Flag indicating that virtual machine is running.
+            std::atomic<bool> running {false};
+            /// Lock serializing lifecycle requests.
+            std::mutex lock;
+        };
+
+        /// Pool virtual machines are taken from.
+        VmPool& m_pool;
+        /// Metrics registry statistics are served by.
+        MetricsRegistry& m_metrics;
+        /// Virtual machines indexed by ID.
+        std::unordered_map<u32, std::unique_ptr<Entry>> m_entries;
+        /// Lock protecting virtual machines map.
+        std::shared_mutex m_lock;
+        /// Next virtual machine ID.
+        std::atomic<u32> m_next_id {1};
+
+    public:
+        /// @brief Construct new VmRegistry object.
+        ///
+        /// @param [in] pool given initialized virtual machines pool.
+        /// @param [in] metrics given metrics registry.
+        VmRegistry(VmPool& pool, MetricsRegistry& metrics) noexcept;
+
+        /// @brief Destroy VmRegistry object.
+        ///
+        /// Running virtual machines are stopped and their statistics
+        /// are no longer served.
+        ~VmRegistry() noexcept;
+
+        /// @brief Handle virtual machine lifecycle request.
+        ///
+        /// Appends Ok reply, or Error reply if request cannot be served.
+        ///
+        /// @param [in] message given control request.
+        /// @param [out] output given buffer reply is appended to.
+        ///
+        /// @return true - if message is lifecycle request.
+        /// @return false - otherwise, nothing is appended.
+        auto handle(const protocol::Message& message, Bytes& output) -> bool;
+
+        /// @brief Get number of managed virtual machines.
+        ///
+        /// @return Number of virtual machines.
+        auto size() -> usize;
+
+    private:
+        /// @brief Create virtual machine.
+        ///
+        /// @param [in] request given creation request.
+        ///
+        /// @return Virtual machine ID - in case of success.
+        /// @return VmmError - otherwise.
+        auto create(const protocol::CreateVmRequest& request)
+        -> VmmResult<u32>;
+
+        /// @brief Start virtual machine on its own thread.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto start(u32 vm_id) -> VmmResult<None>;
+
+        /// @brief Stop virtual machine and wait for its thread.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto stop(u32 vm_id) -> VmmResult<None>;
+
+        /// @brief Stop and remove virtual machine.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto destroy(u32 vm_id) -> VmmResult<None>;
+
+        /// @brief Stop virtual machine thread if it was started.
+        ///
+        /// @param [in] entry given virtual machine entry, locked.
+        static auto stop_entry(Entry& entry) noexcept -> void;
+    };
+
+}
+
+#endif // NULLVM_SERVICE_VM_REGISTRY_HPP
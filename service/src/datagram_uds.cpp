@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Datagram unix domain socket (UDS) server related declarations.
+
+#include <nullvm/service/datagram_uds.hpp>
+#include <nullvm/service/scm_rights.hpp>
+#include <nullvm/log.hpp>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <array>
+#include <format>
+#include <cerrno>
+#include <bit>
+
+namespace nullvm::service {
+
+    DatagramUDS::DatagramUDS(const DatagramUDSConfig& config) noexcept
+        : m_config(config) {}
+
+    auto DatagramUDS::init() noexcept -> VmmResult<None> {
+        const auto& path = m_config.path;
+        const auto batch = m_config.batch_size;
+
+        if (path.empty() || path.size() >= sizeof(sockaddr_un::sun_path))
+            return std::unexpected("Invalid server socket path");
+
+        const auto min_size = sizeof(protocol::MessageHeader);
+
+        if (batch == 0 || m_config.max_datagram < min_size)
+            return std::unexpected("Invalid datagram server configuration");
+
+        auto sockfd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+        if (sockfd == -1)
+            return std::unexpected("Error to create new socket");
+
+        m_sockfd = FDWrapper(sockfd);
+
+        sockaddr_un addr {};
+
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        if (auto ret = remove(path.c_str()); ret == -1 && errno != ENOENT)
+            return std::unexpected("Error to create new socket");
+
+        auto ret = bind(sockfd, std::bit_cast<sockaddr*>(&addr), sizeof(addr));
+
+        if (ret == -1)
+            return std::unexpected("Error to bind server address");
+
+        // Batch buffers are allocated once and reused by every call.
+        m_buffers.resize(batch * m_config.max_datagram);
+        m_replies.resize(batch);
+        m_senders.resize(batch);
+        m_iovecs.resize(batch);
+        m_received.resize(batch);
+        m_outgoing.reserve(batch);
+
+        for (usize i = 0; i < batch; ++i) {
+            m_received[i].msg_hdr = {
+                .msg_name       = &m_senders[i],
+                .msg_namelen    = sizeof(sockaddr_un),
+                .msg_iov        = &m_iovecs[i],
+                .msg_iovlen     = 1,
+                .msg_control    = nullptr,
+                .msg_controllen = 0,
+                .msg_flags      = 0,
+            };
+        }
+
+        return m_stop.init();
+    }
+
+    auto DatagramUDS::send(i32 fd, const Bytes& data) noexcept
+    -> VmmResult<None> {
+        if (auto ret = ::send(fd, data.data(), data.size(), 0); ret == -1)
+            return std::unexpected("Error to send datagram");
+
+        return None {};
+    }
+
+    auto DatagramUDS::send_fds(
+        i32 fd, const Bytes& data, std::span<const i32> fds
+    ) noexcept -> VmmResult<None> {
+        auto sent = service::send_fds(fd, data, fds);
+
+        if (!sent)
+            return std::unexpected(sent.error());
+
+        // Datagram is sent whole or not at all.
+        if (sent.value() != data.size())
+            return std::unexpected("Error to send datagram");
+
+        return None {};
+    }
+
+    auto DatagramUDS::recv(i32 fd) noexcept -> VmmResult<Bytes> {
+        Bytes data(m_config.max_datagram);
+        const auto ret = ::recv(fd, data.data(), data.size(), 0);
+
+        if (ret == -1)
+            return std::unexpected("Error to receive datagram");
+
+        data.resize(static_cast<usize>(ret));
+        return data;
+    }
+
+    auto DatagramUDS::run() noexcept -> VmmResult<None> {
+        if (m_sockfd.fd() == -1)
+            return std::unexpected("Server is not initialized");
+
+        std::array<pollfd, 2> fds {{
+            {.fd = m_sockfd.fd(), .events = POLLIN, .revents = 0},
+            {.fd = m_stop.fd(), .events = POLLIN, .revents = 0},
+        }};
+
+        for (;;) {
+            if (poll(fds.data(), fds.size(), -1) == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                const auto err = std::format(
+                    "Error to wait for datagrams: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            if ((fds[1].revents & POLLIN) != 0) {
+                // Reset stop event, so server can be run again.
+                if (auto result = m_stop.read(); !result)
+                    return std::unexpected(result.error());
+
+                return None {};
+            }
+
+            if ((fds[0].revents & POLLIN) != 0) {
+                if (auto result = drain(); !result)
+                    return result;
+            }
+        }
+    }
+
+    auto DatagramUDS::stop() noexcept -> void {
+        if (auto result = m_stop.write(); !result)
+            log::error("Error to stop datagram UDS server: {}", result.error());
+    }
+
+    auto DatagramUDS::set_handler(DatagramHandler handler) noexcept -> void {
+        m_handler = std::move(handler);
+    }
+
+    auto DatagramUDS::drain() noexcept -> VmmResult<None> {
+        const auto batch = m_config.batch_size;
+        const auto size = m_config.max_datagram;
+
+        for (;;) {
+            for (usize i = 0; i < batch; ++i) {
+                m_iovecs[i] = {
+                    .iov_base = m_buffers.data() + i * size,
+                    .iov_len  = size,
+                };
+                m_received[i].msg_hdr.msg_namelen = sizeof(sockaddr_un);
+                m_received[i].msg_hdr.msg_flags = 0;
+            }
+
+            const auto ret = recvmmsg(
+                m_sockfd.fd(), m_received.data(), static_cast<u32>(batch),
+                MSG_DONTWAIT, nullptr
+            );
+
+            if (ret == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                if (errno == EAGAIN)
+                    return None {};
+
+                const auto err = std::format(
+                    "Error to receive datagrams: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            const auto count = static_cast<usize>(ret);
+            handle_batch(count);
+
+            // Partial batch means socket queue is drained.
+            if (count < batch)
+                return None {};
+        }
+    }
+
+    auto DatagramUDS::handle_batch(usize count) noexcept -> void {
+        const auto size = m_config.max_datagram;
+        const auto max_payload = static_cast<u32>(
+            size - sizeof(protocol::MessageHeader)
+        );
+
+        m_outgoing.clear();
+
+        for (usize i = 0; i < count; ++i) {
+            const auto& header = m_received[i].msg_hdr;
+
+            if ((header.msg_flags & MSG_TRUNC) != 0) {
+                log::debug("Dropping datagram larger than {} bytes", size);
+                continue;
+            }
+
+            const auto data = std::span<const std::byte>(m_buffers).subspan(
+                i * size, m_received[i].msg_len
+            );
+            const auto message = protocol::parse(data, max_payload);
+
+            if (!message) {
+                log::debug("Dropping datagram: {}", message.error());
+                continue;
+            }
+
+            auto& reply = m_replies[i];
+            reply.clear();
+
+            if (m_handler)
+                m_handler(message.value(), reply);
+
+            // Unbound senders have no address to reply to.
+            if (reply.empty() || header.msg_namelen <= sizeof(sa_family_t))
+                continue;
+
+            // Received data is handled, so slot vector is reused for reply.
+            m_iovecs[i] = {.iov_base = reply.data(), .iov_len = reply.size()};
+            m_outgoing.push_back({.msg_hdr = header, .msg_len = 0});
+        }
+
+        usize sent = 0;
+
+        while (sent < m_outgoing.size()) {
+            const auto ret = sendmmsg(
+                m_sockfd.fd(), m_outgoing.data() + sent,
+                static_cast<u32>(m_outgoing.size() - sent), MSG_DONTWAIT
+            );
+
+            if (ret != -1) {
+                sent += static_cast<usize>(ret);
+                continue;
+            }
+
+            if (errno == EINTR)
+                continue;
+
+            // Sender is gone or its queue is full (EAGAIN), only its reply
+            // is dropped, replies to other senders are still sent.
+            log::debug("Dropping datagram reply: {}", std::strerror(errno));
+            ++sent;
+        }
+    }
+
+}
@@ -3,11 +3,26 @@
 
 /// NullVM service entry point.
 
+#include <nullvm/service/vm_registry.hpp>
+#include <nullvm/service/stream_uds.hpp>
+#include <nullvm/service/metrics.hpp>
+#include <nullvm/service/vm_pool.hpp>
 #include <nullvm/core/cpu.hpp>
 #include <nullvm/log.hpp>
+#include <string_view>
 
 using namespace nullvm;
 
+namespace {
+    /// Configuration of virtual machines pool served creation requests.
+    const service::VmPoolConfig POOL_CONFIG {
+        .vm          = {.vcpus = 1},
+        .memory_addr = 0x0,
+        .memory_size = 128 * 1024 * 1024,
+        .capacity    = 4,
+    };
+}
+
 auto main() -> i32 {
     log::info("Running NullVM hypervisor management service");
     log::info("Detected CPU:");
@@ -20,5 +35,46 @@ auto main() -> i32 {
     }
 
     log::info("This CPU support virtualization");
+
+    service::VmPool pool;
+
+    if (auto result = pool.init(POOL_CONFIG); !result) {
+        log::error("Error to init VM pool: {}", result.error());
+        std::exit(EXIT_FAILURE);
+    }
+
+    service::MetricsRegistry metrics;
+    service::VmRegistry vms(pool, metrics);
+    service::StreamUDS server;
+
+    if (auto result = server.init(); !result) {
+        log::error("Error to init control server: {}", result.error());
+        std::exit(EXIT_FAILURE);
+    }
+
+    server.set_handler(
+        [&vms, &metrics](
+            i32, const service::protocol::Message& message,
+            service::Reply& reply
+        ) {
+            if (vms.handle(message, reply.data))
+                return;
+
+            if (metrics.handle(message, reply.data))
+                return;
+
+            constexpr std::string_view err {"Unsupported control request"};
+            service::protocol::encode(
+                reply.data, service::protocol::MessageType::Error,
+                message.header.id, std::as_bytes(std::span(err))
+            );
+        }
+    );
+
+    if (auto result = server.run(); !result) {
+        log::error("Error to run control server: {}", result.error());
+        std::exit(EXIT_FAILURE);
+    }
+
     return 0;
 }
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine metrics related declarations.
+
+#include <nullvm/service/protocol.hpp>
+#include <nullvm/service/metrics.hpp>
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+namespace nullvm::service {
+
+    namespace {
+        /// @brief Append object bytes to buffer.
+        ///
+        /// @param [out] output given output buffer.
+        /// @param [in] bytes given bytes to append.
+        auto append(Bytes& output, std::span<const std::byte> bytes)
+        -> void {
+            output.insert(output.end(), bytes.begin(), bytes.end());
+        }
+
+        /// @brief Append descriptors of statistics to schema.
+        ///
+        /// @param [out] output given output buffer.
+        /// @param [in] stats given statistics.
+        auto append_schema(Bytes& output, const core::KvmStats& stats)
+        -> void {
+            for (const auto& desc : stats.descriptors()) {
+                const protocol::StatsSchemaEntry entry {
+                    .flags       = desc.flags,
+                    .exponent    = desc.exponent,
+                    .size        = desc.size,
+                    .index       = static_cast<u32>(desc.index),
+                    .bucket_size = desc.bucket_size,
+                    .name_size   = static_cast<u32>(desc.name.size()),
+                };
+
+                append(output, std::as_bytes(std::span(&entry, 1)));
+                append(output, std::as_bytes(std::span(desc.name)));
+            }
+        }
+
+        /// @brief Append error reply.
+        ///
+        /// @param [out] output given output buffer.
+        /// @param [in] id given request ID.
+        /// @param [in] error given error message.
+        auto reply_error(Bytes& output, u32 id, const VmmError& error)
+        -> void {
+            protocol::encode(
+                output, protocol::MessageType::Error, id,
+                std::as_bytes(std::span(error))
+            );
+        }
+    }
+
+    auto VmMetrics::init(u32 vm_id, const core::VirtualMachine& vm)
+    -> VmmResult<None> {
+        auto stats = vm.kvm_stats();
+
+        if (!stats)
+            return std::unexpected(stats.error());
+
+        m_vm_id = vm_id;
+        m_vm = std::move(stats.value());
+        m_vcpus.clear();
+
+        for (usize id = 0; id < vm.vcpus_count(); ++id) {
+            auto vcpu = vm.kvm_stats(id);
+
+            if (!vcpu)
+                return std::unexpected(vcpu.error());
+
+            m_vcpus.push_back(std::move(vcpu.value()));
+        }
+
+        const auto vcpu_values = m_vcpus.empty() ?
+            0uz : m_vcpus.front().values().size();
+
+        const protocol::VmStatsReply header {
+            .vm_id       = m_vm_id,
+            .vcpus       = static_cast<u32>(m_vcpus.size()),
+            .vm_values   = static_cast<u32>(m_vm.values().size()),
+            .vcpu_values = static_cast<u32>(vcpu_values),
+        };
+
+        // Header never changes, snapshots overwrite values only.
+        const auto count = m_vm.values().size() +
+                           m_vcpus.size() * vcpu_values;
+
+        m_snapshot.assign(sizeof(header) + count * sizeof(u64), {});
+        std::memcpy(m_snapshot.data(), &header, sizeof(header));
+
+        return None {};
+    }
+
+    auto VmMetrics::schema(Bytes& output) const -> void {
+        const auto vcpu_stats = m_vcpus.empty() ?
+            0uz : m_vcpus.front().descriptors().size();
+
+        const protocol::StatsSchemaReply header {
+            .vm_stats   = static_cast<u32>(m_vm.descriptors().size()),
+            .vcpu_stats = static_cast<u32>(vcpu_stats),
+        };
+
+        append(output, std::as_bytes(std::span(&header, 1)));
+        append_schema(output, m_vm);
+
+        if (!m_vcpus.empty())
+            append_schema(output, m_vcpus.front());
+    }
+
+    auto VmMetrics::snapshot() noexcept
+    -> VmmResult<std::span<const std::byte>> {
+        auto offset = sizeof(protocol::VmStatsReply);
+
+        // Values are read straight into payload, without staging copy.
+        const auto read = [this, &offset](const core::KvmStats& stats)
+        -> VmmResult<None> {
+            const auto size = stats.values().size() * sizeof(u64);
+            const auto output = std::span(m_snapshot).subspan(offset, size);
+
+            if (auto result = stats.sample(output); !result)
+                return result;
+
+            offset += size;
+            return None {};
+        };
+
+        if (auto result = read(m_vm); !result)
+            return std::unexpected(result.error());
+
+        for (const auto& vcpu : m_vcpus) {
+            if (auto result = read(vcpu); !result)
+                return std::unexpected(result.error());
+        }
+
+        return std::span<const std::byte>(m_snapshot);
+    }
+
+    auto MetricsRegistry::add(u32 vm_id, const core::VirtualMachine& vm)
+    -> VmmResult<None> {
+        auto entry = std::make_unique<Entry>();
+
+        if (auto result = entry->metrics.init(vm_id, vm); !result)
+            return result;
+
+        std::unique_lock lock(m_lock);
+        m_entries.insert_or_assign(vm_id, std::move(entry));
+
+        return None {};
+    }
+
+    auto MetricsRegistry::remove(u32 vm_id) -> void {
+        std::unique_lock lock(m_lock);
+        m_entries.erase(vm_id);
+    }
+
+    auto MetricsRegistry::handle(
+        const protocol::Message& message, Bytes& output
+    ) -> bool {
+        using protocol::MessageType;
+
+        const auto type = message.header.type;
+        const auto id = message.header.id;
+
+        if (type != MessageType::VmStats && type != MessageType::StatsSchema)
+            return false;
+
+        const auto request =
+            protocol::decode<protocol::VmRequest>(message.payload);
+
+        if (!request) {
+            reply_error(output, id, request.error());
+            return true;
+        }
+
+        std::shared_lock lock(m_lock);
+        const auto it = m_entries.find(request->vm_id);
+
+        if (it == m_entries.end()) {
+            const auto err = std::format(
+                "Virtual machine {} does not exist", request->vm_id
+            );
+            reply_error(output, id, err);
+            return true;
+        }
+
+        auto& entry = *it->second;
+        std::lock_guard guard(entry.lock);
+
+        if (type == MessageType::StatsSchema) {
+            Bytes schema;
+            entry.metrics.schema(schema);
+            protocol::encode(output, MessageType::Ok, id, schema);
+
+            return true;
+        }
+
+        auto snapshot = entry.metrics.snapshot();
+
+        if (!snapshot) {
+            reply_error(output, id, snapshot.error());
+            return true;
+        }
+
+        protocol::encode(output, MessageType::Ok, id, snapshot.value());
+        return true;
+    }
+
+}
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Control protocol related declarations.
+
+#include <nullvm/service/protocol.hpp>
+#include <algorithm>
+#include <format>
+
+namespace nullvm::service::protocol {
+
+    namespace {
+        /// Control message header size in bytes.
+        constexpr usize HEADER_SIZE {sizeof(MessageHeader)};
+
+        /// Payload bytes reserved ahead of receiving them. Larger payloads
+        /// grow buffer geometrically as bytes arrive, so header alone
+        /// cannot make parser allocate up to payload size limit.
+        constexpr usize RESERVE_LIMIT {64 * 1024};
+
+        /// @brief Read and validate message header.
+        ///
+        /// @param [in] data given bytes starting with header.
+        /// @param [in] max_payload given payload size limit in bytes.
+        ///
+        /// @return Message header - in case of success.
+        /// @return VmmError - otherwise.
+        auto read_header(std::span<const std::byte> data, u32 max_payload)
+        noexcept -> VmmResult<MessageHeader> {
+            MessageHeader header {};
+            std::memcpy(&header, data.data(), HEADER_SIZE);
+
+            if (header.magic != PROTOCOL_MAGIC)
+                return std::unexpected("Invalid control message magic");
+
+            if (header.version != PROTOCOL_VERSION) {
+                const auto err = std::format(
+                    "Unsupported control protocol version {}, expected {}",
+                    header.version, PROTOCOL_VERSION
+                );
+                return std::unexpected(err);
+            }
+
+            if (header.size > max_payload) {
+                const auto err = std::format(
+                    "Control message payload of {} bytes exceeds limit of {}",
+                    header.size, max_payload
+                );
+                return std::unexpected(err);
+            }
+
+            return header;
+        }
+    }
+
+    Parser::Parser(u32 max_payload) noexcept : m_max_payload(max_payload) {}
+
+    auto Parser::buffer(usize min_size) -> std::span<std::byte> {
+        if (m_start == m_end)
+            m_start = m_end = 0;
+
+        auto want = min_size;
+
+        // Reserve space for the rest of message which header is received,
+        // but not more than was already received beyond reserve limit.
+        if (pending() >= HEADER_SIZE) {
+            MessageHeader header {};
+            std::memcpy(&header, m_buffer.data() + m_start, HEADER_SIZE);
+
+            if (header.size <= m_max_payload) {
+                const auto rest = HEADER_SIZE + header.size - pending();
+                const auto limit = std::max(RESERVE_LIMIT, pending());
+
+                want = std::max(want, std::min(rest, limit));
+            }
+        }
+
+        if (m_buffer.size() - m_end < want) {
+            // Only incomplete message is moved to front.
+            std::copy(
+                m_buffer.begin() + static_cast<std::ptrdiff_t>(m_start),
+                m_buffer.begin() + static_cast<std::ptrdiff_t>(m_end),
+                m_buffer.begin()
+            );
+            m_end -= m_start;
+            m_start = 0;
+
+            if (m_buffer.size() - m_end < want)
+                m_buffer.resize(m_end + want);
+        }
+
+        return std::span(m_buffer).subspan(m_end);
+    }
+
+    auto Parser::commit(usize count) noexcept -> void {
+        m_end += std::min(count, m_buffer.size() - m_end);
+    }
+
+    auto Parser::next() noexcept -> VmmResult<std::optional<Message>> {
+        if (pending() < HEADER_SIZE)
+            return std::nullopt;
+
+        const auto data = std::span<const std::byte>(m_buffer).subspan(
+            m_start, pending()
+        );
+        const auto header = read_header(data, m_max_payload);
+
+        if (!header)
+            return std::unexpected(header.error());
+
+        const auto total = HEADER_SIZE + header->size;
+
+        if (data.size() < total)
+            return std::nullopt;
+
+        m_start += total;
+
+        return Message {
+            .header  = header.value(),
+            .payload = data.subspan(HEADER_SIZE, header->size),
+        };
+    }
+
+    auto Parser::pending() const noexcept -> usize {
+        return m_end - m_start;
+    }
+
+    auto parse(std::span<const std::byte> data, u32 max_payload)
+    noexcept -> VmmResult<Message> {
+        if (data.size() < HEADER_SIZE)
+            return std::unexpected("Control message is too short");
+
+        const auto header = read_header(data, max_payload);
+
+        if (!header)
+            return std::unexpected(header.error());
+
+        if (data.size() != HEADER_SIZE + header->size)
+            return std::unexpected("Control message size mismatch");
+
+        return Message {
+            .header  = header.value(),
+            .payload = data.subspan(HEADER_SIZE, header->size),
+        };
+    }
+
+    auto encode(
+        Bytes& output, MessageType type, u32 id,
+        std::span<const std::byte> payload
+    ) -> void {
+        const MessageHeader header {
+            .magic   = PROTOCOL_MAGIC,
+            .version = PROTOCOL_VERSION,
+            .type    = type,
+            .id      = id,
+            .size    = static_cast<u32>(payload.size()),
+        };
+
+        const auto offset = output.size();
+        output.resize(offset + HEADER_SIZE + payload.size());
+
+        std::memcpy(output.data() + offset, &header, HEADER_SIZE);
+        std::ranges::copy(payload, output.data() + offset + HEADER_SIZE);
+    }
+
+}
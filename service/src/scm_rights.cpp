@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// File descriptors passing over unix domain sockets related declarations.
+
+#include <nullvm/service/scm_rights.hpp>
+#include <fcntl.h>
+#include <cstring>
+#include <format>
+#include <cerrno>
+#include <utility>
+#include <vector>
+#include <array>
+
+namespace nullvm::service {
+
+    namespace {
+        /// Control message buffer size for maximum number of descriptors.
+        constexpr auto CONTROL_SIZE {
+            CMSG_SPACE(sizeof(i32) * MAX_PASSED_FDS)
+        };
+    }
+
+    auto FdMessage::init(
+        std::span<const std::byte> data, std::span<const i32> fds
+    ) noexcept -> VmmResult<None> {
+        if (data.empty())
+            return std::unexpected("Descriptors must be sent with data");
+
+        if (fds.empty() || fds.size() > MAX_PASSED_FDS)
+            return std::unexpected("Invalid number of passed descriptors");
+
+        const auto size = sizeof(i32) * fds.size();
+        m_control.assign(CMSG_SPACE(size), std::byte {0});
+
+        m_iov = {
+            .iov_base = const_cast<std::byte*>(data.data()),
+            .iov_len  = data.size(),
+        };
+        m_header = {
+            .msg_name       = nullptr,
+            .msg_namelen    = 0,
+            .msg_iov        = &m_iov,
+            .msg_iovlen     = 1,
+            .msg_control    = m_control.data(),
+            .msg_controllen = m_control.size(),
+            .msg_flags      = 0,
+        };
+
+        auto cmsg = CMSG_FIRSTHDR(&m_header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type  = SCM_RIGHTS;
+        cmsg->cmsg_len   = CMSG_LEN(size);
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), size);
+
+        return None {};
+    }
+
+    auto FdMessage::header() noexcept -> msghdr* {
+        return &m_header;
+    }
+
+    auto FdAttachment::raw() const noexcept -> std::vector<i32> {
+        std::vector<i32> values;
+        values.reserve(fds.size());
+
+        for (const auto& fd : fds)
+            values.push_back(fd.fd());
+
+        return values;
+    }
+
+    auto Reply::attach(std::span<const i32> fds) noexcept -> VmmResult<None> {
+        if (fds.empty())
+            return None {};
+
+        const auto offset = data.size();
+
+        // Attachments of the same reply are merged into one message.
+        const auto merged =
+            !attachments.empty() && attachments.back().offset == offset;
+        const auto count = merged ? attachments.back().fds.size() : 0uz;
+
+        if (count + fds.size() > MAX_PASSED_FDS)
+            return std::unexpected("Too many descriptors attached to reply");
+
+        // Reply is left untouched unless all descriptors are duplicated.
+        std::vector<FDWrapper> copies;
+        copies.reserve(fds.size());
+
+        for (const auto fd : fds) {
+            const auto copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+            if (copy == -1) {
+                const auto err = std::format(
+                    "Error to duplicate descriptor {}: {}",
+                    fd, std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            copies.emplace_back(copy);
+        }
+
+        if (!merged)
+            attachments.push_back({.offset = offset});
+
+        auto& attached = attachments.back().fds;
+
+        for (auto& copy : copies)
+            attached.push_back(std::move(copy));
+
+        return None {};
+    }
+
+    auto Reply::clear() noexcept -> void {
+        data.clear();
+        attachments.clear();
+    }
+
+    auto send_fds(
+        i32 sockfd, std::span<const std::byte> data, std::span<const i32> fds
+    ) noexcept -> VmmResult<usize> {
+        FdMessage message;
+
+        if (auto result = message.init(data, fds); !result)
+            return std::unexpected(result.error());
+
+        for (;;) {
+            const auto ret = sendmsg(sockfd, message.header(), MSG_NOSIGNAL);
+
+            if (ret != -1)
+                return static_cast<usize>(ret);
+
+            if (errno == EINTR)
+                continue;
+
+            // Non-blocking socket is full, nothing is sent.
+            if (errno == EAGAIN)
+                return 0uz;
+
+            const auto err = std::format(
+                "Error to send descriptors: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+    }
+
+    auto recv_fds(
+        i32 sockfd, std::span<std::byte> buffer, std::vector<FDWrapper>& fds
+    ) noexcept -> VmmResult<usize> {
+        alignas(cmsghdr) std::array<std::byte, CONTROL_SIZE> control {};
+        iovec iov {.iov_base = buffer.data(), .iov_len = buffer.size()};
+        msghdr header {
+            .msg_name       = nullptr,
+            .msg_namelen    = 0,
+            .msg_iov        = &iov,
+            .msg_iovlen     = 1,
+            .msg_control    = control.data(),
+            .msg_controllen = control.size(),
+            .msg_flags      = 0,
+        };
+
+        auto ret = recvmsg(sockfd, &header, MSG_CMSG_CLOEXEC);
+
+        while (ret == -1 && errno == EINTR)
+            ret = recvmsg(sockfd, &header, MSG_CMSG_CLOEXEC);
+
+        if (ret == -1) {
+            const auto err = std::format(
+                "Error to receive descriptors: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        // Descriptors are owned before any check, so none of them leaks.
+        std::vector<FDWrapper> received;
+
+        for (auto cmsg = CMSG_FIRSTHDR(&header); cmsg;
+             cmsg = CMSG_NXTHDR(&header, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET ||
+                cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+
+            const auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(i32);
+
+            for (usize i = 0; i < count; ++i) {
+                i32 fd {-1};
+                std::memcpy(
+                    &fd, CMSG_DATA(cmsg) + i * sizeof(i32), sizeof(fd)
+                );
+                received.emplace_back(fd);
+            }
+        }
+
+        if ((header.msg_flags & MSG_CTRUNC) != 0)
+            return std::unexpected("Passed descriptors were truncated");
+
+        for (auto& fd : received)
+            fds.push_back(std::move(fd));
+
+        return static_cast<usize>(ret);
+    }
+
+}
@@ -5,6 +5,7 @@
 
 #include <nullvm/service/server_uds.hpp>
 #include <nullvm/service/stream_uds.hpp>
+#include <nullvm/service/datagram_uds.hpp>
 #include <nullvm/log.hpp>
 
 namespace nullvm::service {
@@ -20,7 +21,7 @@ namespace nullvm::service {
 
         case UDSType::Datagram:
             log::info("Server type is datagram UDS");
-            // TODO: m_inner = std::make_unique(...);
+            m_inner = std::make_unique<DatagramUDS>();
             break;
         }
 
@@ -39,6 +40,16 @@ namespace nullvm::service {
         return m_inner->send(fd, data);
     }
 
+    auto ServerUDS::send_fds(
+        i32 fd, const Bytes& data, std::span<const i32> fds
+    ) noexcept -> VmmResult<None> {
+        log::debug(
+            "Sending {} bytes of data and {} descriptors to client {}",
+            data.size(), fds.size(), fd
+        );
+        return m_inner->send_fds(fd, data, fds);
+    }
+
     auto ServerUDS::recv(i32 fd) noexcept -> VmmResult<Bytes> {
         auto result = m_inner->recv(fd);
 
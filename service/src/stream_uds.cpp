@@ -3,11 +3,19 @@
 
 /// Stream unix domain socket (UDS) server related declarations.
 
+#include <nullvm/core/utils/io_uring.hpp>
 #include <nullvm/service/stream_uds.hpp>
+#include <nullvm/log.hpp>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <algorithm>
 #include <cstring>
+#include <format>
+#include <thread>
+#include <cerrno>
 #include <bit>
 
 namespace nullvm::service {
@@ -16,12 +24,302 @@ namespace nullvm::service {
         /// Received data buffer size limit in bytes.
         constexpr auto BUFFER_SIZE {256};
 
-        /// Stream UDS server connection requests limit.
-        constexpr auto STREAM_SERVER_BACKLOG {5};
+        /// Client connection state.
+        struct Connection {
+            /// Client socket file descriptor.
+            FDWrapper fd {};
+            /// Received control messages parser.
+            protocol::Parser parser {};
+            /// Queued replies.
+            Reply output {};
+            /// Number of queued reply bytes already sent.
+            usize sent {0};
+            /// Number of queued reply attachments already sent.
+            usize attached {0};
+            /// Whether socket is watched for writability.
+            bool writing {false};
+        };
+
+        /// @brief Add file descriptor to epoll instance.
+        ///
+        /// @param [in] epfd given epoll file descriptor.
+        /// @param [in] fd given file descriptor to watch.
+        /// @param [in] events given epoll events mask.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto watch(i32 epfd, i32 fd, u32 events) noexcept -> VmmResult<None> {
+            epoll_event event {.events = events, .data = {.fd = fd}};
+
+            if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == -1) {
+                const auto err = std::format(
+                    "Error to watch file descriptor {}: {}",
+                    fd, std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            return None {};
+        }
+
+        /// @brief Send queued reply bytes until socket buffer is full.
+        ///
+        /// @param [in] epfd given epoll file descriptor.
+        /// @param [in] client given client connection.
+        ///
+        /// @return True - if connection is still usable.
+        /// @return False - otherwise.
+        auto flush(i32 epfd, Connection& client) noexcept -> bool {
+            const auto& output = client.output;
+            const auto& attachments = output.attachments;
+
+            while (client.sent < output.data.size()) {
+                const auto attaching = client.attached < attachments.size() &&
+                    attachments[client.attached].offset == client.sent;
+                const auto next = client.attached + (attaching ? 1 : 0);
+
+                // Descriptors are sent with first byte of their reply, so
+                // each write stops at next attachment.
+                const auto end = next < attachments.size() ?
+                    attachments[next].offset : output.data.size();
+                const auto rest = std::span(output.data).subspan(
+                    client.sent, end - client.sent
+                );
+
+                if (attaching) {
+                    const auto fds = attachments[client.attached].raw();
+                    const auto ret = send_fds(client.fd.fd(), rest, fds);
+
+                    if (!ret) {
+                        log::error("{}", ret.error());
+                        return false;
+                    }
+
+                    if (ret.value() == 0)
+                        break;
+
+                    client.sent += ret.value();
+                    ++client.attached;
+                    continue;
+                }
+
+                const auto ret = ::send(
+                    client.fd.fd(), rest.data(), rest.size(), MSG_NOSIGNAL
+                );
+
+                if (ret == -1) {
+                    if (errno == EINTR)
+                        continue;
+
+                    if (errno == EAGAIN)
+                        break;
+
+                    return false;
+                }
+
+                client.sent += static_cast<usize>(ret);
+            }
+
+            if (client.sent == output.data.size()) {
+                client.output.clear();
+                client.sent = 0;
+                client.attached = 0;
+            }
+
+            // Writability is watched only while there is something to send.
+            const auto writing = !output.data.empty();
+
+            if (writing != client.writing) {
+                const auto fd = client.fd.fd();
+                epoll_event event {
+                    .events = EPOLLIN | EPOLLRDHUP | (writing ? EPOLLOUT : 0u),
+                    .data   = {.fd = fd},
+                };
+
+                if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &event) == -1)
+                    return false;
+
+                client.writing = writing;
+            }
+
+            return true;
+        }
+
+        /// @brief Accept all pending client connections.
+        ///
+        /// @param [in] listenfd given listening socket file descriptor.
+        /// @param [in] epfd given epoll file descriptor.
+        /// @param [in] max_payload given control message payload limit.
+        /// @param [out] clients given worker client connections.
+        auto accept_clients(
+            i32 listenfd, i32 epfd, u32 max_payload,
+            std::unordered_map<i32, Connection>& clients
+        ) noexcept -> void {
+            for (;;) {
+                const auto fd = accept4(
+                    listenfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC
+                );
+
+                if (fd == -1) {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                        continue;
+
+                    // Queue is drained, possibly by another worker.
+                    if (errno != EAGAIN) {
+                        log::error(
+                            "Error to accept client connection: {}",
+                            std::strerror(errno)
+                        );
+                    }
+
+                    return;
+                }
+
+                Connection client {
+                    .fd     = FDWrapper(fd),
+                    .parser = protocol::Parser(max_payload),
+                };
+
+                if (auto result = watch(epfd, fd, EPOLLIN | EPOLLRDHUP);
+                    !result) {
+                    log::error("{}", result.error());
+                    continue;
+                }
+
+                log::debug("Accepted connection with client {}", fd);
+                clients.insert_or_assign(fd, std::move(client));
+            }
+        }
+
+        /// @brief Handle client socket events.
+        ///
+        /// Socket is read once per event, so busy client cannot starve
+        /// others served by the same worker.
+        ///
+        /// @param [in] epfd given epoll file descriptor.
+        /// @param [in] client given client connection.
+        /// @param [in] events given ready epoll events.
+        /// @param [in] handler given control request handler.
+        /// @param [in] max_pending given unsent reply bytes limit.
+        ///
+        /// @return True - if connection is still usable.
+        /// @return False - otherwise.
+        auto serve(
+            i32 epfd, Connection& client, u32 events,
+            const StreamHandler& handler, usize max_pending
+        ) noexcept -> bool {
+            if ((events & EPOLLERR) != 0)
+                return false;
+
+            if ((events & EPOLLOUT) != 0 && !flush(epfd, client))
+                return false;
+
+            if ((events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) == 0)
+                return true;
+
+            const auto fd = client.fd.fd();
+            const auto buffer = client.parser.buffer();
+            const auto ret = read(fd, buffer.data(), buffer.size());
+
+            if (ret == -1)
+                return errno == EAGAIN || errno == EINTR;
+
+            // Client closed connection.
+            if (ret == 0)
+                return false;
+
+            client.parser.commit(static_cast<usize>(ret));
+
+            for (;;) {
+                auto message = client.parser.next();
+
+                if (!message) {
+                    log::error("Client {}: {}", fd, message.error());
+                    return false;
+                }
+
+                if (!message.value())
+                    break;
+
+                if (handler)
+                    handler(fd, *message.value(), client.output);
+            }
+
+            if (client.output.data.size() - client.sent > max_pending) {
+                log::error("Client {} does not read replies", fd);
+                return false;
+            }
+
+            return flush(epfd, client);
+        }
+
+        /// @brief Write whole data to client.
+        ///
+        /// @param [in] fd given client connection file descriptor.
+        /// @param [in] data given sequence of bytes to write.
+        ///
+        /// @return None - in case of success.
+        /// @return VmmError - otherwise.
+        auto write_all(i32 fd, std::span<const std::byte> data) noexcept
+        -> VmmResult<None> {
+            // Short writes are continued until whole data is sent.
+            while (!data.empty()) {
+                const auto ret = write(fd, data.data(), data.size());
+
+                if (ret == -1 && errno == EINTR)
+                    continue;
+
+                if (ret == -1)
+                    return std::unexpected("Error to send data to client");
+
+                data = data.subspan(static_cast<usize>(ret));
+            }
+
+            return None {};
+        }
+
+        /// @brief Choose I/O backend supported by kernel.
+        ///
+        /// @param [in] backend given requested I/O backend.
+        ///
+        /// @return I/O backend - in case of success.
+        /// @return VmmError - if io_uring is requested but not supported.
+        auto resolve_backend(IOBackend backend) noexcept
+        -> VmmResult<IOBackend> {
+            if (backend == IOBackend::Epoll)
+                return IOBackend::Epoll;
+
+            // Single issuer rings and multishot receives both appeared in
+            // Linux 6.0, so probe ring covers everything event loop needs.
+            core::utils::IoUring ring;
+            auto result = ring.init(8, IORING_SETUP_SINGLE_ISSUER);
+
+            if (result) {
+                core::utils::BufferGroup buffers;
+                result = buffers.init(ring, 0, 1, 64);
+            }
+
+            if (result)
+                return IOBackend::IoUring;
+
+            if (backend == IOBackend::IoUring)
+                return std::unexpected(result.error());
+
+            log::info("Falling back to epoll: {}", result.error());
+            return IOBackend::Epoll;
+        }
     }
 
+    StreamUDS::StreamUDS(const StreamUDSConfig& config) noexcept
+        : m_config(config), m_addr() {}
+
     auto StreamUDS::init() noexcept -> VmmResult<None> {
-        auto sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        const auto& path = m_config.path;
+
+        if (path.empty() || path.size() >= sizeof(m_addr.sun_path))
+            return std::unexpected("Invalid server socket path");
+
+        auto sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
 
         if (sockfd == -1)
             return std::unexpected("Error to create new socket");
@@ -29,23 +327,28 @@ namespace nullvm::service {
         sockaddr_un addr {};
 
         addr.sun_family = AF_UNIX;
-        std::strncpy(
-            addr.sun_path, STREAM_SERVER_PATH, sizeof(addr.sun_path) - 1
-        );
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
 
         m_sockfd = FDWrapper(sockfd);
         m_addr   = addr;
 
-        if (auto ret = remove(STREAM_SERVER_PATH); ret == -1 && errno != ENOENT)
+        if (auto ret = remove(path.c_str()); ret == -1 && errno != ENOENT)
             return std::unexpected("Error to create new socket");
 
         if (auto result = link(); !result)
             return result;
 
-        if (auto ret = listen(sockfd, STREAM_SERVER_BACKLOG); ret == -1)
+        if (auto ret = listen(sockfd, m_config.backlog); ret == -1)
             return std::unexpected("Error to listen for new connections");
 
-        return None {};
+        auto backend = resolve_backend(m_config.backend);
+
+        if (!backend)
+            return std::unexpected(backend.error());
+
+        m_backend = backend.value();
+
+        return m_stop.init();
     }
 
     auto StreamUDS::link() noexcept -> VmmResult<None> {
@@ -60,32 +363,156 @@ namespace nullvm::service {
 
     auto StreamUDS::send(i32 fd, const Bytes& data) noexcept
     -> VmmResult<None> {
-        if (auto ret = write(fd, data.data(), data.size()); ret == -1)
+        return write_all(fd, data);
+    }
+
+    auto StreamUDS::send_fds(
+        i32 fd, const Bytes& data, std::span<const i32> fds
+    ) noexcept -> VmmResult<None> {
+        auto sent = service::send_fds(fd, data, fds);
+
+        if (!sent)
+            return std::unexpected(sent.error());
+
+        if (sent.value() == 0)
             return std::unexpected("Error to send data to client");
 
-        return None {};
+        // Descriptors went with first part, the rest is plain data.
+        return write_all(fd, std::span(data).subspan(sent.value()));
     }
 
     auto StreamUDS::recv(i32 fd) noexcept -> VmmResult<Bytes> {
-        Bytes data {BUFFER_SIZE};
+        Bytes data(BUFFER_SIZE);
+        const auto ret = read(fd, data.data(), data.size());
 
-        if (auto ret = read(fd, data.data(), data.size()); ret == -1)
+        if (ret == -1)
             return std::unexpected("Error to receive data from client");
 
+        data.resize(static_cast<usize>(ret));
         return data;
     }
 
     auto StreamUDS::run() noexcept -> VmmResult<None> {
+        if (m_sockfd.fd() == -1)
+            return std::unexpected("Server is not initialized");
+
+        const auto count = std::max<usize>(m_config.workers, 1);
+        std::vector<VmmResult<None>> results(count, None {});
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(count);
+
+            for (usize id = 0; id < count; ++id) {
+                threads.emplace_back([this, id, &results] {
+                    results[id] = m_backend == IOBackend::IoUring
+                        ? run_uring_worker()
+                        : run_epoll_worker();
+
+                    // Failed event loop stops the whole server.
+                    if (!results[id])
+                        stop();
+                });
+            }
+        }
+
+        // Reset stop event, so server can be run again.
+        if (auto result = m_stop.read(); !result)
+            return std::unexpected(result.error());
+
+        for (auto& result : results) {
+            if (!result)
+                return result;
+        }
+
+        return None {};
+    }
+
+    auto StreamUDS::stop() noexcept -> void {
+        // Event is never consumed by workers, so it wakes up all of them.
+        if (auto result = m_stop.write(); !result)
+            log::error("Error to stop stream UDS server: {}", result.error());
+    }
+
+    auto StreamUDS::backend() const noexcept -> IOBackend {
+        return m_backend;
+    }
+
+    auto StreamUDS::set_handler(StreamHandler handler) noexcept -> void {
+        m_handler = std::move(handler);
+    }
+
+    auto StreamUDS::run_epoll_worker() noexcept -> VmmResult<None> {
+        const auto epfd = epoll_create1(EPOLL_CLOEXEC);
+
+        if (epfd == -1) {
+            const auto err = std::format(
+                "Error to create epoll instance: {}", std::strerror(errno)
+            );
+            return std::unexpected(err);
+        }
+
+        const FDWrapper epoll(epfd);
+        const auto listenfd = m_sockfd.fd();
+
+        // Only one of workers waiting on listening socket is woken up.
+        if (auto result = watch(epfd, listenfd, EPOLLIN | EPOLLEXCLUSIVE);
+            !result)
+            return result;
+
+        if (auto result = watch(epfd, m_stop.fd(), EPOLLIN); !result)
+            return result;
+
+        std::unordered_map<i32, Connection> clients;
+        std::vector<epoll_event> events(
+            std::max<usize>(m_config.max_events, 1)
+        );
+
         for (;;) {
-            auto clientfd = accept(m_sockfd.fd(), nullptr, nullptr);
+            const auto count = epoll_wait(
+                epfd, events.data(), static_cast<i32>(events.size()), -1
+            );
+
+            if (count == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                const auto err = std::format(
+                    "Error to wait for events: {}", std::strerror(errno)
+                );
+                return std::unexpected(err);
+            }
+
+            for (const auto& event : std::span(events).first(
+                     static_cast<usize>(count)
+                 )) {
+                const auto fd = event.data.fd;
+
+                if (fd == m_stop.fd())
+                    return None {};
+
+                if (fd == listenfd) {
+                    accept_clients(
+                        listenfd, epfd, m_config.max_payload, clients
+                    );
+                    continue;
+                }
+
+                auto client = clients.find(fd);
 
-            if (clientfd == -1)
-                return std::unexpected("Error to accept client connection");
+                if (client == clients.end())
+                    continue;
 
-            // TODO: handle client messages.
+                const auto served = serve(
+                    epfd, client->second, event.events, m_handler,
+                    m_config.max_pending
+                );
 
-            if (auto ret = close(clientfd); ret == -1)
-                return std::unexpected("Error to close connection with client");
+                if (!served) {
+                    log::debug("Closing connection with client {}", fd);
+                    clients.erase(client);
+                }
+            }
         }
     }
 }
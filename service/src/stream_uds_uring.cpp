@@ -0,0 +1,626 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Stream unix domain socket (UDS) server io_uring event loop.
+
+#include <nullvm/core/utils/io_uring.hpp>
+#include <nullvm/service/stream_uds.hpp>
+#include <nullvm/log.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <poll.h>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+namespace nullvm::service {
+    using core::utils::IoUring;
+    using core::utils::BufferGroup;
+
+    namespace {
+        /// Number of submission queue entries per worker ring.
+        constexpr u32 RING_ENTRIES {256};
+
+        /// Number of provided receive buffers per worker ring.
+        constexpr u32 RECV_BUFFERS {256};
+
+        /// Size of provided receive buffer in bytes.
+        constexpr u32 RECV_BUFFER_SIZE {4096};
+
+        /// Provided receive buffers group ID.
+        constexpr std::uint16_t RECV_BUFFER_GROUP {0};
+
+        /// Operation type, stored in upper half of request user data.
+        enum class Operation : u32 {
+            /// Multishot accept on listening socket.
+            Accept = 1,
+            /// Poll on stop event.
+            Stop,
+            /// Multishot receive on client socket.
+            Recv,
+            /// Send of queued replies.
+            Send,
+            /// Cancellation of client requests.
+            Cancel,
+            /// Close of client socket.
+            Close
+        };
+
+        /// Client connection state.
+        struct Connection {
+            /// Client socket file descriptor.
+            i32 fd {-1};
+            /// Received control messages parser.
+            protocol::Parser parser {};
+            /// Replies queued while send is in flight.
+            Reply output {};
+            /// Replies being sent.
+            Reply sending {};
+            /// Number of bytes of replies being sent already sent.
+            usize sent {0};
+            /// Number of attachments of replies being sent already sent.
+            usize attached {0};
+            /// Message passing descriptors of send in flight.
+            FdMessage message {};
+            /// Whether send in flight passes descriptors.
+            bool attaching {false};
+            /// Number of requests in flight.
+            u32 pending {0};
+            /// Whether connection is being closed.
+            bool closing {false};
+            /// Whether socket is closed.
+            bool closed {false};
+        };
+
+        /// Single worker io_uring event loop.
+        ///
+        /// Connections are keyed by ID rather than file descriptor, since
+        /// closed descriptor may be reused by new client while requests
+        /// of the old one are still completing.
+        class UringLoop final {
+            /// Worker ring.
+            IoUring& m_ring;
+            /// Provided receive buffers.
+            BufferGroup& m_buffers;
+            /// Server configuration.
+            const StreamUDSConfig& m_config;
+            /// Control request handler.
+            const StreamHandler& m_handler;
+            /// Listening socket file descriptor.
+            i32 m_listenfd;
+            /// Stop event file descriptor.
+            i32 m_stopfd;
+            /// Client connections.
+            std::unordered_map<u32, Connection> m_clients;
+            /// Next client connection ID.
+            u32 m_next_id {0};
+            /// Number of requests in flight.
+            u64 m_inflight {0};
+            /// Whether loop is stopping.
+            bool m_stopping {false};
+
+        public:
+            /// @brief Construct new UringLoop object.
+            UringLoop(
+                IoUring& ring, BufferGroup& buffers,
+                const StreamUDSConfig& config, const StreamHandler& handler,
+                i32 listenfd, i32 stopfd
+            ) noexcept
+                : m_ring(ring), m_buffers(buffers), m_config(config),
+                  m_handler(handler), m_listenfd(listenfd), m_stopfd(stopfd) {}
+
+            /// @brief Run event loop until stop event.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto run() noexcept -> VmmResult<None> {
+                if (auto result = accept(); !result)
+                    return result;
+
+                auto sqe = prepare(Operation::Stop, 0);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode       = IORING_OP_POLL_ADD;
+                (*sqe)->fd           = m_stopfd;
+                (*sqe)->poll32_events = POLLIN;
+
+                // Stopping loop waits for cancelled requests, so kernel
+                // never completes request into freed connection buffers.
+                while (!m_stopping || m_inflight != 0) {
+                    if (auto result = m_ring.submit(1); !result)
+                        return std::unexpected(result.error());
+
+                    while (auto cqe = m_ring.peek_cqe()) {
+                        const auto event = *cqe;
+                        m_ring.cqe_seen();
+
+                        if (auto result = handle(event); !result)
+                            return result;
+                    }
+                }
+
+                return None {};
+            }
+
+        private:
+            /// @brief Get submission queue entry for operation.
+            ///
+            /// @param [in] op given operation type.
+            /// @param [in] id given client connection ID.
+            ///
+            /// @return Submission queue entry - in case of success.
+            /// @return VmmError - otherwise.
+            auto prepare(Operation op, u32 id) noexcept
+            -> VmmResult<io_uring_sqe*> {
+                auto sqe = m_ring.get_sqe();
+
+                if (!sqe)
+                    return sqe;
+
+                (*sqe)->user_data = (static_cast<u64>(op) << 32) | id;
+                ++m_inflight;
+
+                return sqe;
+            }
+
+            /// @brief Submit multishot accept.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto accept() noexcept -> VmmResult<None> {
+                auto sqe = prepare(Operation::Accept, 0);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode       = IORING_OP_ACCEPT;
+                (*sqe)->fd           = m_listenfd;
+                (*sqe)->ioprio       = IORING_ACCEPT_MULTISHOT;
+                (*sqe)->accept_flags = SOCK_CLOEXEC;
+
+                return None {};
+            }
+
+            /// @brief Submit multishot receive into provided buffers.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] client given client connection.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto receive(u32 id, Connection& client) noexcept
+            -> VmmResult<None> {
+                auto sqe = prepare(Operation::Recv, id);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode    = IORING_OP_RECV;
+                (*sqe)->fd        = client.fd;
+                (*sqe)->ioprio    = IORING_RECV_MULTISHOT;
+                (*sqe)->flags     = IOSQE_BUFFER_SELECT;
+                (*sqe)->buf_group = m_buffers.group();
+                ++client.pending;
+
+                return None {};
+            }
+
+            /// @brief Submit send of unsent part of replies being sent.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] client given client connection.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto send(u32 id, Connection& client) noexcept
+            -> VmmResult<None> {
+                const auto& sending = client.sending;
+                const auto& attachments = sending.attachments;
+                const auto attaching = client.attached < attachments.size() &&
+                    attachments[client.attached].offset == client.sent;
+                const auto next = client.attached + (attaching ? 1 : 0);
+
+                // Descriptors are sent with first byte of their reply, so
+                // each send stops at next attachment.
+                const auto end = next < attachments.size() ?
+                    attachments[next].offset : sending.data.size();
+                const auto rest = std::span(sending.data).subspan(
+                    client.sent, end - client.sent
+                );
+
+                if (attaching) {
+                    const auto fds = attachments[client.attached].raw();
+
+                    if (auto result = client.message.init(rest, fds);
+                        !result)
+                        return result;
+                }
+
+                auto sqe = prepare(Operation::Send, id);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->fd        = client.fd;
+                (*sqe)->msg_flags = MSG_NOSIGNAL;
+
+                if (attaching) {
+                    (*sqe)->opcode = IORING_OP_SENDMSG;
+                    (*sqe)->addr   = std::bit_cast<u64>(
+                        client.message.header()
+                    );
+                    (*sqe)->len    = 1;
+                }
+                else {
+                    (*sqe)->opcode = IORING_OP_SEND;
+                    (*sqe)->addr   = std::bit_cast<u64>(rest.data());
+                    (*sqe)->len    = static_cast<u32>(rest.size());
+                }
+
+                client.attaching = attaching;
+                ++client.pending;
+
+                return None {};
+            }
+
+            /// @brief Start sending queued replies if no send is in flight.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] client given client connection.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto flush(u32 id, Connection& client) noexcept
+            -> VmmResult<None> {
+                if (!client.sending.data.empty() || client.output.data.empty())
+                    return None {};
+
+                // Buffers are swapped, so both keep their capacity.
+                std::swap(client.sending, client.output);
+                client.sent = 0;
+
+                return send(id, client);
+            }
+
+            /// @brief Cancel client requests and close its socket.
+            ///
+            /// Cancellation is hard-linked with close, so socket is
+            /// closed even if there was nothing to cancel.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] client given client connection.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto close(u32 id, Connection& client) noexcept
+            -> VmmResult<None> {
+                if (client.closing)
+                    return None {};
+
+                client.closing = true;
+                log::debug("Closing connection with client {}", client.fd);
+
+                auto sqe = prepare(Operation::Cancel, id);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode       = IORING_OP_ASYNC_CANCEL;
+                (*sqe)->fd           = client.fd;
+                (*sqe)->cancel_flags = IORING_ASYNC_CANCEL_FD |
+                    IORING_ASYNC_CANCEL_ALL;
+                (*sqe)->flags        = IOSQE_IO_HARDLINK;
+
+                sqe = prepare(Operation::Close, id);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode = IORING_OP_CLOSE;
+                (*sqe)->fd     = client.fd;
+
+                return None {};
+            }
+
+            /// @brief Remove connection once it has nothing in flight.
+            ///
+            /// @param [in] id given client connection ID.
+            auto collect(u32 id) noexcept -> void {
+                auto client = m_clients.find(id);
+
+                if (client == m_clients.end())
+                    return;
+
+                const auto& state = client->second;
+
+                if (state.closed && state.pending == 0)
+                    m_clients.erase(client);
+            }
+
+            /// @brief Handle completion queue entry.
+            ///
+            /// @param [in] cqe given completion queue entry.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto handle(const io_uring_cqe& cqe) noexcept -> VmmResult<None> {
+                const auto op = static_cast<Operation>(cqe.user_data >> 32);
+                const auto id = static_cast<u32>(cqe.user_data);
+
+                // Only failed buffer returns complete, they are not counted.
+                if (cqe.user_data == 0) {
+                    log::error(
+                        "Error to return receive buffer: {}",
+                        std::strerror(-cqe.res)
+                    );
+                    return None {};
+                }
+
+                if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+                    --m_inflight;
+
+                switch (op) {
+                case Operation::Accept:
+                    return on_accept(cqe);
+
+                case Operation::Stop:
+                    return on_stop();
+
+                case Operation::Recv:
+                    return on_receive(id, cqe);
+
+                case Operation::Send:
+                    return on_send(id, cqe);
+
+                case Operation::Cancel:
+                    return None {};
+
+                case Operation::Close:
+                    if (auto client = m_clients.find(id);
+                        client != m_clients.end())
+                        client->second.closed = true;
+
+                    collect(id);
+                    return None {};
+                }
+
+                return None {};
+            }
+
+            /// @brief Handle accepted client.
+            ///
+            /// @param [in] cqe given completion queue entry.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto on_accept(const io_uring_cqe& cqe) noexcept
+            -> VmmResult<None> {
+                const auto more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+                if (cqe.res < 0 && cqe.res != -ECANCELED) {
+                    log::error(
+                        "Error to accept client connection: {}",
+                        std::strerror(-cqe.res)
+                    );
+                }
+
+                if (cqe.res >= 0 && m_stopping)
+                    ::close(cqe.res);
+
+                if (cqe.res >= 0 && !m_stopping) {
+                    const auto id = m_next_id++;
+                    auto& client = m_clients[id];
+
+                    client.fd     = cqe.res;
+                    client.parser = protocol::Parser(m_config.max_payload);
+                    log::debug("Accepted connection with client {}", cqe.res);
+
+                    if (auto result = receive(id, client); !result)
+                        return result;
+                }
+
+                // Kernel ends multishot accept on error, it is rearmed.
+                if (!more && !m_stopping)
+                    return accept();
+
+                return None {};
+            }
+
+            /// @brief Handle stop event.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto on_stop() noexcept -> VmmResult<None> {
+                m_stopping = true;
+
+                auto sqe = prepare(Operation::Cancel, 0);
+
+                if (!sqe)
+                    return std::unexpected(sqe.error());
+
+                (*sqe)->opcode       = IORING_OP_ASYNC_CANCEL;
+                (*sqe)->fd           = m_listenfd;
+                (*sqe)->cancel_flags = IORING_ASYNC_CANCEL_FD |
+                    IORING_ASYNC_CANCEL_ALL;
+
+                for (auto& [id, client] : m_clients) {
+                    if (auto result = close(id, client); !result)
+                        return result;
+                }
+
+                return None {};
+            }
+
+            /// @brief Handle received data.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] cqe given completion queue entry.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto on_receive(u32 id, const io_uring_cqe& cqe) noexcept
+            -> VmmResult<None> {
+                const auto more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+                auto entry = m_clients.find(id);
+
+                if (entry == m_clients.end())
+                    return None {};
+
+                auto& client = entry->second;
+
+                if (!more)
+                    --client.pending;
+
+                if ((cqe.flags & IORING_CQE_F_BUFFER) != 0) {
+                    const auto buffer = static_cast<std::uint16_t>(
+                        cqe.flags >> IORING_CQE_BUFFER_SHIFT
+                    );
+
+                    // Data is copied into parser, so buffer is reused
+                    // right away.
+                    if (cqe.res > 0 && !client.closing) {
+                        const auto size = static_cast<usize>(cqe.res);
+                        const auto data = m_buffers.data(buffer, size);
+
+                        std::ranges::copy(
+                            data, client.parser.buffer(size).begin()
+                        );
+                        client.parser.commit(size);
+                    }
+
+                    if (auto result = m_buffers.recycle(m_ring, buffer);
+                        !result)
+                        return result;
+                }
+
+                if (client.closing) {
+                    collect(id);
+                    return None {};
+                }
+
+                // Out of provided buffers, receive is retried.
+                if (cqe.res == -ENOBUFS)
+                    return more ? None {} : receive(id, client);
+
+                if (cqe.res <= 0)
+                    return close(id, client);
+
+                if (!serve(client))
+                    return close(id, client);
+
+                if (!more) {
+                    if (auto result = receive(id, client); !result)
+                        return result;
+                }
+
+                return flush(id, client);
+            }
+
+            /// @brief Handle sent replies.
+            ///
+            /// @param [in] id given client connection ID.
+            /// @param [in] cqe given completion queue entry.
+            ///
+            /// @return None - in case of success.
+            /// @return VmmError - otherwise.
+            auto on_send(u32 id, const io_uring_cqe& cqe) noexcept
+            -> VmmResult<None> {
+                auto entry = m_clients.find(id);
+
+                if (entry == m_clients.end())
+                    return None {};
+
+                auto& client = entry->second;
+                --client.pending;
+
+                if (client.closing) {
+                    collect(id);
+                    return None {};
+                }
+
+                if (cqe.res < 0)
+                    return close(id, client);
+
+                client.sent += static_cast<usize>(cqe.res);
+
+                if (client.attaching && cqe.res > 0)
+                    ++client.attached;
+
+                client.attaching = false;
+
+                // Short send is continued from where it stopped.
+                if (client.sent < client.sending.data.size())
+                    return send(id, client);
+
+                client.sending.clear();
+                client.sent = 0;
+                client.attached = 0;
+
+                return flush(id, client);
+            }
+
+            /// @brief Handle parsed control messages.
+            ///
+            /// @param [in] client given client connection.
+            ///
+            /// @return True - if connection is still usable.
+            /// @return False - otherwise.
+            auto serve(Connection& client) noexcept -> bool {
+                for (;;) {
+                    auto message = client.parser.next();
+
+                    if (!message) {
+                        log::error(
+                            "Client {}: {}", client.fd, message.error()
+                        );
+                        return false;
+                    }
+
+                    if (!message.value())
+                        break;
+
+                    if (m_handler)
+                        m_handler(client.fd, *message.value(), client.output);
+                }
+
+                const auto queued = client.output.data.size() +
+                    client.sending.data.size() - client.sent;
+
+                if (queued > m_config.max_pending) {
+                    log::error("Client {} does not read replies", client.fd);
+                    return false;
+                }
+
+                return true;
+            }
+        };
+    }
+
+    auto StreamUDS::run_uring_worker() noexcept -> VmmResult<None> {
+        IoUring ring;
+
+        // Ring is used only by this worker thread.
+        auto result = ring.init(RING_ENTRIES, IORING_SETUP_SINGLE_ISSUER);
+
+        if (!result)
+            return result;
+
+        BufferGroup buffers;
+        result = buffers.init(
+            ring, RECV_BUFFER_GROUP, RECV_BUFFERS, RECV_BUFFER_SIZE
+        );
+
+        if (!result)
+            return result;
+
+        UringLoop loop(
+            ring, buffers, m_config, m_handler, m_sockfd.fd(), m_stop.fd()
+        );
+
+        return loop.run();
+    }
+
+}
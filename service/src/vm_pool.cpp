@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Pre-initialized virtual machines pool related declarations.
+
+#include <nullvm/service/vm_pool.hpp>
+#include <nullvm/log.hpp>
+#include <chrono>
+
+namespace nullvm::service {
+
+    namespace {
+        /// Delay before retrying failed virtual machine creation.
+        constexpr std::chrono::milliseconds REFILL_RETRY_DELAY {100};
+    }
+
+    VmPool::~VmPool() noexcept {
+        // Stop refill before ready virtual machines are destroyed.
+        m_refiller.request_stop();
+
+        if (m_refiller.joinable())
+            m_refiller.join();
+    }
+
+    auto VmPool::init(const VmPoolConfig& config) -> VmmResult<None> {
+        if (config.capacity == 0)
+            return std::unexpected("VM pool capacity cannot be 0");
+
+        auto kvm = std::make_shared<core::Kvm>();
+
+        if (auto result = kvm->init(); !result)
+            return result;
+
+        m_kvm = std::move(kvm);
+        m_config = config;
+
+        for (usize i = 0; i < config.capacity; ++i) {
+            auto vm = create();
+
+            if (!vm)
+                return std::unexpected(vm.error());
+
+            m_ready.push_back(std::move(vm.value()));
+        }
+
+        m_refiller = std::jthread([this](std::stop_token stop) {
+            refill(std::move(stop));
+        });
+
+        log::info("VM pool initialized with {} VMs", config.capacity);
+
+        return None {};
+    }
+
+    auto VmPool::acquire()
+    -> VmmResult<std::unique_ptr<core::VirtualMachine>> {
+        {
+            std::unique_lock lock(m_lock);
+
+            if (!m_ready.empty()) {
+                auto vm = std::move(m_ready.front());
+                m_ready.pop_front();
+                lock.unlock();
+
+                m_refill.notify_one();
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+
+                return vm;
+            }
+        }
+
+        // Pool is drained, waiting for refill would not be faster than
+        // creating virtual machine right here.
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        log::debug("VM pool is empty, creating VM inline");
+
+        return create();
+    }
+
+    auto VmPool::size() -> usize {
+        std::lock_guard lock(m_lock);
+        return m_ready.size();
+    }
+
+    auto VmPool::config() const noexcept -> const VmPoolConfig& {
+        return m_config;
+    }
+
+    auto VmPool::stats() const noexcept -> VmPoolStats {
+        return VmPoolStats {
+            .hits   = m_hits.load(std::memory_order_relaxed),
+            .misses = m_misses.load(std::memory_order_relaxed),
+        };
+    }
+
+    auto VmPool::create() const
+    -> VmmResult<std::unique_ptr<core::VirtualMachine>> {
+        auto vm = std::make_unique<core::VirtualMachine>();
+
+        if (auto result = vm->init(m_config.vm, m_kvm); !result)
+            return std::unexpected(result.error());
+
+        if (m_config.memory_size != 0) {
+            auto result = vm->set_mem_region(
+                m_config.memory_addr, m_config.memory_size
+            );
+
+            if (!result)
+                return std::unexpected(result.error());
+        }
+
+        return vm;
+    }
+
+    auto VmPool::refill(std::stop_token stop) -> void {
+        while (!stop.stop_requested()) {
+            {
+                std::unique_lock lock(m_lock);
+
+                const auto needed = m_refill.wait(lock, stop, [this] {
+                    return m_ready.size() < m_config.capacity;
+                });
+
+                if (!needed)
+                    return;
+            }
+
+            // Virtual machine is created without holding the lock, so
+            // acquisitions are never blocked by creation.
+            auto vm = create();
+
+            if (!vm) {
+                log::error("Error to refill VM pool: {}", vm.error());
+                std::this_thread::sleep_for(REFILL_RETRY_DELAY);
+                continue;
+            }
+
+            std::lock_guard lock(m_lock);
+            m_ready.push_back(std::move(vm.value()));
+        }
+    }
+
+}
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machines managed by service related declarations.
+
+#include <nullvm/service/vm_registry.hpp>
+#include <nullvm/log.hpp>
+#include <format>
+
+namespace nullvm::service {
+
+    namespace {
+        /// @brief Append error reply.
+        ///
+        /// @param [out] output given output buffer.
+        /// @param [in] id given request ID.
+        /// @param [in] error given error message.
+        auto reply_error(Bytes& output, u32 id, const VmmError& error)
+        -> void {
+            protocol::encode(
+                output, protocol::MessageType::Error, id,
+                std::as_bytes(std::span(error))
+            );
+        }
+
+        /// @brief Format unknown virtual machine error.
+        ///
+        /// @param [in] vm_id given virtual machine ID.
+        ///
+        /// @return Error message.
+        auto unknown_vm(u32 vm_id) -> VmmError {
+            return std::format("Virtual machine {} does not exist", vm_id);
+        }
+    }
+
+    VmRegistry::VmRegistry(VmPool& pool, MetricsRegistry& metrics) noexcept
+        : m_pool(pool), m_metrics(metrics) {}
+
+    VmRegistry::~VmRegistry() noexcept {
+        std::unique_lock lock(m_lock);
+
+        for (auto& [vm_id, entry] : m_entries) {
+            std::lock_guard guard(entry->lock);
+            stop_entry(*entry);
+            m_metrics.remove(vm_id);
+        }
+    }
+
+    auto VmRegistry::handle(const protocol::Message& message, Bytes& output)
+    -> bool {
+        using protocol::MessageType;
+
+        const auto type = message.header.type;
+        const auto id = message.header.id;
+
+        if (type == MessageType::CreateVm) {
+            const auto request =
+                protocol::decode<protocol::CreateVmRequest>(message.payload);
+
+            if (!request) {
+                reply_error(output, id, request.error());
+                return true;
+            }
+
+            const auto vm_id = create(request.value());
+
+            if (!vm_id) {
+                reply_error(output, id, vm_id.error());
+                return true;
+            }
+
+            const protocol::CreateVmReply reply {.vm_id = vm_id.value()};
+            protocol::encode(
+                output, MessageType::Ok, id,
+                std::as_bytes(std::span(&reply, 1))
+            );
+
+            return true;
+        }
+
+        if (type != MessageType::StartVm && type != MessageType::StopVm &&
+            type != MessageType::DestroyVm)
+            return false;
+
+        const auto request =
+            protocol::decode<protocol::VmRequest>(message.payload);
+
+        if (!request) {
+            reply_error(output, id, request.error());
+            return true;
+        }
+
+        VmmResult<None> result;
+
+        switch (type) {
+            case MessageType::StartVm:
+                result = start(request->vm_id);
+                break;
+
+            case MessageType::StopVm:
+                result = stop(request->vm_id);
+                break;
+
+            default:
+                result = destroy(request->vm_id);
+                break;
+        }
+
+        if (!result) {
+            reply_error(output, id, result.error());
+            return true;
+        }
+
+        protocol::encode(output, MessageType::Ok, id);
+        return true;
+    }
+
+    auto VmRegistry::size() -> usize {
+        std::shared_lock lock(m_lock);
+        return m_entries.size();
+    }
+
+    auto VmRegistry::create(const protocol::CreateVmRequest& request)
+    -> VmmResult<u32> {
+        const auto& config = m_pool.config();
+
+        // Pooled virtual machines are initialized ahead of time, so only
+        // requests matching pool configuration can be served.
+        if (request.vcpus != config.vm.vcpus ||
+            request.memory_size != config.memory_size) {
+            const auto err = std::format(
+                "Virtual machine with {} vCPUs and {:#x} bytes of memory "
+                "is not served by pool",
+                request.vcpus, request.memory_size
+            );
+            return std::unexpected(err);
+        }
+
+        auto vm = m_pool.acquire();
+
+        if (!vm)
+            return std::unexpected(vm.error());
+
+        auto entry = std::make_unique<Entry>();
+        entry->vm = std::move(vm.value());
+
+        const auto vm_id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+
+        if (auto result = m_metrics.add(vm_id, *entry->vm); !result)
+            return std::unexpected(result.error());
+
+        std::unique_lock lock(m_lock);
+        m_entries.emplace(vm_id, std::move(entry));
+
+        log::info("VM {} created", vm_id);
+
+        return vm_id;
+    }
+
+    auto VmRegistry::start(u32 vm_id) -> VmmResult<None> {
+        std::shared_lock lock(m_lock);
+        const auto it = m_entries.find(vm_id);
+
+        if (it == m_entries.end())
+            return std::unexpected(unknown_vm(vm_id));
+
+        auto& entry = *it->second;
+        std::lock_guard guard(entry.lock);
+
+        if (entry.running.load()) {
+            const auto err = std::format(
+                "Virtual machine {} is already running", vm_id
+            );
+            return std::unexpected(err);
+        }
+
+        // Thread of virtual machine that halted on its own is collected.
+        if (entry.runner.joinable())
+            entry.runner.join();
+
+        entry.running.store(true);
+        entry.runner = std::jthread([&entry, vm_id] {
+            if (auto result = entry.vm->run(); !result)
+                log::error("Error to run VM {}: {}", vm_id, result.error());
+
+            entry.running.store(false);
+        });
+
+        log::info("VM {} started", vm_id);
+
+        return None {};
+    }
+
+    auto VmRegistry::stop(u32 vm_id) -> VmmResult<None> {
+        std::shared_lock lock(m_lock);
+        const auto it = m_entries.find(vm_id);
+
+        if (it == m_entries.end())
+            return std::unexpected(unknown_vm(vm_id));
+
+        auto& entry = *it->second;
+        std::lock_guard guard(entry.lock);
+
+        if (!entry.runner.joinable()) {
+            const auto err = std::format(
+                "Virtual machine {} is not started", vm_id
+            );
+            return std::unexpected(err);
+        }
+
+        stop_entry(entry);
+        log::info("VM {} stopped", vm_id);
+
+        return None {};
+    }
+
+    auto VmRegistry::destroy(u32 vm_id) -> VmmResult<None> {
+        std::unique_lock lock(m_lock);
+        const auto it = m_entries.find(vm_id);
+
+        if (it == m_entries.end())
+            return std::unexpected(unknown_vm(vm_id));
+
+        {
+            std::lock_guard guard(it->second->lock);
+            stop_entry(*it->second);
+        }
+
+        m_metrics.remove(vm_id);
+        m_entries.erase(it);
+        log::info("VM {} destroyed", vm_id);
+
+        return None {};
+    }
+
+    auto VmRegistry::stop_entry(Entry& entry) noexcept -> void {
+        if (!entry.runner.joinable())
+            return;
+
+        entry.vm->stop();
+        entry.runner.join();
+
+        // Virtual machine may have halted before stop request, pause()
+        // drops the request so that next start is not cancelled by it.
+        entry.vm->pause();
+    }
+
+}
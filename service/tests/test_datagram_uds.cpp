@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Datagram unix domain socket (UDS) server tests.
+
+#include <nullvm/service/datagram_uds.hpp>
+#include <nullvm/service/server_uds.hpp>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <bit>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// Server socket path used in tests.
+    constexpr auto TEST_SERVER_PATH {"/tmp/nullvm_datagram_server_test"};
+
+    /// Client socket path used in tests.
+    constexpr auto TEST_CLIENT_PATH {"/tmp/nullvm_datagram_client_test"};
+
+    /// Socket path of client which never reads replies.
+    constexpr auto TEST_STALLED_PATH {"/tmp/nullvm_datagram_stalled_test"};
+
+    /// @brief Create unix domain socket address.
+    ///
+    /// @param [in] path given socket path.
+    ///
+    /// @return Socket address.
+    auto make_addr(const char* path) -> sockaddr_un {
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+
+    /// @brief Create datagram socket connected to test server.
+    ///
+    /// @param [in] bound given flag whether socket can receive replies.
+    ///
+    /// @return Socket file descriptor.
+    auto connect_client(bool bound) -> i32 {
+        const auto fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        EXPECT_NE(fd, -1);
+
+        if (bound) {
+            unlink(TEST_CLIENT_PATH);
+
+            auto addr = make_addr(TEST_CLIENT_PATH);
+            const auto ret = bind(
+                fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)
+            );
+            EXPECT_EQ(ret, 0);
+        }
+
+        auto addr = make_addr(TEST_SERVER_PATH);
+        const auto ret = connect(
+            fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)
+        );
+        EXPECT_EQ(ret, 0);
+
+        return fd;
+    }
+
+    /// @brief Send control message.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] id given request ID.
+    auto send_message(i32 fd, u32 id) -> void {
+        Bytes output;
+        const protocol::VmRequest request {.vm_id = id};
+        protocol::encode(
+            output, protocol::MessageType::VmStats, id,
+            std::as_bytes(std::span(&request, 1))
+        );
+
+        const auto ret = send(fd, output.data(), output.size(), 0);
+        EXPECT_EQ(ret, static_cast<ssize_t>(output.size()));
+    }
+}
+
+TEST(test_datagram_uds, test_datagram_uds_initialization) {
+    auto server = DatagramUDS({.path = TEST_SERVER_PATH});
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    server = DatagramUDS({.path = TEST_SERVER_PATH, .batch_size = 0});
+    result = server.init();
+    EXPECT_FALSE(result.has_value());
+
+    auto uds = ServerUDS(UDSType::Datagram);
+    result = uds.init();
+    EXPECT_TRUE(result.has_value());
+}
+
+TEST(test_datagram_uds, test_datagram_uds_replies) {
+    constexpr u32 COUNT {96};
+    constexpr u32 BURST_SIZE {8};
+
+    auto server = DatagramUDS({.path = TEST_SERVER_PATH, .batch_size = 8});
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    // Reply carries VM ID of request.
+    server.set_handler([](const protocol::Message& message, Bytes& output) {
+        protocol::encode(
+            output, protocol::MessageType::Ok, message.header.id,
+            message.payload
+        );
+    });
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client(true);
+
+    // Bursts fit datagram queue of client, so no reply is dropped.
+    for (u32 burst = 0; burst < COUNT; burst += BURST_SIZE) {
+        for (u32 id = burst; id < burst + BURST_SIZE; ++id)
+            send_message(fd, id);
+
+        for (u32 id = burst; id < burst + BURST_SIZE; ++id) {
+            Bytes data(256);
+            const auto ret = recv(fd, data.data(), data.size(), 0);
+            ASSERT_GT(ret, 0);
+
+            auto reply = protocol::parse(
+                std::span(data).first(static_cast<usize>(ret)),
+                protocol::MAX_PAYLOAD_SIZE
+            );
+            ASSERT_TRUE(reply.has_value());
+            EXPECT_EQ(reply->header.type, protocol::MessageType::Ok);
+            EXPECT_EQ(reply->header.id, id);
+
+            auto request = protocol::decode<protocol::VmRequest>(
+                reply->payload
+            );
+            EXPECT_TRUE(request.has_value());
+            EXPECT_EQ(request->vm_id, id);
+        }
+    }
+
+    close(fd);
+    unlink(TEST_CLIENT_PATH);
+    server.stop();
+}
+
+TEST(test_datagram_uds, test_datagram_uds_fire_and_forget) {
+    constexpr u32 COUNT {64};
+
+    auto server = DatagramUDS({.path = TEST_SERVER_PATH});
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    std::atomic<u32> received {0};
+
+    server.set_handler([&received](const protocol::Message&, Bytes& output) {
+        ++received;
+
+        // Unbound sender cannot get reply, it is dropped.
+        protocol::encode(output, protocol::MessageType::Ok, 0);
+    });
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client(false);
+
+    // Malformed datagram is dropped.
+    EXPECT_EQ(send(fd, "garbage", 7, 0), 7);
+
+    for (u32 id = 0; id < COUNT; ++id)
+        send_message(fd, id);
+
+    while (received.load() < COUNT)
+        std::this_thread::yield();
+
+    close(fd);
+    server.stop();
+    thread.join();
+
+    EXPECT_EQ(received.load(), COUNT);
+}
+
+TEST(test_datagram_uds, test_datagram_uds_full_sender_queue) {
+    auto server = DatagramUDS({.path = TEST_SERVER_PATH});
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    server.set_handler([](const protocol::Message& message, Bytes& output) {
+        protocol::encode(
+            output, protocol::MessageType::Ok, message.header.id,
+            message.payload
+        );
+    });
+
+    // Stalled client has its receive queue filled up, so replies to it
+    // fail with EAGAIN.
+    unlink(TEST_STALLED_PATH);
+
+    const auto stalled = socket(AF_UNIX, SOCK_DGRAM, 0);
+    auto stalled_addr = make_addr(TEST_STALLED_PATH);
+    auto ret = bind(
+        stalled, std::bit_cast<sockaddr*>(&stalled_addr), sizeof(stalled_addr)
+    );
+    ASSERT_EQ(ret, 0);
+
+    const auto filler = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    while (sendto(filler, "x", 1, MSG_DONTWAIT,
+                  std::bit_cast<sockaddr*>(&stalled_addr),
+                  sizeof(stalled_addr)) == 1);
+
+    EXPECT_EQ(errno, EAGAIN);
+
+    Bytes request;
+    protocol::encode(request, protocol::MessageType::VmStats, 1);
+
+    auto server_addr = make_addr(TEST_SERVER_PATH);
+    const auto sent = sendto(
+        stalled, request.data(), request.size(), 0,
+        std::bit_cast<sockaddr*>(&server_addr), sizeof(server_addr)
+    );
+    EXPECT_EQ(sent, static_cast<ssize_t>(request.size()));
+
+    // Healthy client's request is handled in the same batch.
+    const auto fd = connect_client(true);
+    send_message(fd, 2);
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const timeval timeout {.tv_sec = 5, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    Bytes data(256);
+    const auto received = recv(fd, data.data(), data.size(), 0);
+
+    server.stop();
+    thread.join();
+
+    close(fd);
+    close(filler);
+    close(stalled);
+    unlink(TEST_CLIENT_PATH);
+    unlink(TEST_STALLED_PATH);
+
+    ASSERT_GT(received, 0);
+
+    auto reply = protocol::parse(
+        std::span(data).first(static_cast<usize>(received)),
+        protocol::MAX_PAYLOAD_SIZE
+    );
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.id, 2u);
+}
@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machine metrics tests.
+
+#include <nullvm/service/stream_uds.hpp>
+#include <nullvm/service/protocol.hpp>
+#include <nullvm/service/vm_registry.hpp>
+#include <nullvm/service/metrics.hpp>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <string_view>
+#include <optional>
+#include <cstring>
+#include <thread>
+#include <bit>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// Server socket path used in tests.
+    constexpr auto TEST_SERVER_PATH {"/tmp/nullvm_metrics_server_test"};
+
+    /// Reply received from server.
+    struct TestReply {
+        /// Reply type.
+        protocol::MessageType type {protocol::MessageType::Ok};
+        /// Reply payload.
+        Bytes payload {};
+    };
+
+    /// @brief Connect to test server.
+    ///
+    /// @return Connected socket file descriptor.
+    auto connect_client() -> i32 {
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_NE(fd, -1);
+
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(
+            addr.sun_path, TEST_SERVER_PATH, sizeof(addr.sun_path) - 1
+        );
+
+        const auto ret = connect(
+            fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)
+        );
+        EXPECT_EQ(ret, 0);
+
+        return fd;
+    }
+
+    /// @brief Send request and read reply.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] type given request type.
+    /// @param [in] id given request ID.
+    /// @param [in] payload given request payload.
+    ///
+    /// @return Reply.
+    template <typename T>
+    auto exchange(i32 fd, protocol::MessageType type, u32 id, const T& payload)
+    -> TestReply {
+        Bytes output;
+        protocol::encode(
+            output, type, id, std::as_bytes(std::span(&payload, 1))
+        );
+
+        const auto ret = write(fd, output.data(), output.size());
+        EXPECT_EQ(static_cast<usize>(ret), output.size());
+
+        protocol::Parser parser;
+
+        for (;;) {
+            auto reply = parser.next();
+
+            if (!reply)
+                return {};
+
+            if (reply.value()) {
+                const auto& message = reply.value().value();
+                EXPECT_EQ(message.header.id, id);
+
+                return {
+                    .type    = message.header.type,
+                    .payload = Bytes(
+                        message.payload.begin(), message.payload.end()
+                    ),
+                };
+            }
+
+            const auto buffer = parser.buffer();
+            const auto count = read(fd, buffer.data(), buffer.size());
+
+            if (count <= 0)
+                return {};
+
+            parser.commit(static_cast<usize>(count));
+        }
+    }
+
+    /// @brief Send virtual machine request and read reply.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] type given request type.
+    /// @param [in] vm_id given virtual machine ID.
+    ///
+    /// @return Reply.
+    auto request(i32 fd, protocol::MessageType type, u32 vm_id)
+    -> TestReply {
+        const protocol::VmRequest payload {.vm_id = vm_id};
+        return exchange(fd, type, vm_id, payload);
+    }
+
+    /// @brief Find virtual CPU statistic in encoded schema.
+    ///
+    /// @param [in] schema given encoded schema.
+    /// @param [in] name given statistic name.
+    ///
+    /// @return Statistic value index - if statistic exists.
+    /// @return std::nullopt - otherwise.
+    auto find_vcpu_stat(std::span<const std::byte> schema,
+                        std::string_view name) -> std::optional<u32> {
+        const auto header =
+            protocol::decode<protocol::StatsSchemaReply>(schema).value();
+        auto rest = schema.subspan(sizeof(header));
+
+        for (u32 i = 0; i < header.vm_stats + header.vcpu_stats; ++i) {
+            const auto entry =
+                protocol::decode<protocol::StatsSchemaEntry>(rest).value();
+            const auto entry_name = std::string_view(
+                std::bit_cast<const char*>(rest.data() + sizeof(entry)),
+                entry.name_size
+            );
+
+            if (i >= header.vm_stats && entry_name == name)
+                return entry.index;
+
+            rest = rest.subspan(sizeof(entry) + entry.name_size);
+        }
+
+        EXPECT_TRUE(rest.empty());
+        return std::nullopt;
+    }
+
+    /// @brief Get virtual CPU value from encoded snapshot.
+    ///
+    /// @param [in] snapshot given encoded snapshot.
+    /// @param [in] vcpu given virtual CPU ID.
+    /// @param [in] index given value index.
+    ///
+    /// @return Statistic value.
+    auto vcpu_value(std::span<const std::byte> snapshot, u32 vcpu, u32 index)
+    -> u64 {
+        const auto header =
+            protocol::decode<protocol::VmStatsReply>(snapshot).value();
+        const auto position = header.vm_values +
+                              vcpu * header.vcpu_values + index;
+
+        u64 value {0};
+        std::memcpy(
+            &value,
+            snapshot.data() + sizeof(header) + position * sizeof(u64),
+            sizeof(value)
+        );
+
+        return value;
+    }
+}
+
+TEST(test_metrics, test_metrics_snapshot) {
+    core::VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 2});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.set_mem_region(0x1000, 0x1000);
+    EXPECT_TRUE(result.has_value());
+
+    VmMetrics metrics;
+    result = metrics.init(7, vm);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    Bytes schema;
+    metrics.schema(schema);
+
+    const auto index = find_vcpu_stat(schema, "halt_exits");
+    ASSERT_TRUE(index.has_value());
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_TRUE(snapshot.has_value());
+
+    const auto header =
+        protocol::decode<protocol::VmStatsReply>(snapshot.value()).value();
+    EXPECT_EQ(header.vm_id, 7u);
+    EXPECT_EQ(header.vcpus, 2u);
+    EXPECT_GT(header.vm_values, 0u);
+    EXPECT_GT(header.vcpu_values, *index);
+    EXPECT_EQ(
+        snapshot->size(),
+        sizeof(header) +
+        (header.vm_values + 2 * header.vcpu_values) * sizeof(u64)
+    );
+
+    const auto halts = vcpu_value(snapshot.value(), 1, *index);
+
+    result = vm.load_raw({0xf4});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.run();
+    EXPECT_TRUE(result.has_value());
+
+    // Same buffer is refilled with fresh values.
+    const auto before = snapshot->data();
+    snapshot = metrics.snapshot();
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_EQ(snapshot->data(), before);
+    EXPECT_EQ(vcpu_value(snapshot.value(), 1, *index), halts + 1);
+}
+
+TEST(test_metrics, test_metrics_served_over_socket) {
+    core::VirtualMachine vm;
+
+    auto result = vm.init({.vcpus = 2});
+    EXPECT_TRUE(result.has_value());
+
+    MetricsRegistry metrics;
+    result = metrics.add(3, vm);
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    auto server = StreamUDS({.path = TEST_SERVER_PATH, .workers = 1});
+    result = server.init();
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    server.set_handler(
+        [&metrics](i32, const protocol::Message& message, Reply& output) {
+            EXPECT_TRUE(metrics.handle(message, output.data));
+        }
+    );
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client();
+
+    auto reply = request(fd, protocol::MessageType::StatsSchema, 3);
+    ASSERT_EQ(reply.type, protocol::MessageType::Ok);
+
+    const auto index = find_vcpu_stat(reply.payload, "halt_exits");
+    ASSERT_TRUE(index.has_value());
+
+    reply = request(fd, protocol::MessageType::VmStats, 3);
+    ASSERT_EQ(reply.type, protocol::MessageType::Ok);
+
+    const auto header =
+        protocol::decode<protocol::VmStatsReply>(reply.payload).value();
+    EXPECT_EQ(header.vm_id, 3u);
+    EXPECT_EQ(header.vcpus, 2u);
+    EXPECT_GT(header.vcpu_values, *index);
+    EXPECT_EQ(
+        reply.payload.size(),
+        sizeof(header) +
+        (header.vm_values + 2 * header.vcpu_values) * sizeof(u64)
+    );
+
+    // Unknown virtual machine gets error reply.
+    reply = request(fd, protocol::MessageType::VmStats, 4);
+    EXPECT_EQ(reply.type, protocol::MessageType::Error);
+
+    close(fd);
+    server.stop();
+}
+
+TEST(test_metrics, test_metrics_created_vm_served) {
+    using protocol::MessageType;
+
+    VmPool pool;
+
+    auto result = pool.init({
+        .vm          = {.vcpus = 2},
+        .memory_addr = 0x0,
+        .memory_size = 0x10000,
+        .capacity    = 1,
+    });
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    MetricsRegistry metrics;
+    VmRegistry vms(pool, metrics);
+
+    auto server = StreamUDS({.path = TEST_SERVER_PATH, .workers = 1});
+    result = server.init();
+    ASSERT_TRUE(result.has_value()) << result.error();
+
+    server.set_handler(
+        [&vms, &metrics](
+            i32, const protocol::Message& message, Reply& output
+        ) {
+            EXPECT_TRUE(
+                vms.handle(message, output.data) ||
+                metrics.handle(message, output.data)
+            );
+        }
+    );
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client();
+
+    const protocol::CreateVmRequest create {
+        .vcpus = 2, .reserved = 0, .memory_size = 0x10000
+    };
+
+    auto reply = exchange(fd, MessageType::CreateVm, 1, create);
+    ASSERT_EQ(reply.type, MessageType::Ok);
+
+    const auto created =
+        protocol::decode<protocol::CreateVmReply>(reply.payload);
+    ASSERT_TRUE(created.has_value());
+
+    const auto vm_id = created->vm_id;
+
+    reply = request(fd, MessageType::StatsSchema, vm_id);
+    ASSERT_EQ(reply.type, MessageType::Ok);
+    EXPECT_TRUE(find_vcpu_stat(reply.payload, "halt_exits").has_value());
+
+    reply = request(fd, MessageType::VmStats, vm_id);
+    ASSERT_EQ(reply.type, MessageType::Ok);
+
+    const auto header =
+        protocol::decode<protocol::VmStatsReply>(reply.payload).value();
+    EXPECT_EQ(header.vm_id, vm_id);
+    EXPECT_EQ(header.vcpus, 2u);
+
+    // Statistics of destroyed virtual machine are no longer served.
+    reply = request(fd, MessageType::DestroyVm, vm_id);
+    EXPECT_EQ(reply.type, MessageType::Ok);
+
+    reply = request(fd, MessageType::VmStats, vm_id);
+    EXPECT_EQ(reply.type, MessageType::Error);
+
+    close(fd);
+    server.stop();
+}
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Control protocol tests.
+
+#include <nullvm/service/protocol.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// @brief Copy bytes into parser buffer.
+    ///
+    /// @param [in] parser given parser.
+    /// @param [in] data given bytes to receive.
+    auto receive(protocol::Parser& parser, std::span<const std::byte> data)
+    -> void {
+        const auto buffer = parser.buffer(data.size());
+        std::ranges::copy(data, buffer.begin());
+        parser.commit(data.size());
+    }
+}
+
+TEST(test_protocol, test_protocol_parse_byte_by_byte) {
+    const protocol::CreateVmRequest request {
+        .vcpus = 2, .memory_size = 1024 * 1024
+    };
+
+    Bytes stream;
+    protocol::encode(
+        stream, protocol::MessageType::CreateVm, 7,
+        std::as_bytes(std::span(&request, 1))
+    );
+
+    protocol::Parser parser;
+
+    for (usize i = 0; i + 1 < stream.size(); ++i) {
+        receive(parser, std::span(stream).subspan(i, 1));
+
+        auto message = parser.next();
+        EXPECT_TRUE(message.has_value());
+        EXPECT_FALSE(message.value().has_value());
+    }
+
+    receive(parser, std::span(stream).last(1));
+
+    auto message = parser.next();
+    EXPECT_TRUE(message.has_value());
+    EXPECT_TRUE(message.value().has_value());
+    EXPECT_EQ(message.value()->header.type, protocol::MessageType::CreateVm);
+    EXPECT_EQ(message.value()->header.id, 7);
+
+    auto decoded = protocol::decode<protocol::CreateVmRequest>(
+        message.value()->payload
+    );
+    EXPECT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->vcpus, 2);
+    EXPECT_EQ(decoded->memory_size, 1024 * 1024);
+    EXPECT_EQ(parser.pending(), 0);
+}
+
+TEST(test_protocol, test_protocol_large_payload) {
+    const Bytes payload(1024 * 1024, std::byte {0xab});
+
+    Bytes stream;
+    protocol::encode(stream, protocol::MessageType::VmStats, 1, payload);
+
+    protocol::Parser parser;
+    const auto header = std::span(stream).first(
+        sizeof(protocol::MessageHeader)
+    );
+    receive(parser, header);
+
+    // Header alone reserves bounded space, not the whole payload.
+    EXPECT_LE(parser.buffer().size(), 64 * 1024);
+
+    auto rest = std::span(stream).subspan(header.size());
+    usize reallocations = 0;
+    const std::byte* previous = nullptr;
+
+    while (!rest.empty()) {
+        const auto chunk = parser.buffer();
+        reallocations += chunk.data() != previous ? 1 : 0;
+
+        const auto size = std::min(rest.size(), chunk.size());
+        std::ranges::copy(rest.first(size), chunk.begin());
+        parser.commit(size);
+        rest = rest.subspan(size);
+        previous = chunk.data() + size;
+    }
+
+    // Buffer grows geometrically with received bytes.
+    EXPECT_LE(reallocations, 6u);
+
+    auto message = parser.next();
+    EXPECT_TRUE(message.has_value());
+    EXPECT_TRUE(message.value().has_value());
+    EXPECT_TRUE(std::ranges::equal(message.value()->payload, payload));
+}
+
+TEST(test_protocol, test_protocol_invalid_messages) {
+    Bytes stream;
+    protocol::encode(stream, protocol::MessageType::StopVm, 1);
+
+    // Wrong magic.
+    auto corrupted = stream;
+    corrupted[0] = std::byte {0};
+
+    protocol::Parser parser;
+    receive(parser, corrupted);
+    EXPECT_FALSE(parser.next().has_value());
+
+    // Payload over limit.
+    protocol::Parser limited(16);
+    stream.clear();
+    protocol::encode(stream, protocol::MessageType::VmStats, 1, Bytes(17));
+    receive(limited, stream);
+    EXPECT_FALSE(limited.next().has_value());
+
+    // Payload too short for request.
+    auto decoded = protocol::decode<protocol::VmRequest>(Bytes(4));
+    EXPECT_FALSE(decoded.has_value());
+}
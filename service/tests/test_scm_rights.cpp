@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// File descriptors passing over unix domain sockets tests.
+
+#include <nullvm/service/scm_rights.hpp>
+#include <nullvm/core/utils/utils.hpp>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+#include <array>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// @brief Create connected pair of stream sockets.
+    ///
+    /// @return Socket file descriptors.
+    auto make_pair() -> std::array<i32, 2> {
+        std::array<i32, 2> fds {-1, -1};
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()), 0);
+        return fds;
+    }
+}
+
+TEST(test_scm_rights, test_scm_rights_shared_memory) {
+    constexpr usize SIZE {4096};
+
+    const auto sockets = make_pair();
+    const auto memfd = memfd_create("nullvm_test", MFD_CLOEXEC);
+    ASSERT_NE(memfd, -1);
+    ASSERT_EQ(ftruncate(memfd, SIZE), 0);
+
+    const Bytes data {std::byte {0x2a}};
+    const std::array fds {memfd};
+    auto sent = send_fds(sockets[0], data, fds);
+    ASSERT_TRUE(sent.has_value());
+    EXPECT_EQ(sent.value(), data.size());
+
+    std::vector<FDWrapper> received;
+    Bytes buffer(16);
+    auto ret = recv_fds(sockets[1], buffer, received);
+    ASSERT_TRUE(ret.has_value());
+    EXPECT_EQ(ret.value(), data.size());
+    EXPECT_EQ(buffer[0], data[0]);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_NE(received[0].fd(), memfd);
+
+    // Both mappings share the same pages, nothing is copied.
+    auto ours = mmap(
+        nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0
+    );
+    auto theirs = mmap(
+        nullptr, SIZE, PROT_READ, MAP_SHARED, received[0].fd(), 0
+    );
+    ASSERT_NE(ours, MAP_FAILED);
+    ASSERT_NE(theirs, MAP_FAILED);
+
+    std::memcpy(ours, "guest", 5);
+    EXPECT_EQ(std::memcmp(theirs, "guest", 5), 0);
+
+    munmap(ours, SIZE);
+    munmap(theirs, SIZE);
+    close(memfd);
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+TEST(test_scm_rights, test_scm_rights_reply_attach) {
+    const auto sockets = make_pair();
+
+    Reply reply;
+    const std::array fds {sockets[0], sockets[1]};
+    auto result = reply.attach(fds);
+    EXPECT_TRUE(result.has_value());
+
+    // Attachments of the same reply are merged.
+    result = reply.attach(std::array {sockets[0]});
+    EXPECT_TRUE(result.has_value());
+    ASSERT_EQ(reply.attachments.size(), 1u);
+    EXPECT_EQ(reply.attachments[0].offset, 0u);
+    EXPECT_EQ(reply.attachments[0].raw().size(), 3u);
+
+    reply.data.resize(8);
+    result = reply.attach(fds);
+    EXPECT_TRUE(result.has_value());
+    ASSERT_EQ(reply.attachments.size(), 2u);
+    EXPECT_EQ(reply.attachments[1].offset, 8u);
+
+    // Rejected descriptors leave attachments untouched.
+    const std::vector<i32> many(MAX_PASSED_FDS, sockets[0]);
+    result = reply.attach(many);
+    EXPECT_FALSE(result.has_value());
+    ASSERT_EQ(reply.attachments.size(), 2u);
+    EXPECT_EQ(reply.attachments[1].raw().size(), 2u);
+
+    reply.data.resize(16);
+    result = reply.attach(std::array {sockets[0], -1});
+    EXPECT_FALSE(result.has_value());
+    EXPECT_EQ(reply.attachments.size(), 2u);
+
+    // Descriptors are duplicated, closing them leaves attached ones open.
+    const auto attached = reply.attachments[0].raw();
+    close(sockets[0]);
+    close(sockets[1]);
+
+    for (const auto fd : attached)
+        EXPECT_TRUE(core::utils::is_fd_open(fd));
+
+    reply.clear();
+    EXPECT_TRUE(reply.data.empty());
+    EXPECT_TRUE(reply.attachments.empty());
+
+    for (const auto fd : attached)
+        EXPECT_FALSE(core::utils::is_fd_open(fd));
+}
+
+TEST(test_scm_rights, test_scm_rights_invalid) {
+    const auto sockets = make_pair();
+    const Bytes data {std::byte {0x2a}};
+    const std::array fds {sockets[0]};
+
+    // Stream sockets need data to carry descriptors.
+    EXPECT_FALSE(send_fds(sockets[0], Bytes {}, fds).has_value());
+    EXPECT_FALSE(
+        send_fds(sockets[0], data, std::span<const i32> {}).has_value()
+    );
+    EXPECT_FALSE(send_fds(-1, data, fds).has_value());
+
+    const std::vector<i32> many(MAX_PASSED_FDS + 1, sockets[0]);
+    EXPECT_FALSE(send_fds(sockets[0], data, many).has_value());
+
+    Reply reply;
+    EXPECT_FALSE(reply.attach(many).has_value());
+    EXPECT_FALSE(reply.attach(std::array {-1}).has_value());
+
+    close(sockets[0]);
+    close(sockets[1]);
+}
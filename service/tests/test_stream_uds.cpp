@@ -3,12 +3,141 @@
 
 /// Stream unix domain socket (UDS) server tests.
 
+#include <nullvm/core/utils/io_uring.hpp>
 #include <nullvm/service/stream_uds.hpp>
+#include <nullvm/core/utils/eventfd.hpp>
 #include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cstring>
+#include <format>
+#include <thread>
+#include <vector>
+#include <array>
+#include <string>
+#include <bit>
 
 using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// Server socket path used in tests.
+    constexpr auto TEST_SERVER_PATH {"/tmp/nullvm_stream_server_test"};
+
+    /// @brief Connect to test server.
+    ///
+    /// @return Connected socket file descriptor.
+    auto connect_client() -> i32 {
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_NE(fd, -1);
+
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(
+            addr.sun_path, TEST_SERVER_PATH, sizeof(addr.sun_path) - 1
+        );
+
+        const auto ret = connect(
+            fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)
+        );
+        EXPECT_EQ(ret, 0);
+
+        return fd;
+    }
+
+    /// @brief Write whole buffer to socket.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] data given bytes to write.
+    auto write_all(i32 fd, std::span<const std::byte> data) -> void {
+        while (!data.empty()) {
+            const auto ret = write(fd, data.data(), data.size());
+            ASSERT_GT(ret, 0);
+            data = data.subspan(static_cast<usize>(ret));
+        }
+    }
+
+    /// @brief Send request and read reply.
+    ///
+    /// @param [in] fd given connected socket file descriptor.
+    /// @param [in] id given request ID.
+    /// @param [in] message given request payload.
+    ///
+    /// @return Reply payload.
+    auto request(i32 fd, u32 id, const std::string& message)
+    -> std::string {
+        Bytes output;
+        protocol::encode(
+            output, protocol::MessageType::VmStats, id,
+            std::as_bytes(std::span(message))
+        );
+        write_all(fd, output);
+
+        protocol::Parser parser;
+
+        for (;;) {
+            auto reply = parser.next();
+            EXPECT_TRUE(reply.has_value());
+
+            if (!reply)
+                return {};
+
+            if (reply.value()) {
+                EXPECT_EQ(reply.value()->header.id, id);
+                const auto payload = reply.value()->payload;
+
+                return {
+                    std::bit_cast<const char*>(payload.data()), payload.size()
+                };
+            }
+
+            const auto buffer = parser.buffer();
+            const auto ret = read(fd, buffer.data(), buffer.size());
+
+            if (ret <= 0)
+                return {};
+
+            parser.commit(static_cast<usize>(ret));
+        }
+    }
+
+    /// @brief Reply with the same payload.
+    auto echo(i32, const protocol::Message& message, Reply& output)
+    -> void {
+        protocol::encode(
+            output.data, protocol::MessageType::Ok, message.header.id,
+            message.payload
+        );
+    }
+
+    /// @brief Check whether kernel supports io_uring event loop.
+    ///
+    /// @return true - if single issuer ring with provided buffers works.
+    /// @return false - otherwise.
+    auto io_uring_supported() -> bool {
+        core::utils::IoUring ring;
+        auto result = ring.init(8, IORING_SETUP_SINGLE_ISSUER);
+
+        if (result) {
+            core::utils::BufferGroup buffers;
+            result = buffers.init(ring, 0, 1, 64);
+        }
+
+        return result.has_value();
+    }
+
+    /// Stream UDS server tests run with every I/O backend.
+    class test_stream_uds_backend
+        : public ::testing::TestWithParam<IOBackend> {
+    protected:
+        auto SetUp() -> void override {
+            if (GetParam() == IOBackend::IoUring && !io_uring_supported())
+                GTEST_SKIP() << "io_uring is not supported by kernel";
+        }
+    };
+}
 
 TEST(test_stream_uds, test_stream_uds_initialization) {
     auto server = StreamUDS();
@@ -61,4 +190,252 @@ TEST(test_stream_uds, test_stream_uds_recv_data_incorrect) {
 
     auto recv_result = server.recv(-1);
     EXPECT_FALSE(recv_result.has_value());
-}
\ No newline at end of file
+}
+
+TEST(test_stream_uds, test_stream_uds_invalid_path) {
+    auto server = StreamUDS({.path = std::string(256, 'a')});
+    auto result = server.init();
+
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_stream_uds, test_stream_uds_backend_resolution) {
+    auto server = StreamUDS({.backend = IOBackend::Epoll});
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(server.backend(), IOBackend::Epoll);
+
+    // Kernel without io_uring support falls back to epoll.
+    const auto expected = io_uring_supported() ?
+        IOBackend::IoUring : IOBackend::Epoll;
+
+    server = StreamUDS({.backend = IOBackend::Auto});
+    result = server.init();
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(server.backend(), expected);
+
+    // Explicit io_uring request does not fall back.
+    server = StreamUDS({.backend = IOBackend::IoUring});
+    result = server.init();
+    EXPECT_EQ(result.has_value(), expected == IOBackend::IoUring);
+}
+
+TEST_P(test_stream_uds_backend, test_stream_uds_serve_clients) {
+    auto server = StreamUDS({
+        .path = TEST_SERVER_PATH, .workers = 2, .backend = GetParam()
+    });
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    server.set_handler(echo);
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    std::vector<i32> clients;
+
+    for (usize i = 0; i < 32; ++i)
+        clients.push_back(connect_client());
+
+    // Connections stay open and are served concurrently.
+    for (usize round = 0; round < 2; ++round) {
+        for (usize i = 0; i < clients.size(); ++i) {
+            const auto message = std::format("client {} round {}", i, round);
+            const auto id = static_cast<u32>(i + round);
+            EXPECT_EQ(request(clients[i], id, message), message);
+        }
+    }
+
+    for (const auto fd : clients)
+        close(fd);
+
+    server.stop();
+}
+
+TEST_P(test_stream_uds_backend, test_stream_uds_slow_client) {
+    constexpr usize REPLY_SIZE {512 * 1024};
+
+    auto server = StreamUDS({
+        .path = TEST_SERVER_PATH, .workers = 1, .backend = GetParam()
+    });
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    // Large reply does not fit socket buffer of client that never reads.
+    server.set_handler(
+        [](i32 fd, const protocol::Message& message, Reply& output) {
+            if (message.header.type != protocol::MessageType::StartVm)
+                return echo(fd, message, output);
+
+            const Bytes reply(REPLY_SIZE);
+            protocol::encode(
+                output.data, protocol::MessageType::Ok, message.header.id,
+                reply
+            );
+        }
+    );
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto slow = connect_client();
+
+    Bytes output;
+    protocol::encode(output, protocol::MessageType::StartVm, 1);
+    write_all(slow, output);
+
+    const auto fast = connect_client();
+    EXPECT_EQ(request(fast, 2, "ping"), "ping");
+
+    close(slow);
+    close(fast);
+
+    server.stop();
+}
+
+TEST_P(test_stream_uds_backend, test_stream_uds_split_and_batched_messages) {
+    auto server = StreamUDS({
+        .path = TEST_SERVER_PATH, .workers = 1, .backend = GetParam()
+    });
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    server.set_handler(echo);
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client();
+
+    // Two requests in one write, second one split over two writes.
+    Bytes output;
+    const std::string first {"first"};
+    const std::string second(100 * 1024, 'x');
+    protocol::encode(
+        output, protocol::MessageType::VmStats, 1,
+        std::as_bytes(std::span(first))
+    );
+    protocol::encode(
+        output, protocol::MessageType::VmStats, 2,
+        std::as_bytes(std::span(second))
+    );
+
+    const auto half = output.size() / 2;
+    write_all(fd, std::span(output).first(half));
+    write_all(fd, std::span(output).subspan(half));
+
+    protocol::Parser parser;
+    std::vector<std::string> replies;
+
+    while (replies.size() < 2) {
+        auto reply = parser.next();
+        ASSERT_TRUE(reply.has_value());
+
+        if (reply.value()) {
+            const auto payload = reply.value()->payload;
+            replies.emplace_back(
+                std::bit_cast<const char*>(payload.data()), payload.size()
+            );
+            continue;
+        }
+
+        const auto buffer = parser.buffer();
+        const auto ret = read(fd, buffer.data(), buffer.size());
+        ASSERT_GT(ret, 0);
+        parser.commit(static_cast<usize>(ret));
+    }
+
+    EXPECT_EQ(replies[0], first);
+    EXPECT_EQ(replies[1], second);
+
+    // Malformed stream closes connection.
+    const std::array<std::byte, 16> garbage {};
+    write_all(fd, garbage);
+
+    std::array<std::byte, 16> data {};
+    EXPECT_EQ(read(fd, data.data(), data.size()), 0);
+
+    close(fd);
+    server.stop();
+}
+
+TEST_P(test_stream_uds_backend, test_stream_uds_pass_descriptors) {
+    auto server = StreamUDS({
+        .path = TEST_SERVER_PATH, .workers = 1, .backend = GetParam()
+    });
+    auto result = server.init();
+    EXPECT_TRUE(result.has_value());
+
+    EventFd event;
+    result = event.init();
+    EXPECT_TRUE(result.has_value());
+
+    // Reply to second request carries event descriptor.
+    server.set_handler(
+        [&event](i32 fd, const protocol::Message& message, Reply& output) {
+            if (message.header.id == 2) {
+                const std::array fds {event.fd()};
+                EXPECT_TRUE(output.attach(fds).has_value());
+            }
+
+            echo(fd, message, output);
+        }
+    );
+
+    std::jthread thread([&server] {
+        EXPECT_TRUE(server.run().has_value());
+    });
+
+    const auto fd = connect_client();
+
+    Bytes output;
+
+    for (u32 id = 1; id <= 3; ++id)
+        protocol::encode(output, protocol::MessageType::VmStats, id);
+
+    write_all(fd, output);
+
+    protocol::Parser parser;
+    std::vector<FDWrapper> fds;
+    u32 replies {0};
+    u32 replies_before_fds {0};
+
+    while (replies < 3) {
+        auto reply = parser.next();
+        ASSERT_TRUE(reply.has_value());
+
+        if (reply.value()) {
+            EXPECT_EQ(reply.value()->header.id, ++replies);
+            continue;
+        }
+
+        const auto passed = fds.size();
+        const auto ret = recv_fds(fd, parser.buffer(), fds);
+        ASSERT_TRUE(ret.has_value());
+        ASSERT_GT(ret.value(), 0u);
+        parser.commit(ret.value());
+
+        if (passed == 0 && !fds.empty())
+            replies_before_fds = replies;
+    }
+
+    // Descriptor arrives with first byte of its reply.
+    ASSERT_EQ(fds.size(), 1u);
+    EXPECT_EQ(replies_before_fds, 1u);
+
+    // Passed descriptor refers to the same event.
+    const u64 value {7};
+    EXPECT_EQ(write(fds[0].fd(), &value, sizeof(value)), 8);
+    EXPECT_EQ(event.read().value_or(0), value);
+
+    close(fd);
+    server.stop();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    test_stream_uds, test_stream_uds_backend,
+    ::testing::Values(IOBackend::Epoll, IOBackend::IoUring, IOBackend::Auto)
+);
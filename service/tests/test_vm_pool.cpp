@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Pre-initialized virtual machines pool tests.
+
+#include <nullvm/service/vm_pool.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// @brief Wait until pool is refilled to given size.
+    ///
+    /// @param [in] pool given virtual machines pool.
+    /// @param [in] size given expected number of ready virtual machines.
+    ///
+    /// @return true - if pool was refilled in time.
+    /// @return false - otherwise.
+    auto wait_refill(VmPool& pool, usize size) -> bool {
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (pool.size() == size)
+                return true;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return false;
+    }
+}
+
+TEST(test_vm_pool, test_vm_pool_initialization) {
+    VmPool pool;
+
+    auto result = pool.init({.capacity = 2});
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(pool.size(), 2);
+
+    VmPool empty;
+    result = empty.init({.capacity = 0});
+    EXPECT_FALSE(result.has_value());
+}
+
+TEST(test_vm_pool, test_vm_pool_acquire_and_refill) {
+    VmPool pool;
+
+    auto result = pool.init({
+        .vm          = {},
+        .memory_addr = 0x0,
+        .memory_size = 0x10000,
+        .capacity    = 2,
+    });
+    EXPECT_TRUE(result.has_value());
+
+    auto vm = pool.acquire();
+    EXPECT_TRUE(vm.has_value());
+    EXPECT_EQ(pool.stats().hits, 1);
+
+    // Memory is already mapped, VM is ready to run.
+    result = vm.value()->load_raw({0xf4});
+    EXPECT_TRUE(result.has_value());
+
+    result = vm.value()->run();
+    EXPECT_TRUE(result.has_value());
+
+    EXPECT_TRUE(wait_refill(pool, 2));
+}
+
+TEST(test_vm_pool, test_vm_pool_acquire_drained) {
+    VmPool pool;
+
+    auto result = pool.init({.capacity = 1});
+    EXPECT_TRUE(result.has_value());
+
+    // Pool never blocks: VMs are created inline when it is empty.
+    std::vector<std::unique_ptr<core::VirtualMachine>> vms;
+
+    for (usize i = 0; i < 4; ++i) {
+        auto vm = pool.acquire();
+        EXPECT_TRUE(vm.has_value());
+        vms.push_back(std::move(vm.value()));
+    }
+
+    const auto stats = pool.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 4);
+    EXPECT_GE(stats.misses, 1);
+}
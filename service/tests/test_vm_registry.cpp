@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2025-present nullvm project and contributors
+
+/// Virtual machines managed by service tests.
+
+#include <nullvm/service/vm_registry.hpp>
+#include <nullvm/service/protocol.hpp>
+#include <gtest/gtest.h>
+#include <optional>
+
+using namespace nullvm::service;
+using namespace nullvm;
+
+namespace {
+    /// Guest memory size of pooled virtual machines.
+    constexpr usize MEMORY_SIZE {0x10000};
+
+    /// @brief Handle request and parse its reply.
+    ///
+    /// @param [in] registry given virtual machines registry.
+    /// @param [in] type given request type.
+    /// @param [in] payload given request payload.
+    /// @param [out] output given buffer reply is stored in.
+    ///
+    /// @return Reply - if request was handled.
+    /// @return std::nullopt - otherwise.
+    template <typename T>
+    auto request(
+        VmRegistry& registry, protocol::MessageType type, const T& payload,
+        Bytes& output
+    ) -> std::optional<protocol::Message> {
+        Bytes input;
+        protocol::encode(
+            input, type, 42, std::as_bytes(std::span(&payload, 1))
+        );
+
+        const auto message = protocol::parse(
+            input, protocol::MAX_PAYLOAD_SIZE
+        );
+        EXPECT_TRUE(message.has_value());
+
+        output.clear();
+
+        if (!registry.handle(message.value(), output))
+            return std::nullopt;
+
+        auto reply = protocol::parse(output, protocol::MAX_PAYLOAD_SIZE);
+        EXPECT_TRUE(reply.has_value());
+        EXPECT_EQ(reply->header.id, 42u);
+
+        return reply.value();
+    }
+
+    /// Virtual machines registry test fixture.
+    class test_vm_registry : public testing::Test {
+    protected:
+        VmPool pool;
+        MetricsRegistry metrics;
+
+        auto SetUp() -> void override {
+            const auto result = pool.init({
+                .vm          = {.vcpus = 1},
+                .memory_addr = 0x0,
+                .memory_size = MEMORY_SIZE,
+                .capacity    = 2,
+            });
+            ASSERT_TRUE(result.has_value()) << result.error();
+        }
+
+        /// @brief Check whether metrics registry serves request.
+        ///
+        /// @param [in] type given statistics request type.
+        /// @param [in] vm given virtual machine request.
+        ///
+        /// @return true - if Ok reply is appended.
+        /// @return false - otherwise.
+        auto served(protocol::MessageType type, const protocol::VmRequest& vm)
+        -> bool {
+            Bytes input;
+            protocol::encode(
+                input, type, 1, std::as_bytes(std::span(&vm, 1))
+            );
+
+            const auto message = protocol::parse(
+                input, protocol::MAX_PAYLOAD_SIZE
+            );
+            Bytes output;
+
+            if (!message || !metrics.handle(message.value(), output))
+                return false;
+
+            const auto reply = protocol::parse(
+                output, protocol::MAX_PAYLOAD_SIZE
+            );
+
+            return reply && reply->header.type == protocol::MessageType::Ok;
+        }
+    };
+}
+
+TEST_F(test_vm_registry, test_vm_registry_lifecycle) {
+    using protocol::MessageType;
+
+    VmRegistry registry(pool, metrics);
+    Bytes output;
+
+    // Creation is served from pool.
+    const protocol::CreateVmRequest create {
+        .vcpus = 1, .reserved = 0, .memory_size = MEMORY_SIZE
+    };
+
+    auto reply = request(registry, MessageType::CreateVm, create, output);
+    ASSERT_TRUE(reply.has_value());
+    ASSERT_EQ(reply->header.type, MessageType::Ok);
+    EXPECT_EQ(pool.stats().hits, 1u);
+    EXPECT_EQ(registry.size(), 1u);
+
+    const auto created =
+        protocol::decode<protocol::CreateVmReply>(reply->payload);
+    ASSERT_TRUE(created.has_value());
+
+    const protocol::VmRequest vm {.vm_id = created->vm_id};
+
+    // Statistics of created virtual machine are served.
+    EXPECT_TRUE(served(MessageType::VmStats, vm));
+
+    // Not started virtual machine cannot be stopped.
+    reply = request(registry, MessageType::StopVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Error);
+
+    reply = request(registry, MessageType::StartVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Ok);
+
+    reply = request(registry, MessageType::StopVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Ok);
+
+    // Stopped virtual machine can be started again.
+    reply = request(registry, MessageType::StartVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Ok);
+
+    reply = request(registry, MessageType::DestroyVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Ok);
+    EXPECT_EQ(registry.size(), 0u);
+    EXPECT_FALSE(served(MessageType::VmStats, vm));
+
+    reply = request(registry, MessageType::StartVm, vm, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Error);
+}
+
+TEST_F(test_vm_registry, test_vm_registry_invalid) {
+    using protocol::MessageType;
+
+    VmRegistry registry(pool, metrics);
+    Bytes output;
+
+    // Configuration pool is not initialized with.
+    const protocol::CreateVmRequest create {
+        .vcpus = 2, .reserved = 0, .memory_size = MEMORY_SIZE
+    };
+
+    auto reply = request(registry, MessageType::CreateVm, create, output);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->header.type, MessageType::Error);
+    EXPECT_EQ(registry.size(), 0u);
+
+    const protocol::VmRequest vm {.vm_id = 1};
+
+    for (const auto type : {MessageType::StartVm, MessageType::StopVm,
+                            MessageType::DestroyVm}) {
+        reply = request(registry, type, vm, output);
+        ASSERT_TRUE(reply.has_value());
+        EXPECT_EQ(reply->header.type, MessageType::Error);
+    }
+
+    // Other requests are left to other handlers.
+    reply = request(registry, MessageType::VmStats, vm, output);
+    EXPECT_FALSE(reply.has_value());
+    EXPECT_TRUE(output.empty());
+}